@@ -9,6 +9,7 @@
 #include "fs.hpp"
 #include "log.hpp"
 #include "utils/audio.hpp"
+#include "utils/io_qos.hpp"
 
 #ifdef USE_NVJPG
 #include <nvjpg.hpp>
@@ -342,6 +343,14 @@ public:
     option::OptionBool m_nsz_compress_block{"dump", "nsz_compress_block", false};
     option::OptionLong m_nsz_compress_block_exponent{"dump", "nsz_compress_block_exponent", 6};
 
+    // io budget for bulk transfers on the sd card, only used with file based emummc.
+    option::OptionLong m_qos_bulk_read_rate{"qos", "bulk_read_rate", utils::qos::DEFAULT_READ_RATE}; // MiB/s, 0 = unlimited.
+    option::OptionLong m_qos_bulk_write_rate{"qos", "bulk_write_rate", utils::qos::DEFAULT_WRITE_RATE}; // MiB/s, 0 = unlimited.
+    option::OptionLong m_qos_bulk_burst{"qos", "bulk_burst", utils::qos::DEFAULT_BURST}; // KiB
+
+    // seconds of audio decoded ahead of playback.
+    option::OptionLong m_audio_decode_ahead{"audio", "decode_ahead", 2};
+
     // todo: move this into it's own menu
     option::OptionLong m_text_scroll_speed{"accessibility", "text_scroll_speed", 1}; // normal
 
@@ -561,6 +561,8 @@ enum class SphairaResult : Result {
     AppstoreFailedZipDownload,
     AppstoreFailedMd5,
     AppstoreFailedParseManifest,
+    AppstoreFailedParseRepo,
+    AppstoreBadRepoIndex,
 
     GameBadReadForDump,
     GameEmptyMetaEntries,
@@ -574,6 +576,7 @@ enum class SphairaResult : Result {
 
     NcaFailedNcaHeaderHashVerify,
     NcaBadSigKeyGen,
+    NcaFailedHashVerify,
 
     GcBadReadForDump,
     GcEmptyGamecard,
@@ -735,6 +738,8 @@ enum : Result {
     MAKE_SPHAIRA_RESULT_ENUM(AppstoreFailedZipDownload),
     MAKE_SPHAIRA_RESULT_ENUM(AppstoreFailedMd5),
     MAKE_SPHAIRA_RESULT_ENUM(AppstoreFailedParseManifest),
+    MAKE_SPHAIRA_RESULT_ENUM(AppstoreFailedParseRepo),
+    MAKE_SPHAIRA_RESULT_ENUM(AppstoreBadRepoIndex),
     MAKE_SPHAIRA_RESULT_ENUM(GameBadReadForDump),
     MAKE_SPHAIRA_RESULT_ENUM(GameEmptyMetaEntries),
     MAKE_SPHAIRA_RESULT_ENUM(GameMultipleKeysFound),
@@ -745,6 +750,7 @@ enum : Result {
     MAKE_SPHAIRA_RESULT_ENUM(KeyFailedDecyptETicketDeviceKey),
     MAKE_SPHAIRA_RESULT_ENUM(NcaFailedNcaHeaderHashVerify),
     MAKE_SPHAIRA_RESULT_ENUM(NcaBadSigKeyGen),
+    MAKE_SPHAIRA_RESULT_ENUM(NcaFailedHashVerify),
     MAKE_SPHAIRA_RESULT_ENUM(GcBadReadForDump),
     MAKE_SPHAIRA_RESULT_ENUM(GcEmptyGamecard),
     MAKE_SPHAIRA_RESULT_ENUM(GcBadXciMagic),
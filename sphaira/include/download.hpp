@@ -21,6 +21,12 @@ enum {
 
     // sets CURLOPT_NOBODY.
     Flag_NoBody = 1 << 1,
+
+    // large files are downloaded in parts over multiple connections,
+    // if the server supports range requests.
+    // an interrupted download is resumed on the next request to the same path.
+    // this api is only available on downloading to file.
+    Flag_Segmented = 1 << 2,
 };
 
 enum class Priority {
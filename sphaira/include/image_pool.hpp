@@ -0,0 +1,44 @@
+#pragma once
+
+#include "image.hpp"
+#include <functional>
+#include <vector>
+#include <switch.h>
+
+namespace sphaira::image_pool {
+
+// returns the encoded image, called from a worker thread.
+using LoadCallback = std::function<std::vector<u8>()>;
+
+// decodes (and resizes) icons on a shared pool of worker threads.
+// each menu owns a queue, the ui thread only has to create textures from
+// the decoded images that are ready.
+struct Queue {
+    // starts the worker threads (ref counted).
+    Queue();
+    // cancels all requests and closes the worker threads.
+    ~Queue();
+
+    // call at the start of each draw, requests made (or touched) this frame
+    // are loaded before older ones, in the order that they were made.
+    void BeginFrame();
+
+    // bumps the priority of an image that was already requested.
+    // returns false if it was never requested.
+    bool Touch(u64 id);
+
+    // adds a new request, id is used by the menu to find the entry.
+    void Push(u64 id, LoadCallback&& load);
+
+    // returns an image that has finished decoding.
+    // out->data is empty if the image failed to load.
+    bool Pop(u64* id, ImageResult* out);
+
+    // cancels all requests, call when the entries are rebuilt.
+    void Clear();
+
+private:
+    const u64 m_id;
+};
+
+} // namespace sphaira::image_pool
@@ -34,6 +34,32 @@ using StartCallback = std::function<Result(PullCallback pull)>;
 // trying to read from the pull callback before it is set.
 using StartCallback2 = std::function<Result(StartThreadCallback start, PullCallback pull)>;
 
+// stats for a single stage of a multi-threaded transfer.
+struct TransferStageStats {
+    // time spent waiting on another stage.
+    u64 stall_ns;
+    u64 bytes;
+};
+
+struct TransferStats {
+    u64 elapsed_ns;
+    u64 buffer_size;
+    TransferStageStats read;
+    TransferStageStats decompress;
+    TransferStageStats write;
+    // only used by the pull api.
+    TransferStageStats pull;
+    // average number of buffers queued, sampled on every push.
+    double read_occupancy;
+    double write_occupancy;
+    // depth of the ring when the transfer ended.
+    u32 read_depth;
+    u32 write_depth;
+};
+
+// returns the stats of the last multi-threaded transfer, these are also logged.
+auto GetLastTransferStats() -> TransferStats;
+
 // reads data from rfunc into wfunc.
 Result Transfer(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfunc, const WriteCallback& wfunc, Mode mode = Mode::MultiThreaded);
 Result Transfer(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfunc, const DecompressCallback& dfunc, const WriteCallback& wfunc, Mode mode = Mode::MultiThreaded);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ui/menus/grid_menu_base.hpp"
+#include "ui/menus/appstore_index.hpp"
 #include "ui/scrollable_text.hpp"
 #include "ui/scrolling_text.hpp"
 #include "ui/list.hpp"
@@ -42,24 +43,25 @@ enum class EntryStatus {
     Update,
 };
 
+// strings are views into the repo index string pool and are null terminated.
 struct Entry {
-    std::string category{}; // todo: lable
-    std::string binary{}; // optional, only valid for .nro
-    std::string updated{}; // date of update
-    std::string name{};
-    std::string license{}; // optional
-    std::string title{}; // same as name but with spaces
-    std::string url{}; // url of repo (optional?)
-    std::string description{};
-    std::string author{};
-    std::string changelog{}; // optional
+    std::string_view category{}; // todo: lable
+    std::string_view binary{}; // optional, only valid for .nro
+    std::string_view updated{}; // date of update
+    std::string_view name{};
+    std::string_view license{}; // optional
+    std::string_view title{}; // same as name but with spaces
+    std::string_view url{}; // url of repo (optional?)
+    std::string_view description{};
+    std::string_view author{};
+    std::string_view changelog{}; // optional
     u64 screens{}; // number of screenshots
     u64 extracted{}; // extracted size in KiB
-    std::string version{};
+    std::string_view version{};
     u64 filesize{}; // compressed size in KiB
-    std::string details{};
+    std::string_view details{};
     u64 app_dls{};
-    std::string md5{}; // md5 of the zip
+    std::string_view md5{}; // md5 of the zip
 
     LazyImage image{};
     u32 updated_num{};
@@ -178,6 +180,10 @@ private:
 private:
     static constexpr inline const char* INI_SECTION = "appstore";
 
+    // entries point into the index, so it must outlive them.
+    RepoIndex m_repo{};
+    // etag of the downloaded repo.json.
+    std::string m_repo_key{};
     std::vector<Entry> m_entries{};
     std::vector<EntryMini> m_entries_index[Filter_MAX]{};
     std::vector<EntryMini> m_entries_index_author{};
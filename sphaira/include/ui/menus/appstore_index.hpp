@@ -0,0 +1,104 @@
+#pragma once
+
+#include "fs.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <switch.h>
+
+namespace sphaira::ui::menu::appstore {
+
+// string in the index string pool, always null terminated.
+struct IndexString {
+    u32 offset;
+    u32 length;
+};
+
+// fixed size record for each package in the repo.json.
+struct IndexRecord {
+    IndexString category;
+    IndexString binary;
+    IndexString updated;
+    IndexString name;
+    IndexString license;
+    IndexString title;
+    IndexString url;
+    IndexString description;
+    IndexString author;
+    IndexString changelog;
+    IndexString version;
+    IndexString details;
+    IndexString md5;
+    u64 screens;
+    u64 extracted;
+    u64 filesize;
+    u64 app_dls;
+    u32 updated_num; // dd/mm/yyyy as yyyymmdd.
+    u32 filter; // appstore::Filter.
+};
+
+struct IndexHeader {
+    u32 magic;
+    u32 version;
+    // etag of the repo.json that this index was built from.
+    IndexString key;
+    s64 json_size;
+    u64 json_modified;
+    u32 record_count;
+    u32 trigram_count;
+    u32 posting_count;
+    u32 pool_size;
+};
+
+// record indices that contain the trigram, stored in postings.
+struct IndexTrigram {
+    u32 trigram;
+    u32 offset;
+    u32 count;
+};
+
+enum SearchField {
+    SearchField_Title = 1 << 0,
+    SearchField_Author = 1 << 1,
+    SearchField_Description = 1 << 2,
+};
+
+// the repo.json compiled into a single buffer.
+// layout: header, records, trigrams, postings, string pool.
+struct RepoIndex {
+    // loads the index, rebuilding it from the json if the key (etag) or json changed.
+    Result Open(fs::Fs* fs, const fs::FsPath& json_path, const fs::FsPath& index_path, std::string_view key);
+
+    auto GetCount() const -> u32 {
+        return m_records.size();
+    }
+
+    auto GetRecord(u32 index) const -> const IndexRecord& {
+        return m_records[index];
+    }
+
+    auto GetString(const IndexString& str) const -> std::string_view {
+        return {m_pool.data() + str.offset, str.length};
+    }
+
+    // fills out with the index of every record where query is found (case-insensitive)
+    // in one of the fields, out is cleared first.
+    void Search(std::string_view query, u32 fields, std::vector<u32>& out) const;
+
+private:
+    Result Load(fs::Fs* fs, const fs::FsPath& index_path);
+    Result Build(fs::Fs* fs, const fs::FsPath& json_path, const fs::FsPath& index_path, std::string_view key, s64 json_size, u64 json_modified);
+    Result Parse(std::vector<u8>&& data);
+    void Reset();
+
+private:
+    std::vector<u8> m_data{};
+    const IndexHeader* m_header{};
+    std::span<const IndexRecord> m_records{};
+    std::span<const IndexTrigram> m_trigrams{};
+    std::span<const u32> m_postings{};
+    std::span<const char> m_pool{};
+};
+
+} // namespace sphaira::ui::menu::appstore
@@ -115,15 +115,14 @@ struct FsEntry {
     }
 };
 
-// roughly 1kib in size per entry
+// copy of a single entry, used for selections and callbacks.
+// roughly 1kib in size per entry, see FileEntryList for how a listing is stored.
 struct FileEntry final : FsDirectoryEntry {
-    std::string extension{}; // if any
     std::string internal_name{}; // if any
     std::string internal_extension{}; // if any
     s64 file_count{-1}; // number of files in a folder, non-recursive
     s64 dir_count{-1}; // number folders in a folder, non-recursive
     FsTimeStampRaw time_stamp{};
-    bool checked_extension{}; // did we already search for an ext?
     bool checked_internal_extension{}; // did we already search for an ext?
     bool selected{}; // is this file selected?
     bool done_stat{}; // have we checked file_size / count.
@@ -145,12 +144,10 @@ struct FileEntry final : FsDirectoryEntry {
     }
 
     auto GetExtension() const -> std::string {
-        if (!checked_extension) {
-            if (auto ext = std::strrchr(name, '.')) {
-                return ext+1;
-            }
+        if (auto ext = std::strrchr(name, '.')) {
+            return ext+1;
         }
-        return extension;
+        return {};
     }
 
     auto GetInternalName() const -> std::string {
@@ -172,6 +169,127 @@ struct FileEntry final : FsDirectoryEntry {
     }
 };
 
+// compact storage for a directory listing, roughly 40 bytes per entry plus the name.
+// names are stored back to back in an arena along with a case folded copy that
+// is used for sorting, everything else is stored in arrays indexed by entry.
+struct FileEntryList {
+    enum Flag : u8 {
+        Flag_Dir = 1 << 0,
+        Flag_Selected = 1 << 1,
+        Flag_DoneStat = 1 << 2, // have we checked file_size / count.
+        Flag_CheckedInternalExtension = 1 << 3, // did we already search for an ext?
+        Flag_TimeStampValid = 1 << 4,
+    };
+
+    void clear();
+    void reserve(size_t count, size_t name_size);
+    void push_back(const FsDirectoryEntry& e);
+
+    auto size() const -> size_t {
+        return m_name_offsets.size();
+    }
+
+    auto empty() const -> bool {
+        return m_name_offsets.empty();
+    }
+
+    // returns a full copy of the entry.
+    auto Get(u32 i) const -> FileEntry;
+
+    auto GetName(u32 i) const -> const char* {
+        return m_names.data() + m_name_offsets[i];
+    }
+
+    // returns the case folded name.
+    auto GetSortKey(u32 i) const -> std::string_view {
+        return {m_keys.data() + m_name_offsets[i], m_name_lengths[i]};
+    }
+
+    auto GetExtension(u32 i) const -> std::string_view {
+        if (!m_ext_offsets[i]) {
+            return {};
+        }
+        return {GetName(i) + m_ext_offsets[i], size_t(m_name_lengths[i] - m_ext_offsets[i])};
+    }
+
+    auto HasFlag(u32 i, u8 flag) const -> bool {
+        return m_flags[i] & flag;
+    }
+
+    void SetFlag(u32 i, u8 flag, bool set) {
+        if (set) {
+            m_flags[i] |= flag;
+        } else {
+            m_flags[i] &= ~flag;
+        }
+    }
+
+    auto IsDir(u32 i) const -> bool {
+        return HasFlag(i, Flag_Dir);
+    }
+
+    auto IsFile(u32 i) const -> bool {
+        return !IsDir(i);
+    }
+
+    auto IsHidden(u32 i) const -> bool {
+        return GetName(i)[0] == '.';
+    }
+
+    auto IsSelected(u32 i) const -> bool {
+        return HasFlag(i, Flag_Selected);
+    }
+
+    void SetSelected(u32 i, bool selected) {
+        SetFlag(i, Flag_Selected, selected);
+    }
+
+    auto GetFileSize(u32 i) const -> s64 {
+        return m_file_sizes[i];
+    }
+
+    auto GetFileCount(u32 i) const -> s64 {
+        return m_file_counts[i];
+    }
+
+    auto GetDirCount(u32 i) const -> s64 {
+        return m_dir_counts[i];
+    }
+
+    auto IsTimeStampValid(u32 i) const -> bool {
+        return HasFlag(i, Flag_TimeStampValid);
+    }
+
+    auto GetTimeStamp(u32 i) const -> u64 {
+        return m_time_stamps[i];
+    }
+
+    void SetDirStat(u32 i, s64 file_count, s64 dir_count);
+    void SetFileStat(u32 i, const FsTimeStampRaw& time_stamp, s64 file_size);
+    void SetInternalName(u32 i, const std::string& name, const std::string& extension);
+
+private:
+    struct InternalName {
+        u32 index;
+        std::string name;
+        std::string extension;
+    };
+
+private:
+    std::string m_names{};
+    std::string m_keys{};
+    std::vector<u32> m_name_offsets{};
+    std::vector<u16> m_name_lengths{};
+    std::vector<u16> m_ext_offsets{}; // 0 if no ext.
+    std::vector<u8> m_flags{};
+    std::vector<s64> m_file_sizes{};
+    std::vector<s32> m_file_counts{}; // number of files in a folder, non-recursive
+    std::vector<s32> m_dir_counts{}; // number folders in a folder, non-recursive
+    std::vector<u64> m_time_stamps{}; // modified time.
+    // only set for the few entries that have been checked, such as zips.
+    std::vector<InternalName> m_internal_names{};
+};
+
 struct FileAssocEntry {
     fs::FsPath path{}; // ini name
     std::string name{}; // ini name
@@ -211,6 +329,7 @@ using FsDirCollections = std::vector<FsDirCollection>;
 void SignalChange();
 
 struct Base;
+struct StatWorker;
 
 struct FsView final : Widget {
     friend class Base;
@@ -260,7 +379,7 @@ struct FsView final : Widget {
     }
 
     auto GetNewPath(s64 index) const -> fs::FsPath {
-        return GetNewPath(m_path, GetEntry(index).name);
+        return GetNewPath(m_path, m_entries.GetName(GetEntryIndex(index)));
     }
 
     auto GetNewPathCurrent() const -> fs::FsPath {
@@ -273,9 +392,9 @@ struct FsView final : Widget {
         if (!m_selected_count) {
             out.emplace_back(GetEntry());
         } else {
-            for (auto&e : m_entries) {
-                if (e.IsSelected()) {
-                    out.emplace_back(e);
+            for (u32 i = 0; i < m_entries.size(); i++) {
+                if (m_entries.IsSelected(i)) {
+                    out.emplace_back(m_entries.Get(i));
                 }
             }
         }
@@ -283,19 +402,29 @@ struct FsView final : Widget {
         return out;
     }
 
-    auto GetEntry(u32 index) -> FileEntry& {
-        return m_entries[m_entries_current[index]];
+    // returns the index into m_entries.
+    auto GetEntryIndex(u32 index) const -> u32 {
+        return m_entries_current[index];
     }
 
-    auto GetEntry(u32 index) const -> const FileEntry& {
-        return m_entries[m_entries_current[index]];
+    auto GetEntryIndex() const -> u32 {
+        return GetEntryIndex(m_index);
     }
 
-    auto GetEntry() -> FileEntry& {
-        return GetEntry(m_index);
+    auto GetEntryName() const -> const char* {
+        return m_entries.GetName(GetEntryIndex());
     }
 
-    auto GetEntry() const -> const FileEntry& {
+    auto GetEntryExtension() const -> std::string_view {
+        return m_entries.GetExtension(GetEntryIndex());
+    }
+
+    // returns a copy of the entry.
+    auto GetEntry(u32 index) const -> FileEntry {
+        return m_entries.Get(GetEntryIndex(index));
+    }
+
+    auto GetEntry() const -> FileEntry {
         return GetEntry(m_index);
     }
 
@@ -307,6 +436,13 @@ struct FsView final : Widget {
     void SortAndFindLastFile(bool scan = false);
     void SetIndexFromLastFile(const LastFile& last_file);
 
+    // queues the visible range of entries to be stat'd in the background.
+    void QueueStat(s64 first, s64 last);
+    // applies finished stat results to the entries.
+    void UpdateStat();
+    // drops pending stats, must be called before the entries are cleared.
+    void CancelStat();
+
     void OnDeleteCallback();
     void OnPasteCallback();
     void OnRenameCallback();
@@ -339,7 +475,7 @@ struct FsView final : Widget {
     std::shared_ptr<fs::Fs> m_fs{};
     FsEntry m_fs_entry{};
     fs::FsPath m_path{};
-    std::vector<FileEntry> m_entries{};
+    FileEntryList m_entries{};
     std::vector<u32> m_entries_index{}; // files not including hidden
     std::vector<u32> m_entries_index_hidden{}; // includes hidden files
     std::vector<u32> m_entries_index_search{}; // files found via search
@@ -357,6 +493,11 @@ struct FsView final : Widget {
     s64 m_selected_count{};
     ScrollingText m_scroll_name{};
 
+    std::unique_ptr<StatWorker> m_stat_worker{};
+    // last range passed to QueueStat().
+    s64 m_stat_first{-1};
+    s64 m_stat_last{-1};
+
     bool m_is_update_folder{};
 };
 
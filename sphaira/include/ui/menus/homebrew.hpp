@@ -3,6 +3,7 @@
 #include "ui/menus/grid_menu_base.hpp"
 #include "ui/list.hpp"
 #include "nro.hpp"
+#include "image_pool.hpp"
 #include "fs.hpp"
 #include "option.hpp"
 
@@ -82,6 +83,8 @@ private:
 
     s64 m_index{}; // where i am in the array
     std::unique_ptr<List> m_list{};
+    // decodes icons off the ui thread.
+    image_pool::Queue m_icons{};
     bool m_dirty{};
 
     option::OptionLong m_sort{INI_SECTION, "sort", SortType::SortType_AlphabeticalStar};
@@ -2,6 +2,9 @@
 
 #include "ui/menus/menu_base.hpp"
 #include "yati/source/stream.hpp"
+#include <span>
+#include <algorithm>
+#include <atomic>
 
 namespace sphaira::ui::menu::stream {
 
@@ -22,20 +25,75 @@ using OnInstallStart = std::function<bool(const char* path)>;
 using OnInstallWrite = std::function<bool(const void* buf, size_t size)>;
 using OnInstallClose = std::function<void()>;
 
+// fixed size single producer / single consumer byte ring.
+// each position is only written by its owner, so reading and writing does not
+// need a lock, the caller only has to sleep when the ring is empty / full.
+struct ByteRing {
+    explicit ByteRing(u64 capacity) : m_buffer(capacity) {}
+
+    // contiguous data that can be read, may be less than Size() if it wraps.
+    auto ReadSpan() const -> std::span<const u8> {
+        const u64 read = m_read;
+        const auto off = read % m_buffer.size();
+        const auto size = std::min<u64>(m_write - read, m_buffer.size() - off);
+        return {m_buffer.data() + off, size};
+    }
+
+    void Consume(u64 size) {
+        m_read += size;
+    }
+
+    // contiguous space that can be written, may be less than Free() if it wraps.
+    auto WriteSpan() -> std::span<u8> {
+        const u64 write = m_write;
+        const auto off = write % m_buffer.size();
+        const auto size = std::min<u64>(m_buffer.size() - (write - m_read), m_buffer.size() - off);
+        return {m_buffer.data() + off, size};
+    }
+
+    void Commit(u64 size) {
+        m_write += size;
+    }
+
+    auto Size() const -> u64 {
+        return m_write - m_read;
+    }
+
+    auto Free() const -> u64 {
+        return m_buffer.size() - Size();
+    }
+
+private:
+    std::vector<u8> m_buffer;
+    // free running, only the consumer writes m_read and the producer m_write.
+    std::atomic<u64> m_read{};
+    std::atomic<u64> m_write{};
+};
+
 struct Stream final : yati::source::Stream {
     Stream(const fs::FsPath& path, std::stop_token token);
 
     Result ReadChunk(void* buf, s64 size, u64* bytes_read) override;
+    Result Skip(s64 off, s64 size) override;
     bool Push(const void* buf, s64 size);
     void Disable();
     auto& GetPath() const { return m_path; }
 
+private:
+    // sleeps until there is data / space in the ring, or the stream is disabled.
+    void WaitForRead();
+    void WaitForWrite();
+    // only takes the lock if the other side is sleeping.
+    void Signal(CondVar* var, const std::atomic_bool& waiting);
+
 private:
     fs::FsPath m_path{};
     std::stop_token m_token{};
-    std::vector<u8> m_buffer{};
+    ByteRing m_ring;
     CondVar m_can_read{};
     CondVar m_can_write{};
+    std::atomic_bool m_read_waiting{};
+    std::atomic_bool m_write_waiting{};
 
 public:
     Mutex m_mutex{};
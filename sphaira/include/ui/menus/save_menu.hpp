@@ -3,6 +3,7 @@
 #include "ui/menus/grid_menu_base.hpp"
 #include "ui/list.hpp"
 #include "title_info.hpp"
+#include "image_pool.hpp"
 #include "fs.hpp"
 #include "option.hpp"
 #include "dumper.hpp"
@@ -107,6 +108,8 @@ private:
     s64 m_index{}; // where i am in the array
     s64 m_selected_count{};
     std::unique_ptr<List> m_list{};
+    // decodes icons off the ui thread.
+    image_pool::Queue m_icons{};
     bool m_is_reversed{};
     bool m_dirty{};
 
@@ -5,6 +5,7 @@
 #include "fs.hpp"
 #include "utils/audio.hpp"
 #include <memory>
+#include <vector>
 
 namespace sphaira::ui::music {
 
@@ -16,6 +17,13 @@ struct Menu final : Widget {
     void Draw(NVGcontext* vg, Theme* theme) override;
 
 private:
+    // plays the other songs in the same folder once this one ends.
+    void ScanPlaylist(const fs::FsPath& path);
+    // reloads the info / meta and queues up the next song.
+    void OnSongChanged();
+    // returns false if there's no song left to play.
+    bool OpenNextSong();
+
     void PauseToggle();
     void SeekForward();
     void SeekBack();
@@ -24,7 +32,12 @@ private:
     void DecreaseVolume();
 
 private:
+    fs::Fs* m_fs{};
     audio::SongID m_song{};
+    std::vector<fs::FsPath> m_playlist{};
+    u32 m_index{};
+    // matches audio::Progress::track.
+    u32 m_track{};
     audio::Info m_info{};
     audio::Meta m_meta{};
     // only set if metadata was loaded.
@@ -31,6 +31,8 @@ struct ProgressBox final : Widget {
     // zeros the saved offset.
     auto ResetTranfser() -> ProgressBox&;
     auto UpdateTransfer(s64 offset, s64 size) -> ProgressBox&;
+    // extra info shown next to the speed, such as the buffers used.
+    auto SetTransferInfo(const std::string& info) -> ProgressBox&;
     // not const in order to avoid copy by using std::swap
     auto SetImage(int image) -> ProgressBox&;
     auto SetImageData(std::vector<u8>& data) -> ProgressBox&;
@@ -92,6 +94,7 @@ private:
     std::string m_action{};
     std::string m_title{};
     std::string m_transfer{};
+    std::string m_transfer_info{};
     s64 m_size{};
     s64 m_offset{};
     s64 m_last_offset{};
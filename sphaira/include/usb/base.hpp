@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <switch.h>
+#include "utils/buffer_pool.hpp"
 
 namespace sphaira::usb {
 
@@ -23,7 +24,7 @@ struct Base {
         return TransferPacketImpl(read, page, remaining, size, out_size_transferred, m_transfer_timeout);
     }
 
-    // transfers all data.
+    // transfers all data, page aligned buffers are transferred directly.
     Result TransferAll(bool read, void *data, u32 size, u64 timeout);
     Result TransferAll(bool read, void *data, u32 size) {
         return TransferAll(read, data, size, m_transfer_timeout);
@@ -57,7 +58,10 @@ protected:
 private:
     u64 m_transfer_timeout{};
     UEvent m_uevent{};
-    std::unique_ptr<u8*> m_aligned{};
+    // keeps pipeline buffers cached for the lifetime of the session.
+    utils::ScopedBufferPool m_buffer_pool{};
+    // only used for unaligned buffers, allocated on first use.
+    utils::PageBuffer m_bounce{};
 };
 
 } // namespace sphaira::usb
@@ -26,6 +26,15 @@ enum : u32 {
     FLAG_STREAM = 1 << 0,
 };
 
+// the device asks for a pipeline window in arg4 of the first SendPacket,
+// the host replies with the window it accepts in arg4 of the ResultPacket.
+// older hosts leave arg4 as 0, in which case each request waits for its result.
+enum : u32 {
+    PIPELINE_WINDOW_NONE = 1,
+    PIPELINE_WINDOW = 4,
+    PIPELINE_WINDOW_MAX = 16,
+};
+
 struct UsbPacket {
     u32 magic{};
     u32 arg2{};
@@ -35,11 +35,17 @@ struct Usb {
 private:
     Result SendAndVerify(const void* data, u32 size, u64 timeout, api::ResultPacket* out = nullptr);
     Result SendAndVerify(const void* data, u32 size, api::ResultPacket* out = nullptr);
+    Result ReceiveResult();
 
 private:
     std::unique_ptr<usb::UsbDs> m_usb{};
     Result m_open_result{};
     bool m_was_connected{};
+
+    // number of writes that can be in flight, 1 is stop-and-wait.
+    u32 m_window{api::PIPELINE_WINDOW_NONE};
+    // number of writes that have been sent, but not yet acked.
+    u32 m_pending{};
 };
 
 } // namespace sphaira::usb::dumpl
@@ -2,9 +2,11 @@
 
 #include "usb/usbds.hpp"
 #include "usb/usb_api.hpp"
+#include "utils/buffer_pool.hpp"
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <memory>
 #include <switch.h>
 
@@ -37,11 +39,33 @@ private:
     Result SendAndVerify(const void* data, u32 size, u64 timeout, api::ResultPacket* out = nullptr);
     Result SendAndVerify(const void* data, u32 size, api::ResultPacket* out = nullptr);
 
+    // pipelined reads, only used if the host accepted a window > 1.
+    Result ReadPipelined(void* buf, u64 off, u32 size, u64* bytes_read);
+    Result RequestBlock(u64 off);
+    Result ReceiveBlock();
+    Result ReceiveBlock(void* buf, u32* out_size);
+    Result DrainPending();
+
 private:
     std::unique_ptr<usb::UsbDs> m_usb{};
     Result m_open_result{};
     bool m_was_connected{};
     u32 m_flags{};
+
+    // number of requests that can be in flight, 1 is stop-and-wait.
+    u32 m_window{api::PIPELINE_WINDOW_NONE};
+    u64 m_file_size{};
+    struct Block {
+        u64 off;
+        u32 size;
+    };
+
+    // blocks that have been requested, but not yet received.
+    std::deque<Block> m_pending{};
+    // last received block, reads that want a whole block skip this.
+    utils::PageBuffer m_block{};
+    u64 m_block_off{};
+    u64 m_block_size{};
 };
 
 } // namespace sphaira::usb::install
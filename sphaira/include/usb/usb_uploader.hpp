@@ -1,6 +1,7 @@
 #pragma once
 
 #include "usb/usbhs.hpp"
+#include "utils/buffer_pool.hpp"
 
 #include <string>
 #include <memory>
@@ -42,7 +43,7 @@ private:
 
 private:
     std::unique_ptr<usb::UsbHs> m_usb{};
-    std::vector<u8> m_buf{};
+    utils::PageBuffer m_buf{};
     Result m_open_result{};
     bool m_was_connected{};
 };
@@ -17,6 +17,8 @@ enum class State {
 
 struct Progress {
     u64 played;
+    // incremented each time a queued song starts playing.
+    u32 track;
 };
 
 struct Info {
@@ -65,6 +67,14 @@ Result PlaySong(SongID id);
 Result PauseSong(SongID id);
 Result SeekSong(SongID id, u64 target);
 
+// plays the song straight after the current one, without a gap.
+// the song is loaded in the background, it is dropped if it fails to load or
+// can't be played on the same voice, ie, the sample rate or channel count
+// differ, in which case it should be opened once the current song has finished.
+Result QueueSong(SongID id, fs::Fs* fs, const fs::FsPath& path);
+// returns true if the file extension is a supported format, this is cheap.
+bool IsSongSupported(const fs::FsPath& path);
+
 // todo:
 // 0.0 -> 2.0.
 Result GetVolumeSong(SongID id, float* out);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <switch.h>
+
+namespace sphaira::utils {
+
+// usb requires page aligned buffers, anything transferred from a buffer
+// allocated here can skip the bounce copy.
+constexpr u64 BUFFER_ALIGN = 0x1000;
+
+// returns page aligned memory, the size is rounded up to the page size.
+void* BufferPoolAlloc(std::size_t size);
+void BufferPoolFree(void* ptr, std::size_t size);
+
+static inline bool IsBufferAligned(const void* ptr) {
+    return !(reinterpret_cast<std::uintptr_t>(ptr) & (BUFFER_ALIGN - 1));
+}
+
+// freed buffers are only cached while a scope is alive, so that the
+// transfer threads, yati and usb can reuse each others buffers.
+// once the last scope exits, the cache is freed.
+struct ScopedBufferPool {
+    ScopedBufferPool();
+    ~ScopedBufferPool();
+
+    ScopedBufferPool(const ScopedBufferPool&) = delete;
+    ScopedBufferPool& operator=(const ScopedBufferPool&) = delete;
+};
+
+template<typename T>
+struct BufferPoolAllocator {
+    using value_type = T;
+
+    BufferPoolAllocator() = default;
+
+    template<typename U>
+    BufferPoolAllocator(const BufferPoolAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(BufferPoolAlloc(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        BufferPoolFree(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const BufferPoolAllocator<U>&) const {
+        return true;
+    }
+};
+
+// vector whose data is always page aligned.
+using PageBuffer = std::vector<u8, BufferPoolAllocator<u8>>;
+
+} // namespace sphaira::utils
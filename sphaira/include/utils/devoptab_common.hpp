@@ -138,6 +138,8 @@ struct MountConfig {
     bool no_stat_dir{true};
     bool fs_hidden{};
     bool dump_hidden{};
+    // seconds that listings and stats are cached for, 0 to disable.
+    long cache_ttl{};
 
     std::unordered_map<std::string, std::string> extra{};
 };
@@ -161,6 +163,19 @@ struct MountDevice {
         return common::fix_path(str, out, strip_leading_slash);
     }
 
+    // return true if dirnext fills in the full stat, in which case lstat
+    // can be answered from a cached listing.
+    virtual bool dirnext_has_full_stat() const {
+        return false;
+    }
+
+    // return true if file handles don't share any state, in which case file calls
+    // (read, write, seek...) only lock the file rather than the whole device.
+    // path and directory calls always lock the device.
+    virtual bool supports_concurrent_files() const {
+        return false;
+    }
+
     virtual bool Mount() = 0;
     virtual int devoptab_open(void *fileStruct, const char *path, int flags, int mode) { return -EIO; }
     virtual int devoptab_close(void *fd) { return -EIO; }
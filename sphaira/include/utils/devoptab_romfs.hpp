@@ -13,6 +13,9 @@ struct RomfsCollection {
     romfs_header header;
     std::vector<u8> dir_table;
     std::vector<u8> file_table;
+    // used for path lookups, empty if the romfs does not have them.
+    std::vector<u32> dir_hash_table;
+    std::vector<u32> file_hash_table;
     u64 offset;
 };
 
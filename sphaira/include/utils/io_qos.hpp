@@ -0,0 +1,65 @@
+#pragma once
+
+#include <switch.h>
+
+namespace sphaira::utils::qos {
+
+enum Device {
+    // sd card, this includes nand when using file based emummc.
+    Device_Sd,
+    Device_Count,
+};
+
+// reads and writes have their own budget, so that a copy which reads and
+// writes the same device runs at the full rate rather than half of it.
+enum Direction {
+    Direction_Read,
+    Direction_Write,
+    Direction_Count,
+};
+
+enum Priority {
+    // ui io, such as listing a folder or loading icons. never waits but uses
+    // up budget, so that bulk io backs off while the ui is busy.
+    Priority_Foreground,
+    // copies, installs, dumps and hashing.
+    Priority_Bulk,
+};
+
+// default budgets for file based emummc, in MiB/s and KiB.
+// each direction is above what the old 2ms sleep allowed on a typical card,
+// see tools/host/test_io_qos.cpp.
+constexpr s64 DEFAULT_READ_RATE = 72;
+constexpr s64 DEFAULT_WRITE_RATE = 60;
+constexpr s64 DEFAULT_BURST = 1024;
+
+struct Budget {
+    s64 rate; // bytes per second, 0 for unlimited.
+    s64 burst; // bytes that can be used up front before waiting.
+};
+
+// token bucket, kept separate from the device state so that it can be
+// driven with a fake clock.
+struct TokenBucket {
+    void SetBudget(const Budget& budget, u64 now);
+
+    // reserves size bytes at time now (in ns) and returns how long the
+    // caller should wait before doing the io, always 0 for foreground io.
+    // bulk callers are served in the order they reserve, so threads share fairly.
+    auto Reserve(u64 now, s64 size, Priority priority) -> u64;
+
+private:
+    Budget m_budget{};
+    // time at which all reserved io is paid for (GCRA theoretical arrival time).
+    u64 m_tat{};
+};
+
+// budgets default to unlimited, see App for when they are set.
+void SetBudget(Device device, Direction direction, const Budget& budget);
+
+// blocks bulk io until the device has enough budget for size bytes, each
+// byte should only be charged once. foreground io is charged without waiting.
+// replaces the fixed 2ms sleep that was used for file based emummc.
+void Acquire(Device device, Direction direction, Priority priority, s64 size);
+
+} // namespace sphaira::utils::qos
@@ -3,6 +3,7 @@
 #include "defines.hpp"
 #include <functional>
 #include <atomic>
+#include <bit>
 
 namespace sphaira::utils {
 
@@ -14,6 +15,15 @@ static inline Result CreateThread(Thread *t, ThreadFunc entry, void *arg, size_t
     R_SUCCEED();
 }
 
+// returns the number of cores the process is allowed to run on.
+static inline u32 GetCoreCount() {
+    u64 core_mask = 0;
+    if (R_FAILED(svcGetInfo(&core_mask, InfoType_CoreMask, CUR_PROCESS_HANDLE, 0)) || !core_mask) {
+        return 1;
+    }
+    return std::popcount(core_mask);
+}
+
 struct Async final {
     using Callback = std::function<void(void)>;
 
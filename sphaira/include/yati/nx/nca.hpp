@@ -332,16 +332,34 @@ Result GetDecryptedTitleKey(fs::Fs* fs, const fs::FsPath& path, Header& header,
 
 // helpers.
 struct DecyptedData : yati::source::Base {
+    // largest alignment supported (xts sector size).
+    static constexpr u64 MAX_ALIGN = 0x200;
+    // unaligned head / tail blocks are decrypted into here.
+    static constexpr u32 CACHE_BLOCKS = 4;
+
     DecyptedData(u64 align, const std::shared_ptr<yati::source::Base>& source);
     Result Read(void *_buf, s64 _off, s64 _size, u64* _bytes_read) override;
     virtual Result SetCtr(u64 ctr) = 0;
 
+protected:
+    // must be called if the same offset would now decrypt differently.
+    void InvalidateCache();
+
 private:
     virtual Result Decrypt(void* buf, s64 off, s64 size) = 0;
+    Result ReadBlock(s64 off, const u8** out);
 
 private:
+    struct CachedBlock {
+        s64 off;
+        bool valid;
+        u8 data[MAX_ALIGN];
+    };
+
     std::shared_ptr<yati::source::Base> m_source;
     const u64 m_align;
+    CachedBlock m_cache[CACHE_BLOCKS]{};
+    u32 m_cache_next{};
 };
 
 // todo: add support for xts sections.
@@ -355,22 +373,36 @@ private:
 private:
     Aes128CtrContext m_ctx{};
     u8 m_ctr[AES_BLOCK_SIZE]{};
+    u64 m_section_ctr{};
 };
 
+struct HashTree;
+
 struct NcaReader final : yati::source::Base {
     NcaReader(const nca::Header& decrypted_header, const void* key, u64 size, const std::shared_ptr<yati::source::Base>& source);
+    ~NcaReader();
     Result Read(void *_buf, s64 off, s64 size, u64* bytes_read) override;
     Result ReadEncrypted(void *_buf, s64 off, s64 size, u64* bytes_read);
 
+    // if enabled, decrypted reads are checked against the section's hash tree
+    // and fail with Result_NcaFailedHashVerify if the data is corrupted.
+    void SetVerify(bool enable) {
+        m_verify = enable;
+    }
+
 private:
     Result ReadInternal(void *_buf, s64 off, s64 size, u64* bytes_read, bool decrypt);
+    Result ReadSection(u32 index, void *_buf, s64 off, s64 size);
+    Result ReadVerified(u32 index, void *_buf, s64 off, s64 size);
 
 private:
     const nca::Header m_header;
     const u64 m_capacity;
     std::shared_ptr<yati::source::Base> m_source;
     std::unique_ptr<DecyptedData> m_decryptor{};
+    std::unique_ptr<HashTree> m_hash_tree[NCA_SECTION_TOTAL]{};
     u8 m_key[0x10]{};
+    bool m_verify{};
 };
 
 } // namespace sphaira::nca
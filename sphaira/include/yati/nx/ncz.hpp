@@ -1,11 +1,11 @@
 #pragma once
 
 #include "yati/source/base.hpp"
-#include "utils/lru.hpp"
 #include "defines.hpp"
 
 #include <switch.h>
 #include <vector>
+#include <deque>
 #include <memory>
 #include <zstd.h>
 
@@ -75,20 +75,45 @@ using Sections = std::vector<Section>;
 
 struct NczBlockReader final : yati::source::Base {
     explicit NczBlockReader(const Header& header, const Sections& sections, const BlockHeader& block_header, const Blocks& blocks, u64 offset, const std::shared_ptr<yati::source::Base>& source);
+    ~NczBlockReader();
+
     Result Read(void *_buf, s64 off, s64 size, u64* bytes_read) override;
 
 private:
-    struct LruData {
-        s64 offset{};
+    enum class SlotState {
+        Empty,
+        // block is being decompressed by a worker.
+        Pending,
+        Ready,
+    };
+
+    struct Slot {
         std::vector<u8> data{};
+        s64 block_id{-1};
+        u64 last_use{};
+        Result rc{};
+        SlotState state{SlotState::Empty};
+    };
 
-        auto InRange(u64 off) const -> bool {
-            return off < offset + data.size() && off >= offset;
-        }
+    struct Worker {
+        NczBlockReader* self{};
+        ZSTD_DCtx* dctx{};
+        // buffer that the compressed block is read into.
+        std::vector<u8> temp{};
+        Thread thread{};
+        bool created{};
     };
 
 private:
-    Result ReadInternal(void *_buf, s64 off, s64 size, u64* bytes_read, bool decrypt);
+    Result GetBlock(s64 block_id, Slot*& slot_out);
+    Result DecompressBlock(s64 block_id, ZSTD_DCtx* dctx, std::vector<u8>& temp, std::vector<u8>& out);
+    void Prefetch(s64 block_id);
+    void CreateWorkers();
+    // returns the least recently used slot that is not pending or within the range.
+    auto GetFreeSlot(s64 block_lo, s64 block_hi) const -> s32;
+    void AssignSlot(s32 index, s64 block_id);
+
+    static void WorkerFunc(void* arg);
 
 private:
     const Header m_header;
@@ -101,9 +126,30 @@ private:
     u32 m_block_size{};
     std::vector<BlockInfo> m_block_infos{};
 
-    // lru cache of blocks
-    std::vector<LruData> m_lru_data{};
-    utils::Lru<LruData> m_lru{};
+    // fixed pool of decompressed blocks.
+    std::vector<Slot> m_slots{};
+    // maps block_id to slot index, -1 if not cached.
+    std::vector<s32> m_block_slots{};
+    // used for blocks decompressed on the reader thread.
+    ZSTD_DCtx* m_dctx{};
+    std::vector<u8> m_temp{};
+    u64 m_tick{};
+
+    // read-ahead is enabled once sequential access is detected.
+    s64 m_last_block_id{-1};
+    u32 m_readahead{};
+
+    Mutex m_mutex{};
+    // serialises reads from the source as it may not be thread safe.
+    Mutex m_source_mutex{};
+    CondVar m_can_work{};
+    CondVar m_can_read{};
+    // slot indices queued for the workers.
+    std::deque<s32> m_jobs{};
+    std::vector<Worker> m_workers{};
+    u32 m_worker_count{};
+    bool m_workers_created{};
+    bool m_quit{};
 };
 
 } // namespace sphaira::ncz
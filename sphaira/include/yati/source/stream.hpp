@@ -9,10 +9,17 @@ namespace sphaira::yati::source {
 // streams are for data that do not allow for random access,
 // such as FTP or MTP.
 struct Stream : Base {
+    // size of the buffer used to discard data when skipping.
+    static constexpr s64 SKIP_BUFFER_SIZE = 1024 * 64;
+
     virtual ~Stream() = default;
     virtual Result ReadChunk(void* buf, s64 size, u64* bytes_read) = 0;
 
     Result Read(void* buf, s64 off, s64 size, u64* bytes_read) override;
+    // skips size bytes starting at off, called by Read() when seeking forward.
+    // the default reads the data into a small buffer and discards it, streams
+    // that can drop the data without a copy should override this.
+    virtual Result Skip(s64 off, s64 size);
 
     bool IsStream() const override {
         return true;
@@ -27,6 +34,8 @@ protected:
 
 private:
     s64 m_offset{};
+    // reused between skips, see Skip().
+    std::vector<u8> m_skip_buffer{};
 };
 
 } // namespace sphaira::yati::source
@@ -27,6 +27,7 @@
 #include "utils/profile.hpp"
 #include "utils/thread.hpp"
 #include "utils/devoptab.hpp"
+#include "utils/io_qos.hpp"
 
 #include <nanovg_dk.h>
 #include <minIni.h>
@@ -1542,6 +1543,12 @@ App::App(const char* argv0) {
             else if (app->m_nsz_compress_ldm.LoadFrom(Key, Value)) {}
             else if (app->m_nsz_compress_block.LoadFrom(Key, Value)) {}
             else if (app->m_nsz_compress_block_exponent.LoadFrom(Key, Value)) {}
+        } else if (!std::strcmp(Section, "qos")) {
+            if (app->m_qos_bulk_read_rate.LoadFrom(Key, Value)) {}
+            else if (app->m_qos_bulk_write_rate.LoadFrom(Key, Value)) {}
+            else if (app->m_qos_bulk_burst.LoadFrom(Key, Value)) {}
+        } else if (!std::strcmp(Section, "audio")) {
+            if (app->m_audio_decode_ahead.LoadFrom(Key, Value)) {}
         } else if (!std::strcmp(Section, "ftp")) {
             if (app->m_ftp_port.LoadFrom(Key, Value)) {}
             else if (app->m_ftp_anon.LoadFrom(Key, Value)) {}
@@ -1661,6 +1668,18 @@ App::App(const char* argv0) {
                 log_write("[emummc] file based path: %s\n", m_emummc_paths.file_based_path);
                 log_write("[emummc] nintendo path: %s\n", m_emummc_paths.nintendo);
             }
+
+            // heavy io starves the emummc driver, so bulk io is rate limited.
+            if (App::IsFileBaseEmummc()) {
+                utils::qos::SetBudget(utils::qos::Device_Sd, utils::qos::Direction_Read, {
+                    .rate = m_qos_bulk_read_rate.Get() * 1024 * 1024,
+                    .burst = m_qos_bulk_burst.Get() * 1024,
+                });
+                utils::qos::SetBudget(utils::qos::Device_Sd, utils::qos::Direction_Write, {
+                    .rate = m_qos_bulk_write_rate.Get() * 1024 * 1024,
+                    .burst = m_qos_bulk_burst.Get() * 1024,
+                });
+            }
         }
 
         devoptab::FixDkpBug();
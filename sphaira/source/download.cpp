@@ -14,6 +14,7 @@
 #include <mutex>
 #include <algorithm>
 #include <ranges>
+#include <optional>
 #include <curl/curl.h>
 #include <yyjson.h>
 
@@ -32,6 +33,8 @@ namespace {
 
 constexpr auto API_AGENT = "TotalJustice";
 constexpr u64 CHUNK_SIZE = 1024*1024;
+// number of full buffers that can be queued for the disk writer before curl has to wait.
+constexpr u32 WRITE_BUFFER_COUNT = 4;
 constexpr auto MAX_THREADS = 4;
 
 std::atomic_bool g_running{};
@@ -48,11 +51,56 @@ struct UploadStruct {
     fs::File f{};
 };
 
+// downloads to file hand full buffers to a writer thread, so that slow sd card
+// writes don't stall the connection.
+// the thread is only started once the first buffer is full, smaller files are
+// written on close.
+struct FileWriter {
+    FileWriter() {
+        mutexInit(&m_mutex);
+        condvarInit(&m_can_write);
+        condvarInit(&m_can_push);
+    }
+
+    ~FileWriter() {
+        std::vector<u8> empty;
+        Close(empty);
+    }
+
+    auto Open(fs::FsNativeSd& fs, const fs::FsPath& path) -> Result {
+        return fs.OpenFile(path, FsOpenMode_Write|FsOpenMode_Append, &m_file);
+    }
+
+    // queues the buffer to be written and swaps in an empty one from the pool.
+    // blocks if the queue is full.
+    auto Push(std::vector<u8>& buf) -> bool;
+
+    // writes the remaining data, waits for the queue to be written and closes the file.
+    auto Close(std::vector<u8>& buf) -> bool;
+
+private:
+    static void ThreadFunc(void* p);
+
+    fs::File m_file{};
+    s64 m_offset{};
+
+    Thread m_thread{};
+    bool m_started{};
+    bool m_closing{};
+    bool m_failed{};
+
+    Mutex m_mutex{};
+    CondVar m_can_write{};
+    CondVar m_can_push{};
+    std::deque<std::vector<u8>> m_queue{};
+    // written buffers are reused by the write callback.
+    std::vector<std::vector<u8>> m_pool{};
+};
+
 struct DataStruct {
     std::vector<u8> data;
     s64 offset{};
-    fs::File f{};
-    s64 file_offset{};
+    FileWriter writer{};
 };
 
 struct SeekCustomData {
@@ -522,33 +570,123 @@ auto WriteFileCallback(void *contents, size_t size, size_t num_files, void *user
     }
 
     auto data_struct = static_cast<DataStruct*>(userp);
+    auto& buf = data_struct->data;
+    const auto data = static_cast<const u8*>(contents);
     const auto realsize = size * num_files;
 
-    // flush data if incomming data would overflow the buffer
-    if (data_struct->offset && data_struct->data.size() < data_struct->offset + realsize) {
-        if (R_FAILED(data_struct->f.Write(data_struct->file_offset, data_struct->data.data(), data_struct->offset, FsWriteOption_None))) {
+    for (size_t off = 0; off < realsize;) {
+        const auto rsize = std::min<size_t>(realsize - off, CHUNK_SIZE - buf.size());
+        buf.insert(buf.end(), data + off, data + off + rsize);
+        off += rsize;
+
+        // hand the full buffer to the writer thread.
+        if (buf.size() == CHUNK_SIZE && !data_struct->writer.Push(buf)) {
             return 0;
         }
-
-        data_struct->file_offset += data_struct->offset;
-        data_struct->offset = 0;
     }
 
-    // we have a huge chunk! write it directly to file
-    if (data_struct->data.size() < realsize) {
-        if (R_FAILED(data_struct->f.Write(data_struct->file_offset, contents, realsize, FsWriteOption_None))) {
-            return 0;
+    return realsize;
+}
+
+auto FileWriter::Push(std::vector<u8>& buf) -> bool {
+    if (!m_started) {
+        if (R_FAILED(utils::CreateThread(&m_thread, ThreadFunc, this, 1024*32))) {
+            log_write("[CURL] failed to create writer thread\n");
+            return false;
+        }
+
+        if (R_FAILED(threadStart(&m_thread))) {
+            log_write("[CURL] failed to start writer thread\n");
+            threadClose(&m_thread);
+            return false;
         }
+        m_started = true;
+    }
+
+    SCOPED_MUTEX(&m_mutex);
+    while (m_queue.size() >= WRITE_BUFFER_COUNT && !m_failed) {
+        condvarWait(&m_can_push, &m_mutex);
+    }
+
+    if (m_failed) {
+        return false;
+    }
 
-        data_struct->file_offset += realsize;
+    m_queue.emplace_back(std::move(buf));
+    condvarWakeOne(&m_can_write);
+
+    if (!m_pool.empty()) {
+        buf = std::move(m_pool.back());
+        m_pool.pop_back();
     } else {
-        // buffer data until later
-        std::memcpy(data_struct->data.data() + data_struct->offset, contents, realsize);
-        data_struct->offset += realsize;
+        buf = {};
+        buf.reserve(CHUNK_SIZE);
     }
 
-    Yield();
-    return realsize;
+    return true;
+}
+
+auto FileWriter::Close(std::vector<u8>& buf) -> bool {
+    if (m_started) {
+        if (!buf.empty() && !Push(buf)) {
+            m_failed = true;
+        }
+
+        mutexLock(&m_mutex);
+        m_closing = true;
+        condvarWakeOne(&m_can_write);
+        mutexUnlock(&m_mutex);
+
+        threadWaitForExit(&m_thread);
+        threadClose(&m_thread);
+        m_started = false;
+    } else if (!buf.empty()) {
+        if (R_FAILED(m_file.Write(m_offset, buf.data(), buf.size(), FsWriteOption_None))) {
+            m_failed = true;
+        }
+        m_offset += buf.size();
+    }
+
+    buf.clear();
+    m_queue.clear();
+    m_pool.clear();
+    m_file.Close();
+    return !m_failed;
+}
+
+void FileWriter::ThreadFunc(void* p) {
+    auto w = static_cast<FileWriter*>(p);
+    std::vector<u8> buf;
+
+    for (;;) {
+        mutexLock(&w->m_mutex);
+        while (w->m_queue.empty() && !w->m_closing) {
+            condvarWait(&w->m_can_write, &w->m_mutex);
+        }
+
+        if (w->m_queue.empty()) {
+            mutexUnlock(&w->m_mutex);
+            break;
+        }
+
+        buf = std::move(w->m_queue.front());
+        w->m_queue.pop_front();
+        mutexUnlock(&w->m_mutex);
+
+        const auto rc = w->m_file.Write(w->m_offset, buf.data(), buf.size(), FsWriteOption_None);
+        w->m_offset += buf.size();
+
+        SCOPED_MUTEX(&w->m_mutex);
+        buf.clear();
+        w->m_pool.emplace_back(std::move(buf));
+        condvarWakeOne(&w->m_can_push);
+
+        if (R_FAILED(rc)) {
+            log_write("[CURL] failed to write download: 0x%X\n", rc);
+            w->m_failed = true;
+            break;
+        }
+    }
 }
 
 auto header_callback(char* b, size_t size, size_t nitems, void* userdata) -> size_t {
@@ -678,8 +816,593 @@ void SetCommonCurlOptions(CURL* curl, const Api& e) {
     } else {
         CURL_EASY_SETOPT_LOG(curl, CURLOPT_XFERINFOFUNCTION, ProgressCallbackFunc1);
     }
+}
+
+auto BuildHeaderList(const Header& header) -> curl_slist* {
+    curl_slist* list{};
+
+    for (const auto& [key, value] : header.m_map) {
+        if (value.empty()) {
+            continue;
+        }
+
+        // create header key value pair.
+        const auto header_str = key + ": " + value;
+
+        // try to append header chunk.
+        auto temp = curl_slist_append(list, header_str.c_str());
+        if (temp) {
+            log_write("adding header: %s\n", header_str.c_str());
+            list = temp;
+        } else {
+            log_write("failed to append header\n");
+        }
+    }
+
+    return list;
+}
+
+// segmented downloads split the file into parts, which are downloaded by the
+// calling thread and any idle download threads at the same time.
+// progress is saved to a journal next to the temp file so that an
+// interrupted download can be resumed.
+constexpr s64 SEGMENT_PART_SIZE = 1024 * 1024 * 4;
+// smaller files are downloaded over a single connection.
+constexpr s64 SEGMENT_MIN_SIZE = SEGMENT_PART_SIZE * 2;
+// number of times a part is retried before the download fails.
+constexpr u32 SEGMENT_RETRY_MAX = 3;
+constexpr u32 SEGMENT_JOURNAL_MAGIC = 0x4A474553; // SEGJ
+constexpr u32 SEGMENT_JOURNAL_VERSION = 0;
+
+struct SegmentJournalHeader {
+    u32 magic;
+    u32 version;
+    s64 total_size;
+    s64 part_size;
+    u32 part_count;
+    u32 url_crc;
+    // crc of the etag / last-modified, resume is disabled if the server sends neither.
+    u32 validator_crc;
+    u32 reserved;
+};
+
+struct SegmentPart {
+    s64 off{};
+    s64 size{};
+    // bytes written to the file, this is saved in the journal.
+    s64 done{};
+    u32 retries{};
+    bool active{};
+};
+
+struct SegmentDownload {
+    const Api* api{};
+    // url after redirects, so that each part doesn't have to follow them again.
+    std::string url{};
+    curl_slist* headers{};
+    s64 total_size{};
+
+    fs::File file{};
+    fs::File journal{};
+
+    Mutex mutex{};
+    CondVar can_wait{};
+    std::vector<SegmentPart> parts{};
+    // number of download threads helping.
+    u32 helpers{};
+
+    // bytes received, used for progress.
+    std::atomic<s64> downloaded{};
+    // set on error or cancel, stops all parts.
+    std::atomic_bool failed{};
+};
+
+struct SegmentWriter {
+    CURL* curl{};
+    SegmentDownload* ctx{};
+    SegmentPart* part{};
+    u32 index{};
+    // only the thread that started the download reports progress.
+    bool is_owner{};
+    bool checked_code{};
+    std::vector<u8> buf{};
+    s64 buf_off{};
+};
+
+Mutex g_segment_mutex{};
+std::vector<SegmentDownload*> g_segment_downloads{};
+
+auto SegmentFlush(SegmentWriter& w) -> bool {
+    if (!w.buf_off) {
+        return true;
+    }
+
+    auto& part = *w.part;
+    if (R_FAILED(w.ctx->file.Write(part.off + part.done, w.buf.data(), w.buf_off, FsWriteOption_None))) {
+        log_write("[SEGMENT] failed to write part: %u\n", w.index);
+        return false;
+    }
+
+    part.done += w.buf_off;
+    w.buf_off = 0;
+
+    // the journal entry is only updated once the data has been written.
+    const auto journal_off = sizeof(SegmentJournalHeader) + w.index * sizeof(part.done);
+    if (R_FAILED(w.ctx->journal.Write(journal_off, &part.done, sizeof(part.done), FsWriteOption_None))) {
+        log_write("[SEGMENT] failed to update journal: %u\n", w.index);
+    }
+
+    return true;
+}
+
+auto SegmentWriteCallback(void *contents, size_t size, size_t num_files, void *userp) -> size_t {
+    auto w = static_cast<SegmentWriter*>(userp);
+    if (!g_running || w->ctx->failed) {
+        return 0;
+    }
+
+    // a server that ignores the range would send the file from the start.
+    if (!w->checked_code) {
+        long http_code = 0;
+        curl_easy_getinfo(w->curl, CURLINFO_RESPONSE_CODE, &http_code);
+        if (http_code != 206) {
+            log_write("[SEGMENT] part: %u got code: %ld\n", w->index, http_code);
+            return 0;
+        }
+        w->checked_code = true;
+    }
+
+    auto data = static_cast<const u8*>(contents);
+    const auto realsize = size * num_files;
+
+    if (w->part->done + w->buf_off + (s64)realsize > w->part->size) {
+        log_write("[SEGMENT] part: %u received too much data\n", w->index);
+        return 0;
+    }
+
+    for (size_t off = 0; off < realsize;) {
+        const auto rsize = std::min<size_t>(realsize - off, w->buf.size() - w->buf_off);
+        std::memcpy(w->buf.data() + w->buf_off, data + off, rsize);
+        w->buf_off += rsize;
+        off += rsize;
+
+        if (w->buf_off == (s64)w->buf.size() && !SegmentFlush(*w)) {
+            w->ctx->failed = true;
+            return 0;
+        }
+    }
+
+    w->ctx->downloaded += realsize;
+    return realsize;
+}
+
+// returns false if the download should stop.
+auto SegmentReportProgress(SegmentDownload& ctx) -> bool {
+    const auto& api = *ctx.api;
+    if (!g_running || api.GetToken().stop_requested()) {
+        return false;
+    }
+
+    if (api.GetOnProgress() && !api.GetOnProgress()(ctx.total_size, ctx.downloaded, 0, 0)) {
+        return false;
+    }
+
+    return true;
+}
+
+auto SegmentProgressCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) -> size_t {
+    auto w = static_cast<SegmentWriter*>(clientp);
+    if (!g_running || w->ctx->failed) {
+        return 1;
+    }
+
+    if (w->is_owner && !SegmentReportProgress(*w->ctx)) {
+        w->ctx->failed = true;
+        return 1;
+    }
+
+    Yield();
+    return 0;
+}
+
+auto SegmentDownloadPart(CURL* curl, SegmentDownload& ctx, u32 index, bool is_owner) -> bool {
+    auto& part = ctx.parts[index];
+
+    SegmentWriter w{curl, &ctx, &part, index, is_owner};
+    w.buf.resize(CHUNK_SIZE);
+
+    // resume from where the part was left.
+    char range[64];
+    std::snprintf(range, sizeof(range), "%lld-%lld", (long long)(part.off + part.done), (long long)(part.off + part.size - 1));
+
+    curl_easy_reset(curl);
+    SetCommonCurlOptions(curl, *ctx.api);
+
+    // ranges apply to the encoded data, so ask for the file as is.
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_ACCEPT_ENCODING, nullptr);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_URL, ctx.url.c_str());
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_RANGE, range);
+
+    if (ctx.headers) {
+        CURL_EASY_SETOPT_LOG(curl, CURLOPT_HTTPHEADER, ctx.headers);
+    }
+
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_WRITEFUNCTION, SegmentWriteCallback);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_WRITEDATA, &w);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_XFERINFOFUNCTION, SegmentProgressCallback);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_XFERINFODATA, &w);
+
+    const auto res = curl_easy_perform(curl);
+
+    // whatever was received is valid, keep it so that a retry can continue from it.
+    if (w.checked_code && !ctx.failed && !SegmentFlush(w)) {
+        ctx.failed = true;
+    }
+
+    // drop data that was counted but never written.
+    ctx.downloaded -= w.buf_off;
+
+    if (res != CURLE_OK || part.done != part.size) {
+        log_write("[SEGMENT] part: %u failed: %s done: %zd size: %zd\n", index, curl_easy_strerror(res), part.done, part.size);
+        return false;
+    }
+
+    return true;
+}
+
+// returns the index of the next part to download, or -1 if there are none.
+// lock must be held.
+auto SegmentNextPart(SegmentDownload& ctx) -> s32 {
+    if (ctx.failed) {
+        return -1;
+    }
+
+    for (u32 i = 0; i < ctx.parts.size(); i++) {
+        const auto& part = ctx.parts[i];
+        if (!part.active && part.done < part.size) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// downloads parts until none are left, or stop is set.
+void SegmentRunParts(CURL* curl, SegmentDownload& ctx, bool is_owner, const std::atomic_bool* stop) {
+    while (!stop || !*stop) {
+        mutexLock(&ctx.mutex);
+        const auto index = SegmentNextPart(ctx);
+        if (index < 0) {
+            mutexUnlock(&ctx.mutex);
+            break;
+        }
+
+        ctx.parts[index].active = true;
+        mutexUnlock(&ctx.mutex);
+
+        const auto success = SegmentDownloadPart(curl, ctx, index, is_owner);
+
+        SCOPED_MUTEX(&ctx.mutex);
+        auto& part = ctx.parts[index];
+        part.active = false;
+        if (!success && ++part.retries > SEGMENT_RETRY_MAX) {
+            ctx.failed = true;
+        }
+        condvarWakeAll(&ctx.can_wait);
+    }
+}
+
+// called by idle download threads to help with segmented downloads.
+// stops once a download is queued on this thread.
+void SegmentHelp(CURL* curl, const std::atomic_bool& in_progress) {
+    while (g_running && !in_progress) {
+        SegmentDownload* ctx{};
+
+        {
+            SCOPED_MUTEX(&g_segment_mutex);
+            for (auto e : g_segment_downloads) {
+                SCOPED_MUTEX(&e->mutex);
+                if (SegmentNextPart(*e) >= 0) {
+                    // keeps the download alive until we are done with it.
+                    e->helpers++;
+                    ctx = e;
+                    break;
+                }
+            }
+        }
+
+        if (!ctx) {
+            break;
+        }
+
+        SegmentRunParts(curl, *ctx, false, &in_progress);
+
+        SCOPED_MUTEX(&ctx->mutex);
+        ctx->helpers--;
+        condvarWakeAll(&ctx->can_wait);
+    }
+}
+
+auto ProbeWriteCallback(void *contents, size_t size, size_t num_files, void *userp) -> size_t {
+    auto received = static_cast<s64*>(userp);
+    const auto realsize = size * num_files;
+
+    // a range of 0-0 is 1 byte, anything more means the range was ignored.
+    *received += realsize;
+    if (*received > 1) {
+        return 0;
+    }
+
+    return realsize;
+}
+
+// requests the first byte to check that ranges are supported and to get the size.
+auto SegmentProbe(CURL* curl, const Api& e, const std::string& encoded_url, const Header& header_in, Header& header_out, long& http_code, std::string& effective_url) -> s64 {
+    curl_easy_reset(curl);
+    SetCommonCurlOptions(curl, e);
+
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_ACCEPT_ENCODING, nullptr);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_URL, encoded_url.c_str());
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_RANGE, "0-0");
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_HEADERDATA, &header_out);
+
+    auto list = BuildHeaderList(header_in);
+    ON_SCOPE_EXIT(if (list) { curl_slist_free_all(list); } );
+    if (list) {
+        CURL_EASY_SETOPT_LOG(curl, CURLOPT_HTTPHEADER, list);
+    }
+
+    s64 received{};
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_WRITEFUNCTION, ProbeWriteCallback);
+    CURL_EASY_SETOPT_LOG(curl, CURLOPT_WRITEDATA, &received);
+
+    const auto res = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    if (res != CURLE_OK || http_code != 206) {
+        log_write("[SEGMENT] probe failed: %s code: %ld\n", curl_easy_strerror(res), http_code);
+        return -1;
+    }
+
+    // Content-Range: bytes 0-0/1234
+    const auto it = header_out.Find("content-range");
+    if (it == header_out.m_map.end()) {
+        return -1;
+    }
+
+    const auto slash = it->second.find('/');
+    if (slash == std::string::npos) {
+        return -1;
+    }
+
+    char* url{};
+    if (curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &url) == CURLE_OK && url) {
+        effective_url = url;
+    } else {
+        effective_url = encoded_url;
+    }
+
+    return std::strtoll(it->second.c_str() + slash + 1, nullptr, 10);
+}
+
+void GetSegmentTempPath(const fs::FsPath& path, fs::FsPath& file_path, fs::FsPath& journal_path) {
+    const auto key = generate_key_from_path(path);
+    std::snprintf(file_path, sizeof(file_path), "/switch/sphaira/cache/download_segment_%s", key.c_str());
+    std::snprintf(journal_path, sizeof(journal_path), "/switch/sphaira/cache/download_segment_%s.journal", key.c_str());
+}
+
+// opens the journal and temp file, resuming if both match the download.
+auto SegmentOpen(fs::FsNativeSd& fs, SegmentDownload& ctx, const fs::FsPath& file_path, const fs::FsPath& journal_path, const SegmentJournalHeader& want) -> bool {
+    std::vector<s64> done(want.part_count);
+
+    const auto try_resume = [&]() -> bool {
+        if (!want.validator_crc) {
+            return false;
+        }
+
+        if (R_FAILED(fs.OpenFile(journal_path, FsOpenMode_Read|FsOpenMode_Write, &ctx.journal))) {
+            return false;
+        }
+
+        SegmentJournalHeader header;
+        u64 bytes_read;
+        if (R_FAILED(ctx.journal.Read(0, &header, sizeof(header), FsReadOption_None, &bytes_read)) || bytes_read != sizeof(header)) {
+            return false;
+        }
+
+        if (std::memcmp(&header, &want, sizeof(header))) {
+            log_write("[SEGMENT] journal does not match, restarting\n");
+            return false;
+        }
+
+        const auto done_size = done.size() * sizeof(s64);
+        if (R_FAILED(ctx.journal.Read(sizeof(header), done.data(), done_size, FsReadOption_None, &bytes_read)) || bytes_read != done_size) {
+            return false;
+        }
+
+        s64 file_size;
+        if (R_FAILED(fs.OpenFile(file_path, FsOpenMode_Write, &ctx.file)) || R_FAILED(ctx.file.GetSize(&file_size)) || file_size != want.total_size) {
+            return false;
+        }
+
+        return true;
+    };
+
+    if (!try_resume()) {
+        ctx.file.Close();
+        ctx.journal.Close();
+        std::ranges::fill(done, 0);
+
+        fs.DeleteFile(file_path);
+        fs.DeleteFile(journal_path);
+        fs.CreateDirectoryRecursivelyWithPath(file_path);
+
+        if (R_FAILED(fs.CreateFile(file_path, want.total_size, 0)) || R_FAILED(fs.CreateFile(journal_path, 0, 0))) {
+            log_write("[SEGMENT] failed to create: %s\n", file_path.s);
+            return false;
+        }
+
+        if (R_FAILED(fs.OpenFile(file_path, FsOpenMode_Write, &ctx.file)) || R_FAILED(fs.OpenFile(journal_path, FsOpenMode_Write|FsOpenMode_Append, &ctx.journal))) {
+            log_write("[SEGMENT] failed to open: %s\n", file_path.s);
+            return false;
+        }
+
+        if (R_FAILED(ctx.journal.Write(0, &want, sizeof(want), FsWriteOption_None)) || R_FAILED(ctx.journal.Write(sizeof(want), done.data(), done.size() * sizeof(s64), FsWriteOption_None))) {
+            log_write("[SEGMENT] failed to write journal: %s\n", journal_path.s);
+            return false;
+        }
+    }
+
+    for (u32 i = 0; i < want.part_count; i++) {
+        auto& part = ctx.parts.emplace_back();
+        part.off = i * want.part_size;
+        part.size = std::min<s64>(want.part_size, want.total_size - part.off);
+        part.done = std::clamp<s64>(done[i], 0, part.size);
+        ctx.downloaded += part.done;
+    }
+
+    log_write("[SEGMENT] opened: %s resumed: %zd / %zd\n", file_path.s, ctx.downloaded.load(), want.total_size);
+    return true;
+}
+
+// returns nullopt if the server does not support ranges or the file is too small,
+// in which case the file is downloaded normally.
+auto DownloadSegmented(CURL* curl, const Api& e, const std::string& encoded_url) -> std::optional<ApiResult> {
+    fs::FsNativeSd fs;
+    Header header_in = e.GetHeader();
+    Header header_out;
+
+    // only add etag if the dst file still exists.
+    if ((e.GetFlags() & Flag_Cache) && fs::FileExists(&fs.m_fs, e.GetPath())) {
+        g_cache.get(e.GetPath(), header_in);
+    }
+
+    long http_code = 0;
+    std::string effective_url;
+    const auto total_size = SegmentProbe(curl, e, encoded_url, header_in, header_out, http_code, effective_url);
+
+    if (http_code == 304) {
+        log_write("cached download: %s\n", e.GetUrl().c_str());
+        return ApiResult{true, http_code, header_out, {}, e.GetPath()};
+    }
+
+    if (total_size < SEGMENT_MIN_SIZE) {
+        log_write("[SEGMENT] falling back to single download, size: %zd\n", total_size);
+        return std::nullopt;
+    }
+
+    std::string validator;
+    if (auto it = header_out.Find("etag"); it != header_out.m_map.end()) {
+        validator = it->second;
+    } else if (auto it = header_out.Find("last-modified"); it != header_out.m_map.end()) {
+        validator = it->second;
+    }
+
+    SegmentJournalHeader want{};
+    want.magic = SEGMENT_JOURNAL_MAGIC;
+    want.version = SEGMENT_JOURNAL_VERSION;
+    want.total_size = total_size;
+    want.part_size = SEGMENT_PART_SIZE;
+    want.part_count = (total_size + SEGMENT_PART_SIZE - 1) / SEGMENT_PART_SIZE;
+    want.url_crc = crc32Calculate(e.GetUrl().data(), e.GetUrl().length());
+    want.validator_crc = validator.empty() ? 0 : crc32Calculate(validator.data(), validator.length());
+
+    fs::FsPath file_path, journal_path;
+    GetSegmentTempPath(e.GetPath(), file_path, journal_path);
+
+    SegmentDownload ctx{};
+    ctx.api = &e;
+    ctx.url = effective_url;
+    ctx.total_size = total_size;
+    mutexInit(&ctx.mutex);
+    condvarInit(&ctx.can_wait);
+
+    if (!SegmentOpen(fs, ctx, file_path, journal_path, want)) {
+        return ApiResult{false, http_code, header_out, {}, e.GetPath()};
+    }
+
+    // conditional headers only apply to the probe.
+    ctx.headers = BuildHeaderList(e.GetHeader());
+    ON_SCOPE_EXIT(if (ctx.headers) { curl_slist_free_all(ctx.headers); } );
+
+    // share the parts with idle download threads.
+    {
+        SCOPED_MUTEX(&g_segment_mutex);
+        g_segment_downloads.emplace_back(&ctx);
+    }
+
+    for (auto& thread : g_threads) {
+        if (!thread.InProgress()) {
+            ueventSignal(&thread.m_uevent);
+        }
+    }
+
+    for (;;) {
+        SegmentRunParts(curl, ctx, true, nullptr);
+
+        // wait for the parts being downloaded by other threads, a part that
+        // fails is put back, in which case this thread downloads it.
+        mutexLock(&ctx.mutex);
+        const auto all_done = std::ranges::all_of(ctx.parts, [](auto& part) {
+            return part.done == part.size;
+        });
+
+        if (all_done || ctx.failed) {
+            mutexUnlock(&ctx.mutex);
+            break;
+        }
+
+        if (SegmentNextPart(ctx) < 0) {
+            condvarWaitTimeout(&ctx.can_wait, &ctx.mutex, 1e+8);
+        }
+        mutexUnlock(&ctx.mutex);
+
+        if (!SegmentReportProgress(ctx)) {
+            ctx.failed = true;
+        }
+    }
+
+    // stop new helpers and wait for the current ones to finish.
+    {
+        SCOPED_MUTEX(&g_segment_mutex);
+        std::erase(g_segment_downloads, &ctx);
+    }
+
+    mutexLock(&ctx.mutex);
+    while (ctx.helpers) {
+        condvarWait(&ctx.can_wait, &ctx.mutex);
+    }
+    mutexUnlock(&ctx.mutex);
+
+    ctx.file.Close();
+    ctx.journal.Close();
+
+    const auto success = !ctx.failed && std::ranges::all_of(ctx.parts, [](auto& part) {
+        return part.done == part.size;
+    });
+
+    if (!success) {
+        // the temp file and journal are kept so that the next attempt can resume.
+        log_write("[SEGMENT] failed: %s downloaded: %zd / %zd\n", e.GetUrl().c_str(), ctx.downloaded.load(), total_size);
+        return ApiResult{false, http_code, header_out, {}, e.GetPath()};
+    }
+
+    fs.DeleteFile(journal_path);
+    fs.DeleteFile(e.GetPath());
+    fs.CreateDirectoryRecursivelyWithPath(e.GetPath());
+    if (R_FAILED(fs.RenameFile(file_path, e.GetPath()))) {
+        fs.DeleteFile(file_path);
+        return ApiResult{false, http_code, header_out, {}, e.GetPath()};
+    }
+
+    if (e.GetFlags() & Flag_Cache) {
+        g_cache.set(e.GetPath(), header_out);
+    }
 
+    log_write("[SEGMENT] downloaded %s parts: %zu size: %zd\n", e.GetUrl().c_str(), ctx.parts.size(), total_size);
+    return ApiResult{true, http_code, header_out, {}, e.GetPath()};
 }
+
 auto DownloadInternal(CURL* curl, const Api& e) -> ApiResult {
     App::SetAutoSleepDisabled(true);
     ON_SCOPE_EXIT(App::SetAutoSleepDisabled(false));
@@ -694,6 +1417,12 @@ auto DownloadInternal(CURL* curl, const Api& e) -> ApiResult {
     const bool has_post = !e.GetFields().empty() && e.GetFields() != "";
     const auto encoded_url = EncodeUrl(e.GetUrl());
 
+    if (has_file && !has_post && (e.GetFlags() & Flag_Segmented) && !(e.GetFlags() & Flag_NoBody) && e.GetCustomRequest().empty()) {
+        if (auto result = DownloadSegmented(curl, e, encoded_url)) {
+            return *result;
+        }
+    }
+
     DataStruct chunk;
     Header header_in = e.GetHeader();
     Header header_out;
@@ -708,7 +1437,7 @@ auto DownloadInternal(CURL* curl, const Api& e) -> ApiResult {
             return {};
         }
 
-        if (R_FAILED(fs.OpenFile(tmp_buf, FsOpenMode_Write|FsOpenMode_Append, &chunk.f))) {
+        if (R_FAILED(chunk.writer.Open(fs, tmp_buf))) {
             log_write("failed to open file: %s\n", tmp_buf.s);
             return {};
         }
@@ -734,27 +1463,9 @@ auto DownloadInternal(CURL* curl, const Api& e) -> ApiResult {
         log_write("setting post field: %s\n", e.GetFields().c_str());
     }
 
-    struct curl_slist* list = NULL;
+    auto list = BuildHeaderList(header_in);
     ON_SCOPE_EXIT(if (list) { curl_slist_free_all(list); } );
 
-    for (const auto& [key, value] : header_in.m_map) {
-        if (value.empty()) {
-            continue;
-        }
-
-        // create header key value pair.
-        const auto header_str = key + ": " + value;
-
-        // try to append header chunk.
-        auto temp = curl_slist_append(list, header_str.c_str());
-        if (temp) {
-            log_write("adding header: %s\n", header_str.c_str());
-            list = temp;
-        } else {
-            log_write("failed to append header\n");
-        }
-    }
-
     if (list) {
         CURL_EASY_SETOPT_LOG(curl, CURLOPT_HTTPHEADER, list);
     }
@@ -772,13 +1483,16 @@ auto DownloadInternal(CURL* curl, const Api& e) -> ApiResult {
 
     if (has_file) {
         ON_SCOPE_EXIT( fs.DeleteFile(tmp_buf) );
-        if (res == CURLE_OK && chunk.offset) {
-            chunk.f.Write(chunk.file_offset, chunk.data.data(), chunk.offset, FsWriteOption_None);
+        if (res != CURLE_OK) {
+            chunk.data.clear();
         }
 
-        chunk.f.Close();
+        if (!chunk.writer.Close(chunk.data)) {
+            log_write("failed to write file: %s\n", tmp_buf.s);
+            success = false;
+        }
 
-        if (res == CURLE_OK) {
+        if (success) {
             if (http_code == 304) {
                 log_write("cached download: %s\n", e.GetUrl().c_str());
             } else {
@@ -876,27 +1590,9 @@ auto UploadInternal(CURL* curl, const Api& e) -> ApiResult {
     // instruct libcurl to create ftp folders if they don't yet exist.
     CURL_EASY_SETOPT_LOG(curl, CURLOPT_FTP_CREATE_MISSING_DIRS, CURLFTP_CREATE_DIR_RETRY);
 
-    struct curl_slist* list = NULL;
+    auto list = BuildHeaderList(header_in);
     ON_SCOPE_EXIT(if (list) { curl_slist_free_all(list); } );
 
-    for (const auto& [key, value] : header_in.m_map) {
-        if (value.empty()) {
-            continue;
-        }
-
-        // create header key value pair.
-        const auto header_str = key + ": " + value;
-
-        // try to append header chunk.
-        auto temp = curl_slist_append(list, header_str.c_str());
-        if (temp) {
-            log_write("adding header: %s\n", header_str.c_str());
-            list = temp;
-        } else {
-            log_write("failed to append header\n");
-        }
-    }
-
     if (list) {
         CURL_EASY_SETOPT_LOG(curl, CURLOPT_HTTPHEADER, list);
     }
@@ -967,6 +1663,12 @@ void ThreadEntry::ThreadFunc(void* p) {
             continue;
         }
 
+        // woken up without a download, help with any segmented downloads.
+        if (!data->m_in_progress) {
+            SegmentHelp(data->m_curl, data->m_in_progress);
+            continue;
+        }
+
         const auto result = data->m_api.IsUpload() ? UploadInternal(data->m_curl, data->m_api) : DownloadInternal(data->m_curl, data->m_api);
         if (g_running && data->m_api.GetOnComplete() && !data->m_api.GetToken().stop_requested()) {
             evman::push(
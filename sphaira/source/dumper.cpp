@@ -7,6 +7,7 @@
 #include "i18n.hpp"
 #include "location.hpp"
 #include "threaded_file_transfer.hpp"
+#include "utils/io_qos.hpp"
 
 #include "ui/sidebar.hpp"
 #include "ui/error_box.hpp"
@@ -318,8 +319,6 @@ Result DumpToUsb(ui::ProgressBox* pbox, BaseSource* source, std::span<const fs::
 }
 
 Result DumpToFile(ui::ProgressBox* pbox, fs::Fs* fs, const fs::FsPath& root, BaseSource* source, std::span<const fs::FsPath> paths, const CustomTransfer& custom_transfer) {
-    const auto is_file_based_emummc = App::IsFileBaseEmummc();
-
     for (const auto& path : paths) {
         const auto base_path = fs::AppendPath(root, path);
         const auto file_size = source->GetSize(path);
@@ -347,11 +346,8 @@ Result DumpToFile(ui::ProgressBox* pbox, fs::Fs* fs, const fs::FsPath& root, Bas
                         return source->Read(path, data, off, size, bytes_read);
                     },
                     [&](const void* data, s64 off, s64 size) -> Result {
-                        const auto rc = write_source->Write(data, off, size);
-                        if (is_file_based_emummc) {
-                            svcSleepThread(2e+6); // 2ms
-                        }
-                        return rc;
+                        utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Write, utils::qos::Priority_Bulk, size);
+                        return write_source->Write(data, off, size);
                     }
                 ));
             }
@@ -15,6 +15,7 @@
 #include <fcntl.h>
 #include <dirent.h>
 #include <ftw.h>
+#include <sys/time.h>
 
 namespace fs {
 namespace {
@@ -1,6 +1,7 @@
 #include "hasher.hpp"
 #include "app.hpp"
 #include "threaded_file_transfer.hpp"
+#include "utils/io_qos.hpp"
 #include <mbedtls/md5.h>
 #include <utility>
 
@@ -14,7 +15,6 @@ consteval auto CalculateHashStrLen(s64 buf_size) {
 struct FileSource final : BaseSource {
     FileSource(fs::Fs* fs, const fs::FsPath& path) : m_fs{fs} {
         m_open_result = m_fs->OpenFile(path, FsOpenMode_Read, std::addressof(m_file));
-        m_is_file_based_emummc = App::IsFileBaseEmummc();
     }
 
     Result Size(s64* out) override {
@@ -24,18 +24,16 @@ struct FileSource final : BaseSource {
 
     Result Read(void* buf, s64 off, s64 size, u64* bytes_read) override {
         R_TRY(m_open_result);
-        const auto rc = m_file.Read(off, buf, size, 0, bytes_read);
-        if (m_fs->IsNative() && m_is_file_based_emummc) {
-            svcSleepThread(2e+6); // 2ms
+        if (m_fs->IsNative()) {
+            utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Bulk, size);
         }
-        return rc;
+        return m_file.Read(off, buf, size, 0, bytes_read);
     }
 
 private:
     fs::Fs* m_fs{};
     fs::File m_file{};
     Result m_open_result{};
-    bool m_is_file_based_emummc{};
 };
 
 struct MemSource final : BaseSource {
@@ -32,6 +32,11 @@ namespace {
 
 constexpr int BPP = 4;
 
+#ifdef USE_NVJPG
+// the decoder is shared, images may be loaded from any thread.
+Mutex g_nvjpg_mutex{};
+#endif
+
 auto ImageLoadInternal(stbi_uc* image_data, int x, int y) -> ImageResult {
     if (image_data) {
         ImageResult result{};
@@ -60,6 +65,7 @@ auto ImageLoadInternal(nj::Image&& image) -> ImageResult {
         return {};
     }
 
+    SCOPED_MUTEX(&g_nvjpg_mutex);
     if (R_FAILED(App::GetApp()->m_decoder.render(image, surf, 255))) {
         log_write("[NVJPG] failed to render\n");
         return {};
@@ -0,0 +1,295 @@
+#include "image_pool.hpp"
+#include "defines.hpp"
+#include "ui/types.hpp"
+#include "log.hpp"
+
+#include "utils/thread.hpp"
+
+#include <memory>
+#include <algorithm>
+
+namespace sphaira::image_pool {
+namespace {
+
+// nvjpg is a single engine, so more threads only helps the stb fallback.
+constexpr u32 THREAD_COUNT = 2;
+// max images decoded ahead of the ui uploading them, per queue.
+constexpr u32 READY_MAX = 8;
+// icons larger than this are resized before being uploaded.
+constexpr int ICON_SIZE_MAX = 256;
+
+struct Request {
+    u64 id;
+    u64 frame;
+    u32 order;
+    LoadCallback load;
+};
+
+struct Ready {
+    u64 id;
+    ImageResult image;
+};
+
+struct QueueData {
+    u64 id;
+    // bumped on clear, so that in flight requests are dropped.
+    u32 generation;
+    u64 frame;
+    u32 order;
+    std::vector<Request> pending;
+    std::vector<u64> in_flight;
+    std::vector<Ready> ready;
+    std::vector<u64> failed;
+};
+
+Mutex g_mutex{};
+CondVar g_can_work{};
+Thread g_threads[THREAD_COUNT]{};
+u32 g_thread_count{};
+u32 g_ref_count{};
+bool g_running{};
+u64 g_queue_id{};
+u64 g_frame{};
+std::vector<std::unique_ptr<QueueData>> g_queues{};
+
+// lock must be held.
+auto FindQueue(u64 queue_id) -> QueueData* {
+    for (auto& e : g_queues) {
+        if (e->id == queue_id) {
+            return e.get();
+        }
+    }
+
+    return nullptr;
+}
+
+// lock must be held.
+// returns the newest request, from a queue that has room for the result.
+auto FindNextRequest(QueueData** out_queue) -> Request* {
+    Request* best{};
+
+    for (auto& q : g_queues) {
+        if (q->in_flight.size() + q->ready.size() >= READY_MAX) {
+            continue;
+        }
+
+        for (auto& e : q->pending) {
+            if (!best || e.frame > best->frame || (e.frame == best->frame && e.order < best->order)) {
+                best = &e;
+                *out_queue = q.get();
+            }
+        }
+    }
+
+    return best;
+}
+
+auto LoadImage(const LoadCallback& load) -> ImageResult {
+    const auto data = load();
+    if (data.empty()) {
+        return {};
+    }
+
+    auto image = ImageLoadFromMemory(data, ImageFlag_JPEG);
+    if (image.data.empty()) {
+        return {};
+    }
+
+    // some homebrew use huge icons, resize them here rather than on the gpu.
+    if (image.w > ICON_SIZE_MAX || image.h > ICON_SIZE_MAX) {
+        const auto scale = (float)ICON_SIZE_MAX / (float)std::max(image.w, image.h);
+        const auto w = std::max(1, int(image.w * scale));
+        const auto h = std::max(1, int(image.h * scale));
+
+        if (auto resized = ImageResize(image.data, image.w, image.h, w, h); !resized.data.empty()) {
+            image = std::move(resized);
+        }
+    }
+
+    return image;
+}
+
+void ThreadFunc(void* arg) {
+    mutexLock(&g_mutex);
+    ON_SCOPE_EXIT(mutexUnlock(&g_mutex));
+
+    while (g_running) {
+        QueueData* queue{};
+        auto request = FindNextRequest(&queue);
+        if (!request) {
+            condvarWait(&g_can_work, &g_mutex);
+            continue;
+        }
+
+        const auto queue_id = queue->id;
+        const auto generation = queue->generation;
+        const auto id = request->id;
+        const auto load = std::move(request->load);
+        queue->pending.erase(queue->pending.begin() + std::distance(queue->pending.data(), request));
+        queue->in_flight.emplace_back(id);
+
+        // decode without the lock held.
+        mutexUnlock(&g_mutex);
+        TimeStamp ts;
+        auto image = LoadImage(load);
+        log_write("\t[image pool] time taken: %.2fs %zums\n", ts.GetSecondsD(), ts.GetMs());
+        mutexLock(&g_mutex);
+
+        // the queue may have been cleared or closed whilst decoding.
+        queue = FindQueue(queue_id);
+        if (!queue || queue->generation != generation) {
+            continue;
+        }
+
+        std::erase(queue->in_flight, id);
+        queue->ready.push_back({id, std::move(image)});
+    }
+}
+
+Result Init() {
+    SCOPED_MUTEX(&g_mutex);
+
+    if (!g_ref_count) {
+        condvarInit(&g_can_work);
+        g_running = true;
+
+        for (auto& thread : g_threads) {
+            if (R_FAILED(utils::CreateThread(&thread, ThreadFunc, nullptr))) {
+                break;
+            }
+
+            if (R_FAILED(threadStart(&thread))) {
+                threadClose(&thread);
+                break;
+            }
+
+            g_thread_count++;
+        }
+
+        // a single thread is enough to keep going.
+        R_UNLESS(g_thread_count, 0x1);
+    }
+
+    g_ref_count++;
+    R_SUCCEED();
+}
+
+void Exit() {
+    {
+        SCOPED_MUTEX(&g_mutex);
+        if (!g_ref_count || --g_ref_count) {
+            return;
+        }
+
+        g_running = false;
+        condvarWakeAll(&g_can_work);
+    }
+
+    for (u32 i = 0; i < g_thread_count; i++) {
+        threadWaitForExit(&g_threads[i]);
+        threadClose(&g_threads[i]);
+    }
+
+    g_thread_count = 0;
+}
+
+} // namespace
+
+Queue::Queue() : m_id{++g_queue_id} {
+    if (R_FAILED(Init())) {
+        log_write("[IMAGE] failed to start pool\n");
+    }
+
+    SCOPED_MUTEX(&g_mutex);
+    auto& q = g_queues.emplace_back(std::make_unique<QueueData>());
+    q->id = m_id;
+}
+
+Queue::~Queue() {
+    {
+        SCOPED_MUTEX(&g_mutex);
+        std::erase_if(g_queues, [this](auto& e) {
+            return e->id == m_id;
+        });
+    }
+
+    Exit();
+}
+
+void Queue::BeginFrame() {
+    SCOPED_MUTEX(&g_mutex);
+    if (auto q = FindQueue(m_id)) {
+        q->frame = ++g_frame;
+        q->order = 0;
+    }
+}
+
+bool Queue::Touch(u64 id) {
+    SCOPED_MUTEX(&g_mutex);
+    auto q = FindQueue(m_id);
+    if (!q) {
+        return true;
+    }
+
+    for (auto& e : q->pending) {
+        if (e.id == id) {
+            e.frame = q->frame;
+            e.order = q->order++;
+            return true;
+        }
+    }
+
+    const auto has_id = [id](auto& e) {
+        return e == id;
+    };
+
+    const auto has_ready_id = [id](auto& e) {
+        return e.id == id;
+    };
+
+    return std::ranges::any_of(q->in_flight, has_id) || std::ranges::any_of(q->ready, has_ready_id) || std::ranges::any_of(q->failed, has_id);
+}
+
+void Queue::Push(u64 id, LoadCallback&& load) {
+    SCOPED_MUTEX(&g_mutex);
+    if (auto q = FindQueue(m_id)) {
+        q->pending.push_back({id, q->frame, q->order++, std::move(load)});
+        condvarWakeOne(&g_can_work);
+    }
+}
+
+bool Queue::Pop(u64* id, ImageResult* out) {
+    SCOPED_MUTEX(&g_mutex);
+    auto q = FindQueue(m_id);
+    if (!q || q->ready.empty()) {
+        return false;
+    }
+
+    auto& e = q->ready.front();
+    *id = e.id;
+    *out = std::move(e.image);
+    q->ready.erase(q->ready.begin());
+
+    // don't try and load this again.
+    if (out->data.empty()) {
+        q->failed.emplace_back(*id);
+    }
+
+    // there's now room for another image.
+    condvarWakeOne(&g_can_work);
+    return true;
+}
+
+void Queue::Clear() {
+    SCOPED_MUTEX(&g_mutex);
+    if (auto q = FindQueue(m_id)) {
+        q->generation++;
+        q->pending.clear();
+        q->in_flight.clear();
+        q->ready.clear();
+        q->failed.clear();
+        condvarWakeAll(&g_can_work);
+    }
+}
+
+} // namespace sphaira::image_pool
@@ -3,28 +3,200 @@
 #include "evman.hpp"
 #include "app.hpp"
 #include "log.hpp"
+#include "utils/io_qos.hpp"
 
 #include <switch.h>
 #include <vector>
 #include <cstring>
 #include <string_view>
+#include <algorithm>
+#include <unordered_map>
 #include <minIni.h>
 
 namespace sphaira {
 namespace {
 
-auto nro_parse_internal(fs::Fs* fs, const fs::FsPath& path, NroEntry& entry) -> Result {
-    entry.path = path;
+// cache of parsed nro's, so that only new or modified nro's are read on scan.
+constexpr fs::FsPath NRO_INDEX_PATH{"/switch/sphaira/cache/nro_index.bin"};
+constexpr u32 NRO_INDEX_MAGIC = 0x58444E49; // INDX
+constexpr u32 NRO_INDEX_VERSION = 1;
+
+struct NroIndexHeader {
+    u32 magic;
+    u32 version;
+    u32 count;
+    u32 reserved;
+};
+
+// followed by the path, name, author and display version strings.
+struct NroIndexRecord {
+    u64 created;
+    u64 modified;
+    s64 size;
+    u64 icon_size;
+    u64 icon_offset;
+    u16 path_len;
+    u16 name_len;
+    u16 author_len;
+    u8 display_version_len;
+    u8 is_nacp_valid;
+};
+
+struct NroIndex {
+    void Load(fs::Fs* fs);
+    void Save(fs::Fs* fs, const fs::FsPath& root);
+
+    // returns the cached entry if the file hasn't changed since it was indexed.
+    auto Find(const fs::FsPath& path, const FsTimeStampRaw& timestamp) -> const NroEntry*;
+    void Add(const NroEntry& entry);
+
+private:
+    // entries from the last scan.
+    std::unordered_map<std::string, NroEntry> m_entries{};
+    // entries found in this scan.
+    std::unordered_map<std::string, NroEntry> m_found{};
+    bool m_dirty{};
+};
+
+void NroIndex::Load(fs::Fs* fs) {
+    std::vector<u8> buf;
+    if (R_FAILED(fs->read_entire_file(NRO_INDEX_PATH, buf))) {
+        return;
+    }
 
-    // todo: special sorting for fw 2.0.0 to make it not look like shit
-    if (hosversionAtLeast(3,0,0)) {
-        // it doesn't matter if we fail
-        entry.timestamp.is_valid = false;
-        fs->GetFileTimeStampRaw(entry.path, &entry.timestamp);
-        // if (R_FAILED(fsFsGetFileTimeStampRaw(fs, entry.path, &entry.timestamp))) {
-        //     // log_write("failed to get timestamp for: %s\n", path);
-        // }
+    NroIndexHeader header;
+    if (buf.size() < sizeof(header)) {
+        return;
+    }
+
+    std::memcpy(&header, buf.data(), sizeof(header));
+    if (header.magic != NRO_INDEX_MAGIC || header.version != NRO_INDEX_VERSION) {
+        log_write("[NRO] index is outdated\n");
+        return;
+    }
+
+    u64 off = sizeof(header);
+    const auto read_str = [&buf, &off](char* out, u64 len, u64 max) -> bool {
+        if (len >= max || off + len > buf.size()) {
+            return false;
+        }
+
+        std::memcpy(out, buf.data() + off, len);
+        out[len] = '\0';
+        off += len;
+        return true;
+    };
+
+    for (u32 i = 0; i < header.count; i++) {
+        NroIndexRecord record;
+        if (off + sizeof(record) > buf.size()) {
+            break;
+        }
+
+        std::memcpy(&record, buf.data() + off, sizeof(record));
+        off += sizeof(record);
+
+        NroEntry entry{};
+        if (!read_str(entry.path, record.path_len, sizeof(entry.path)) ||
+            !read_str(entry.nacp.lang.name, record.name_len, sizeof(entry.nacp.lang.name)) ||
+            !read_str(entry.nacp.lang.author, record.author_len, sizeof(entry.nacp.lang.author)) ||
+            !read_str(entry.nacp.display_version, record.display_version_len, sizeof(entry.nacp.display_version))) {
+            log_write("[NRO] index is corrupted\n");
+            break;
+        }
+
+        entry.timestamp.created = record.created;
+        entry.timestamp.modified = record.modified;
+        entry.timestamp.is_valid = true;
+        entry.size = record.size;
+        entry.icon_size = record.icon_size;
+        entry.icon_offset = record.icon_offset;
+        entry.is_nacp_valid = record.is_nacp_valid;
+        m_entries.emplace(entry.path.toString(), entry);
+    }
+}
+
+void NroIndex::Save(fs::Fs* fs, const fs::FsPath& root) {
+    // keep entries that are outside of the scanned folder, compare with the
+    // trailing slash so that scanning /switch/foo keeps /switch/foobar.
+    auto prefix = root.toString();
+    if (!prefix.ends_with('/')) {
+        prefix += '/';
+    }
+
+    for (auto& [path, entry] : m_entries) {
+        if (!m_found.contains(path)) {
+            if (!entry.path.starts_with(prefix)) {
+                m_found.emplace(path, entry);
+            } else {
+                m_dirty = true;
+            }
+        }
+    }
+
+    if (!m_dirty) {
+        return;
+    }
+
+    std::vector<u8> buf;
+    const auto write = [&buf](const void* data, u64 size) {
+        const auto off = buf.size();
+        buf.resize(off + size);
+        std::memcpy(buf.data() + off, data, size);
+    };
+
+    const NroIndexHeader header{NRO_INDEX_MAGIC, NRO_INDEX_VERSION, (u32)m_found.size(), 0};
+    write(&header, sizeof(header));
+
+    for (const auto& [path, e] : m_found) {
+        const NroIndexRecord record{
+            .created = e.timestamp.created,
+            .modified = e.timestamp.modified,
+            .size = e.size,
+            .icon_size = e.icon_size,
+            .icon_offset = e.icon_offset,
+            .path_len = (u16)std::strlen(e.path),
+            .name_len = (u16)strnlen(e.nacp.lang.name, sizeof(e.nacp.lang.name) - 1),
+            .author_len = (u16)strnlen(e.nacp.lang.author, sizeof(e.nacp.lang.author) - 1),
+            .display_version_len = (u8)strnlen(e.nacp.display_version, sizeof(e.nacp.display_version) - 1),
+            .is_nacp_valid = e.is_nacp_valid,
+        };
+
+        write(&record, sizeof(record));
+        write(e.path.s, record.path_len);
+        write(e.nacp.lang.name, record.name_len);
+        write(e.nacp.lang.author, record.author_len);
+        write(e.nacp.display_version, record.display_version_len);
+    }
+
+    fs->CreateDirectoryRecursivelyWithPath(NRO_INDEX_PATH);
+    if (R_FAILED(fs->write_entire_file(NRO_INDEX_PATH, buf))) {
+        log_write("[NRO] failed to save index\n");
     }
+}
+
+auto NroIndex::Find(const fs::FsPath& path, const FsTimeStampRaw& timestamp) -> const NroEntry* {
+    const auto it = m_entries.find(path.toString());
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+
+    const auto& e = it->second;
+    if (e.timestamp.created != timestamp.created || e.timestamp.modified != timestamp.modified) {
+        return nullptr;
+    }
+
+    m_found.emplace(it->first, e);
+    return &e;
+}
+
+void NroIndex::Add(const NroEntry& entry) {
+    m_found.insert_or_assign(entry.path.toString(), entry);
+    m_dirty = true;
+}
+
+auto nro_parse_file(fs::Fs* fs, const fs::FsPath& path, NroEntry& entry) -> Result {
+    entry.path = path;
 
     fs::File f;
     R_TRY(fs->OpenFile(entry.path, FsOpenMode_Read, &f));
@@ -71,10 +243,46 @@ auto nro_parse_internal(fs::Fs* fs, const fs::FsPath& path, NroEntry& entry) ->
     R_SUCCEED();
 }
 
+auto nro_parse_internal(fs::Fs* fs, const fs::FsPath& path, NroEntry& entry, NroIndex* index = nullptr) -> Result {
+    // todo: special sorting for fw 2.0.0 to make it not look like shit
+    if (hosversionAtLeast(3,0,0)) {
+        entry.timestamp.is_valid = false;
+
+        // the timestamp is used to validate the index, so only the files that
+        // changed since the last scan have to be opened.
+        // if it can't be read, parse the file and don't cache it.
+        if (index) {
+            if (R_SUCCEEDED(fs->GetFileTimeStampRaw(path, &entry.timestamp))) {
+                if (auto cached = index->Find(path, entry.timestamp)) {
+                    entry = *cached;
+                    R_SUCCEED();
+                }
+            } else {
+                entry.timestamp.is_valid = false;
+            }
+
+            R_TRY(nro_parse_file(fs, path, entry));
+            if (entry.timestamp.is_valid) {
+                index->Add(entry);
+            }
+
+            R_SUCCEED();
+        }
+
+        // it doesn't matter if we fail
+        fs->GetFileTimeStampRaw(path, &entry.timestamp);
+        // if (R_FAILED(fsFsGetFileTimeStampRaw(fs, entry.path, &entry.timestamp))) {
+        //     // log_write("failed to get timestamp for: %s\n", path);
+        // }
+    }
+
+    return nro_parse_file(fs, path, entry);
+}
+
 // this function is recursive by 1 level deep
 // if the nro is in switch/folder/folder2/app.nro it will NOT be found
 // switch/folder/app.nro for example will work fine.
-auto nro_scan_internal(fs::Fs* fs, const fs::FsPath& path, std::vector<NroEntry>& nros, bool nested, bool scan_all_dir, bool root) -> Result {
+auto nro_scan_internal(fs::Fs* fs, const fs::FsPath& path, std::vector<NroEntry>& nros, bool nested, bool scan_all_dir, bool root, NroIndex* index) -> Result {
     // we don't need to scan for folders if we are not root
     u32 dir_open_type = FsDirOpenMode_ReadFiles | FsDirOpenMode_NoFileSize;
     if (root) {
@@ -101,20 +309,20 @@ auto nro_scan_internal(fs::Fs* fs, const fs::FsPath& path, std::vector<NroEntry>
 
             // fast path for detecting an nro in a folder
             NroEntry entry;
-            if (R_SUCCEEDED(nro_parse_internal(fs, fullpath, entry))) {
+            if (R_SUCCEEDED(nro_parse_internal(fs, fullpath, entry, index))) {
                 // log_write("NRO: fast path for: %s\n", fullpath);
                 nros.emplace_back(entry);
             } else {
                 // slow path...
                 std::snprintf(fullpath, sizeof(fullpath), "%s/%s", path.s, e.name);
-                nro_scan_internal(fs, fullpath, nros, nested, scan_all_dir, false);
+                nro_scan_internal(fs, fullpath, nros, nested, scan_all_dir, false, index);
             }
         } else if (e.type == FsDirEntryType_File && std::string_view{e.name}.ends_with(".nro")) {
             fs::FsPath fullpath;
             std::snprintf(fullpath, sizeof(fullpath), "%s/%s", path.s, e.name);
 
             NroEntry entry;
-            if (R_SUCCEEDED(nro_parse_internal(fs, fullpath, entry))) {
+            if (R_SUCCEEDED(nro_parse_internal(fs, fullpath, entry, index))) {
                 nros.emplace_back(entry);
                 if (!root && !scan_all_dir) {
                     // log_write("NRO: slow path for: %s\n", fullpath);
@@ -131,7 +339,12 @@ auto nro_scan_internal(fs::Fs* fs, const fs::FsPath& path, std::vector<NroEntry>
 
 auto nro_scan_internal(const fs::FsPath& path, std::vector<NroEntry>& nros, bool nested, bool scan_all_dir, bool root) -> Result {
     fs::FsNativeSd fs;
-    return nro_scan_internal(&fs, path, nros, nested, scan_all_dir, root);
+    NroIndex index{};
+    index.Load(&fs);
+
+    R_TRY(nro_scan_internal(&fs, path, nros, nested, scan_all_dir, root, &index));
+    index.Save(&fs, path);
+    R_SUCCEED();
 }
 
 auto nro_get_icon_internal(fs::File* f, u64 size, u64 offset) -> std::vector<u8> {
@@ -144,6 +357,9 @@ auto nro_get_icon_internal(fs::File* f, u64 size, u64 offset) -> std::vector<u8>
     u64 bytes_read{};
     icon.resize(size);
 
+    // icons are loaded whilst scrolling, so they take priority over bulk io.
+    utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Foreground, size);
+
     R_TRY_RESULT(f->Read(offset, icon.data(), icon.size(), FsReadOption_None, &bytes_read), {});
     R_UNLESS(bytes_read == icon.size(), {});
 
@@ -280,7 +496,7 @@ auto nro_normalise_path(const std::string& p) -> std::string {
 }
 
 auto nro_find(std::span<const NroEntry> array, std::string_view name, std::string_view author, const fs::FsPath& path) -> std::optional<NroEntry> {
-    const auto it = std::find_if(array.cbegin(), array.cend(), [name, author, path](auto& e){
+    const auto it = std::find_if(array.begin(), array.end(), [name, author, path](auto& e){
         if (!name.empty() && !author.empty() && !path.empty()) {
             return e.GetName() == name && e.GetAuthor() == author && e.path == path;
         } else if (!name.empty()) {
@@ -293,7 +509,7 @@ auto nro_find(std::span<const NroEntry> array, std::string_view name, std::strin
         return false;
     });
 
-    if (it == array.cend()) {
+    if (it == array.end()) {
         return std::nullopt;
     }
 
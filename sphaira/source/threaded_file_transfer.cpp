@@ -4,11 +4,15 @@
 #include "app.hpp"
 #include "minizip_helper.hpp"
 #include "utils/thread.hpp"
+#include "utils/utils.hpp"
+#include "utils/buffer_pool.hpp"
 
 #include <vector>
 #include <algorithm>
 #include <cstring>
 #include <atomic>
+#include <bit>
+#include <string>
 #include <minizip/unzip.h>
 #include <minizip/zip.h>
 
@@ -19,56 +23,119 @@ namespace {
 constexpr u64 SMALL_BUFFER_SIZE = 1024 * 512;
 // used for everything else.
 constexpr u64 NORMAL_BUFFER_SIZE = 1024*1024*4;
-
-struct ThreadBuffer {
-    ThreadBuffer() {
-        buf.reserve(NORMAL_BUFFER_SIZE);
+// smallest buffer size used when splitting up small transfers.
+constexpr u64 MIN_BUFFER_SIZE = 1024 * 128;
+// small transfers are split into at least this many chunks so that read / write overlap.
+constexpr u64 MIN_CHUNK_COUNT = 8;
+
+// the ring starts with 2 buffers (double buffering) and grows up to the max
+// if the writer is bursty, such as sd card flushes or network mounts.
+constexpr u32 RING_DEPTH_MIN = 2;
+constexpr u32 RING_DEPTH_MAX = 8;
+// memory left free when sizing buffers or growing the ring.
+constexpr u64 MEMORY_RESERVE = 1024 * 1024 * 32;
+
+// depth that the last transfer ended with, used as the starting depth for the next.
+std::atomic<u32> g_ring_depth_hint{RING_DEPTH_MIN};
+
+Mutex g_last_stats_mutex{};
+TransferStats g_last_stats{};
+
+auto GetFreeMemory() -> u64 {
+    u64 total{}, used{};
+    if (R_FAILED(svcGetInfo(&total, InfoType_TotalMemorySize, CUR_PROCESS_HANDLE, 0)) || R_FAILED(svcGetInfo(&used, InfoType_UsedMemorySize, CUR_PROCESS_HANDLE, 0)) || used > total) {
+        return 0;
     }
+    return total - used;
+}
 
-    std::vector<u8> buf;
+struct ThreadBuffer {
+    utils::PageBuffer buf;
     s64 off;
 };
 
-template<std::size_t Size>
+// per-stage stats, logged at the end of a transfer so that changes
+// to the buffer size / count can be measured.
+struct StageStats {
+    // time spent waiting on another stage.
+    u64 stall_ticks{};
+    u64 bytes{};
+};
+
 struct RingBuf {
 private:
-    ThreadBuffer buf[Size]{};
+    // buffers are swapped in and out, so memory is only used for the active depth.
+    ThreadBuffer buf[RING_DEPTH_MAX]{};
     unsigned r_index{};
     unsigned w_index{};
+    unsigned depth{RING_DEPTH_MIN};
+    // sampled on every push.
+    u64 occupancy_sum{};
+    u64 occupancy_samples{};
 
-    static_assert((sizeof(RingBuf::buf) & (sizeof(RingBuf::buf) - 1)) == 0, "Must be power of 2!");
+    static_assert((RING_DEPTH_MAX & (RING_DEPTH_MAX - 1)) == 0, "Must be power of 2!");
 
 public:
+    // number of times the producer waited on a full ring.
+    u64 full_waits{};
+    // number of times the consumer waited on an empty ring after it was first filled.
+    u64 empty_waits{};
+
     void ringbuf_reset() {
         this->r_index = this->w_index;
     }
 
     unsigned ringbuf_capacity() const {
-        return sizeof(this->buf) / sizeof(this->buf[0]);
+        return this->depth;
     }
 
     unsigned ringbuf_size() const {
-        return (this->w_index - this->r_index) % (ringbuf_capacity() * 2U);
+        return (this->w_index - this->r_index) % (RING_DEPTH_MAX * 2U);
     }
 
     unsigned ringbuf_free() const {
         return ringbuf_capacity() - ringbuf_size();
     }
 
-    void ringbuf_push(std::vector<u8>& buf_in, s64 off_in) {
-        auto& value = this->buf[this->w_index % ringbuf_capacity()];
+    void ringbuf_set_depth(unsigned new_depth) {
+        this->depth = std::clamp(std::bit_floor(new_depth), RING_DEPTH_MIN, RING_DEPTH_MAX);
+    }
+
+    // doubles the depth, returns false if already at the max.
+    bool ringbuf_grow() {
+        if (this->depth >= RING_DEPTH_MAX) {
+            return false;
+        }
+
+        this->depth *= 2;
+        return true;
+    }
+
+    // average number of buffers queued.
+    double ringbuf_occupancy() const {
+        if (!this->occupancy_samples) {
+            return 0;
+        }
+        return (double)this->occupancy_sum / (double)this->occupancy_samples;
+    }
+
+    void ringbuf_push(utils::PageBuffer& buf_in, s64 off_in) {
+        auto& value = this->buf[this->w_index % RING_DEPTH_MAX];
         value.off = off_in;
         std::swap(value.buf, buf_in);
 
-        this->w_index = (this->w_index + 1U) % (ringbuf_capacity() * 2U);
+        this->w_index = (this->w_index + 1U) % (RING_DEPTH_MAX * 2U);
+
+        this->occupancy_sum += ringbuf_size();
+        this->occupancy_samples++;
     }
 
-    void ringbuf_pop(std::vector<u8>& buf_out, s64& off_out) {
-        auto& value = this->buf[this->r_index % ringbuf_capacity()];
+    void ringbuf_pop(utils::PageBuffer& buf_out, s64& off_out) {
+        auto& value = this->buf[this->r_index % RING_DEPTH_MAX];
         off_out = value.off;
         std::swap(value.buf, buf_out);
 
-        this->r_index = (this->r_index + 1U) % (ringbuf_capacity() * 2U);
+        this->r_index = (this->r_index + 1U) % (RING_DEPTH_MAX * 2U);
     }
 };
 
@@ -157,12 +224,24 @@ struct ThreadData {
     Result decompressFuncInternal();
     Result writeFuncInternal();
 
+    // only call once all threads have exited.
+    auto GetStats(const TimeStamp& ts) const -> TransferStats;
+    void LogStats(const TransferStats& stats) const;
+
+    // returns the depth to use for the next transfer.
+    auto GetDepthHint() const -> u32;
+
 private:
-    Result SetDecompressBuf(std::vector<u8>& buf, s64 off, s64 size);
-    Result GetDecompressBuf(std::vector<u8>& buf_out, s64& off_out);
-    Result SetWriteBuf(std::vector<u8>& buf, s64 size);
-    Result GetWriteBuf(std::vector<u8>& buf_out, s64& off_out);
-    Result SetPullBuf(std::vector<u8>& buf, s64 size);
+    Result Wait(CondVar* var, Mutex* mutex, StageStats& stats);
+    // grows the ring if the consumer ran dry since it was last full, which happens
+    // when the consumer is bursty. must be called with the ring's mutex locked.
+    bool TryGrowRing(RingBuf& ring, const char* name);
+    void UpdateTransferInfo();
+    Result SetDecompressBuf(utils::PageBuffer& buf, s64 off, s64 size);
+    Result GetDecompressBuf(utils::PageBuffer& buf_out, s64& off_out);
+    Result SetWriteBuf(utils::PageBuffer& buf, s64 size);
+    Result GetWriteBuf(utils::PageBuffer& buf_out, s64& off_out);
+    Result SetPullBuf(utils::PageBuffer& buf, s64 size);
     Result GetPullBuf(void* data, s64 size, u64* bytes_read);
 
     Result Read(void* buf, s64 size, u64* bytes_read);
@@ -194,10 +273,10 @@ private:
     UEvent m_uevent_decompress_progress{};
     UEvent m_uevent_write_progress{};
 
-    RingBuf<2> read_buffers{};
-    RingBuf<2> write_buffers{};
+    RingBuf read_buffers{};
+    RingBuf write_buffers{};
 
-    std::vector<u8> pull_buffer{};
+    utils::PageBuffer pull_buffer{};
     s64 pull_buffer_offset{};
 
     const u64 read_buffer_size;
@@ -216,6 +295,12 @@ private:
     std::atomic_bool read_running{true};
     std::atomic_bool decompress_running{true};
     std::atomic_bool write_running{true};
+
+    // each is only updated by its own thread.
+    StageStats read_stats{};
+    StageStats decompress_stats{};
+    StageStats write_stats{};
+    StageStats pull_stats{};
 };
 
 ThreadData::ThreadData(ui::ProgressBox* _pbox, s64 size, const ReadCallback& _rfunc, const DecompressCallback& _dfunc, const WriteCallback& _wfunc, u64 buffer_size)
@@ -241,6 +326,12 @@ ThreadData::ThreadData(ui::ProgressBox* _pbox, s64 size, const ReadCallback& _rf
     ueventCreate(GetReadProgressEvent(), true);
     ueventCreate(GetDecompressProgressEvent(), true);
     ueventCreate(GetWriteProgressEvent(), true);
+
+    // start with the depth that the last transfer ended with.
+    const auto depth = g_ring_depth_hint.load();
+    read_buffers.ringbuf_set_depth(depth);
+    write_buffers.ringbuf_set_depth(depth);
+    UpdateTransferInfo();
 }
 
 auto ThreadData::GetResults() volatile -> Result {
@@ -265,7 +356,91 @@ void ThreadData::WakeAllThreads() {
     mutexUnlock(std::addressof(pull_mutex));
 }
 
-Result ThreadData::SetDecompressBuf(std::vector<u8>& buf, s64 off, s64 size) {
+auto ThreadData::GetDepthHint() const -> u32 {
+    const auto depth = std::max(read_buffers.ringbuf_capacity(), write_buffers.ringbuf_capacity());
+
+    // shrink back down if the producers never had to wait.
+    if (!read_buffers.full_waits && !write_buffers.full_waits) {
+        return std::max(RING_DEPTH_MIN, depth / 2);
+    }
+
+    return depth;
+}
+
+bool ThreadData::TryGrowRing(RingBuf& ring, const char* name) {
+    if (!ring.empty_waits) {
+        return false;
+    }
+
+    // the buffer swapped into the new slot is allocated on first use.
+    const auto new_memory = ring.ringbuf_capacity() * read_buffer_size;
+    if (GetFreeMemory() < MEMORY_RESERVE + new_memory) {
+        return false;
+    }
+
+    if (!ring.ringbuf_grow()) {
+        return false;
+    }
+
+    ring.empty_waits = 0;
+    log_write("[THREAD] grew %s ring to %u\n", name, ring.ringbuf_capacity());
+    UpdateTransferInfo();
+    return true;
+}
+
+void ThreadData::UpdateTransferInfo() {
+    // capacity is only read here for display, so a stale value is fine.
+    const auto depth = std::max(read_buffers.ringbuf_capacity(), write_buffers.ringbuf_capacity());
+    pbox->SetTransferInfo(std::to_string(depth) + " x " + utils::formatSizeStorage(read_buffer_size));
+}
+
+Result ThreadData::Wait(CondVar* var, Mutex* mutex, StageStats& stats) {
+    const auto start = armGetSystemTick();
+    const auto rc = condvarWait(var, mutex);
+    stats.stall_ticks += armGetSystemTick() - start;
+    return rc;
+}
+
+auto ThreadData::GetStats(const TimeStamp& ts) const -> TransferStats {
+    const auto stage = [](const StageStats& stats) -> TransferStageStats {
+        return { armTicksToNs(stats.stall_ticks), stats.bytes };
+    };
+
+    TransferStats stats{};
+    stats.elapsed_ns = std::max<u64>(1, ts.GetNs());
+    stats.buffer_size = read_buffer_size;
+    stats.read = stage(read_stats);
+    stats.decompress = stage(decompress_stats);
+    stats.write = stage(write_stats);
+    stats.pull = stage(pull_stats);
+    stats.read_occupancy = read_buffers.ringbuf_occupancy();
+    stats.write_occupancy = write_buffers.ringbuf_occupancy();
+    stats.read_depth = read_buffers.ringbuf_capacity();
+    stats.write_depth = write_buffers.ringbuf_capacity();
+    return stats;
+}
+
+void ThreadData::LogStats(const TransferStats& stats) const {
+    const auto elapsed_s = stats.elapsed_ns / 1e+9;
+
+    const auto log_stage = [&](const char* name, const TransferStageStats& stage) {
+        log_write("[THREAD] %s: %.2f MiB/s stall: %.2fms (%.1f%%)\n",
+            name, stage.bytes / 1024.0 / 1024.0 / elapsed_s, stage.stall_ns / 1e+6, stage.stall_ns * 100.0 / stats.elapsed_ns);
+    };
+
+    log_write("[THREAD] stats: %.2f MiB in %.2fs buffer: %zu KiB\n", write_size / 1024.0 / 1024.0, elapsed_s, stats.buffer_size / 1024);
+    log_stage("read", stats.read);
+    log_stage("decompress", stats.decompress);
+    log_stage("write", stats.write);
+    if (!wfunc) {
+        log_stage("pull", stats.pull);
+    }
+
+    log_write("[THREAD] occupancy read: %.2f/%u write: %.2f/%u\n",
+        stats.read_occupancy, stats.read_depth, stats.write_occupancy, stats.write_depth);
+}
+
+Result ThreadData::SetDecompressBuf(utils::PageBuffer& buf, s64 off, s64 size) {
     buf.resize(size);
 
     mutexLock(std::addressof(read_mutex));
@@ -273,7 +448,11 @@ Result ThreadData::SetDecompressBuf(std::vector<u8>& buf, s64 off, s64 size) {
         if (!write_running) {
             R_SUCCEED();
         }
-        R_TRY(condvarWait(std::addressof(can_read), std::addressof(read_mutex)));
+
+        if (!TryGrowRing(read_buffers, "read")) {
+            read_buffers.full_waits++;
+            R_TRY(Wait(std::addressof(can_read), std::addressof(read_mutex), read_stats));
+        }
     }
 
     ON_SCOPE_EXIT(mutexUnlock(std::addressof(read_mutex)));
@@ -282,14 +461,18 @@ Result ThreadData::SetDecompressBuf(std::vector<u8>& buf, s64 off, s64 size) {
     return condvarWakeOne(std::addressof(can_decompress));
 }
 
-Result ThreadData::GetDecompressBuf(std::vector<u8>& buf_out, s64& off_out) {
+Result ThreadData::GetDecompressBuf(utils::PageBuffer& buf_out, s64& off_out) {
     mutexLock(std::addressof(read_mutex));
     if (!read_buffers.ringbuf_size()) {
         if (!read_running) {
             buf_out.resize(0);
             R_SUCCEED();
         }
-        R_TRY(condvarWait(std::addressof(can_decompress), std::addressof(read_mutex)));
+
+        if (read_buffers.full_waits) {
+            read_buffers.empty_waits++;
+        }
+        R_TRY(Wait(std::addressof(can_decompress), std::addressof(read_mutex), decompress_stats));
     }
 
     ON_SCOPE_EXIT(mutexUnlock(std::addressof(read_mutex)));
@@ -298,7 +481,7 @@ Result ThreadData::GetDecompressBuf(std::vector<u8>& buf_out, s64& off_out) {
     return condvarWakeOne(std::addressof(can_read));
 }
 
-Result ThreadData::SetWriteBuf(std::vector<u8>& buf, s64 size) {
+Result ThreadData::SetWriteBuf(utils::PageBuffer& buf, s64 size) {
     buf.resize(size);
 
     mutexLock(std::addressof(write_mutex));
@@ -306,7 +489,11 @@ Result ThreadData::SetWriteBuf(std::vector<u8>& buf, s64 size) {
         if (!decompress_running) {
             R_SUCCEED();
         }
-        R_TRY(condvarWait(std::addressof(can_decompress_write), std::addressof(write_mutex)));
+
+        if (!TryGrowRing(write_buffers, "write")) {
+            write_buffers.full_waits++;
+            R_TRY(Wait(std::addressof(can_decompress_write), std::addressof(write_mutex), decompress_stats));
+        }
     }
 
     ON_SCOPE_EXIT(mutexUnlock(std::addressof(write_mutex)));
@@ -315,14 +502,18 @@ Result ThreadData::SetWriteBuf(std::vector<u8>& buf, s64 size) {
     return condvarWakeOne(std::addressof(can_write));
 }
 
-Result ThreadData::GetWriteBuf(std::vector<u8>& buf_out, s64& off_out) {
+Result ThreadData::GetWriteBuf(utils::PageBuffer& buf_out, s64& off_out) {
     mutexLock(std::addressof(write_mutex));
     if (!write_buffers.ringbuf_size()) {
         if (!decompress_running) {
             buf_out.resize(0);
             R_SUCCEED();
         }
-        R_TRY(condvarWait(std::addressof(can_write), std::addressof(write_mutex)));
+
+        if (write_buffers.full_waits) {
+            write_buffers.empty_waits++;
+        }
+        R_TRY(Wait(std::addressof(can_write), std::addressof(write_mutex), write_stats));
     }
 
     ON_SCOPE_EXIT(mutexUnlock(std::addressof(write_mutex)));
@@ -331,12 +522,12 @@ Result ThreadData::GetWriteBuf(std::vector<u8>& buf_out, s64& off_out) {
     return condvarWakeOne(std::addressof(can_decompress_write));
 }
 
-Result ThreadData::SetPullBuf(std::vector<u8>& buf, s64 size) {
+Result ThreadData::SetPullBuf(utils::PageBuffer& buf, s64 size) {
     buf.resize(size);
 
     mutexLock(std::addressof(pull_mutex));
     if (!pull_buffer.empty()) {
-        R_TRY(condvarWait(std::addressof(can_pull_write), std::addressof(pull_mutex)));
+        R_TRY(Wait(std::addressof(can_pull_write), std::addressof(pull_mutex), write_stats));
     }
 
     ON_SCOPE_EXIT(mutexUnlock(std::addressof(pull_mutex)));
@@ -349,7 +540,7 @@ Result ThreadData::SetPullBuf(std::vector<u8>& buf, s64 size) {
 Result ThreadData::GetPullBuf(void* data, s64 size, u64* bytes_read) {
     mutexLock(std::addressof(pull_mutex));
     if (pull_buffer.empty()) {
-        R_TRY(condvarWait(std::addressof(can_pull), std::addressof(pull_mutex)));
+        R_TRY(Wait(std::addressof(can_pull), std::addressof(pull_mutex), pull_stats));
     }
 
     ON_SCOPE_EXIT(mutexUnlock(std::addressof(pull_mutex)));
@@ -358,6 +549,7 @@ Result ThreadData::GetPullBuf(void* data, s64 size, u64* bytes_read) {
     *bytes_read = size = std::min<s64>(size, pull_buffer.size() - pull_buffer_offset);
     std::memcpy(data, pull_buffer.data() + pull_buffer_offset, size);
     pull_buffer_offset += size;
+    pull_stats.bytes += size;
 
     if (pull_buffer_offset == pull_buffer.size()) {
         pull_buffer_offset = 0;
@@ -384,7 +576,7 @@ Result ThreadData::readFuncInternal() {
     ON_SCOPE_EXIT( read_running = false; );
 
     // the main buffer which data is read into.
-    std::vector<u8> buf;
+    utils::PageBuffer buf;
     buf.reserve(this->read_buffer_size);
 
     while (this->read_offset < this->write_size && R_SUCCEEDED(this->GetResults())) {
@@ -399,6 +591,7 @@ Result ThreadData::readFuncInternal() {
             break;
         }
 
+        this->read_stats.bytes += bytes_read;
         ueventSignal(GetReadProgressEvent());
         auto buf_size = bytes_read;
         R_TRY(this->SetDecompressBuf(buf, buffer_offset, buf_size));
@@ -412,8 +605,8 @@ Result ThreadData::readFuncInternal() {
 Result ThreadData::decompressFuncInternal() {
     ON_SCOPE_EXIT( decompress_running = false; );
 
-    std::vector<u8> buf{};
-    std::vector<u8> temp_buf{};
+    utils::PageBuffer buf{};
+    utils::PageBuffer temp_buf{};
     buf.reserve(this->read_buffer_size);
     temp_buf.reserve(this->read_buffer_size);
     const auto temp_buf_flush_max = this->read_buffer_size / 2;
@@ -446,6 +639,7 @@ Result ThreadData::decompressFuncInternal() {
                     size -= rsize;
                     data += rsize;
                     this->decompress_offset += rsize;
+                    this->decompress_stats.bytes += rsize;
                     ueventSignal(GetDecompressProgressEvent());
                 }
 
@@ -453,6 +647,7 @@ Result ThreadData::decompressFuncInternal() {
             }));
         } else {
             this->decompress_offset += buf.size();
+            this->decompress_stats.bytes += buf.size();
             ueventSignal(GetDecompressProgressEvent());
 
             R_TRY(this->SetWriteBuf(buf, buf.size()));
@@ -473,7 +668,7 @@ Result ThreadData::decompressFuncInternal() {
 Result ThreadData::writeFuncInternal() {
     ON_SCOPE_EXIT( write_running = false; );
 
-    std::vector<u8> buf;
+    utils::PageBuffer buf;
     buf.reserve(this->read_buffer_size);
 
     while (this->write_offset < this->write_size && R_SUCCEEDED(this->GetResults())) {
@@ -492,6 +687,7 @@ Result ThreadData::writeFuncInternal() {
         }
 
         this->write_offset += size;
+        this->write_stats.bytes += size;
         ueventSignal(GetWriteProgressEvent());
     }
 
@@ -533,6 +729,20 @@ Result TransferInternal(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfu
         }
     }
 
+    if (mode == Mode::MultiThreaded) {
+        // use smaller chunks for small transfers, otherwise the first read has to
+        // complete before anything can be written.
+        if (size > 0) {
+            buffer_size = std::clamp<u64>(std::bit_floor<u64>(size / MIN_CHUNK_COUNT), MIN_BUFFER_SIZE, buffer_size);
+        }
+
+        // ensure that both rings at the max depth fit in memory, plus 1 buffer per thread.
+        const auto free_memory = GetFreeMemory();
+        while (buffer_size > MIN_BUFFER_SIZE && free_memory < MEMORY_RESERVE + buffer_size * (RING_DEPTH_MAX * 2 + 3)) {
+            buffer_size /= 2;
+        }
+    }
+
     // single threaded pull buffer is not supported.
     log_write("checking invalid transfer mode: %u %u\n", mode == Mode::MultiThreaded, !sfunc);
     R_UNLESS(mode == Mode::MultiThreaded || !sfunc, 0x1);
@@ -540,7 +750,7 @@ Result TransferInternal(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfu
 
     // todo: support single threaded pull buffer.
     if (mode == Mode::SingleThreaded) {
-        std::vector<u8> buf(buffer_size);
+        utils::PageBuffer buf(buffer_size);
 
         s64 offset{};
         while (offset < size) {
@@ -562,6 +772,9 @@ Result TransferInternal(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfu
         R_SUCCEED();
     }
     else {
+        const TimeStamp ts;
+        // pipeline buffers are reused by the next stage and freed once the transfer ends.
+        const utils::ScopedBufferPool buffer_pool{};
         ThreadData t_data{pbox, size, rfunc, dfunc, wfunc, buffer_size};
 
         Thread t_read{};
@@ -637,6 +850,13 @@ Result TransferInternal(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfu
             break;
         }
         log_write("threads closed\n");
+        const auto stats = t_data.GetStats(ts);
+        t_data.LogStats(stats);
+        {
+            SCOPED_MUTEX(&g_last_stats_mutex);
+            g_last_stats = stats;
+        }
+        g_ring_depth_hint = t_data.GetDepthHint();
 
         // if any of the threads failed, wake up all threads so they can exit.
         if (R_FAILED(t_data.GetResults())) {
@@ -652,6 +872,11 @@ Result TransferInternal(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfu
 
 } // namespace
 
+auto GetLastTransferStats() -> TransferStats {
+    SCOPED_MUTEX(&g_last_stats_mutex);
+    return g_last_stats;
+}
+
 Result Transfer(ui::ProgressBox* pbox, s64 size, const ReadCallback& rfunc, const WriteCallback& wfunc, Mode mode) {
     return TransferInternal(pbox, size, rfunc, nullptr, wfunc, nullptr, mode);
 }
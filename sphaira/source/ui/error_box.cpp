@@ -91,6 +91,8 @@ auto GetCodeMessage(Result rc) -> const char* {
         case Result_AppstoreFailedZipDownload: return "SphairaError_AppstoreFailedZipDownload";
         case Result_AppstoreFailedMd5: return "SphairaError_AppstoreFailedMd5";
         case Result_AppstoreFailedParseManifest: return "SphairaError_AppstoreFailedParseManifest";
+        case Result_AppstoreFailedParseRepo: return "SphairaError_AppstoreFailedParseRepo";
+        case Result_AppstoreBadRepoIndex: return "SphairaError_AppstoreBadRepoIndex";
         case Result_GameBadReadForDump: return "SphairaError_GameBadReadForDump";
         case Result_GameEmptyMetaEntries: return "SphairaError_GameEmptyMetaEntries";
         case Result_GameMultipleKeysFound: return "SphairaError_GameMultipleKeysFound";
@@ -101,6 +103,7 @@ auto GetCodeMessage(Result rc) -> const char* {
         case Result_KeyFailedDecyptETicketDeviceKey: return "SphairaError_KeyFailedDecyptETicketDeviceKey";
         case Result_NcaFailedNcaHeaderHashVerify: return "SphairaError_NcaFailedNcaHeaderHashVerify";
         case Result_NcaBadSigKeyGen: return "SphairaError_NcaBadSigKeyGen";
+        case Result_NcaFailedHashVerify: return "SphairaError_NcaFailedHashVerify";
         case Result_GcBadReadForDump: return "SphairaError_GcBadReadForDump";
         case Result_GcEmptyGamecard: return "SphairaError_GcEmptyGamecard";
         case Result_GcBadXciMagic: return "SphairaError_GcBadXciMagic";
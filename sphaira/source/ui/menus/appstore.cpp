@@ -11,7 +11,6 @@
 #include "app.hpp"
 #include "ui/nvg_util.hpp"
 #include "fs.hpp"
-#include "yyjson_helper.hpp"
 #include "swkbd.hpp"
 #include "i18n.hpp"
 #include "hasher.hpp"
@@ -36,6 +35,8 @@ namespace sphaira::ui::menu::appstore {
 namespace {
 
 constexpr fs::FsPath REPO_PATH{"/switch/sphaira/cache/appstore/repo.json"};
+// repo.json compiled by RepoIndex, rebuilt when the etag changes.
+constexpr fs::FsPath REPO_INDEX_PATH{"/switch/sphaira/cache/appstore/repo_index.bin"};
 constexpr fs::FsPath CACHE_PATH{"/switch/sphaira/cache/appstore"};
 constexpr auto URL_BASE = "https://switch.cdn.fortheusers.org";
 constexpr auto URL_JSON = "https://switch.cdn.fortheusers.org/repo.json";
@@ -83,51 +84,51 @@ constexpr const char* ORDER_STR[] = {
 
 auto BuildIconUrl(const Entry& e) -> std::string {
     char out[0x100];
-    std::snprintf(out, sizeof(out), "%s/packages/%s/icon.png", URL_BASE, e.name.c_str());
+    std::snprintf(out, sizeof(out), "%s/packages/%s/icon.png", URL_BASE, e.name.data());
     return out;
 }
 
 auto BuildBannerUrl(const Entry& e) -> std::string {
     char out[0x100];
-    std::snprintf(out, sizeof(out), "%s/packages/%s/screen.png", URL_BASE, e.name.c_str());
+    std::snprintf(out, sizeof(out), "%s/packages/%s/screen.png", URL_BASE, e.name.data());
     return out;
 }
 
 auto BuildManifestUrl(const Entry& e) -> std::string {
     char out[0x100];
-    std::snprintf(out, sizeof(out), "%s/packages/%s/manifest.install", URL_BASE, e.name.c_str());
+    std::snprintf(out, sizeof(out), "%s/packages/%s/manifest.install", URL_BASE, e.name.data());
     return out;
 }
 
 auto BuildZipUrl(const Entry& e) -> std::string {
     char out[0x100];
-    std::snprintf(out, sizeof(out), "%s/zips/%s.zip", URL_BASE, e.name.c_str());
+    std::snprintf(out, sizeof(out), "%s/zips/%s.zip", URL_BASE, e.name.data());
     return out;
 }
 
 auto BuildIconCachePath(const Entry& e) -> fs::FsPath {
     fs::FsPath out;
-    std::snprintf(out, sizeof(out), "%s/icons/%s.png", CACHE_PATH.s, e.name.c_str());
+    std::snprintf(out, sizeof(out), "%s/icons/%s.png", CACHE_PATH.s, e.name.data());
     return out;
 }
 
 auto BuildBannerCachePath(const Entry& e) -> fs::FsPath {
     fs::FsPath out;
-    std::snprintf(out, sizeof(out), "%s/banners/%s.png", CACHE_PATH.s, e.name.c_str());
+    std::snprintf(out, sizeof(out), "%s/banners/%s.png", CACHE_PATH.s, e.name.data());
     return out;
 }
 
 #if 0
 auto BuildScreensCachePath(const Entry& e, u8 num) -> fs::FsPath {
     fs::FsPath out;
-    std::snprintf(out, sizeof(out), "%s/screens/%s%u.png", CACHE_PATH, e.name.c_str(), num+1);
+    std::snprintf(out, sizeof(out), "%s/screens/%s%u.png", CACHE_PATH, e.name.data(), num+1);
     return out;
 }
 #endif
 
 // use appstore path in order to maintain compat with appstore
 auto BuildPackageCachePath(const Entry& e) -> fs::FsPath {
-    return "/switch/appstore/.get/packages/" + e.name;
+    return fs::FsPath{"/switch/appstore/.get/packages/"} + e.name;
 }
 
 auto BuildInfoCachePath(const Entry& e) -> fs::FsPath {
@@ -142,36 +143,6 @@ auto BuildFeedbackCachePath(const Entry& e) -> fs::FsPath {
     return BuildPackageCachePath(e) + "/feedback.json";
 }
 
-void from_json(yyjson_val* json, Entry& e) {
-    JSON_OBJ_ITR(
-        JSON_SET_STR(category);
-        JSON_SET_STR(binary);
-        JSON_SET_STR(updated);
-        JSON_SET_STR(name);
-        JSON_SET_STR(license);
-        JSON_SET_STR(title);
-        JSON_SET_STR(url);
-        JSON_SET_STR(description);
-        JSON_SET_STR(author);
-        JSON_SET_STR(changelog);
-        JSON_SET_UINT(screens);
-        JSON_SET_UINT(extracted);
-        JSON_SET_STR(version);
-        JSON_SET_UINT(filesize);
-        JSON_SET_STR(details);
-        JSON_SET_UINT(app_dls);
-        JSON_SET_STR(md5);
-    );
-}
-
-void from_json(const fs::FsPath& path, std::vector<appstore::Entry>& e) {
-    yyjson_read_err err;
-    JSON_INIT_VEC_FILE(path, nullptr, &err);
-    JSON_OBJ_ITR(
-        JSON_SET_ARR_OBJ2(packages, e);
-    );
-}
-
 auto ParseManifest(std::span<const char> view) -> ManifestEntries {
     ManifestEntries entries;
     // auto view = std::string_view{manifest_data.data(), manifest_data.size()};
@@ -313,14 +284,14 @@ void ReadFromInfoJson(Entry& e) {
         const auto root = yyjson_doc_get_root(doc);
         const auto version = yyjson_obj_get(root, "version");
         if (version) {
-            if (!std::strcmp(yyjson_get_str(version), e.version.c_str())) {
+            if (!std::strcmp(yyjson_get_str(version), e.version.data())) {
                 e.status = EntryStatus::Installed;
             } else {
                 e.status = EntryStatus::Update;
-                log_write("info.json said %s needs update: %s vs %s\n", e.name.c_str(), yyjson_get_str(version), e.version.c_str());
+                log_write("info.json said %s needs update: %s vs %s\n", e.name.data(), yyjson_get_str(version), e.version.data());
             }
         }
-        // log_write("got info for: %s\n", e.name.c_str());
+        // log_write("got info for: %s\n", e.name.data());
         yyjson_doc_free(doc);
     }
 }
@@ -384,7 +355,7 @@ auto InstallApp(ProgressBox* pbox, const Entry& entry) -> Result {
 
     // 1. download the zip
     if (!pbox->ShouldExit()) {
-        pbox->NewTransfer("Downloading "_i18n + entry.title);
+        pbox->NewTransfer("Downloading "_i18n + std::string{entry.title});
         log_write("starting download\n");
 
         const auto url = BuildZipUrl(entry);
@@ -395,6 +366,7 @@ auto InstallApp(ProgressBox* pbox, const Entry& entry) -> Result {
 
         if (file_download) {
             api.SetOption(curl::Path{zip_out});
+            api.SetOption(curl::Flags{curl::Flag_Segmented});
             api_result = curl::ToFile(api);
         } else {
             api_result = curl::ToMemory(api);
@@ -418,7 +390,7 @@ auto InstallApp(ProgressBox* pbox, const Entry& entry) -> Result {
         }
 
         if (strncasecmp(hash_out.data(), entry.md5.data(), entry.md5.length())) {
-            log_write("bad md5: %.*s vs %.*s\n", 32, hash_out.data(), 32, entry.md5.c_str());
+            log_write("bad md5: %.*s vs %.*s\n", 32, hash_out.data(), 32, entry.md5.data());
             R_THROW(Result_AppstoreFailedMd5);
         }
     }
@@ -560,18 +532,10 @@ auto InstallApp(ProgressBox* pbox, const Entry& entry) -> Result {
     R_SUCCEED();
 }
 
-// case-insensitive version of str.find()
-auto FindCaseInsensitive(std::string_view base, std::string_view term) -> bool {
-    const auto it = std::search(base.cbegin(), base.cend(), term.cbegin(), term.cend(), [](char a, char b){
-        return std::toupper(a) == std::toupper(b);
-    });
-    return it != base.cend();
-}
-
 } // namespace
 
 EntryMenu::EntryMenu(Entry& entry, const LazyImage& default_icon, Menu& menu)
-: MenuBase{entry.title, MenuFlag_None}
+: MenuBase{std::string{entry.title}, MenuFlag_None}
 , m_entry{entry}
 , m_default_icon{default_icon}
 , m_menu{menu} {
@@ -599,9 +563,9 @@ EntryMenu::EntryMenu(Entry& entry, const LazyImage& default_icon, Menu& menu)
 
             options->Add<SidebarEntryCallback>("Leave Feedback"_i18n, [this](){
                 std::string out;
-                std::string header = "Leave feedback for " + m_entry.title;
+                std::string header = "Leave feedback for " + std::string{m_entry.title};
                 if (R_SUCCEEDED(swkbd::ShowText(out, header.c_str())) && !out.empty()) {
-                    const auto post = "name=" "switch_user" "&package=" + m_entry.name + "&message=" + out;
+                    const auto post = "name=" "switch_user" "&package=" + std::string{m_entry.name} + "&message=" + out;
                     const auto file = BuildFeedbackCachePath(m_entry);
 
                     curl::Api().ToAsync(
@@ -622,7 +586,7 @@ EntryMenu::EntryMenu(Entry& entry, const LazyImage& default_icon, Menu& menu)
 
             if (App::IsApplication() && !m_entry.url.empty()) {
                 options->Add<SidebarEntryCallback>("Visit Website"_i18n, [this](){
-                    WebShow(m_entry.url);
+                    WebShow(std::string{m_entry.url});
                 });
             }
         }}),
@@ -660,10 +624,10 @@ EntryMenu::EntryMenu(Entry& entry, const LazyImage& default_icon, Menu& menu)
         }})
     );
 
-    SetTitleSubHeading("by " + m_entry.author);
+    SetTitleSubHeading("by " + std::string{m_entry.author});
 
-    m_details = std::make_unique<ScrollableText>(m_entry.details, 0, 374, 250, 768, 18);
-    m_changelog = std::make_unique<ScrollableText>(m_entry.changelog, 0, 374, 250, 768, 18);
+    m_details = std::make_unique<ScrollableText>(std::string{m_entry.details}, 0, 374, 250, 768, 18);
+    m_changelog = std::make_unique<ScrollableText>(std::string{m_entry.changelog}, 0, 374, 250, 768, 18);
 
     m_show_changlog ^= 1;
     ShowChangelogAction();
@@ -689,8 +653,8 @@ EntryMenu::EntryMenu(Entry& entry, const LazyImage& default_icon, Menu& menu)
         }
     });
 
-    SetSubHeading(m_entry.binary);
-    SetSubHeading(m_entry.description);
+    SetSubHeading(std::string{m_entry.binary});
+    SetSubHeading(std::string{m_entry.description});
     UpdateOptions();
 
     // todo: see Draw()
@@ -735,11 +699,11 @@ void EntryMenu::Draw(NVGcontext* vg, Theme* theme) {
     const float text_inc_y = 32;
     const float font_size = 20;
 
-    gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "version: %s"_i18n.c_str(), m_entry.version.c_str());
+    gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "version: %s"_i18n.c_str(), m_entry.version.data());
     text_start_y += text_inc_y;
-    gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "updated: %s"_i18n.c_str(), m_entry.updated.c_str());
+    gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "updated: %s"_i18n.c_str(), m_entry.updated.data());
     text_start_y += text_inc_y;
-    gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "category: %s"_i18n.c_str(), m_entry.category.c_str());
+    gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "category: %s"_i18n.c_str(), m_entry.category.data());
     text_start_y += text_inc_y;
     gfx::drawTextArgs(vg, text_start_x, text_start_y, font_size, NVG_ALIGN_LEFT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "extracted: %s"_i18n.c_str(), utils::formatSizeStorage(m_entry.extracted).c_str());
     text_start_y += text_inc_y;
@@ -795,18 +759,18 @@ void EntryMenu::ShowChangelogAction() {
 
 void EntryMenu::UpdateOptions() {
     const auto launch = [this](){
-        nro_launch(m_entry.binary);
+        nro_launch(std::string{m_entry.binary});
     };
 
     const auto install = [this](){
-        App::Push<ProgressBox>(m_entry.image.image, "Downloading "_i18n, m_entry.title, [this](auto pbox){
+        App::Push<ProgressBox>(m_entry.image.image, "Downloading "_i18n, std::string{m_entry.title}, [this](auto pbox){
             return InstallApp(pbox, m_entry);
         }, [this](Result rc){
             homebrew::SignalChange();
             App::PushErrorBox(rc, "Failed to, TODO: add message here"_i18n);
 
             if (R_SUCCEEDED(rc)) {
-                App::Notify("Downloaded "_i18n + m_entry.title);
+                App::Notify("Downloaded "_i18n + std::string{m_entry.title});
                 m_entry.status = EntryStatus::Installed;
                 m_menu.SetDirty();
                 UpdateOptions();
@@ -815,14 +779,14 @@ void EntryMenu::UpdateOptions() {
     };
 
     const auto uninstall = [this](){
-        App::Push<ProgressBox>(m_entry.image.image, "Uninstalling "_i18n, m_entry.title, [this](auto pbox){
+        App::Push<ProgressBox>(m_entry.image.image, "Uninstalling "_i18n, std::string{m_entry.title}, [this](auto pbox){
             return UninstallApp(pbox, m_entry);
         }, [this](Result rc){
             homebrew::SignalChange();
             App::PushErrorBox(rc, "Failed to, TODO: add message here"_i18n);
 
             if (R_SUCCEEDED(rc)) {
-                App::Notify("Removed "_i18n + m_entry.title);
+                App::Notify("Removed "_i18n + std::string{m_entry.title});
                 m_entry.status = EntryStatus::Get;
                 m_menu.SetDirty();
                 UpdateOptions();
@@ -833,7 +797,7 @@ void EntryMenu::UpdateOptions() {
     const Option install_option{"Install"_i18n, install};
     const Option update_option{"Update"_i18n, install};
     const Option launch_option{"Launch"_i18n, launch};
-    const Option remove_option{"Remove"_i18n, "Completely remove "_i18n + m_entry.title + '?', uninstall};
+    const Option remove_option{"Remove"_i18n, "Completely remove "_i18n + std::string{m_entry.title} + '?', uninstall};
 
     m_options.clear();
     switch (m_entry.status) {
@@ -987,6 +951,10 @@ Menu::Menu(u32 flags) : grid::Menu{"AppStore"_i18n, flags} {
         curl::StopToken{this->GetToken()},
         curl::OnComplete{[this](auto& result){
             if (result.success) {
+                if (auto it = result.header.Find("etag"); it != result.header.m_map.end()) {
+                    m_repo_key = it->second;
+                }
+
                 m_repo_download_state = ImageDownloadState::Done;
                 if (HasFocus()) {
                     ScanHomebrew();
@@ -1093,7 +1061,7 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
         }
 
         const auto selected = pos == m_index;
-        const auto image_vec = DrawEntryNoImage(vg, theme, m_layout.Get(), v, selected, e.title.c_str(), e.author.c_str(), e.version.c_str());
+        const auto image_vec = DrawEntryNoImage(vg, theme, m_layout.Get(), v, selected, e.title.data(), e.author.data(), e.version.data());
 
         const auto image_scale = 256.0 / image_vec.w;
         DrawIcon(vg, e.image, m_default_image, image_vec.x, image_vec.y, image_vec.w, image_vec.h, true, image_scale);
@@ -1175,44 +1143,54 @@ void Menu::ScanHomebrew() {
     App::SetBoostMode(true);
     ON_SCOPE_EXIT(App::SetBoostMode(false));
 
-    from_json(REPO_PATH, m_entries);
-
     fs::FsNativeSd fs;
     if (R_FAILED(fs.GetFsOpenResult())) {
         log_write("failed to open sd card in appstore scan\n");
         return;
     }
 
+    if (R_FAILED(m_repo.Open(&fs, REPO_PATH, REPO_INDEX_PATH, m_repo_key))) {
+        log_write("failed to open appstore repo index\n");
+        return;
+    }
+
+    const auto count = m_repo.GetCount();
+    m_entries.resize(count);
+
     // pre-allocate the max size, can shrink later if needed
     for (auto& index : m_entries_index) {
-        index.reserve(m_entries.size());
+        index.reserve(count);
     }
 
-    for (u32 i = 0; i < m_entries.size(); i++) {
-        auto& e = m_entries[i];
+    // search results never allocate after this.
+    m_entries_index_search.reserve(count);
+    m_entries_index_author.reserve(count);
 
-        m_entries_index[Filter_All].push_back(i);
+    for (u32 i = 0; i < count; i++) {
+        const auto& r = m_repo.GetRecord(i);
+        auto& e = m_entries[i];
 
-        if (e.category == std::string_view{"game"}) {
-            m_entries_index[Filter_Games].push_back(i);
-        } else if (e.category == std::string_view{"emu"}) {
-            m_entries_index[Filter_Emulators].push_back(i);
-        } else if (e.category == std::string_view{"tool"}) {
-            m_entries_index[Filter_Tools].push_back(i);
-        } else if (e.category == std::string_view{"advanced"}) {
-            m_entries_index[Filter_Advanced].push_back(i);
-        } else if (e.category == std::string_view{"theme"}) {
-            m_entries_index[Filter_Themes].push_back(i);
-        } else if (e.category == std::string_view{"legacy"}) {
-            m_entries_index[Filter_Legacy].push_back(i);
-        } else {
-            m_entries_index[Filter_Misc].push_back(i);
-        }
+        e.category = m_repo.GetString(r.category);
+        e.binary = m_repo.GetString(r.binary);
+        e.updated = m_repo.GetString(r.updated);
+        e.name = m_repo.GetString(r.name);
+        e.license = m_repo.GetString(r.license);
+        e.title = m_repo.GetString(r.title);
+        e.url = m_repo.GetString(r.url);
+        e.description = m_repo.GetString(r.description);
+        e.author = m_repo.GetString(r.author);
+        e.changelog = m_repo.GetString(r.changelog);
+        e.screens = r.screens;
+        e.extracted = r.extracted;
+        e.version = m_repo.GetString(r.version);
+        e.filesize = r.filesize;
+        e.details = m_repo.GetString(r.details);
+        e.app_dls = r.app_dls;
+        e.md5 = m_repo.GetString(r.md5);
+        e.updated_num = r.updated_num;
 
-        // fwiw, this is how N stores update info
-        e.updated_num = std::atoi(e.updated.c_str()); // day
-        e.updated_num += std::atoi(e.updated.c_str() + 3) * 100; // month
-        e.updated_num += std::atoi(e.updated.c_str() + 6) * 100 * 100; // year
+        m_entries_index[Filter_All].push_back(i);
+        m_entries_index[r.filter].push_back(i);
 
         e.status = EntryStatus::Get;
         // if binary is present, check for it, if not avalible, report as not installed
@@ -1248,7 +1226,7 @@ void Menu::ScanHomebrew() {
                     if (!filtered) {
                         e.status = EntryStatus::Local;
                     } else {
-                        log_write("filtered: %s path: %s\n", e.name.c_str(), e.binary.c_str());
+                        log_write("filtered: %s path: %s\n", e.name.data(), e.binary.data());
                     }
                 }
             }
@@ -1296,7 +1274,7 @@ void Menu::Sort() {
             switch (sort) {
                 case SortType_Updated: {
                     if (lhs.updated_num == rhs.updated_num) {
-                        return strcasecmp(lhs.name.c_str(), rhs.name.c_str()) < 0;
+                        return strcasecmp(lhs.name.data(), rhs.name.data()) < 0;
                     } else if (order == OrderType_Descending) {
                         return lhs.updated_num > rhs.updated_num;
                     } else {
@@ -1305,7 +1283,7 @@ void Menu::Sort() {
                 } break;
                 case SortType_Downloads: {
                     if (lhs.app_dls == rhs.app_dls) {
-                        return strcasecmp(lhs.name.c_str(), rhs.name.c_str()) < 0;
+                        return strcasecmp(lhs.name.data(), rhs.name.data()) < 0;
                     } else if (order == OrderType_Descending) {
                         return lhs.app_dls > rhs.app_dls;
                     } else {
@@ -1314,7 +1292,7 @@ void Menu::Sort() {
                 } break;
                 case SortType_Size: {
                     if (lhs.extracted == rhs.extracted) {
-                        return strcasecmp(lhs.name.c_str(), rhs.name.c_str()) < 0;
+                        return strcasecmp(lhs.name.data(), rhs.name.data()) < 0;
                     } else if (order == OrderType_Descending) {
                         return lhs.extracted > rhs.extracted;
                     } else {
@@ -1323,9 +1301,9 @@ void Menu::Sort() {
                 } break;
                 case SortType_Alphabetical: {
                     if (order == OrderType_Descending) {
-                        return strcasecmp(lhs.name.c_str(), rhs.name.c_str()) < 0;
+                        return strcasecmp(lhs.name.data(), rhs.name.data()) < 0;
                     } else {
-                        return strcasecmp(lhs.name.c_str(), rhs.name.c_str()) > 0;
+                        return strcasecmp(lhs.name.data(), rhs.name.data()) > 0;
                     }
                 } break;
             }
@@ -1383,15 +1361,7 @@ void Menu::SetSearch(const std::string& term) {
     }
 
     m_search_term = term;
-    m_entries_index_search.clear();
-    const auto query = m_search_term;
-
-    for (u64 i = 0; i < m_entries.size(); i++) {
-        const auto& e = m_entries[i];
-        if (FindCaseInsensitive(e.title, query) || FindCaseInsensitive(e.author, query) || FindCaseInsensitive(e.description, query)) {
-            m_entries_index_search.emplace_back(i);
-        }
-    }
+    m_repo.Search(m_search_term, SearchField_Title | SearchField_Author | SearchField_Description, m_entries_index_search);
 
     m_is_search = true;
     m_entries_current = m_entries_index_search;
@@ -1405,15 +1375,7 @@ void Menu::SetAuthor() {
     }
 
     m_author_term = m_entries[m_entries_current[m_index]].author;
-    m_entries_index_author.clear();
-    const auto query = m_author_term;
-
-    for (u64 i = 0; i < m_entries.size(); i++) {
-        const auto& e = m_entries[i];
-        if (FindCaseInsensitive(e.author, query)) {
-            m_entries_index_author.emplace_back(i);
-        }
-    }
+    m_repo.Search(m_author_term, SearchField_Author, m_entries_index_author);
 
     m_is_author = true;
     m_entries_current = m_entries_index_author;
@@ -0,0 +1,386 @@
+#include "ui/menus/appstore_index.hpp"
+#include "ui/menus/appstore.hpp"
+
+#include "defines.hpp"
+#include "log.hpp"
+
+#include <yyjson.h>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+
+namespace sphaira::ui::menu::appstore {
+namespace {
+
+constexpr u32 INDEX_MAGIC = 0x58444953; // SIDX
+constexpr u32 INDEX_VERSION = 1;
+
+static_assert(sizeof(IndexHeader) % alignof(IndexRecord) == 0);
+static_assert(sizeof(IndexRecord) % alignof(IndexTrigram) == 0);
+
+constexpr IndexString IndexRecord::* RECORD_STRINGS[] = {
+    &IndexRecord::category,
+    &IndexRecord::binary,
+    &IndexRecord::updated,
+    &IndexRecord::name,
+    &IndexRecord::license,
+    &IndexRecord::title,
+    &IndexRecord::url,
+    &IndexRecord::description,
+    &IndexRecord::author,
+    &IndexRecord::changelog,
+    &IndexRecord::version,
+    &IndexRecord::details,
+    &IndexRecord::md5,
+};
+
+auto ToLower(char c) -> u8 {
+    return std::tolower((unsigned char)c);
+}
+
+// packs 3 lower case chars into a trigram.
+auto MakeTrigram(const char* str) -> u32 {
+    return (u32)ToLower(str[0]) << 16 | (u32)ToLower(str[1]) << 8 | (u32)ToLower(str[2]);
+}
+
+void AddTrigrams(std::string_view str, std::vector<u32>& out) {
+    for (size_t i = 0; i + 3 <= str.size(); i++) {
+        out.emplace_back(MakeTrigram(str.data() + i));
+    }
+}
+
+// case-insensitive version of str.find()
+auto FindCaseInsensitive(std::string_view base, std::string_view term) -> bool {
+    const auto it = std::search(base.cbegin(), base.cend(), term.cbegin(), term.cend(), [](char a, char b){
+        return ToLower(a) == ToLower(b);
+    });
+    return it != base.cend();
+}
+
+auto GetFilter(std::string_view category) -> Filter {
+    if (category == "game") {
+        return Filter_Games;
+    } else if (category == "emu") {
+        return Filter_Emulators;
+    } else if (category == "tool") {
+        return Filter_Tools;
+    } else if (category == "advanced") {
+        return Filter_Advanced;
+    } else if (category == "theme") {
+        return Filter_Themes;
+    } else if (category == "legacy") {
+        return Filter_Legacy;
+    } else {
+        return Filter_Misc;
+    }
+}
+
+// fwiw, this is how N stores update info
+auto GetUpdatedNum(const char* updated, size_t len) -> u32 {
+    if (len < 6) {
+        return 0;
+    }
+
+    u32 num = std::atoi(updated); // day
+    num += std::atoi(updated + 3) * 100; // month
+    num += std::atoi(updated + 6) * 100 * 100; // year
+    return num;
+}
+
+auto GetJsonStr(yyjson_val* json, const char* key) -> std::string_view {
+    const auto val = yyjson_obj_get(json, key);
+    if (!yyjson_is_str(val)) {
+        return {};
+    }
+    return {yyjson_get_str(val), yyjson_get_len(val)};
+}
+
+auto GetJsonUint(yyjson_val* json, const char* key) -> u64 {
+    return yyjson_get_uint(yyjson_obj_get(json, key));
+}
+
+// dedupes strings as the category, author and license are often the same.
+struct StringPool {
+    StringPool() {
+        // offset 0 is the empty string.
+        m_pool.emplace_back('\0');
+    }
+
+    auto Add(std::string_view str) -> IndexString {
+        if (str.empty()) {
+            return {};
+        }
+
+        if (const auto it = m_strings.find(str); it != m_strings.end()) {
+            return it->second;
+        }
+
+        const IndexString out{(u32)m_pool.size(), (u32)str.size()};
+        m_pool.insert(m_pool.end(), str.cbegin(), str.cend());
+        m_pool.emplace_back('\0');
+        m_strings.emplace(str, out);
+        return out;
+    }
+
+    std::vector<char> m_pool{};
+
+private:
+    // views into the json doc, which outlives the pool.
+    std::unordered_map<std::string_view, IndexString> m_strings{};
+};
+
+} // namespace
+
+Result RepoIndex::Open(fs::Fs* fs, const fs::FsPath& json_path, const fs::FsPath& index_path, std::string_view key) {
+    FsTimeStampRaw ts;
+    s64 json_size;
+    R_TRY(fs->FileGetSizeAndTimestamp(json_path, &ts, &json_size));
+
+    if (R_SUCCEEDED(Load(fs, index_path))) {
+        // not every response has an etag, so the json is also checked.
+        if ((key.empty() || GetString(m_header->key) == key) && m_header->json_size == json_size && m_header->json_modified == ts.modified) {
+            log_write("[APPSTORE] loaded index, count: %u\n", GetCount());
+            R_SUCCEED();
+        }
+
+        log_write("[APPSTORE] repo changed, rebuilding index\n");
+    }
+
+    return Build(fs, json_path, index_path, key, json_size, ts.modified);
+}
+
+void RepoIndex::Search(std::string_view query, u32 fields, std::vector<u32>& out) const {
+    out.clear();
+
+    const auto matches = [this, query, fields](u32 i) {
+        const auto& r = m_records[i];
+        return ((fields & SearchField_Title) && FindCaseInsensitive(GetString(r.title), query)) ||
+               ((fields & SearchField_Author) && FindCaseInsensitive(GetString(r.author), query)) ||
+               ((fields & SearchField_Description) && FindCaseInsensitive(GetString(r.description), query));
+    };
+
+    // too short to have a trigram, check every record.
+    if (query.size() < 3) {
+        for (u32 i = 0; i < m_records.size(); i++) {
+            if (matches(i)) {
+                out.emplace_back(i);
+            }
+        }
+        return;
+    }
+
+    // every record that matches has all of the query's trigrams, so only the
+    // records of the rarest trigram need to be checked.
+    std::span<const u32> candidates{};
+    for (size_t i = 0; i + 3 <= query.size(); i++) {
+        const auto trigram = MakeTrigram(query.data() + i);
+        const auto it = std::ranges::lower_bound(m_trigrams, trigram, {}, &IndexTrigram::trigram);
+        if (it == m_trigrams.end() || it->trigram != trigram) {
+            return;
+        }
+
+        if (!i || it->count < candidates.size()) {
+            candidates = m_postings.subspan(it->offset, it->count);
+        }
+    }
+
+    for (const auto i : candidates) {
+        if (matches(i)) {
+            out.emplace_back(i);
+        }
+    }
+}
+
+Result RepoIndex::Load(fs::Fs* fs, const fs::FsPath& index_path) {
+    std::vector<u8> data;
+    R_TRY(fs->read_entire_file(index_path, data));
+    return Parse(std::move(data));
+}
+
+Result RepoIndex::Build(fs::Fs* fs, const fs::FsPath& json_path, const fs::FsPath& index_path, std::string_view key, s64 json_size, u64 json_modified) {
+    Reset();
+
+    yyjson_read_err err;
+    auto doc = yyjson_read_file(json_path, YYJSON_READ_NOFLAG, nullptr, &err);
+    if (!doc) {
+        log_write("[APPSTORE] failed to parse repo: %s\n", err.msg);
+        R_THROW(Result_AppstoreFailedParseRepo);
+    }
+    ON_SCOPE_EXIT(yyjson_doc_free(doc));
+
+    const auto packages = yyjson_obj_get(yyjson_doc_get_root(doc), "packages");
+    R_UNLESS(yyjson_is_arr(packages), Result_AppstoreFailedParseRepo);
+
+    StringPool pool;
+    std::vector<IndexRecord> records;
+    records.reserve(yyjson_arr_size(packages));
+
+    // trigram << 32 | record, sorting these groups the records of each trigram.
+    std::vector<u64> pairs;
+    std::vector<u32> trigrams;
+
+    size_t idx, max;
+    yyjson_val* json;
+    yyjson_arr_foreach(packages, idx, max, json) {
+        if (!yyjson_is_obj(json)) {
+            continue;
+        }
+
+        const auto category = GetJsonStr(json, "category");
+        const auto updated = GetJsonStr(json, "updated");
+
+        IndexRecord r{};
+        r.category = pool.Add(category);
+        r.binary = pool.Add(GetJsonStr(json, "binary"));
+        r.updated = pool.Add(updated);
+        r.name = pool.Add(GetJsonStr(json, "name"));
+        r.license = pool.Add(GetJsonStr(json, "license"));
+        r.title = pool.Add(GetJsonStr(json, "title"));
+        r.url = pool.Add(GetJsonStr(json, "url"));
+        r.description = pool.Add(GetJsonStr(json, "description"));
+        r.author = pool.Add(GetJsonStr(json, "author"));
+        r.changelog = pool.Add(GetJsonStr(json, "changelog"));
+        r.version = pool.Add(GetJsonStr(json, "version"));
+        r.details = pool.Add(GetJsonStr(json, "details"));
+        r.md5 = pool.Add(GetJsonStr(json, "md5"));
+        r.screens = GetJsonUint(json, "screens");
+        r.extracted = GetJsonUint(json, "extracted");
+        r.filesize = GetJsonUint(json, "filesize");
+        r.app_dls = GetJsonUint(json, "app_dls");
+        r.updated_num = GetUpdatedNum(updated.data(), updated.size());
+        r.filter = GetFilter(category);
+
+        trigrams.clear();
+        AddTrigrams(GetJsonStr(json, "title"), trigrams);
+        AddTrigrams(GetJsonStr(json, "author"), trigrams);
+        AddTrigrams(GetJsonStr(json, "description"), trigrams);
+        std::ranges::sort(trigrams);
+        const auto [first, last] = std::ranges::unique(trigrams);
+        trigrams.erase(first, last);
+
+        for (const auto trigram : trigrams) {
+            pairs.emplace_back((u64)trigram << 32 | records.size());
+        }
+
+        records.emplace_back(r);
+    }
+
+    std::ranges::sort(pairs);
+
+    std::vector<IndexTrigram> table;
+    std::vector<u32> postings(pairs.size());
+    for (u32 i = 0; i < pairs.size(); i++) {
+        const auto trigram = (u32)(pairs[i] >> 32);
+        if (table.empty() || table.back().trigram != trigram) {
+            table.emplace_back(trigram, i, 0);
+        }
+
+        table.back().count++;
+        postings[i] = (u32)pairs[i];
+    }
+
+    const auto key_str = pool.Add(key);
+
+    const IndexHeader header{
+        .magic = INDEX_MAGIC,
+        .version = INDEX_VERSION,
+        .key = key_str,
+        .json_size = json_size,
+        .json_modified = json_modified,
+        .record_count = (u32)records.size(),
+        .trigram_count = (u32)table.size(),
+        .posting_count = (u32)postings.size(),
+        .pool_size = (u32)pool.m_pool.size(),
+    };
+
+    std::vector<u8> data;
+    const auto write = [&data](const void* buf, u64 size) {
+        const auto off = data.size();
+        data.resize(off + size);
+        std::memcpy(data.data() + off, buf, size);
+    };
+
+    data.reserve(sizeof(header) + records.size() * sizeof(IndexRecord) + table.size() * sizeof(IndexTrigram) + postings.size() * sizeof(u32) + pool.m_pool.size());
+    write(&header, sizeof(header));
+    write(records.data(), records.size() * sizeof(IndexRecord));
+    write(table.data(), table.size() * sizeof(IndexTrigram));
+    write(postings.data(), postings.size() * sizeof(u32));
+    write(pool.m_pool.data(), pool.m_pool.size());
+
+    log_write("[APPSTORE] built index, count: %zu trigrams: %zu size: %zu\n", records.size(), table.size(), data.size());
+
+    fs->CreateDirectoryRecursivelyWithPath(index_path);
+    if (R_FAILED(fs->write_entire_file(index_path, data))) {
+        log_write("[APPSTORE] failed to save index\n");
+    }
+
+    return Parse(std::move(data));
+}
+
+Result RepoIndex::Parse(std::vector<u8>&& data) {
+    Reset();
+
+    IndexHeader header;
+    R_UNLESS(data.size() >= sizeof(header), Result_AppstoreBadRepoIndex);
+    std::memcpy(&header, data.data(), sizeof(header));
+    R_UNLESS(header.magic == INDEX_MAGIC, Result_AppstoreBadRepoIndex);
+    R_UNLESS(header.version == INDEX_VERSION, Result_AppstoreBadRepoIndex);
+
+    const u64 records_off = sizeof(header);
+    const u64 trigrams_off = records_off + (u64)header.record_count * sizeof(IndexRecord);
+    const u64 postings_off = trigrams_off + (u64)header.trigram_count * sizeof(IndexTrigram);
+    const u64 pool_off = postings_off + (u64)header.posting_count * sizeof(u32);
+    R_UNLESS(header.pool_size && pool_off + header.pool_size == data.size(), Result_AppstoreBadRepoIndex);
+
+    const auto ptr = data.data();
+    const std::span records{(const IndexRecord*)(ptr + records_off), header.record_count};
+    const std::span trigrams{(const IndexTrigram*)(ptr + trigrams_off), header.trigram_count};
+    const std::span postings{(const u32*)(ptr + postings_off), header.posting_count};
+    const std::span pool{(const char*)(ptr + pool_off), header.pool_size};
+
+    // validate everything once so that lookups don't need to.
+    const auto valid_str = [&pool](const IndexString& str) {
+        return (u64)str.offset + str.length < pool.size() && pool[str.offset + str.length] == '\0';
+    };
+
+    R_UNLESS(valid_str(header.key), Result_AppstoreBadRepoIndex);
+
+    for (const auto& r : records) {
+        for (const auto str : RECORD_STRINGS) {
+            R_UNLESS(valid_str(r.*str), Result_AppstoreBadRepoIndex);
+        }
+        R_UNLESS(r.filter < Filter_MAX, Result_AppstoreBadRepoIndex);
+    }
+
+    for (u32 i = 0; i < trigrams.size(); i++) {
+        const auto& t = trigrams[i];
+        R_UNLESS(!i || trigrams[i - 1].trigram < t.trigram, Result_AppstoreBadRepoIndex);
+        R_UNLESS((u64)t.offset + t.count <= postings.size(), Result_AppstoreBadRepoIndex);
+    }
+
+    for (const auto i : postings) {
+        R_UNLESS(i < records.size(), Result_AppstoreBadRepoIndex);
+    }
+
+    // moving the vector keeps the same buffer.
+    m_data = std::move(data);
+    m_header = (const IndexHeader*)m_data.data();
+    m_records = records;
+    m_trigrams = trigrams;
+    m_postings = postings;
+    m_pool = pool;
+    R_SUCCEED();
+}
+
+void RepoIndex::Reset() {
+    m_header = nullptr;
+    m_records = {};
+    m_trigrams = {};
+    m_postings = {};
+    m_pool = {};
+    m_data.clear();
+}
+
+} // namespace sphaira::ui::menu::appstore
@@ -12,6 +12,8 @@
 
 #include "utils/utils.hpp"
 #include "utils/devoptab.hpp"
+#include "utils/thread.hpp"
+#include "utils/io_qos.hpp"
 
 #include "log.hpp"
 #include "app.hpp"
@@ -38,12 +40,14 @@
 #include <dirent.h>
 #include <cstring>
 #include <cassert>
+#include <cctype>
 #include <string>
 #include <string_view>
 #include <ctime>
 #include <span>
 #include <utility>
 #include <ranges>
+#include <deque>
 
 #ifdef ENABLE_LIBUSBDVD
 #include <usbdvd.h>
@@ -279,6 +283,7 @@ auto GetRomIcon(std::string filename, const RomDatabaseIndexs& db_indexs, const
         // try and find icon locally
         std::vector<u8> image_file;
         if (R_SUCCEEDED(fs::FsNativeSd().read_entire_file(ra_thumbnail_path, image_file))) {
+            utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Foreground, image_file.size());
             return image_file;
         }
     }
@@ -398,8 +403,453 @@ auto ForwarderForm::LoadNroMeta() -> Result {
     R_SUCCEED();
 }
 
+// files up to this size are copied in parallel when pasting, as the open / create
+// latency is greater than the time it takes to copy the data.
+// larger files are copied one at a time using the threaded transfer.
+constexpr s64 PASTE_SMALL_FILE_MAX = 1024 * 1024 * 4;
+constexpr u32 PASTE_WORKER_COUNT = 4;
+constexpr u64 PASTE_BUFFER_SIZE = 1024 * 512;
+
+struct PasteJob {
+    fs::FsPath src_path;
+    fs::FsPath dst_path;
+    // size reported by the dir listing, the real size is fetched on open.
+    s64 size;
+};
+
+// called on the worker thread once a file has been copied.
+using PasteDoneCallback = std::function<Result(const fs::FsPath& src_path, const fs::FsPath& dst_path)>;
+
+struct PasteScheduler {
+    fs::Fs* fs_src;
+    fs::Fs* fs_dst;
+    std::span<const PasteJob> jobs;
+    const PasteDoneCallback* on_done;
+    bool throttle;
+
+    std::atomic<u64> next_job{};
+    std::atomic<u64> done_jobs{};
+    std::atomic<s64> offset{};
+    std::atomic<s64> total{};
+    std::atomic_bool quit{};
+
+    Mutex mutex{};
+    Result rc{};
+
+    void SetResult(Result result) {
+        SCOPED_MUTEX(&mutex);
+        if (R_SUCCEEDED(rc)) {
+            rc = result;
+        }
+        quit = true;
+    }
+
+    Result CopyFile(const PasteJob& job, std::vector<u8>& buf) {
+        fs::File src_file;
+        R_TRY(fs_src->OpenFile(job.src_path, FsOpenMode_Read, &src_file));
+
+        s64 src_size;
+        R_TRY(src_file.GetSize(&src_size));
+        total += src_size - job.size;
+
+        // see ProgressBox::CopyFile() as to why the result is ignored.
+        fs_dst->CreateFile(job.dst_path, src_size, 0);
+
+        fs::File dst_file;
+        R_TRY(fs_dst->OpenFile(job.dst_path, FsOpenMode_Write, &dst_file));
+        R_TRY(dst_file.SetSize(src_size));
+
+        for (s64 off = 0; off < src_size;) {
+            R_UNLESS(!quit, Result_TransferCancelled);
+
+            u64 bytes_read;
+            const auto read_size = std::min<s64>(buf.size(), src_size - off);
+            if (throttle) {
+                utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Bulk, read_size);
+            }
+
+            R_TRY(src_file.Read(off, buf.data(), read_size, 0, &bytes_read));
+            if (!bytes_read) {
+                break;
+            }
+
+            if (throttle) {
+                utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Write, utils::qos::Priority_Bulk, bytes_read);
+            }
+
+            R_TRY(dst_file.Write(off, buf.data(), bytes_read, 0));
+
+            off += bytes_read;
+            offset += bytes_read;
+        }
+
+        R_SUCCEED();
+    }
+
+    static void WorkerFunc(void* arg) {
+        auto self = static_cast<PasteScheduler*>(arg);
+        std::vector<u8> buf(PASTE_BUFFER_SIZE);
+
+        while (!self->quit) {
+            const auto index = self->next_job++;
+            if (index >= self->jobs.size()) {
+                break;
+            }
+
+            const auto& job = self->jobs[index];
+            auto rc = self->CopyFile(job, buf);
+            if (R_SUCCEEDED(rc) && *self->on_done) {
+                rc = (*self->on_done)(job.src_path, job.dst_path);
+            }
+
+            if (R_FAILED(rc)) {
+                log_write("[PASTE] failed to copy: %s 0x%X\n", job.src_path.s, rc);
+                self->SetResult(rc);
+                break;
+            }
+
+            self->done_jobs++;
+        }
+    }
+};
+
+// copies all jobs using a pool of workers, progress is reported as a single transfer.
+Result PasteFiles(ProgressBox* pbox, fs::Fs* fs_src, fs::Fs* fs_dst, std::span<const PasteJob> jobs, const PasteDoneCallback& on_done) {
+    if (jobs.empty()) {
+        R_SUCCEED();
+    }
+
+    const auto is_both_native = fs_src->IsNative() && fs_dst->IsNative();
+
+    PasteScheduler ctx{};
+    ctx.fs_src = fs_src;
+    ctx.fs_dst = fs_dst;
+    ctx.jobs = jobs;
+    ctx.on_done = &on_done;
+    // see ProgressBox::CopyFile().
+    ctx.throttle = is_both_native && App::IsFileBaseEmummc();
+    mutexInit(&ctx.mutex);
+
+    for (const auto& job : jobs) {
+        ctx.total += job.size;
+    }
+
+    // devoptab backed fs may not handle concurrent access to multiple files,
+    // nor does it help file based emummc, so only use 1 worker there.
+    u32 worker_count = 1;
+    if (is_both_native && !ctx.throttle) {
+        worker_count = std::min<u64>(PASTE_WORKER_COUNT, jobs.size());
+    }
+
+    std::vector<Thread> threads(worker_count);
+    u32 thread_count = 0;
+
+    for (auto& thread : threads) {
+        if (R_FAILED(utils::CreateThread(&thread, PasteScheduler::WorkerFunc, &ctx))) {
+            log_write("[PASTE] failed to create worker\n");
+            break;
+        }
+
+        if (R_FAILED(threadStart(&thread))) {
+            log_write("[PASTE] failed to start worker\n");
+            threadClose(&thread);
+            break;
+        }
+
+        thread_count++;
+    }
+
+    // no workers, copy on this thread instead.
+    if (!thread_count) {
+        PasteScheduler::WorkerFunc(&ctx);
+    }
+
+    u64 last_done = ~0ULL;
+    while (thread_count && ctx.done_jobs < jobs.size() && !ctx.quit) {
+        if (const auto rc = pbox->ShouldExitResult(); R_FAILED(rc)) {
+            ctx.SetResult(rc);
+            break;
+        }
+
+        if (const auto done = ctx.done_jobs.load(); done != last_done) {
+            last_done = done;
+            pbox->SetTitle(std::to_string(done) + " / " + std::to_string(jobs.size()));
+        }
+
+        pbox->UpdateTransfer(ctx.offset, ctx.total);
+        svcSleepThread(1e+7); // 10ms
+    }
+
+    // workers exit once they finish their current file.
+    ctx.quit = true;
+    for (u32 i = 0; i < thread_count; i++) {
+        threadWaitForExit(&threads[i]);
+        threadClose(&threads[i]);
+    }
+
+    return ctx.rc;
+}
+
 } // namespace
 
+void FileEntryList::clear() {
+    m_names.clear();
+    m_keys.clear();
+    m_name_offsets.clear();
+    m_name_lengths.clear();
+    m_ext_offsets.clear();
+    m_flags.clear();
+    m_file_sizes.clear();
+    m_file_counts.clear();
+    m_dir_counts.clear();
+    m_time_stamps.clear();
+    m_internal_names.clear();
+}
+
+void FileEntryList::reserve(size_t count, size_t name_size) {
+    m_names.reserve(name_size);
+    m_keys.reserve(name_size);
+    m_name_offsets.reserve(count);
+    m_name_lengths.reserve(count);
+    m_ext_offsets.reserve(count);
+    m_flags.reserve(count);
+    m_file_sizes.reserve(count);
+    m_file_counts.reserve(count);
+    m_dir_counts.reserve(count);
+    m_time_stamps.reserve(count);
+}
+
+void FileEntryList::push_back(const FsDirectoryEntry& e) {
+    const auto len = strnlen(e.name, sizeof(e.name) - 1);
+    const auto offset = m_names.size();
+
+    // names are null terminated so that they can be passed as c strings.
+    m_names.append(e.name, len);
+    m_names.push_back('\0');
+
+    for (size_t i = 0; i < len; i++) {
+        m_keys.push_back(std::tolower((u8)e.name[i]));
+    }
+    m_keys.push_back('\0');
+
+    u16 ext_offset = 0;
+    if (auto ext = std::strrchr(m_names.data() + offset, '.')) {
+        ext_offset = ext + 1 - (m_names.data() + offset);
+    }
+
+    m_name_offsets.emplace_back(offset);
+    m_name_lengths.emplace_back(len);
+    m_ext_offsets.emplace_back(ext_offset);
+    m_flags.emplace_back(e.type == FsDirEntryType_Dir ? Flag_Dir : 0);
+    m_file_sizes.emplace_back(e.file_size);
+    m_file_counts.emplace_back(-1);
+    m_dir_counts.emplace_back(-1);
+    m_time_stamps.emplace_back(0);
+}
+
+auto FileEntryList::Get(u32 i) const -> FileEntry {
+    FileEntry e{};
+    std::strcpy(e.name, GetName(i));
+    e.type = IsDir(i) ? FsDirEntryType_Dir : FsDirEntryType_File;
+    e.file_size = m_file_sizes[i];
+    e.file_count = m_file_counts[i];
+    e.dir_count = m_dir_counts[i];
+    e.time_stamp.modified = m_time_stamps[i];
+    e.time_stamp.is_valid = IsTimeStampValid(i);
+    e.checked_internal_extension = HasFlag(i, Flag_CheckedInternalExtension);
+    e.selected = IsSelected(i);
+    e.done_stat = HasFlag(i, Flag_DoneStat);
+
+    for (const auto& internal : m_internal_names) {
+        if (internal.index == i) {
+            e.internal_name = internal.name;
+            e.internal_extension = internal.extension;
+            break;
+        }
+    }
+
+    return e;
+}
+
+void FileEntryList::SetDirStat(u32 i, s64 file_count, s64 dir_count) {
+    m_file_counts[i] = file_count;
+    m_dir_counts[i] = dir_count;
+    SetFlag(i, Flag_DoneStat, true);
+}
+
+void FileEntryList::SetFileStat(u32 i, const FsTimeStampRaw& time_stamp, s64 file_size) {
+    m_time_stamps[i] = time_stamp.modified;
+    SetFlag(i, Flag_TimeStampValid, time_stamp.is_valid);
+    SetFlag(i, Flag_DoneStat, true);
+
+    // -1 if the size was not fetched.
+    if (file_size != -1) {
+        m_file_sizes[i] = file_size;
+    }
+}
+
+void FileEntryList::SetInternalName(u32 i, const std::string& name, const std::string& extension) {
+    for (auto& internal : m_internal_names) {
+        if (internal.index == i) {
+            internal.name = name;
+            internal.extension = extension;
+            return;
+        }
+    }
+
+    m_internal_names.push_back({i, name, extension});
+}
+
+// stats entries on a background thread, as some mounts (network, usb) can
+// take longer than a frame to respond.
+struct StatWorker {
+    struct Request {
+        u32 index; // index into m_entries.
+        fs::FsPath path;
+        bool is_dir;
+    };
+
+    struct Reply {
+        u32 index;
+        s64 file_count{-1};
+        s64 dir_count{-1};
+        s64 file_size{-1}; // -1 if unchanged.
+        FsTimeStampRaw time_stamp{};
+    };
+
+    StatWorker() {
+        mutexInit(&m_mutex);
+        condvarInit(&m_can_work);
+    }
+
+    ~StatWorker() {
+        mutexLock(&m_mutex);
+        m_quit = true;
+        condvarWakeAll(&m_can_work);
+        mutexUnlock(&m_mutex);
+
+        if (m_created) {
+            threadWaitForExit(&m_thread);
+            threadClose(&m_thread);
+        }
+    }
+
+    // replaces the queue, requests are handled in the order given.
+    void Push(const std::shared_ptr<fs::Fs>& fs, std::vector<Request>&& requests) {
+        if (!CreateThread()) {
+            return;
+        }
+
+        SCOPED_MUTEX(&m_mutex);
+        m_fs = fs;
+        m_requests.clear();
+
+        // skip requests that are in flight or waiting to be collected.
+        for (auto& request : requests) {
+            if (request.index == m_in_flight) {
+                continue;
+            }
+
+            const auto it = std::ranges::find_if(m_replies, [&request](auto& e) {
+                return e.index == request.index;
+            });
+
+            if (it == m_replies.end()) {
+                m_requests.emplace_back(std::move(request));
+            }
+        }
+
+        if (!m_requests.empty()) {
+            condvarWakeOne(&m_can_work);
+        }
+    }
+
+    // drops all pending requests and results, the in flight result is discarded.
+    void Cancel() {
+        SCOPED_MUTEX(&m_mutex);
+        m_requests.clear();
+        m_replies.clear();
+        m_in_flight = -1;
+        m_generation++;
+    }
+
+    // moves finished results into out, never blocks for a stat.
+    void Pop(std::vector<Reply>& out) {
+        SCOPED_MUTEX(&m_mutex);
+        std::swap(out, m_replies);
+        m_replies.clear();
+    }
+
+private:
+    auto CreateThread() -> bool {
+        if (!m_created && !m_failed) {
+            if (R_FAILED(utils::CreateThread(&m_thread, ThreadFunc, this, 1024*32))) {
+                log_write("[STAT] failed to create thread\n");
+                m_failed = true;
+            } else if (R_FAILED(threadStart(&m_thread))) {
+                log_write("[STAT] failed to start thread\n");
+                threadClose(&m_thread);
+                m_failed = true;
+            } else {
+                m_created = true;
+            }
+        }
+
+        return m_created;
+    }
+
+    static void ThreadFunc(void* arg) {
+        auto self = static_cast<StatWorker*>(arg);
+
+        for (;;) {
+            mutexLock(&self->m_mutex);
+            while (!self->m_quit && self->m_requests.empty()) {
+                condvarWait(&self->m_can_work, &self->m_mutex);
+            }
+
+            if (self->m_quit) {
+                mutexUnlock(&self->m_mutex);
+                break;
+            }
+
+            const auto request = self->m_requests.front();
+            self->m_requests.pop_front();
+            const auto fs = self->m_fs;
+            const auto generation = self->m_generation;
+            self->m_in_flight = request.index;
+            mutexUnlock(&self->m_mutex);
+
+            Reply reply{request.index};
+            if (request.is_dir) {
+                fs->DirGetEntryCount(request.path, &reply.file_count, &reply.dir_count);
+            } else if (fs->IsNative()) {
+                fs->GetFileTimeStampRaw(request.path, &reply.time_stamp);
+            } else {
+                fs->FileGetSizeAndTimestamp(request.path, &reply.time_stamp, &reply.file_size);
+            }
+
+            SCOPED_MUTEX(&self->m_mutex);
+            if (generation == self->m_generation) {
+                self->m_replies.emplace_back(reply);
+                self->m_in_flight = -1;
+            }
+        }
+    }
+
+private:
+    Mutex m_mutex{};
+    CondVar m_can_work{};
+    Thread m_thread{};
+    std::shared_ptr<fs::Fs> m_fs{};
+    std::deque<Request> m_requests{};
+    std::vector<Reply> m_replies{};
+    s64 m_in_flight{-1};
+    u32 m_generation{};
+    bool m_created{};
+    bool m_failed{};
+    bool m_quit{};
+};
+
 // case insensitive check
 auto IsSamePath(std::string_view a, std::string_view b) -> bool {
     return a.length() == b.length() && !strncasecmp(a.data(), b.data(), a.length());
@@ -434,9 +884,9 @@ FsView::FsView(Base* menu, const std::shared_ptr<fs::Fs>& fs, const fs::FsPath&
                 const auto set = m_selected_count != m_entries_current.size();
 
                 for (u32 i = 0; i < m_entries_current.size(); i++) {
-                    auto& e = GetEntry(i);
-                    if (e.selected != set) {
-                        e.selected = set;
+                    const auto index = GetEntryIndex(i);
+                    if (m_entries.IsSelected(index) != set) {
+                        m_entries.SetSelected(index, set);
                         if (set) {
                             m_selected_count++;
                         } else {
@@ -445,8 +895,9 @@ FsView::FsView(Base* menu, const std::shared_ptr<fs::Fs>& fs, const fs::FsPath&
                     }
                 }
             } else {
-                GetEntry().selected ^= 1;
-                if (GetEntry().selected) {
+                const auto index = GetEntryIndex();
+                m_entries.SetSelected(index, !m_entries.IsSelected(index));
+                if (m_entries.IsSelected(index)) {
                     m_selected_count++;
                 } else {
                     m_selected_count--;
@@ -524,7 +975,7 @@ FsView::~FsView() {
     // don't store mount points for non-sd card paths.
     if (IsSd() && !m_entries_current.empty()) {
         ini_puts("paths", "last_path", m_path, App::CONFIG_PATH);
-        ini_puts("paths", "last_file", GetEntry().name, App::CONFIG_PATH);
+        ini_puts("paths", "last_file", GetEntryName(), App::CONFIG_PATH);
     }
 }
 
@@ -545,9 +996,9 @@ void FsView::Update(Controller* controller, TouchInfo* touch) {
                 while (old_index != new_index) {
                     old_index += inc;
 
-                    auto& e = GetEntry(old_index);
-                    e.selected ^= 1;
-                    if (e.selected) {
+                    const auto index = GetEntryIndex(old_index);
+                    m_entries.SetSelected(index, !m_entries.IsSelected(index));
+                    if (m_entries.IsSelected(index)) {
                         m_selected_count++;
                     } else {
                         m_selected_count--;
@@ -560,6 +1011,7 @@ void FsView::Update(Controller* controller, TouchInfo* touch) {
 
 void FsView::Draw(NVGcontext* vg, Theme* theme) {
     const auto& text_col = theme->GetColour(ThemeEntryID_TEXT);
+    UpdateStat();
 
     if (m_entries_current.empty()) {
         gfx::drawTextArgs(vg, GetX() + GetW() / 2.f, GetY() + GetH() / 2.f, 36.f, NVG_ALIGN_CENTER | NVG_ALIGN_MIDDLE, theme->GetColour(ThemeEntryID_TEXT_INFO), "Empty..."_i18n.c_str());
@@ -567,11 +1019,18 @@ void FsView::Draw(NVGcontext* vg, Theme* theme) {
     }
 
     constexpr float text_xoffset{15.f};
-    bool got_dir_count = false;
+    s64 stat_first = -1;
+    s64 stat_last = -1;
 
-    m_list->Draw(vg, theme, m_entries_current.size(), [this, text_col, &got_dir_count](auto* vg, auto* theme, auto& v, auto i) {
+    m_list->Draw(vg, theme, m_entries_current.size(), [this, text_col, &stat_first, &stat_last](auto* vg, auto* theme, auto& v, auto i) {
         const auto& [x, y, w, h] = v;
-        auto& e = GetEntry(i);
+        const auto index = GetEntryIndex(i);
+        const auto& e = m_entries;
+
+        if (stat_first < 0) {
+            stat_first = i;
+        }
+        stat_last = i;
 
         auto text_id = ThemeEntryID_TEXT;
         const auto selected = m_index == i;
@@ -584,11 +1043,11 @@ void FsView::Draw(NVGcontext* vg, Theme* theme) {
             }
         }
 
-        if (e.IsDir()) {
+        if (e.IsDir(index)) {
             DrawElement(x + text_xoffset, y + 5, 50, 50, ThemeEntryID_ICON_FOLDER);
         } else {
             auto icon = ThemeEntryID_ICON_FILE;
-            const auto ext = e.GetExtension();
+            const auto ext = e.GetExtension(index);
             if (IsExtension(ext, AUDIO_EXTENSIONS)) {
                 icon = ThemeEntryID_ICON_AUDIO;
             } else if (IsExtension(ext, VIDEO_EXTENSIONS)) {
@@ -607,46 +1066,111 @@ void FsView::Draw(NVGcontext* vg, Theme* theme) {
             DrawElement(x + text_xoffset, y + 5, 50, 50, icon);
         }
 
-        if (e.IsSelected()) {
+        if (e.IsSelected(index)) {
             gfx::drawText(vg, x + text_xoffset + 50 / 2, y + (h / 2.f) - (24.f / 2), 24.f, "\uE14B", nullptr, NVG_ALIGN_CENTER | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT_SELECTED));
         }
 
-        m_scroll_name.Draw(vg, selected, x + text_xoffset+65, y + (h / 2.f), w-(75+text_xoffset+65+50), 20, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE, theme->GetColour(text_id), e.name);
-
-        if (e.IsDir() && !m_fs_entry.IsNoStatDir() && (e.dir_count != -1 || !e.done_stat)) {
-            // NOTE: this takes longer than 16ms when opening a new folder due to it
-            // checking all 9 folders at once.
-            if (!got_dir_count && !e.done_stat && e.file_count == -1 && e.dir_count == -1) {
-                got_dir_count = true;
-                e.done_stat = true;
-                m_fs->DirGetEntryCount(GetNewPath(e), &e.file_count, &e.dir_count);
-            }
+        m_scroll_name.Draw(vg, selected, x + text_xoffset+65, y + (h / 2.f), w-(75+text_xoffset+65+50), 20, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE, theme->GetColour(text_id), e.GetName(index));
 
-            if (e.file_count != -1) {
-                gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) - 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_BOTTOM, theme->GetColour(ThemeEntryID_TEXT_INFO), "%zd files"_i18n.c_str(), e.file_count);
-            }
-            if (e.dir_count != -1) {
-                gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) + 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT_INFO), "%zd dirs"_i18n.c_str(), e.dir_count);
+        if (e.IsDir(index) && !m_fs_entry.IsNoStatDir() && (e.GetDirCount(index) != -1 || !e.HasFlag(index, FileEntryList::Flag_DoneStat))) {
+            if (e.GetFileCount(index) != -1) {
+                gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) - 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_BOTTOM, theme->GetColour(ThemeEntryID_TEXT_INFO), "%zd files"_i18n.c_str(), e.GetFileCount(index));
             }
-        } else if (e.IsFile() && !m_fs_entry.IsNoStatFile() && (e.file_size != -1 || !e.time_stamp.is_valid)) {
-            if (!e.time_stamp.is_valid && !e.done_stat) {
-                e.done_stat = true;
-                const auto path = GetNewPath(e);
-                if (m_fs->IsNative()) {
-                    m_fs->GetFileTimeStampRaw(path, &e.time_stamp);
-                } else {
-                    m_fs->FileGetSizeAndTimestamp(path, &e.time_stamp, &e.file_size);
-                }
+            if (e.GetDirCount(index) != -1) {
+                gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) + 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT_INFO), "%zd dirs"_i18n.c_str(), e.GetDirCount(index));
             }
-
-            const auto t = (time_t)(e.time_stamp.modified);
+        } else if (e.IsFile(index) && !m_fs_entry.IsNoStatFile() && (e.GetFileSize(index) != -1 || !e.IsTimeStampValid(index))) {
+            const auto t = (time_t)(e.GetTimeStamp(index));
             struct tm tm{};
             localtime_r(&t, &tm);
 
             gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) + 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT_INFO), "%02u/%02u/%u", tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900);
-            gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) - 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_BOTTOM, theme->GetColour(ThemeEntryID_TEXT_INFO), "%s", utils::formatSizeStorage(e.file_size).c_str());
+            gfx::drawTextArgs(vg, x + w - text_xoffset, y + (h / 2.f) - 3, 16.f, NVG_ALIGN_RIGHT | NVG_ALIGN_BOTTOM, theme->GetColour(ThemeEntryID_TEXT_INFO), "%s", utils::formatSizeStorage(e.GetFileSize(index)).c_str());
         }
     });
+
+    if (stat_first >= 0 && (stat_first != m_stat_first || stat_last != m_stat_last)) {
+        QueueStat(stat_first, stat_last);
+    }
+}
+
+void FsView::QueueStat(s64 first, s64 last) {
+    m_stat_first = first;
+    m_stat_last = last;
+
+    std::vector<StatWorker::Request> requests;
+    const auto add = [this, &requests](s64 i) {
+        if (i < 0 || i >= m_entries_current.size()) {
+            return;
+        }
+
+        const auto index = GetEntryIndex(i);
+        if (m_entries.HasFlag(index, FileEntryList::Flag_DoneStat)) {
+            return;
+        }
+
+        if (m_entries.IsDir(index)) {
+            if (m_fs_entry.IsNoStatDir() || m_entries.GetFileCount(index) != -1 || m_entries.GetDirCount(index) != -1) {
+                return;
+            }
+        } else if (m_fs_entry.IsNoStatFile() || m_entries.IsTimeStampValid(index)) {
+            return;
+        }
+
+        requests.push_back({index, GetNewPath(i), m_entries.IsDir(index)});
+    };
+
+    // visible entries first, then the next page followed by the previous page.
+    const auto page = last - first + 1;
+    for (auto i = first; i <= last; i++) {
+        add(i);
+    }
+    for (auto i = last + 1; i <= last + page; i++) {
+        add(i);
+    }
+    for (auto i = first - 1; i >= first - page; i--) {
+        add(i);
+    }
+
+    if (requests.empty()) {
+        return;
+    }
+
+    if (!m_stat_worker) {
+        m_stat_worker = std::make_unique<StatWorker>();
+    }
+
+    m_stat_worker->Push(m_fs, std::move(requests));
+}
+
+void FsView::UpdateStat() {
+    if (!m_stat_worker) {
+        return;
+    }
+
+    std::vector<StatWorker::Reply> replies;
+    m_stat_worker->Pop(replies);
+
+    for (const auto& reply : replies) {
+        if (reply.index >= m_entries.size()) {
+            continue;
+        }
+
+        if (m_entries.IsDir(reply.index)) {
+            m_entries.SetDirStat(reply.index, reply.file_count, reply.dir_count);
+        } else {
+            m_entries.SetFileStat(reply.index, reply.time_stamp, reply.file_size);
+        }
+    }
+}
+
+void FsView::CancelStat() {
+    if (m_stat_worker) {
+        m_stat_worker->Cancel();
+    }
+
+    m_stat_first = -1;
+    m_stat_last = -1;
 }
 
 void FsView::OnFocusGained() {
@@ -714,7 +1238,7 @@ void FsView::OnClick() {
         return;
     }
 
-    const auto& entry = GetEntry();
+    const auto entry = GetEntry();
 
     if (entry.type == FsDirEntryType_Dir) {
         Scan(GetNewPathCurrent());
@@ -783,7 +1307,7 @@ void FsView::OnClick() {
                     items.emplace_back(p.name);
                 }
 
-                const auto title = "Launch option for: "_i18n + GetEntry().name;
+                const auto title = "Launch option for: "_i18n + GetEntryName();
                 App::Push<PopupList>(
                     title, items, [this, assoc_list](auto op_index){
                         if (op_index) {
@@ -808,15 +1332,14 @@ void FsView::SetIndex(s64 index) {
         m_list->SetYoff();
     }
 
-    if (IsSd() && !m_entries_current.empty() && !GetEntry().checked_internal_extension && IsSamePath(GetEntry().GetExtension(), "zip")) {
-        GetEntry().checked_internal_extension = true;
+    if (IsSd() && !m_entries_current.empty() && !m_entries.HasFlag(GetEntryIndex(), FileEntryList::Flag_CheckedInternalExtension) && IsSamePath(GetEntryExtension(), "zip")) {
+        m_entries.SetFlag(GetEntryIndex(), FileEntryList::Flag_CheckedInternalExtension, true);
 
         TimeStamp ts;
         fs::FsPath filename_inzip{};
         if (R_SUCCEEDED(mz::PeekFirstFileName(GetFs(), GetNewPathCurrent(), filename_inzip))) {
             if (auto ext = std::strrchr(filename_inzip, '.')) {
-                GetEntry().internal_name = filename_inzip.toString();
-                GetEntry().internal_extension = ext+1;
+                m_entries.SetInternalName(GetEntryIndex(), filename_inzip.toString(), ext+1);
             }
             log_write("\tzip, time taken: %.2fs %zums\n", ts.GetSecondsD(), ts.GetMs());
         }
@@ -826,7 +1349,7 @@ void FsView::SetIndex(s64 index) {
 }
 
 void FsView::InstallForwarder() {
-    if (IsSamePath(GetEntry().GetExtension(), "nro")) {
+    if (IsSamePath(GetEntryExtension(), "nro")) {
         if (R_FAILED(homebrew::Menu::InstallHomebrewFromPath(GetNewPathCurrent()))) {
             log_write("failed to create forwarder\n");
         }
@@ -835,7 +1358,7 @@ void FsView::InstallForwarder() {
 
     const auto assoc_list = m_menu->FindFileAssocFor();
     if (assoc_list.empty()) {
-        log_write("failed to find assoc for: %s ext: %s\n", GetEntry().name, GetEntry().GetExtension().c_str());
+        log_write("failed to find assoc for: %s ext: %s\n", GetEntryName(), GetEntry().GetExtension().c_str());
         return;
     }
 
@@ -844,7 +1367,7 @@ void FsView::InstallForwarder() {
         items.emplace_back(p.name);
     }
 
-    const auto title = std::string{"Select launcher for: "_i18n} + GetEntry().name;
+    const auto title = std::string{"Select launcher for: "_i18n} + GetEntryName();
     App::Push<PopupList>(
         title, items, [this, assoc_list](auto op_index){
             if (op_index) {
@@ -1037,11 +1560,12 @@ auto FsView::Scan(fs::FsPath new_path, bool is_walk_up) -> Result {
 
     log_write("new scan path: %s\n", new_path.s);
     if (!is_walk_up && !m_path.empty() && !m_entries_current.empty()) {
-        const LastFile f(GetEntry().name, m_index, m_list->GetYoff(), m_entries_current.size());
+        const LastFile f(GetEntryName(), m_index, m_list->GetYoff(), m_entries_current.size());
         m_previous_highlighted_file.emplace_back(f);
     }
 
     g_change_signalled = false;
+    CancelStat();
     m_path = new_path;
     m_entries.clear();
     m_entries_index.clear();
@@ -1060,8 +1584,18 @@ auto FsView::Scan(fs::FsPath new_path, bool is_walk_up) -> Result {
     std::vector<FsDirectoryEntry> dir_entries;
     R_TRY(d.ReadAll(dir_entries));
 
+    // ui io, charged so that a paste running in the background backs off.
+    if (IsSd()) {
+        utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Foreground, dir_entries.size() * sizeof(FsDirectoryEntry));
+    }
+
     const auto count = dir_entries.size();
-    m_entries.reserve(count);
+    size_t name_size = 0;
+    for (const auto& e : dir_entries) {
+        name_size += std::strlen(e.name) + 1;
+    }
+
+    m_entries.reserve(count, name_size);
     m_entries_index.reserve(count);
     m_entries_index_hidden.reserve(count);
 
@@ -1089,7 +1623,7 @@ auto FsView::Scan(fs::FsPath new_path, bool is_walk_up) -> Result {
         }
 
         m_entries_index_hidden.emplace_back(i);
-        m_entries.emplace_back(e);
+        m_entries.push_back(e);
         i++;
     }
 
@@ -1119,40 +1653,40 @@ void FsView::Sort() {
     const auto hidden_last = m_menu->m_hidden_last.Get();
 
     const auto sorter = [this, sort, order, folders_first, hidden_last](u32 _lhs, u32 _rhs) -> bool {
-        const auto& lhs = m_entries[_lhs];
-        const auto& rhs = m_entries[_rhs];
+        const auto& e = m_entries;
 
         if (hidden_last) {
-            if (lhs.IsHidden() && !rhs.IsHidden()) {
+            if (e.IsHidden(_lhs) && !e.IsHidden(_rhs)) {
                 return false;
-            } else if (!lhs.IsHidden() && rhs.IsHidden()) {
+            } else if (!e.IsHidden(_lhs) && e.IsHidden(_rhs)) {
                 return true;
             }
         }
 
         if (folders_first) {
-            if (lhs.type == FsDirEntryType_Dir && !(rhs.type == FsDirEntryType_Dir)) { // left is folder
+            if (e.IsDir(_lhs) && !e.IsDir(_rhs)) { // left is folder
                 return true;
-            } else if (!(lhs.type == FsDirEntryType_Dir) && rhs.type == FsDirEntryType_Dir) { // right is folder
+            } else if (!e.IsDir(_lhs) && e.IsDir(_rhs)) { // right is folder
                 return false;
             }
         }
 
+        // keys are case folded, so this matches strncasecmp().
         switch (sort) {
             case SortType_Size: {
-                if (lhs.file_size == rhs.file_size) {
-                    return strncasecmp(lhs.name, rhs.name, sizeof(lhs.name)) < 0;
+                if (e.GetFileSize(_lhs) == e.GetFileSize(_rhs)) {
+                    return e.GetSortKey(_lhs) < e.GetSortKey(_rhs);
                 } else if (order == OrderType_Descending) {
-                    return lhs.file_size > rhs.file_size;
+                    return e.GetFileSize(_lhs) > e.GetFileSize(_rhs);
                 } else {
-                    return lhs.file_size < rhs.file_size;
+                    return e.GetFileSize(_lhs) < e.GetFileSize(_rhs);
                 }
             } break;
             case SortType_Alphabetical: {
                 if (order == OrderType_Descending) {
-                    return strncasecmp(lhs.name, rhs.name, sizeof(lhs.name)) < 0;
+                    return e.GetSortKey(_lhs) < e.GetSortKey(_rhs);
                 } else {
-                    return strncasecmp(lhs.name, rhs.name, sizeof(lhs.name)) > 0;
+                    return e.GetSortKey(_lhs) > e.GetSortKey(_rhs);
                 }
             } break;
         }
@@ -1167,12 +1701,16 @@ void FsView::Sort() {
     }
 
     std::sort(m_entries_current.begin(), m_entries_current.end(), sorter);
+
+    // the visible entries have changed, so queue them again.
+    m_stat_first = -1;
+    m_stat_last = -1;
 }
 
 void FsView::SortAndFindLastFile(bool scan) {
     std::optional<LastFile> last_file;
     if (!m_path.empty() && !m_entries_current.empty()) {
-        last_file = LastFile(GetEntry().name, m_index, m_list->GetYoff(), m_entries_current.size());
+        last_file = LastFile(GetEntryName(), m_index, m_list->GetYoff(), m_entries_current.size());
     }
 
     if (scan) {
@@ -1191,7 +1729,7 @@ void FsView::SetIndexFromLastFile(const LastFile& last_file) {
 
     s64 index = -1;
     for (u64 i = 0; i < m_entries_current.size(); i++) {
-        if (last_file.name == GetEntry(i).name) {
+        if (last_file.name == m_entries.GetName(GetEntryIndex(i))) {
             index = i;
             break;
         }
@@ -1334,10 +1872,23 @@ void FsView::OnPasteCallback() {
                     const auto full_path = GetNewPath(selected.m_path, p.name);
                     if (p.IsDir()) {
                         pbox->NewTransfer("Scanning "_i18n + full_path);
-                        R_TRY(get_collections(src_fs, full_path, p.name, collections));
+                        R_TRY(get_collections(src_fs, full_path, p.name, collections, true));
                     }
                 }
 
+                // small files are batched and copied in parallel, large files are copied after.
+                std::vector<PasteJob> small_jobs;
+                std::vector<PasteJob> large_jobs;
+                const auto add_job = [&](const fs::FsPath& src_path, const fs::FsPath& dst_path, s64 size) {
+                    if (size >= 0 && size <= PASTE_SMALL_FILE_MAX) {
+                        small_jobs.push_back({src_path, dst_path, size});
+                    } else {
+                        large_jobs.push_back({src_path, dst_path, std::max<s64>(size, 0)});
+                    }
+                };
+
+                // create all folders upfront, parents before children, so that files
+                // can then be copied in any order.
                 for (const auto& p : selected.m_files) {
                     pbox->Yield();
                     R_TRY(pbox->ShouldExitResult());
@@ -1350,14 +1901,10 @@ void FsView::OnPasteCallback() {
                         pbox->NewTransfer("Creating "_i18n + dst_path);
                         m_fs->CreateDirectory(dst_path);
                     } else {
-                        pbox->SetTitle(p.name);
-                        pbox->NewTransfer("Copying "_i18n + src_path);
-                        R_TRY(pbox->CopyFile(src_fs, m_fs.get(), src_path, dst_path, is_same_fs));
-                        R_TRY(on_paste_file(src_path, dst_path));
+                        add_job(src_path, dst_path, p.file_size);
                     }
                 }
 
-                // copy everything in collections
                 for (const auto& c : collections) {
                     const auto base_dst_path = GetNewPath(m_path, c.parent_name);
 
@@ -1365,7 +1912,6 @@ void FsView::OnPasteCallback() {
                         pbox->Yield();
                         R_TRY(pbox->ShouldExitResult());
 
-                        // const auto src_path = GetNewPath(c.path, p.name);
                         const auto dst_path = GetNewPath(base_dst_path, p.name);
 
                         pbox->SetTitle(p.name);
@@ -1374,17 +1920,29 @@ void FsView::OnPasteCallback() {
                     }
 
                     for (const auto& p : c.files) {
-                        pbox->Yield();
-                        R_TRY(pbox->ShouldExitResult());
+                        add_job(GetNewPath(c.path, p.name), GetNewPath(base_dst_path, p.name), p.file_size);
+                    }
+                }
 
-                        const auto src_path = GetNewPath(c.path, p.name);
-                        const auto dst_path = GetNewPath(base_dst_path, p.name);
+                // a single file gains nothing from the scheduler, copy it below.
+                if (small_jobs.size() == 1) {
+                    large_jobs.insert(large_jobs.begin(), small_jobs.front());
+                    small_jobs.clear();
+                }
 
-                        pbox->SetTitle(p.name);
-                        pbox->NewTransfer("Copying "_i18n + src_path);
-                        R_TRY(pbox->CopyFile(src_fs, m_fs.get(), src_path, dst_path, is_same_fs));
-                        R_TRY(on_paste_file(src_path, dst_path));
-                    }
+                if (!small_jobs.empty()) {
+                    pbox->NewTransfer("Copying "_i18n + selected.m_path.toString());
+                    R_TRY(PasteFiles(pbox, src_fs, m_fs.get(), small_jobs, on_paste_file));
+                }
+
+                for (const auto& job : large_jobs) {
+                    pbox->Yield();
+                    R_TRY(pbox->ShouldExitResult());
+
+                    pbox->SetTitle(std::strrchr(job.src_path.s, '/') + 1);
+                    pbox->NewTransfer("Copying "_i18n + job.src_path);
+                    R_TRY(pbox->CopyFile(src_fs, m_fs.get(), job.src_path, job.dst_path, is_same_fs));
+                    R_TRY(on_paste_file(job.src_path, job.dst_path));
                 }
 
                 // moving accross fs is not possible, thus files have to be copied.
@@ -1441,12 +1999,10 @@ auto FsView::CheckIfUpdateFolder() -> Result {
     R_UNLESS(m_entries.size() > 150 && m_entries.size() < 300, Result_FileBrowserDirNotDaybreak);
 
     // check that all entries end in .nca
-    for (auto& e : m_entries) {
+    for (u32 i = 0; i < m_entries.size(); i++) {
         // check that we are at the bottom level
-        R_UNLESS(e.type == FsDirEntryType_File, Result_FileBrowserDirNotDaybreak);
-
-        const auto ext = std::strrchr(e.name, '.');
-        R_UNLESS(ext && IsSamePath(ext, ".nca"), Result_FileBrowserDirNotDaybreak);
+        R_UNLESS(m_entries.IsFile(i), Result_FileBrowserDirNotDaybreak);
+        R_UNLESS(IsSamePath(m_entries.GetExtension(i), "nca"), Result_FileBrowserDirNotDaybreak);
     }
 
     R_SUCCEED();
@@ -1566,6 +2122,7 @@ void FsView::SetFs(const std::shared_ptr<fs::Fs>& fs, const fs::FsPath& new_path
     }
 
     // m_fs.reset();
+    CancelStat();
     m_path = new_path;
     m_entries.clear();
     m_entries_index.clear();
@@ -1592,7 +2149,7 @@ void FsView::DisplayHash(hash::Type type) {
     static std::string hash_out;
     hash_out.clear();
 
-    App::Push<ProgressBox>(0, "Hashing"_i18n, GetEntry().name, [this, type](auto pbox) -> Result {
+    App::Push<ProgressBox>(0, "Hashing"_i18n, GetEntryName(), [this, type](auto pbox) -> Result {
         const auto full_path = GetNewPathCurrent();
         pbox->NewTransfer(full_path);
         R_TRY(hash::Hash(pbox, type, m_fs.get(), full_path, hash_out));
@@ -1709,7 +2266,7 @@ void FsView::DisplayOptions() {
     if (m_entries_current.size() && !m_selected_count && !m_fs_entry.IsReadOnly()) {
         options->Add<SidebarEntryCallback>("Rename"_i18n, [this](){
             std::string out;
-            const auto& entry = GetEntry();
+            const auto entry = GetEntry();
             const auto name = entry.GetName();
             const auto header = "Set new name"_i18n;
             if (R_SUCCEEDED(swkbd::ShowText(out, header.c_str(), header.c_str(), name.c_str())) && !out.empty() && out != name) {
@@ -1775,7 +2332,7 @@ void FsView::DisplayOptions() {
         }
 
         if (IsSd() && m_entries_current.size() && !m_selected_count) {
-            if (GetEntry().IsFile() && (IsSamePath(GetEntry().GetExtension(), "nro") || !m_menu->FindFileAssocFor().empty())) {
+            if (m_entries.IsFile(GetEntryIndex()) && (IsSamePath(GetEntryExtension(), "nro") || !m_menu->FindFileAssocFor().empty())) {
                 auto entry = options->Add<SidebarEntryCallback>("Install Forwarder"_i18n, [this](){;
                     InstallForwarder();
                 });
@@ -1887,20 +2444,20 @@ void FsView::DisplayAdvancedOptions() {
         });
     }
 
-    if (m_entries_current.size() && !m_selected_count && GetEntry().IsFile() && GetEntry().file_size < 1024*64) {
+    if (m_entries_current.size() && !m_selected_count && m_entries.IsFile(GetEntryIndex()) && m_entries.GetFileSize(GetEntryIndex()) < 1024*64) {
         options->Add<SidebarEntryCallback>("View as text (unfinished)"_i18n, [this](){
             App::Push<fileview::Menu>(GetFs(), GetNewPathCurrent());
         });
     }
 
-    if (m_entries_current.size() && !m_selected_count && IsExtension(GetEntry().GetExtension(), THEME_MUSIC_EXTENSIONS)) {
+    if (m_entries_current.size() && !m_selected_count && IsExtension(GetEntryExtension(), THEME_MUSIC_EXTENSIONS)) {
         options->Add<SidebarEntryCallback>("Set as background music"_i18n, [this](){
             const auto rc = App::SetDefaultBackgroundMusic(GetFs(), GetNewPathCurrent());
             App::PushErrorBox(rc, "Failed to set default music path"_i18n);
         });
     }
 
-    if (m_entries_current.size() && !m_selected_count && GetEntry().IsFile()) {
+    if (m_entries_current.size() && !m_selected_count && m_entries.IsFile(GetEntryIndex())) {
         options->Add<SidebarEntryCallback>("Hash"_i18n, [this](){
             auto options = std::make_unique<Sidebar>("Hash Options"_i18n, Sidebar::Side::RIGHT);
             ON_SCOPE_EXIT(App::Push(std::move(options)));
@@ -1939,7 +2496,7 @@ void FsView::MountFileFs(const MountFsFunc& mount_func, const UmountFsFunc& umou
             umount_func(mount);
         });
 
-        MountFsHelper(fs, GetEntry().GetName());
+        MountFsHelper(fs, GetEntryName());
     }
 }
 
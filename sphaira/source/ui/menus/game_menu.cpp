@@ -9,6 +9,7 @@
 
 #include "utils/utils.hpp"
 #include "utils/nsz_dumper.hpp"
+#include "utils/io_qos.hpp"
 
 #include "ui/menus/game_menu.hpp"
 #include "ui/menus/game_meta_menu.hpp"
@@ -40,7 +41,6 @@ std::atomic_bool g_change_signalled{};
 
 struct NspSource final : dump::BaseSource {
     NspSource(const std::vector<NspEntry>& entries) : m_entries{entries} {
-        m_is_file_based_emummc = App::IsFileBaseEmummc();
     }
 
     Result Read(const std::string& path, void* buf, s64 off, s64 size, u64* bytes_read) override {
@@ -49,11 +49,8 @@ struct NspSource final : dump::BaseSource {
         });
         R_UNLESS(it != m_entries.end(), Result_GameBadReadForDump);
 
-        const auto rc = it->Read(buf, off, size, bytes_read);
-        if (m_is_file_based_emummc) {
-            svcSleepThread(2e+6); // 2ms
-        }
-        return rc;
+        utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Bulk, size);
+        return it->Read(buf, off, size, bytes_read);
     }
 
     Result Read(const std::string& path, void* buf, s64 off, s64 size) {
@@ -109,7 +106,6 @@ struct NspSource final : dump::BaseSource {
 
 private:
     std::vector<NspEntry> m_entries{};
-    bool m_is_file_based_emummc{};
 };
 
 #ifdef ENABLE_NSZ
@@ -121,10 +117,14 @@ Result NszExport(ProgressBox* pbox, const keys::Keys& keys, dump::BaseSource* _s
 
     const auto nca_creator = [&entry](const nca::Header& header, const keys::KeyEntry& title_key, const utils::nsz::Collection& collection) {
         const auto content_id = ncm::GetContentIdFromStr(collection.name.c_str());
-        return std::make_unique<nca::NcaReader>(
+        auto reader = std::make_unique<nca::NcaReader>(
             header, &title_key, collection.size,
             std::make_shared<ncm::NcmSource>(&entry.cs, &content_id)
         );
+
+        // verify whilst dumping, saves having to hash the output afterwards.
+        reader->SetVerify(true);
+        return reader;
     };
 
     auto& collections = entry.collections;
@@ -513,11 +513,27 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
         return;
     }
 
-    // max images per frame, in order to not hit io / gpu too hard.
-    const int image_load_max = 2;
-    int image_load_count = 0;
+    // max images uploaded per frame, decoding is done by the image pool.
+    const int image_upload_max = 4;
+    u64 id;
+    ImageResult image;
+
+    for (int i = 0; i < image_upload_max && m_icons.Pop(&id, &image); i++) {
+        if (image.data.empty()) {
+            continue;
+        }
+
+        for (auto& e : m_entries) {
+            if (e.app_id == id && !e.image) {
+                e.image = nvgCreateImageRGBA(vg, image.w, image.h, 0, image.data.data());
+            }
+        }
+    }
+
+    // entries drawn this frame are loaded first.
+    m_icons.BeginFrame();
 
-    m_list->Draw(vg, theme, m_entries.size(), [this, &image_load_count](auto* vg, auto* theme, auto v, auto pos) {
+    m_list->Draw(vg, theme, m_entries.size(), [this](auto* vg, auto* theme, auto v, auto pos) {
         const auto& [x, y, w, h] = v;
         auto& e = m_entries[pos];
 
@@ -529,9 +545,11 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
         }
 
         // lazy load image
-        if (image_load_count < image_load_max) {
-            if (LoadControlImage(e, title::GetAsync(e.app_id))) {
-                image_load_count++;
+        if (!e.image && !m_icons.Touch(e.app_id)) {
+            if (auto result = title::GetAsync(e.app_id); result && !result->icon.empty()) {
+                m_icons.Push(e.app_id, [icon = result->icon]() {
+                    return icon;
+                });
             }
         }
 
@@ -668,6 +686,7 @@ void Menu::FreeEntries() {
     }
 
     m_entries.clear();
+    m_icons.Clear();
 }
 
 void Menu::OnLayoutChange() {
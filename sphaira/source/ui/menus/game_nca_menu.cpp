@@ -13,6 +13,7 @@
 
 #include "utils/utils.hpp"
 #include "utils/devoptab.hpp"
+#include "utils/io_qos.hpp"
 
 #include "title_info.hpp"
 #include "app.hpp"
@@ -53,7 +54,6 @@ private:
 
 struct NcaSource final : dump::BaseSource {
     NcaSource(NcmContentStorage* cs, int icon, const std::vector<NcaEntry>& entries) : m_cs{cs}, m_icon{icon}, m_entries{entries} {
-        m_is_file_based_emummc = App::IsFileBaseEmummc();
     }
 
     Result Read(const std::string& path, void* buf, s64 off, s64 size, u64* bytes_read) override {
@@ -62,15 +62,12 @@ struct NcaSource final : dump::BaseSource {
         });
         R_UNLESS(it != m_entries.end(), Result_GameBadReadForDump);
 
+        utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Bulk, size);
         const auto rc = ncmContentStorageReadContentIdFile(m_cs, buf, size, &it->content_id, off);
         if (R_SUCCEEDED(rc)) {
             *bytes_read = size;
         }
 
-        if (m_is_file_based_emummc) {
-            svcSleepThread(2e+6); // 2ms
-        }
-
         return rc;
     }
 
@@ -106,7 +103,6 @@ private:
     NcmContentStorage* const m_cs;
     const int m_icon;
     std::vector<NcaEntry> m_entries{};
-    bool m_is_file_based_emummc{};
 };
 
 Result GetFsFileSystemType(u8 content_type, FsFileSystemType& out) {
@@ -402,10 +402,14 @@ Result NszExport(ProgressBox* pbox, const keys::Keys& keys, dump::BaseSource* _s
         }
 
         const auto nca_creator = [&yati_source](const nca::Header& header, const keys::KeyEntry& title_key, const utils::nsz::Collection& collection) {
-            return std::make_unique<nca::NcaReader>(
+            auto reader = std::make_unique<nca::NcaReader>(
                 header, &title_key, collection.size,
                 std::make_shared<NcaReader>(&yati_source, collection.offset)
             );
+
+            // verify whilst dumping, saves having to hash the output afterwards.
+            reader->SetVerify(true);
+            return reader;
         };
 
         // todo: update write offset.
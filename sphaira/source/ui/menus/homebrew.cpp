@@ -22,6 +22,8 @@
 #include <minIni.h>
 #include <utility>
 #include <algorithm>
+#include <unordered_map>
+#include <cctype>
 
 namespace sphaira::ui::menu::homebrew {
 namespace {
@@ -41,6 +43,15 @@ void FreeEntry(NVGcontext* vg, NroEntry& e) {
     e.image = 0;
 }
 
+// paths are case insensitive, used as the key when matching the playlog.
+auto PathToKey(std::string_view path) -> std::string {
+    std::string key{path};
+    for (auto& c : key) {
+        c = std::tolower((unsigned char)c);
+    }
+    return key;
+}
+
 } // namespace
 
 void SignalChange() {
@@ -98,35 +109,42 @@ void Menu::Update(Controller* controller, TouchInfo* touch) {
 void Menu::Draw(NVGcontext* vg, Theme* theme) {
     MenuBase::Draw(vg, theme);
 
-    // max images per frame, in order to not hit io / gpu too hard.
-    const int image_load_max = 2;
-    int image_load_count = 0;
+    // max images uploaded per frame, decoding is done by the image pool.
+    const int image_upload_max = 4;
+    u64 id;
+    ImageResult image;
+
+    for (int i = 0; i < image_upload_max && m_icons.Pop(&id, &image); i++) {
+        if (id >= m_entries.size() || m_entries[id].image) {
+            continue;
+        }
+
+        auto& e = m_entries[id];
+        if (!image.data.empty()) {
+            e.image = nvgCreateImageRGBA(vg, image.w, image.h, 0, image.data.data());
+        } else {
+            // prevent loading of this icon again as it's already failed.
+            e.icon_offset = e.icon_size = 0;
+        }
+    }
+
+    // entries drawn this frame are loaded first.
+    m_icons.BeginFrame();
 
-    m_list->Draw(vg, theme, m_entries_current.size(), [this, &image_load_count](auto* vg, auto* theme, auto v, auto pos) {
+    m_list->Draw(vg, theme, m_entries_current.size(), [this](auto* vg, auto* theme, auto v, auto pos) {
         const auto index = m_entries_current[pos];
         auto& e = m_entries[index];
 
         // lazy load image
-        if (image_load_count < image_load_max) {
-            if (!e.image && e.icon_size && e.icon_offset) {
-                // NOTE: it seems that images can be any size. SuperTux uses a 1024x1024
-                // ~300Kb image, which takes a few frames to completely load.
-                // really, switch-tools should handle this by resizing the image before
-                // adding it to the nro, as well as validate its a valid jpeg.
-                const auto icon = nro_get_icon(e.path, e.icon_size, e.icon_offset);
-                TimeStamp ts;
-                if (!icon.empty()) {
-                    const auto image = ImageLoadFromMemory(icon, ImageFlag_JPEG);
-                    if (!image.data.empty()) {
-                        e.image = nvgCreateImageRGBA(vg, image.w, image.h, 0, image.data.data());
-                        log_write("\t[image load] time taken: %.2fs %zums\n", ts.GetSecondsD(), ts.GetMs());
-                        image_load_count++;
-                    } else {
-                        // prevent loading of this icon again as it's already failed.
-                        e.icon_offset = e.icon_size = 0;
-                    }
-                }
-            }
+        if (!e.image && e.icon_size && e.icon_offset && !m_icons.Touch(index)) {
+            // NOTE: it seems that images can be any size. SuperTux uses a 1024x1024
+            // ~300Kb image, which takes a few frames to completely load.
+            // really, switch-tools should handle this by resizing the image before
+            // adding it to the nro, as well as validate its a valid jpeg.
+            // the image pool resizes these before they're uploaded.
+            m_icons.Push(index, [path = e.path, size = e.icon_size, offset = e.icon_offset]() {
+                return nro_get_icon(path, size, offset);
+            });
         }
 
 
@@ -206,10 +224,15 @@ void Menu::ScanHomebrew() {
     }
 
     struct IniUser {
-        std::vector<NroEntry>& entires;
+        std::unordered_map<std::string, Hbini*> entries;
         Hbini* ini{};
         std::string last_section{};
-    } ini_user{ m_entries };
+    } ini_user{};
+
+    ini_user.entries.reserve(m_entries.size());
+    for (auto& e : m_entries) {
+        ini_user.entries.emplace(PathToKey(e.path), &e.hbini);
+    }
 
     ini_browse([](const mTCHAR *Section, const mTCHAR *Key, const mTCHAR *Value, void *UserData) -> int {
         auto user = static_cast<IniUser*>(UserData);
@@ -218,11 +241,8 @@ void Menu::ScanHomebrew() {
             user->last_section = Section;
             user->ini = nullptr;
 
-            for (auto& e : user->entires) {
-                if (e.path == Section) {
-                    user->ini = &e.hbini;
-                    break;
-                }
+            if (const auto it = user->entries.find(PathToKey(Section)); it != user->entries.end()) {
+                user->ini = it->second;
             }
         }
 
@@ -399,6 +419,7 @@ void Menu::FreeEntries() {
 
     m_entries.clear();
     m_entries_current = {};
+    m_icons.Clear();
     for (auto& e : m_entries_index) {
         e.clear();
     }
@@ -21,11 +21,10 @@ std::atomic<InstallState> INSTALL_STATE{InstallState::None};
 
 } // namespace
 
-Stream::Stream(const fs::FsPath& path, std::stop_token token) {
+Stream::Stream(const fs::FsPath& path, std::stop_token token) : m_ring{MAX_BUFFER_SIZE} {
     m_path = path;
     m_token = token;
     m_active = true;
-    m_buffer.reserve(MAX_BUFFER_SIZE);
 
     mutexInit(&m_mutex);
     condvarInit(&m_can_read);
@@ -42,19 +41,23 @@ Result Stream::ReadChunk(void* _buf, s64 size, u64* bytes_read) {
     );
 
     while (!m_token.stop_requested()) {
-        SCOPED_MUTEX(&m_mutex);
-        if (m_active && m_buffer.empty()) {
-            R_TRY(condvarWait(std::addressof(m_can_read), std::addressof(m_mutex)));
-        }
+        const auto span = m_ring.ReadSpan();
+        if (span.empty()) {
+            // the producer may commit its last chunk and disable the stream
+            // after the ring was read, so check the ring again once inactive.
+            if (!m_active && !m_ring.Size()) {
+                break;
+            }
 
-        if ((!m_active && m_buffer.empty()) || m_token.stop_requested()) {
-            break;
+            WaitForRead();
+            continue;
         }
 
-        const auto rsize = std::min<s64>(size, m_buffer.size());
-        std::memcpy(buf, m_buffer.data(), rsize);
-        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + rsize);
-        condvarWakeOne(&m_can_write);
+        // copy straight out of the ring, the space is released once copied.
+        const auto rsize = std::min<s64>(size, span.size());
+        std::memcpy(buf, span.data(), rsize);
+        m_ring.Consume(rsize);
+        Signal(&m_can_write, m_write_waiting);
 
         size -= rsize;
         buf += rsize;
@@ -69,6 +72,30 @@ Result Stream::ReadChunk(void* _buf, s64 size, u64* bytes_read) {
     R_THROW(Result_TransferCancelled);
 }
 
+Result Stream::Skip(s64 off, s64 size) {
+    // drop the data straight from the ring rather than copying it out.
+    while (size && !m_token.stop_requested()) {
+        const auto span = m_ring.ReadSpan();
+        if (span.empty()) {
+            // see ReadChunk().
+            if (!m_active && !m_ring.Size()) {
+                break;
+            }
+
+            WaitForRead();
+            continue;
+        }
+
+        const auto rsize = std::min<s64>(size, span.size());
+        m_ring.Consume(rsize);
+        Signal(&m_can_write, m_write_waiting);
+        size -= rsize;
+    }
+
+    R_UNLESS(!size, Result_TransferCancelled);
+    R_SUCCEED();
+}
+
 bool Stream::Push(const void* _buf, s64 size) {
     auto buf = static_cast<const u8*>(_buf);
     if (!size) {
@@ -86,22 +113,21 @@ bool Stream::Push(const void* _buf, s64 size) {
             return true;
         }
 
-        SCOPED_MUTEX(&m_mutex);
-        if (m_active && m_buffer.size() >= MAX_BUFFER_SIZE) {
-            R_TRY(condvarWait(std::addressof(m_can_write), std::addressof(m_mutex)));
-        }
-
         if (!m_active) {
             log_write("[Stream::Push] file not active\n");
             break;
         }
 
-        const auto wsize = std::min<s64>(size, MAX_BUFFER_SIZE - m_buffer.size());
-        const auto offset = m_buffer.size();
-        m_buffer.resize(offset + wsize);
+        const auto span = m_ring.WriteSpan();
+        if (span.empty()) {
+            WaitForWrite();
+            continue;
+        }
 
-        std::memcpy(m_buffer.data() + offset, buf, wsize);
-        condvarWakeOne(&m_can_read);
+        const auto wsize = std::min<s64>(size, span.size());
+        std::memcpy(span.data(), buf, wsize);
+        m_ring.Commit(wsize);
+        Signal(&m_can_read, m_read_waiting);
 
         size -= wsize;
         buf += wsize;
@@ -114,6 +140,35 @@ bool Stream::Push(const void* _buf, s64 size) {
     return false;
 }
 
+void Stream::WaitForRead() {
+    SCOPED_MUTEX(&m_mutex);
+
+    // the flag must be set before checking the ring, otherwise the producer
+    // may commit and skip the wake up between the check and the wait.
+    m_read_waiting = true;
+    if (m_active && !m_ring.Size() && !m_token.stop_requested()) {
+        condvarWait(&m_can_read, &m_mutex);
+    }
+    m_read_waiting = false;
+}
+
+void Stream::WaitForWrite() {
+    SCOPED_MUTEX(&m_mutex);
+
+    m_write_waiting = true;
+    if (m_active && !m_ring.Free() && !m_token.stop_requested()) {
+        condvarWait(&m_can_write, &m_mutex);
+    }
+    m_write_waiting = false;
+}
+
+void Stream::Signal(CondVar* var, const std::atomic_bool& waiting) {
+    if (waiting) {
+        SCOPED_MUTEX(&m_mutex);
+        condvarWakeOne(var);
+    }
+}
+
 void Stream::Disable() {
     log_write("[Stream::Disable] disabling file\n");
 
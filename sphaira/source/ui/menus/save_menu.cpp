@@ -427,11 +427,27 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
         return;
     }
 
-    // max images per frame, in order to not hit io / gpu too hard.
-    const int image_load_max = 2;
-    int image_load_count = 0;
+    // max images uploaded per frame, decoding is done by the image pool.
+    const int image_upload_max = 4;
+    u64 id;
+    ImageResult image;
+
+    for (int i = 0; i < image_upload_max && m_icons.Pop(&id, &image); i++) {
+        if (image.data.empty()) {
+            continue;
+        }
+
+        for (auto& e : m_entries) {
+            if (e.application_id == id && !e.image) {
+                e.image = nvgCreateImageRGBA(vg, image.w, image.h, 0, image.data.data());
+            }
+        }
+    }
+
+    // entries drawn this frame are loaded first.
+    m_icons.BeginFrame();
 
-    m_list->Draw(vg, theme, m_entries.size(), [this, &image_load_count](auto* vg, auto* theme, auto v, auto pos) {
+    m_list->Draw(vg, theme, m_entries.size(), [this](auto* vg, auto* theme, auto v, auto pos) {
         const auto& [x, y, w, h] = v;
         auto& e = m_entries[pos];
 
@@ -447,9 +463,11 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
         }
 
         // lazy load image
-        if (image_load_count < image_load_max) {
-            if (LoadControlImage(e, title::GetAsync(e.application_id))) {
-                image_load_count++;
+        if (!e.image && !m_icons.Touch(e.application_id)) {
+            if (auto result = title::GetAsync(e.application_id); result && !result->icon.empty()) {
+                m_icons.Push(e.application_id, [icon = result->icon]() {
+                    return icon;
+                });
             }
         }
 
@@ -608,6 +626,7 @@ void Menu::FreeEntries() {
     }
 
     m_entries.clear();
+    m_icons.Clear();
 }
 
 void Menu::OnLayoutChange() {
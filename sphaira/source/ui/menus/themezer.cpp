@@ -526,7 +526,8 @@ auto InstallTheme(ProgressBox* pbox, const PackListEntry& entry) -> Result {
         const auto result = curl::Api().ToFile(
             curl::Url{download_pack.url},
             curl::Path{zip_out},
-            curl::OnProgress{pbox->OnDownloadProgressCallback()}
+            curl::OnProgress{pbox->OnDownloadProgressCallback()},
+            curl::Flags{curl::Flag_Segmented}
         );
 
         R_UNLESS(result.success, Result_ThemezerFailedToDownloadTheme);
@@ -4,6 +4,8 @@
 #include "i18n.hpp"
 #include "image.hpp"
 
+#include <algorithm>
+
 namespace sphaira::ui::music {
 namespace {
 
@@ -30,7 +32,7 @@ inline auto TimeFormat(u64 sec) -> std::string {
 
 } // namespace
 
-Menu::Menu(fs::Fs* fs, const fs::FsPath& path) {
+Menu::Menu(fs::Fs* fs, const fs::FsPath& path) : m_fs{fs} {
     SetAction(Button::B, Action{[this](){
         SetPop();
     }});
@@ -67,37 +69,8 @@ Menu::Menu(fs::Fs* fs, const fs::FsPath& path) {
         return;
     }
 
-    audio::GetInfo(m_song, &m_info);
-    audio::GetMeta(m_song, &m_meta);
-
-    if (!m_meta.image.empty()) {
-        m_icon = nvgCreateImageMem(App::GetVg(), 0, m_meta.image.data(), m_meta.image.size());
-    }
-
-    if (m_icon > 0) {
-        if (m_meta.title.empty()) {
-            m_meta.title = path.toString();
-
-            // only keep file name.
-            if (auto i = m_meta.title.find_last_of('/'); i != std::string::npos) {
-                m_meta.title = m_meta.title.substr(i + 1);
-            }
-
-            // remove extension.
-            if (auto i = m_meta.title.find_last_of('.'); i != std::string::npos) {
-                m_meta.title = m_meta.title.substr(0, i);
-            }
-        }
-
-        if (m_meta.artist.empty()) {
-            m_meta.artist = "Artist: Unknown";
-        }
-
-        if (m_meta.album.empty()) {
-            m_meta.album = "Album: Unknown";
-        }
-    }
-
+    ScanPlaylist(path);
+    OnSongChanged();
     audio::PlaySong(m_song);
 }
 
@@ -145,6 +118,17 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
         return;
     }
 
+    // a queued song started playing.
+    if (song_progress.track != m_track) {
+        m_index += song_progress.track - m_track;
+        m_track = song_progress.track;
+        OnSongChanged();
+    }
+
+    if (song_state == audio::State::Finished && OpenNextSong()) {
+        return;
+    }
+
     if (song_state == audio::State::Finished || song_state == audio::State::Error) {
         log_write("got finished, doing pop now\n");
         SetPop();
@@ -225,6 +209,118 @@ void Menu::Draw(NVGcontext* vg, Theme* theme) {
     }
 }
 
+void Menu::ScanPlaylist(const fs::FsPath& path) {
+    m_playlist = {path};
+    m_index = 0;
+
+    const auto path_str = path.toString();
+    const auto pos = path_str.find_last_of('/');
+    if (pos == std::string::npos) {
+        return;
+    }
+
+    const fs::FsPath root = pos ? path_str.substr(0, pos) : "/";
+
+    fs::Dir d;
+    if (R_FAILED(m_fs->OpenDirectory(root, FsDirOpenMode_ReadFiles, &d))) {
+        return;
+    }
+
+    std::vector<FsDirectoryEntry> entries;
+    if (R_FAILED(d.ReadAll(entries))) {
+        return;
+    }
+
+    std::vector<fs::FsPath> playlist;
+    for (const auto& e : entries) {
+        // skip hidden files.
+        if ('.' == e.name[0] || !audio::IsSongSupported(e.name)) {
+            continue;
+        }
+
+        playlist.emplace_back(fs::AppendPath(root, e.name));
+    }
+
+    std::ranges::sort(playlist, [](const auto& a, const auto& b) {
+        return strcasecmp(a, b) < 0;
+    });
+
+    const auto it = std::ranges::find_if(playlist, [&path](const auto& e) {
+        return !strcasecmp(e, path);
+    });
+
+    if (it != playlist.end()) {
+        m_index = std::distance(playlist.begin(), it);
+        m_playlist = std::move(playlist);
+    }
+}
+
+void Menu::OnSongChanged() {
+    const auto& path = m_playlist[m_index];
+
+    if (m_icon) {
+        nvgDeleteImage(App::GetVg(), m_icon);
+        m_icon = 0;
+    }
+
+    m_info = {};
+    m_meta = {};
+    audio::GetInfo(m_song, &m_info);
+    audio::GetMeta(m_song, &m_meta);
+
+    if (!m_meta.image.empty()) {
+        m_icon = nvgCreateImageMem(App::GetVg(), 0, m_meta.image.data(), m_meta.image.size());
+    }
+
+    if (m_icon > 0) {
+        if (m_meta.title.empty()) {
+            m_meta.title = path.toString();
+
+            // only keep file name.
+            if (auto i = m_meta.title.find_last_of('/'); i != std::string::npos) {
+                m_meta.title = m_meta.title.substr(i + 1);
+            }
+
+            // remove extension.
+            if (auto i = m_meta.title.find_last_of('.'); i != std::string::npos) {
+                m_meta.title = m_meta.title.substr(0, i);
+            }
+        }
+
+        if (m_meta.artist.empty()) {
+            m_meta.artist = "Artist: Unknown";
+        }
+
+        if (m_meta.album.empty()) {
+            m_meta.album = "Album: Unknown";
+        }
+    }
+
+    // queue the next song so that it plays without a gap, this is called from
+    // Draw() so the song is loaded on the decode thread rather than here.
+    if (m_index + 1 < m_playlist.size()) {
+        if (auto rc = audio::QueueSong(m_song, m_fs, m_playlist[m_index + 1]); R_FAILED(rc)) {
+            log_write("[MUSIC] failed to queue next song: 0x%X\n", rc);
+        }
+    }
+}
+
+bool Menu::OpenNextSong() {
+    audio::CloseSong(&m_song);
+
+    // the next song may not have been queued if its format differs.
+    while (++m_index < m_playlist.size()) {
+        if (R_SUCCEEDED(audio::OpenSong(m_fs, m_playlist[m_index], 0, &m_song))) {
+            m_track = 0;
+            OnSongChanged();
+            audio::PlaySong(m_song);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void Menu::PauseToggle() {
     audio::State state{};
     audio::GetProgress(m_song, nullptr, &state);
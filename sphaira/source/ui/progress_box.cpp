@@ -9,6 +9,7 @@
 
 #include "utils/utils.hpp"
 #include "utils/thread.hpp"
+#include "utils/io_qos.hpp"
 
 #include <cstring>
 #include <cmath>
@@ -102,6 +103,7 @@ auto ProgressBox::Draw(NVGcontext* vg, Theme* theme) -> void {
     const auto action = m_action;
     const auto title = m_title;
     const auto transfer = m_transfer;
+    const auto transfer_info = m_transfer_info;
     const auto size = m_size;
     const auto offset = m_offset;
     const auto speed = m_speed;
@@ -168,7 +170,11 @@ auto ProgressBox::Draw(NVGcontext* vg, Theme* theme) -> void {
             std::snprintf(time_str, sizeof(time_str), "%zu seconds remaining"_i18n.c_str(), seconds);
         }
 
-        gfx::drawTextArgs(vg, center_x, prog_bar.y + prog_bar.h + 30, 18, NVG_ALIGN_CENTER | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "%s (%s)", time_str, utils::formatSizeNetwork(speed).c_str());
+        if (transfer_info.empty()) {
+            gfx::drawTextArgs(vg, center_x, prog_bar.y + prog_bar.h + 30, 18, NVG_ALIGN_CENTER | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "%s (%s)", time_str, utils::formatSizeNetwork(speed).c_str());
+        } else {
+            gfx::drawTextArgs(vg, center_x, prog_bar.y + prog_bar.h + 30, 18, NVG_ALIGN_CENTER | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), "%s (%s) [%s]", time_str, utils::formatSizeNetwork(speed).c_str(), transfer_info.c_str());
+        }
     }
 
     gfx::drawTextArgs(vg, center_x, m_pos.y + 40, 24, NVG_ALIGN_CENTER | NVG_ALIGN_TOP, theme->GetColour(ThemeEntryID_TEXT), action.c_str());
@@ -207,6 +213,7 @@ auto ProgressBox::SetTitle(const std::string& title)  -> ProgressBox& {
 auto ProgressBox::NewTransfer(const std::string& transfer)  -> ProgressBox& {
     SCOPED_MUTEX(&m_mutex);
     m_transfer = transfer;
+    m_transfer_info.clear();
     m_size = 0;
     m_offset = 0;
     m_last_offset = 0;
@@ -230,6 +237,12 @@ auto ProgressBox::UpdateTransfer(s64 offset, s64 size)  -> ProgressBox& {
     return *this;
 }
 
+auto ProgressBox::SetTransferInfo(const std::string& info) -> ProgressBox& {
+    SCOPED_MUTEX(&m_mutex);
+    m_transfer_info = info;
+    return *this;
+}
+
 auto ProgressBox::SetImage(int image) -> ProgressBox& {
     SCOPED_MUTEX(&m_mutex);
     m_image_pending = image;
@@ -293,7 +306,6 @@ void ProgressBox::RemoveCancelEvent(const UEvent* event) {
 }
 
 auto ProgressBox::CopyFile(fs::Fs* fs_src, fs::Fs* fs_dst, const fs::FsPath& src_path, const fs::FsPath& dst_path, bool single_threaded) -> Result {
-    const auto is_file_based_emummc = App::IsFileBaseEmummc();
     const auto is_both_native = fs_src->IsNative() && fs_dst->IsNative();
 
     fs::File src_file;
@@ -313,22 +325,18 @@ auto ProgressBox::CopyFile(fs::Fs* fs_src, fs::Fs* fs_dst, const fs::FsPath& src
 
     R_TRY(thread::Transfer(this, src_size,
         [&](void* data, s64 off, s64 size, u64* bytes_read) -> Result {
-            const auto rc = src_file.Read(off, data, size, 0, bytes_read);
-
-            if (is_both_native && is_file_based_emummc) {
-                svcSleepThread(2e+6); // 2ms
+            if (is_both_native) {
+                utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Read, utils::qos::Priority_Bulk, size);
             }
 
-            return rc;
+            return src_file.Read(off, data, size, 0, bytes_read);
         },
         [&](const void* data, s64 off, s64 size) -> Result {
-            const auto rc = dst_file.Write(off, data, size, 0);
-
-            if (is_both_native && is_file_based_emummc) {
-                svcSleepThread(2e+6); // 2ms
+            if (is_both_native) {
+                utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Write, utils::qos::Priority_Bulk, size);
             }
 
-            return rc;
+            return dst_file.Write(off, data, size, 0);
         }, single_threaded ? thread::Mode::SingleThreaded : thread::Mode::MultiThreaded
     ));
 
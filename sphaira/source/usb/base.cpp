@@ -22,13 +22,20 @@
 #include "app.hpp"
 #include <ranges>
 #include <cstring>
+#include <algorithm>
+#include <bit>
 
 namespace sphaira::usb {
 namespace {
 
-constexpr u64 TRANSFER_ALIGN = 0x1000;
 constexpr u64 TRANSFER_MAX = 1024*1024*16;
-static_assert(!(TRANSFER_MAX % TRANSFER_ALIGN));
+// unaligned transfers are split into chunks of this size.
+constexpr u64 BOUNCE_MAX = 1024*1024;
+// small transfers (headers) are always bounced, this avoids dma touching
+// cache lines that may be shared with other data on the stack.
+constexpr u64 DIRECT_MIN = utils::BUFFER_ALIGN;
+static_assert(!(TRANSFER_MAX % utils::BUFFER_ALIGN));
+static_assert(!(BOUNCE_MAX % utils::BUFFER_ALIGN));
 
 } // namespace
 
@@ -37,7 +44,6 @@ Base::Base(u64 transfer_timeout) {
 
     m_transfer_timeout = transfer_timeout;
     ueventCreate(GetCancelEvent(), false);
-    m_aligned = std::make_unique<u8*>(new(std::align_val_t{TRANSFER_ALIGN}) u8[TRANSFER_MAX]);
 }
 
 Base::~Base() {
@@ -61,32 +67,40 @@ Result Base::TransferPacketImpl(bool read, void *page, u32 remaining, u32 size,
     return GetTransferResult(ep, xfer_id, nullptr, out_size_transferred);
 }
 
-// while it may seem like a bad idea to transfer data to a buffer and copy it
-// in practice, this has no impact on performance.
-// the switch is *massively* bottlenecked by slow io (nand and sd).
-// so making usb transfers zero-copy provides no benefit other than increased
-// code complexity and the increase of future bugs if/when sphaira is forked
-// an changes are made.
-// yati already goes to great lengths to be zero-copy during installing
-// by swapping buffers and inflating in-place.
+// buffers from the pipeline (utils::PageBuffer) are page aligned, so usb
+// reads and writes go straight into / out of them.
+// only unaligned callers pay for a copy through the bounce buffer.
 Result Base::TransferAll(bool read, void *data, u32 size, u64 timeout) {
     auto buf = static_cast<u8*>(data);
-    auto transfer_buf = *m_aligned;
-
-    R_UNLESS(!((u64)transfer_buf & 0xFFF), Result_UsbBadBufferAlign);
-    R_UNLESS(size <= TRANSFER_MAX, Result_UsbBadTransferSize);
 
     while (size) {
-        if (!read) {
-            std::memcpy(transfer_buf, buf, size);
+        const auto direct = utils::IsBufferAligned(buf) && size >= DIRECT_MIN;
+
+        u8* transfer_buf;
+        u32 transfer_size;
+        if (direct) {
+            transfer_buf = buf;
+            transfer_size = std::min<u64>(size, TRANSFER_MAX);
+        } else {
+            transfer_size = std::min<u64>(size, BOUNCE_MAX);
+            if (m_bounce.size() < transfer_size) {
+                m_bounce.resize(std::min<u64>(std::bit_ceil<u64>(transfer_size), BOUNCE_MAX));
+            }
+
+            transfer_buf = m_bounce.data();
+            R_UNLESS(utils::IsBufferAligned(transfer_buf), Result_UsbBadBufferAlign);
+
+            if (!read) {
+                std::memcpy(transfer_buf, buf, transfer_size);
+            }
         }
 
         u32 out_size_transferred;
-        R_TRY(TransferPacketImpl(read, transfer_buf, size, size, &out_size_transferred, timeout));
+        R_TRY(TransferPacketImpl(read, transfer_buf, transfer_size, transfer_size, &out_size_transferred, timeout));
         R_UNLESS(out_size_transferred > 0, Result_UsbEmptyTransferSize);
-        R_UNLESS(out_size_transferred <= size, Result_UsbOverflowTransferSize);
+        R_UNLESS(out_size_transferred <= transfer_size, Result_UsbOverflowTransferSize);
 
-        if (read) {
+        if (read && !direct) {
             std::memcpy(buf, transfer_buf, out_size_transferred);
         }
 
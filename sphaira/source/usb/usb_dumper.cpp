@@ -4,6 +4,7 @@
 #include "log.hpp"
 
 #include <ranges>
+#include <algorithm>
 
 namespace sphaira::usb::dump {
 namespace {
@@ -35,8 +36,12 @@ Result Usb::WaitForConnection(std::string_view path, u64 timeout) {
     R_TRY(m_open_result);
     R_TRY(m_usb->IsUsbConnected(timeout));
 
-    const auto send_header = SendPacket::Build(CMD_EXPORT, path.length());
-    R_TRY(SendAndVerify(&send_header, sizeof(send_header), timeout));
+    // ask for a pipeline window, older hosts reply with 0.
+    const auto send_header = SendPacket::Build(CMD_EXPORT, path.length(), PIPELINE_WINDOW);
+    ResultPacket recv_header;
+    R_TRY(SendAndVerify(&send_header, sizeof(send_header), timeout, &recv_header));
+    m_window = std::clamp<u32>(recv_header.arg4, PIPELINE_WINDOW_NONE, PIPELINE_WINDOW_MAX);
+    m_pending = 0;
     R_TRY(SendAndVerify(path.data(), path.length(), timeout));
 
     m_was_connected = true;
@@ -44,6 +49,11 @@ Result Usb::WaitForConnection(std::string_view path, u64 timeout) {
 }
 
 Result Usb::CloseFile() {
+    // the host acks in order, so collect what is still in flight first.
+    while (m_pending) {
+        R_TRY(ReceiveResult());
+    }
+
     const auto send_header = SendDataPacket::Build(0, 0, 0);
 
     return SendAndVerify(&send_header, sizeof(send_header));
@@ -56,10 +66,31 @@ void Usb::SignalCancel() {
 Result Usb::Write(const void* buf, u64 off, u32 size) {
     const auto send_header = SendDataPacket::Build(off, size, crc32cCalculate(buf, size));
 
+    if (m_window > PIPELINE_WINDOW_NONE) {
+        // only wait for the oldest ack once the window is full.
+        if (m_pending >= m_window) {
+            R_TRY(ReceiveResult());
+        }
+
+        // when pipelining, the header and data are sent back to back and acked once.
+        R_TRY(m_usb->TransferAll(false, const_cast<SendDataPacket*>(&send_header), sizeof(send_header)));
+        R_TRY(m_usb->TransferAll(false, const_cast<void*>(buf), size));
+        m_pending++;
+        R_SUCCEED();
+    }
+
     R_TRY(SendAndVerify(&send_header, sizeof(send_header)));
     return SendAndVerify(buf, size);
 }
 
+Result Usb::ReceiveResult() {
+    m_pending--;
+
+    ResultPacket recv_header;
+    R_TRY(m_usb->TransferAll(true, &recv_header, sizeof(recv_header)));
+    return recv_header.Verify();
+}
+
 // casts away const, but it does not modify the buffer!
 Result Usb::SendAndVerify(const void* data, u32 size, u64 timeout, ResultPacket* out) {
     R_TRY(m_usb->TransferAll(false, const_cast<void*>(data), size, timeout));
@@ -4,12 +4,17 @@
 #include "log.hpp"
 
 #include <ranges>
+#include <algorithm>
+#include <cstring>
 
 namespace sphaira::usb::install {
 namespace {
 
 using namespace usb::api;
 
+// size of each request when pipelining, reads are aligned to this.
+constexpr u64 PIPELINE_BLOCK_SIZE = 1024 * 1024;
+
 } // namespace
 
 Usb::Usb(u64 transfer_timeout) {
@@ -35,9 +40,12 @@ Result Usb::WaitForConnection(u64 timeout, std::vector<std::string>& out_names)
     R_TRY(m_open_result);
     R_TRY(m_usb->IsUsbConnected(timeout));
 
-    const auto send_header = SendPacket::Build(RESULT_OK);
+    // ask for a pipeline window, older hosts reply with 0.
+    const auto send_header = SendPacket::Build(RESULT_OK, 0, PIPELINE_WINDOW);
     ResultPacket recv_header;
     R_TRY(SendAndVerify(&send_header, sizeof(send_header), timeout, &recv_header))
+    m_window = std::clamp<u32>(recv_header.arg4, PIPELINE_WINDOW_NONE, PIPELINE_WINDOW_MAX);
+    log_write("[USB] pipeline window: %u\n", m_window);
 
     std::vector<char> names(recv_header.arg3);
     R_TRY(m_usb->TransferAll(true, names.data(), names.size(), timeout));
@@ -67,10 +75,17 @@ Result Usb::OpenFile(u32 index, s64& file_size) {
 
     m_flags = flags;
     file_size = ((u64)file_size_msb << 32) | file_size_lsb;
+    m_file_size = file_size;
+    m_block_off = 0;
+    m_block_size = 0;
     R_SUCCEED();
 }
 
 Result Usb::CloseFile() {
+    // the host answers in order, so collect what is still in flight first.
+    R_TRY(DrainPending());
+    m_block_size = 0;
+
     const auto send_header = SendDataPacket::Build(0, 0, 0);
 
     return SendAndVerify(&send_header, sizeof(send_header));
@@ -85,6 +100,10 @@ u32 Usb::GetFlags() const {
 }
 
 Result Usb::Read(void* buf, u64 off, u32 size, u64* bytes_read) {
+    if (m_window > PIPELINE_WINDOW_NONE) {
+        return ReadPipelined(buf, off, size, bytes_read);
+    }
+
     const auto send_header = SendDataPacket::Build(off, size, 0);
     ResultPacket recv_header;
     R_TRY(SendAndVerify(&send_header, sizeof(send_header), &recv_header))
@@ -100,6 +119,139 @@ Result Usb::Read(void* buf, u64 off, u32 size, u64* bytes_read) {
     R_SUCCEED();
 }
 
+Result Usb::ReadPipelined(void* _buf, u64 off, u32 size, u64* bytes_read) {
+    auto buf = static_cast<u8*>(_buf);
+    *bytes_read = 0;
+
+    if (off >= m_file_size) {
+        R_SUCCEED();
+    }
+
+    size = std::min<u64>(size, m_file_size - off);
+    while (size) {
+        // copy out of the last received block.
+        if (off >= m_block_off && off < m_block_off + m_block_size) {
+            const auto block_pos = off - m_block_off;
+            const auto rsize = std::min<u64>(size, m_block_size - block_pos);
+            std::memcpy(buf, m_block.data() + block_pos, rsize);
+
+            buf += rsize;
+            off += rsize;
+            size -= rsize;
+            *bytes_read += rsize;
+            continue;
+        }
+
+        // discard blocks that were skipped over.
+        while (!m_pending.empty() && m_pending.front().off + m_pending.front().size <= off) {
+            R_TRY(ReceiveBlock());
+        }
+
+        // seeked backwards, start again from this offset.
+        if (!m_pending.empty() && m_pending.front().off > off) {
+            R_TRY(DrainPending());
+        }
+
+        // blocks start from wherever the reader is, so that sequential reads
+        // line up with the blocks and can be received without a copy.
+        if (m_pending.empty()) {
+            R_TRY(RequestBlock(off));
+        }
+
+        // keep the window full.
+        while (m_pending.size() < m_window) {
+            const auto next_off = m_pending.back().off + m_pending.back().size;
+            if (next_off >= m_file_size) {
+                break;
+            }
+            R_TRY(RequestBlock(next_off));
+        }
+
+        // receive straight into the callers buffer if it wants the whole block.
+        const auto block = m_pending.front();
+        if (block.off == off && block.size <= size && utils::IsBufferAligned(buf)) {
+            u32 rsize;
+            R_TRY(ReceiveBlock(buf, &rsize));
+
+            buf += rsize;
+            off += rsize;
+            size -= rsize;
+            *bytes_read += rsize;
+
+            // the host returned less than asked for, treat as eof.
+            if (rsize < block.size) {
+                break;
+            }
+            continue;
+        }
+
+        R_TRY(ReceiveBlock());
+
+        // the host returned less than asked for, treat as eof.
+        if (off >= m_block_off + m_block_size) {
+            break;
+        }
+    }
+
+    R_SUCCEED();
+}
+
+Result Usb::RequestBlock(u64 off) {
+    const auto size = std::min<u64>(PIPELINE_BLOCK_SIZE, m_file_size - off);
+    auto send_header = SendDataPacket::Build(off, size, 0);
+    R_TRY(m_usb->TransferAll(false, &send_header, sizeof(send_header)));
+
+    m_pending.push_back({off, u32(size)});
+    R_SUCCEED();
+}
+
+Result Usb::ReceiveBlock() {
+    if (m_block.empty()) {
+        m_block.resize(PIPELINE_BLOCK_SIZE);
+    }
+
+    // invalidate the block until it has been verified.
+    const auto off = m_pending.front().off;
+    m_block_size = 0;
+
+    u32 size;
+    R_TRY(ReceiveBlock(m_block.data(), &size));
+
+    m_block_off = off;
+    m_block_size = size;
+    R_SUCCEED();
+}
+
+Result Usb::ReceiveBlock(void* buf, u32* out_size) {
+    const auto block = m_pending.front();
+    m_pending.pop_front();
+
+    ResultPacket recv_header;
+    R_TRY(m_usb->TransferAll(true, &recv_header, sizeof(recv_header)));
+    R_TRY(recv_header.Verify());
+
+    const auto size = recv_header.arg3;
+    R_UNLESS(size <= block.size, 3);
+
+    if (size) {
+        R_TRY(m_usb->TransferAll(true, buf, size));
+    }
+
+    // verify crc32c.
+    R_UNLESS(crc32cCalculate(buf, size) == recv_header.arg4, 3);
+
+    *out_size = size;
+    R_SUCCEED();
+}
+
+Result Usb::DrainPending() {
+    while (!m_pending.empty()) {
+        R_TRY(ReceiveBlock());
+    }
+
+    R_SUCCEED();
+}
+
 // casts away const, but it does not modify the buffer!
 Result Usb::SendAndVerify(const void* data, u32 size, u64 timeout, ResultPacket* out) {
     R_TRY(m_usb->TransferAll(false, const_cast<void*>(data), size, timeout));
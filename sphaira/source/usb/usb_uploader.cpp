@@ -57,7 +57,7 @@ Result Usb::WaitForConnection(u64 timeout, std::span<const std::string> names) {
     R_TRY(m_usb->TransferAll(true, &send_header, sizeof(send_header), timeout));
     R_TRY(send_header.Verify());
 
-    // send table info.
+    // send table info, no window is given so the device stays in stop-and-wait mode.
     R_TRY(SendResult(RESULT_OK, names_list.length()));
 
     // send name table.
@@ -108,11 +108,11 @@ Result Usb::file_transfer_loop() {
     log_write("reading buffer: %zu\n", m_buf.size());
 
     R_TRY(Read(m_buf.data(), send_header.GetOffset(), m_buf.size(), &bytes_read));
-    const auto crc32 = crc32Calculate(m_buf.data(), m_buf.size());
+    const auto crc32c = crc32cCalculate(m_buf.data(), m_buf.size());
 
     log_write("read the buffer: %zu\n", bytes_read);
-    // respond back with the length of the data and the crc32.
-    R_TRY(SendResult(RESULT_OK, m_buf.size(), crc32));
+    // respond back with the length of the data and the crc32c.
+    R_TRY(SendResult(RESULT_OK, m_buf.size(), crc32c));
 
     log_write("sent result with crc\n");
 
@@ -7,6 +7,9 @@
 #include "app.hpp"
 #include "log.hpp"
 
+#include <deque>
+#include <algorithm>
+
 // sizes of all formats (stacked).
 // 2.6 MiB (2,708,685) without                (+0k   | +0k)
 // 2.6 MiB (2,733,261) with wav               (+25k  | +25k)
@@ -176,6 +179,31 @@ struct Base {
     virtual Result Update(Progress& out, State& state) = 0;
     virtual Result Seek(u64 target) = 0;
 
+    // called once the song has been loaded and is about to be played.
+    virtual Result Start() {
+        R_SUCCEED();
+    }
+
+    // stops any threads used by the song, must be called before it's destroyed.
+    virtual void Stop() {
+    }
+
+    // queues a song to be played once this one ends, without a gap.
+    // the song is loaded in the background, see CustomBase::DecodeLoop().
+    virtual Result Queue(std::unique_ptr<Base>&& source, fs::Fs* fs, const fs::FsPath& path) {
+        R_THROW(0x1);
+    }
+
+    virtual bool IsGapless() const {
+        return false;
+    }
+
+    // returns the song that is currently being played, which changes
+    // as queued songs are played.
+    virtual auto GetPlaying() -> Base* {
+        return this;
+    }
+
     virtual void GetMeta(Meta* out) {
         *out = {};
     }
@@ -274,16 +302,32 @@ struct CustomBase : Base {
         }
     }
 
+    // position of the decoder, which runs ahead of playback.
     virtual u64 Tell() = 0;
+    virtual Result SeekDecoder(u64 target) = 0;
 
-    // taken from sys-tune.
+    // called by LoadFile(), the voice is only created once the song is started.
+    // this allows for songs to be loaded ahead of time and queued.
     Result Create(int channel_count, int sample_rate, const Decode& decode) {
+        m_decode = decode;
+        m_channel_count = channel_count;
+        m_sample_rate = sample_rate;
+        R_SUCCEED();
+    }
+
+    // decodes up to sample_count frames into out, returns 0 at the end of the song.
+    int DecodeFrames(int sample_count, s16* out) {
+        return m_decode(sample_count, out);
+    }
+
+    // taken from sys-tune.
+    Result Start() override {
         auto player = plsrPlayerGetInstance();
         R_UNLESS(player, 0x1);
         m_drv = &player->driver;
 
         const int MinSampleCount  = 2048; // 21ms of audio at 44100
-        const int MaxChannelCount = channel_count;
+        const int MaxChannelCount = m_channel_count;
         const int AudioSampleSize = MinSampleCount * MaxChannelCount * sizeof(s16);
         const int AudioPoolSize   = ((AudioSampleSize * BufferCount) + 0xFFF) &~ 0xFFF;
         constexpr std::align_val_t pool_align{AUDREN_MEMPOOL_ALIGNMENT};
@@ -299,10 +343,10 @@ struct CustomBase : Base {
         log_write("got voice id: %d\n", m_voice_id);
         R_UNLESS(m_voice_id >= 0, 0x1);
 
-        R_UNLESS(audrvVoiceInit(m_drv, m_voice_id, channel_count, PcmFormat_Int16, sample_rate), 0x1);
+        R_UNLESS(audrvVoiceInit(m_drv, m_voice_id, m_channel_count, PcmFormat_Int16, m_sample_rate), 0x1);
         audrvVoiceSetDestinationMix(m_drv, m_voice_id, AUDREN_FINAL_MIX_ID);
 
-        if (channel_count == 1) {
+        if (m_channel_count == 1) {
             audrvVoiceSetMixFactor(m_drv, m_voice_id, 1.0f, 0, 0);
             audrvVoiceSetMixFactor(m_drv, m_voice_id, 1.0f, 0, 1);
         } else {
@@ -315,8 +359,6 @@ struct CustomBase : Base {
         audrvVoiceStart(m_drv, m_voice_id);
         m_sample_count = AudioSampleSize / BufferCount / sizeof(s16);
 
-        log_write("[AUDIO] pool size: %u sample_count: %d\n", AudioPoolSize, m_sample_count);
-
         for (int i = 0; i < BufferCount; i++) {
             m_buffers[i].data_pcm16          = *m_aligned;
             m_buffers[i].size                = AudioSampleSize;
@@ -324,11 +366,44 @@ struct CustomBase : Base {
             m_buffers[i].end_sample_offset   = m_buffers[i].start_sample_offset + m_sample_count;
         }
 
-        m_decode = decode;
-        m_channel_count = channel_count;
+        // the ring holds x seconds of decoded audio, which hides slow reads
+        // (network mounts, flac) from playback.
+        const u64 seconds = std::max<s64>(App::GetApp()->m_audio_decode_ahead.Get(), 0);
+        const auto chunk_count = std::max<u64>(BufferCount, seconds * m_sample_rate / m_sample_count);
+        m_ring.resize(chunk_count);
+        m_ring_data.resize(chunk_count * m_sample_count * m_channel_count);
+
+        log_write("[AUDIO] pool size: %u sample_count: %d ring: %zu\n", AudioPoolSize, m_sample_count, m_ring.size());
+
+        mutexInit(&m_ring_mutex);
+        mutexInit(&m_decode_mutex);
+        condvarInit(&m_can_decode);
+
+        R_TRY(utils::CreateThread(&m_thread, decode_thread_func, this, 1024*128, 0x2B));
+        if (R_FAILED(threadStart(&m_thread))) {
+            threadClose(&m_thread);
+            R_THROW(0x1);
+        }
+
+        m_thread_running = true;
         R_SUCCEED();
     }
 
+    void Stop() override {
+        if (!m_thread_running) {
+            return;
+        }
+
+        mutexLock(&m_ring_mutex);
+        m_quit = true;
+        condvarWakeOne(&m_can_decode);
+        mutexUnlock(&m_ring_mutex);
+
+        threadWaitForExit(&m_thread);
+        threadClose(&m_thread);
+        m_thread_running = false;
+    }
+
     Result Update(Progress& out, State& state) override {
         if (state == State::Playing) {
             // set volume and pitch.
@@ -348,38 +423,262 @@ struct CustomBase : Base {
             }
 
             if (refillBuf) {
-                s16 *data = *m_aligned + refillBuf->start_sample_offset * m_channel_count;
-
-                const int nSamples = m_decode(m_sample_count, data);
-                if (nSamples > 0) {
-                    armDCacheFlush(data, nSamples * m_channel_count * sizeof(u16));
-                    refillBuf->end_sample_offset = refillBuf->start_sample_offset + nSamples;
-
-                    // todo: handle error here, should it fail.
-                    if (!audrvVoiceAddWaveBuf(m_drv, m_voice_id, refillBuf)) {
-                        R_THROW(0x1);
+                // freed once the ring lock is released.
+                std::unique_ptr<CustomBase> finished{};
+                bool submitted{};
+
+                {
+                    SCOPED_MUTEX(&m_ring_mutex);
+
+                    if (m_ring_count) {
+                        const auto& chunk = m_ring[m_ring_head];
+                        s16 *data = *m_aligned + refillBuf->start_sample_offset * m_channel_count;
+
+                        std::memcpy(data, GetChunkData(m_ring_head), chunk.sample_count * m_channel_count * sizeof(s16));
+                        armDCacheFlush(data, chunk.sample_count * m_channel_count * sizeof(u16));
+                        refillBuf->end_sample_offset = refillBuf->start_sample_offset + chunk.sample_count;
+
+                        // todo: handle error here, should it fail.
+                        if (!audrvVoiceAddWaveBuf(m_drv, m_voice_id, refillBuf)) {
+                            R_THROW(0x1);
+                        }
+
+                        // the first chunk of the next song, swap over without stopping the voice.
+                        if (chunk.source != m_playing) {
+                            if (m_playing != this) {
+                                finished = std::move(m_queue.front());
+                                m_queue.pop_front();
+                            }
+
+                            m_playing = chunk.source;
+                            m_track++;
+                        }
+
+                        m_played = chunk.played;
+                        m_ring_head = (m_ring_head + 1) % m_ring.size();
+                        m_ring_count--;
+                        condvarWakeOne(&m_can_decode);
+                        m_starved = false;
+                        submitted = true;
+                    } else if (m_eof) {
+                        if (m_played < m_playing->m_info.sample_count) {
+                            state = State::Error;
+                        } else if (IsAllBuffersEmpty()) {
+                            state = State::Finished;
+                        }
+                    } else if (!m_starved && IsAllBuffersEmpty()) {
+                        m_starved = true;
+                        log_write("[AUDIO] underrun: %u\n", ++m_underrun_count);
                     }
+                }
 
-                    // update again as we pushed a new buffer.
+                // update again as we pushed a new buffer.
+                if (submitted) {
                     R_TRY(audrvUpdate(m_drv));
-                } else {
-                    if (Tell() < m_info.sample_count) {
-                        state = State::Error;
-                    } else if (IsAllBuffersEmpty()) {
-                        state = State::Finished;
-                    }
                 }
             }
         }
 
         // audrvVoiceGetPlayedSampleCount doesn't handle seek and has no way of adjusting :/
         // out.played = audrvVoiceGetPlayedSampleCount(m_drv, m_voice_id);
-        out.played = Tell();
+        out.played = m_played;
+        out.track = m_track;
+
+        R_SUCCEED();
+    }
+
+    Result Seek(u64 target) override {
+        // blocks until the current decode has finished.
+        SCOPED_MUTEX(&m_decode_mutex);
+        SCOPED_MUTEX(&m_ring_mutex);
+
+        // rewind any queued songs that have already started decoding.
+        for (auto& e : m_queue) {
+            if (e.get() != m_playing && e->Tell()) {
+                e->SeekDecoder(0);
+            }
+        }
+
+        const auto rc = m_playing->SeekDecoder(target);
+        m_decoding = m_playing;
+        m_played = target;
+
+        // flush the ring.
+        m_ring_head = 0;
+        m_ring_count = 0;
+        m_generation++;
+        m_eof = false;
+        condvarWakeOne(&m_can_decode);
+
+        return rc;
+    }
+
+    Result Queue(std::unique_ptr<Base>&& source, fs::Fs* fs, const fs::FsPath& path) override {
+        R_UNLESS(source->IsGapless(), 0x1);
+
+        // replaces any song that has not been loaded yet.
+        SCOPED_MUTEX(&m_ring_mutex);
+        m_pending.reset(static_cast<CustomBase*>(source.release()));
+        m_pending_fs = fs;
+        m_pending_path = path;
+        condvarWakeOne(&m_can_decode);
 
         R_SUCCEED();
     }
 
+    bool IsGapless() const override {
+        return true;
+    }
+
+    auto GetPlaying() -> Base* override {
+        return m_playing;
+    }
+
 private:
+    struct Chunk {
+        // the song that this chunk was decoded from.
+        CustomBase* source;
+        // decoder position at the end of this chunk.
+        u64 played;
+        int sample_count;
+    };
+
+    static void decode_thread_func(void* arg) {
+        static_cast<CustomBase*>(arg)->DecodeLoop();
+    }
+
+    void DecodeLoop() {
+        for (;;) {
+            u32 slot;
+            u32 generation;
+            std::unique_ptr<CustomBase> pending{};
+            fs::Fs* pending_fs{};
+            fs::FsPath pending_path{};
+
+            {
+                SCOPED_MUTEX(&m_ring_mutex);
+                while (!m_quit && !m_pending && (m_eof || m_ring_count == m_ring.size())) {
+                    condvarWait(&m_can_decode, &m_ring_mutex);
+                }
+
+                if (m_quit) {
+                    return;
+                }
+
+                // load the queued song once the ring is full, so that the
+                // decoded audio covers the time it takes to load.
+                if (m_pending && (m_eof || m_ring_count == m_ring.size())) {
+                    pending = std::move(m_pending);
+                    pending_fs = m_pending_fs;
+                    pending_path = m_pending_path;
+                } else {
+                    slot = (m_ring_head + m_ring_count) % m_ring.size();
+                    generation = m_generation;
+                }
+            }
+
+            if (pending) {
+                LoadQueued(std::move(pending), pending_fs, pending_path);
+                continue;
+            }
+
+            // seek takes this lock to change the decoder, so the generation
+            // can only change whilst waiting for it.
+            SCOPED_MUTEX(&m_decode_mutex);
+            {
+                SCOPED_MUTEX(&m_ring_mutex);
+                if (generation != m_generation) {
+                    continue;
+                }
+            }
+
+            auto source = m_decoding;
+            const auto data = GetChunkData(slot);
+            int sample_count = 0;
+            bool switched = false;
+            bool eof = false;
+
+            // fill the whole chunk, carrying on into the next queued song.
+            // the end of a song is otherwise a short chunk, which the voice
+            // plays before the audio thread can submit the next one.
+            while (sample_count < m_sample_count) {
+                const auto count = source->DecodeFrames(m_sample_count - sample_count, data + sample_count * m_channel_count);
+                if (count > 0) {
+                    sample_count += count;
+                    continue;
+                }
+
+                // move onto the next song in the queue, if any.
+                // only once per chunk, so that each chunk is at most one track change.
+                SCOPED_MUTEX(&m_ring_mutex);
+                if (switched) {
+                    break;
+                } else if (auto next = GetNextQueued(source)) {
+                    m_decoding = next;
+                    source = next;
+                    switched = true;
+                } else {
+                    eof = true;
+                    break;
+                }
+            }
+
+            const auto played = source->Tell();
+
+            // eof is set along with the last chunk, as the audio thread
+            // finishes the song once the ring is empty at eof.
+            SCOPED_MUTEX(&m_ring_mutex);
+            if (sample_count > 0) {
+                m_ring[slot] = {source, played, sample_count};
+                m_ring_count++;
+            }
+            m_eof = eof;
+        }
+    }
+
+    void LoadQueued(std::unique_ptr<CustomBase>&& source, fs::Fs* fs, const fs::FsPath& path) {
+        if (auto rc = source->LoadFile(fs, path, 0); R_FAILED(rc)) {
+            log_write("[AUDIO] failed to load queued song: 0x%X\n", rc);
+            return;
+        }
+
+        // the voice can only play a single format, the song is instead
+        // opened once this one has finished.
+        if (source->m_channel_count != m_channel_count || source->m_sample_rate != m_sample_rate) {
+            log_write("[AUDIO] queued song format differs, not queueing\n");
+            return;
+        }
+
+        auto next = source.get();
+        SCOPED_MUTEX(&m_ring_mutex);
+        m_queue.emplace_back(std::move(source));
+
+        // the last song already finished decoding, so continue with the new one.
+        if (m_eof) {
+            m_decoding = next;
+            m_eof = false;
+        }
+    }
+
+    // lock must be held.
+    auto GetNextQueued(const CustomBase* source) -> CustomBase* {
+        if (source == this) {
+            return m_queue.empty() ? nullptr : m_queue.front().get();
+        }
+
+        for (size_t i = 0; i + 1 < m_queue.size(); i++) {
+            if (m_queue[i].get() == source) {
+                return m_queue[i + 1].get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    auto GetChunkData(u32 slot) -> s16* {
+        return m_ring_data.data() + slot * m_sample_count * m_channel_count;
+    }
+
     bool IsAllBuffersEmpty() const {
         for (auto &buffer : m_buffers) {
             if (buffer.state != AudioDriverWaveBufState_Free && buffer.state != AudioDriverWaveBufState_Done) {
@@ -411,6 +710,37 @@ private:
     int m_voice_id{-1};
     int m_sample_count{};
     int m_channel_count{};
+    int m_sample_rate{};
+
+    // decoded audio waiting to be submitted, filled by the decode thread.
+    std::vector<Chunk> m_ring{};
+    std::vector<s16> m_ring_data{};
+    u32 m_ring_head{};
+    u32 m_ring_count{};
+    // bumped on seek so that the decode thread drops stale chunks.
+    u32 m_generation{};
+    u32 m_underrun_count{};
+    bool m_eof{};
+    bool m_quit{};
+    bool m_starved{};
+    Mutex m_ring_mutex{};
+    Mutex m_decode_mutex{};
+    CondVar m_can_decode{};
+    Thread m_thread{};
+    bool m_thread_running{};
+
+    // songs queued to play after this one, the front is played next.
+    std::deque<std::unique_ptr<CustomBase>> m_queue{};
+    // song passed to Queue() that the decode thread has yet to load.
+    std::unique_ptr<CustomBase> m_pending{};
+    fs::Fs* m_pending_fs{};
+    fs::FsPath m_pending_path{};
+    // the song currently being heard, either this or the front of the queue.
+    CustomBase* m_playing{this};
+    // the song the decode thread is reading from.
+    CustomBase* m_decoding{this};
+    u64 m_played{};
+    u32 m_track{};
 };
 
 struct PlsrBFSTM final : PlsrBase {
@@ -488,7 +818,7 @@ struct DrWAV final : CustomBase {
         });
     }
 
-    Result Seek(u64 target) override {
+    Result SeekDecoder(u64 target) override {
         return drwav_seek_to_pcm_frame(&m_wav, target);
     }
 
@@ -584,7 +914,7 @@ struct DrMP3 final : CustomBase {
         });
     }
 
-    Result Seek(u64 target) override {
+    Result SeekDecoder(u64 target) override {
         return drmp3_seek_to_pcm_frame(&m_mp3, target);
     }
 
@@ -698,7 +1028,7 @@ struct DrFLAC final : CustomBase {
         });
     }
 
-    Result Seek(u64 target) override {
+    Result SeekDecoder(u64 target) override {
         return drflac_seek_to_pcm_frame(m_flac, target);
     }
 
@@ -772,7 +1102,7 @@ struct DrOGG final : CustomBase {
         });
     }
 
-    Result Seek(u64 target) override {
+    Result SeekDecoder(u64 target) override {
         if (DR_VORBIS_SUCCESS != dr_vorbis_seek_to_pcm_frame(&m_vorbis, target)) {
             R_THROW(0x1);
         }
@@ -842,11 +1172,12 @@ struct stbOGG final : CustomBase {
         m_info.channels = info.channels;
 
         return Create(m_info.channels, m_info.sample_rate, [this](int sample_count, s16 *data) -> int {
-            return stb_vorbis_get_samples_short_interleaved(m_ogg, m_info.channels, data, sample_count);
+            // takes the size of the buffer in shorts, not frames.
+            return stb_vorbis_get_samples_short_interleaved(m_ogg, m_info.channels, data, sample_count * m_info.channels);
         });
     }
 
-    Result Seek(u64 target) override {
+    Result SeekDecoder(u64 target) override {
         return stb_vorbis_seek(m_ogg, target);
     }
 
@@ -904,6 +1235,49 @@ Thread g_thread{};
 UEvent g_cancel_uevent{};
 std::atomic_bool g_is_init{};
 
+auto CreateSource(const fs::FsPath& path) -> std::unique_ptr<Base> {
+    if (path.ends_with(".bfstm")) {
+        return std::make_unique<PlsrBFSTM>();
+    }
+    else if (path.ends_with(".bfwav")) {
+        return std::make_unique<PlsrBFWAV>();
+    }
+#ifdef ENABLE_AUDIO_WAV
+    else if (path.ends_with(".wav")) {
+        return std::make_unique<DrWAV>();
+    }
+#endif // ENABLE_AUDIO_WAV
+#ifdef ENABLE_AUDIO_MP3
+    else if (path.ends_with(".mp3") || path.ends_with(".mp2") || path.ends_with(".mp1")) {
+        return std::make_unique<DrMP3>();
+    }
+    else if (path.ends_with(".adf")) {
+        return std::make_unique<DrMP3>(std::make_unique<GTAViceCityFile>());
+    }
+#endif // ENABLE_AUDIO_MP3
+#ifdef ENABLE_AUDIO_FLAC
+    else if (path.ends_with(".flac")) {
+        return std::make_unique<DrFLAC>();
+    }
+#endif // ENABLE_AUDIO_FLAC
+#ifdef ENABLE_AUDIO_OGG
+    // else if (path.ends_with(".ogg")) {
+    //     return std::make_unique<DrOGG>();
+    // }
+    else if (path.ends_with(".ogg")) {
+        return std::make_unique<stbOGG>();
+    }
+#endif // ENABLE_AUDIO_OGG
+
+    return {};
+}
+
+// stops the song before destroying it, as the decode thread may still be using it.
+void DestroySource(Base* source) {
+    source->Stop();
+    delete source;
+}
+
 void thread_func(void* arg) {
     auto player = plsrPlayerGetInstance();
     if (!player) {
@@ -1040,7 +1414,7 @@ void Exit() {
     for (auto& e : g_songs) {
         SCOPED_MUTEX(&e.mutex);
         if (e.state != State::Free) {
-            delete e.source;
+            DestroySource(e.source);
         }
     }
 
@@ -1075,43 +1449,10 @@ Result OpenSong(fs::Fs* fs, const fs::FsPath& path, u32 flags, SongID* id) {
         SCOPED_MUTEX(&e.mutex);
 
         if (e.state == State::Free) {
-            std::unique_ptr<Base> source{};
-
-            if (path.ends_with(".bfstm")) {
-                source = std::make_unique<PlsrBFSTM>();
-            }
-            else if (path.ends_with(".bfwav")) {
-                source = std::make_unique<PlsrBFWAV>();
-            }
-#ifdef ENABLE_AUDIO_WAV
-            else if (path.ends_with(".wav")) {
-                source = std::make_unique<DrWAV>();
-            }
-#endif // ENABLE_AUDIO_WAV
-#ifdef ENABLE_AUDIO_MP3
-            else if (path.ends_with(".mp3") || path.ends_with(".mp2") || path.ends_with(".mp1")) {
-                source = std::make_unique<DrMP3>();
-            }
-            else if (path.ends_with(".adf")) {
-                source = std::make_unique<DrMP3>(std::make_unique<GTAViceCityFile>());
-            }
-#endif // ENABLE_AUDIO_MP3
-#ifdef ENABLE_AUDIO_FLAC
-            else if (path.ends_with(".flac")) {
-                source = std::make_unique<DrFLAC>();
-            }
-#endif // ENABLE_AUDIO_FLAC
-#ifdef ENABLE_AUDIO_OGG
-            // else if (path.ends_with(".ogg")) {
-            //     source = std::make_unique<DrOGG>();
-            // }
-            else if (path.ends_with(".ogg")) {
-                source = std::make_unique<stbOGG>();
-            }
-#endif // ENABLE_AUDIO_OGG
-
+            auto source = CreateSource(path);
             R_UNLESS(source, 0x1);
             R_TRY(source->LoadFile(fs, path, flags));
+            R_TRY(source->Start());
 
             e.state = State::Paused;
             e.source = source.release();
@@ -1134,7 +1475,7 @@ Result CloseSong(SongID* id) {
     SCOPED_MUTEX(&e->mutex);
     R_UNLESS(e->state != State::Free, 0x1);
 
-    delete e->source;
+    DestroySource(e->source);
     e->state = State::Free;
     *id = nullptr;
 
@@ -1176,6 +1517,41 @@ Result SeekSong(SongID id, u64 target) {
     );
 }
 
+Result QueueSong(SongID id, fs::Fs* fs, const fs::FsPath& path) {
+    R_UNLESS(g_is_init, 0x1);
+    R_UNLESS(fs && !path.empty(), 0x1);
+
+    auto source = CreateSource(path);
+    R_UNLESS(source && source->IsGapless(), 0x1);
+
+    LockSongAndDo(IsGood,
+        R_TRY(e->source->Queue(std::move(source), fs, path));
+    );
+}
+
+bool IsSongSupported(const fs::FsPath& path) {
+    // same as CreateSource(), without creating the decoder.
+    static constexpr const char* extensions[]{
+        ".bfstm", ".bfwav",
+#ifdef ENABLE_AUDIO_WAV
+        ".wav",
+#endif // ENABLE_AUDIO_WAV
+#ifdef ENABLE_AUDIO_MP3
+        ".mp3", ".mp2", ".mp1", ".adf",
+#endif // ENABLE_AUDIO_MP3
+#ifdef ENABLE_AUDIO_FLAC
+        ".flac",
+#endif // ENABLE_AUDIO_FLAC
+#ifdef ENABLE_AUDIO_OGG
+        ".ogg",
+#endif // ENABLE_AUDIO_OGG
+    };
+
+    return std::ranges::any_of(extensions, [&path](auto ext) {
+        return path.ends_with(ext);
+    });
+}
+
 Result GetVolumeSong(SongID id, float* out) {
     LockSongAndDo(IsGood,
         e->source->GetVolume(out);
@@ -1202,13 +1578,13 @@ Result SetPitchSong(SongID id, float in) {
 
 Result GetInfo(SongID id, Info* out) {
     LockSongAndDo(IsGood,
-        e->source->GetInfo(out);
+        e->source->GetPlaying()->GetInfo(out);
     );
 }
 
 Result GetMeta(SongID id, Meta* out) {
     LockSongAndDo(IsGood,
-        e->source->GetMeta(out);
+        e->source->GetPlaying()->GetMeta(out);
     );
 }
 
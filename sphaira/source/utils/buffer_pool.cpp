@@ -0,0 +1,98 @@
+#include "utils/buffer_pool.hpp"
+#include "defines.hpp"
+#include "log.hpp"
+
+#include <new>
+#include <algorithm>
+
+namespace sphaira::utils {
+namespace {
+
+// smaller buffers are not worth caching.
+constexpr std::size_t CACHE_ENTRY_MIN = 1024 * 64;
+// same as the bounce buffer that usb used to allocate per session.
+constexpr std::size_t CACHE_SIZE_MAX = 1024 * 1024 * 16;
+
+struct CacheEntry {
+    void* ptr;
+    std::size_t size;
+};
+
+Mutex g_mutex{};
+std::vector<CacheEntry> g_cache{};
+std::size_t g_cache_size{};
+u32 g_scope_count{};
+
+auto AlignSize(std::size_t size) -> std::size_t {
+    return (std::max<std::size_t>(size, 1) + BUFFER_ALIGN - 1) & ~(BUFFER_ALIGN - 1);
+}
+
+void FreeAligned(void* ptr) {
+    ::operator delete[](ptr, std::align_val_t{BUFFER_ALIGN});
+}
+
+// lock must be held.
+void ClearCache() {
+    for (auto& e : g_cache) {
+        FreeAligned(e.ptr);
+    }
+
+    g_cache.clear();
+    g_cache_size = 0;
+}
+
+} // namespace
+
+void* BufferPoolAlloc(std::size_t size) {
+    size = AlignSize(size);
+
+    {
+        SCOPED_MUTEX(&g_mutex);
+        const auto it = std::ranges::find_if(g_cache, [size](auto& e) {
+            return e.size == size;
+        });
+
+        if (it != g_cache.end()) {
+            const auto ptr = it->ptr;
+            g_cache_size -= it->size;
+            g_cache.erase(it);
+            return ptr;
+        }
+    }
+
+    return ::operator new[](size, std::align_val_t{BUFFER_ALIGN});
+}
+
+void BufferPoolFree(void* ptr, std::size_t size) {
+    if (!ptr) {
+        return;
+    }
+
+    size = AlignSize(size);
+
+    {
+        SCOPED_MUTEX(&g_mutex);
+        if (g_scope_count && size >= CACHE_ENTRY_MIN && g_cache_size + size <= CACHE_SIZE_MAX) {
+            g_cache.push_back({ptr, size});
+            g_cache_size += size;
+            return;
+        }
+    }
+
+    FreeAligned(ptr);
+}
+
+ScopedBufferPool::ScopedBufferPool() {
+    SCOPED_MUTEX(&g_mutex);
+    g_scope_count++;
+}
+
+ScopedBufferPool::~ScopedBufferPool() {
+    SCOPED_MUTEX(&g_mutex);
+    if (!--g_scope_count) {
+        log_write("[BUFFER] freeing cache: %zu\n", g_cache_size);
+        ClearCache();
+    }
+}
+
+} // namespace sphaira::utils
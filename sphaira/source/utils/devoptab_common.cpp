@@ -47,23 +47,197 @@ const char* curl_url_strerror_wrap(CURLUcode code) {
     }
 }
 
+// default for network mounts loaded from the ini.
+constexpr long METADATA_CACHE_TTL_DEFAULT = 30;
+// the cache is cleared if it grows past this, large listings are still cached.
+constexpr size_t METADATA_CACHE_MAX_STATS = 1024 * 8;
+constexpr size_t METADATA_CACHE_MAX_LISTS = 64;
+
+struct CachedDirEntry {
+    std::string name;
+    struct stat st;
+};
+using CachedDirEntries = std::vector<CachedDirEntry>;
+
+auto GetParentPath(std::string_view path) -> std::string_view {
+    const auto pos = path.rfind('/');
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+
+    if (!pos) {
+        return path.size() > 1 ? "/" : "";
+    }
+
+    return path.substr(0, pos);
+}
+
+auto JoinPath(std::string_view dir, std::string_view name) -> std::string {
+    std::string out{dir};
+    if (!out.empty() && !out.ends_with('/')) {
+        out += '/';
+    }
+    out += name;
+    return out;
+}
+
+// caches listings and stats of network devices, so that browsing doesn't
+// cost a round trip per entry.
+// entries expire after the ttl and are removed on local changes.
+// the device mutex must be held for all calls.
+struct MetadataCache {
+    struct StatEntry {
+        struct stat st;
+        // negative entries store the error.
+        int err;
+        u64 expire;
+    };
+
+    struct ListEntry {
+        std::shared_ptr<const CachedDirEntries> entries;
+        u64 expire;
+    };
+
+    void Init(long ttl) {
+        m_ttl = ttl > 0 ? armNsToTicks(ttl * 1'000'000'000ULL) : 0;
+    }
+
+    auto IsEnabled() const -> bool {
+        return m_ttl != 0;
+    }
+
+    // returns true if found, ret is set to 0 or the negative error.
+    auto GetStat(const std::string& path, struct stat* st, int& ret, bool has_full_stat) -> bool {
+        const auto now = armGetSystemTick();
+
+        if (auto it = m_stats.find(path); it != m_stats.end()) {
+            if (it->second.expire > now) {
+                std::memcpy(st, &it->second.st, sizeof(*st));
+                ret = it->second.err;
+                return true;
+            }
+            m_stats.erase(it);
+        }
+
+        // try and find the entry in the listing of the parent.
+        const auto parent = GetParentPath(path);
+        const auto name = std::string_view{path}.substr(parent.size() + (parent.empty() || parent.ends_with('/') ? 0 : 1));
+        const auto list = GetList(std::string{parent});
+        if (!list || name.empty()) {
+            return false;
+        }
+
+        const auto it = std::ranges::find_if(*list, [&name](auto& e) {
+            return e.name == name;
+        });
+
+        if (it == list->end()) {
+            ret = -ENOENT;
+            return true;
+        }
+
+        // listings of some devices only contain the type.
+        if (has_full_stat || S_ISDIR(it->st.st_mode)) {
+            std::memcpy(st, &it->st, sizeof(*st));
+            ret = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    void SetStat(const std::string& path, const struct stat* st, int ret) {
+        // only cache results that depend on the path, not the connection.
+        if (ret && ret != -ENOENT) {
+            return;
+        }
+
+        if (m_stats.size() >= METADATA_CACHE_MAX_STATS) {
+            m_stats.clear();
+        }
+
+        auto& e = m_stats[path];
+        std::memcpy(&e.st, st, sizeof(*st));
+        e.err = ret;
+        e.expire = armGetSystemTick() + m_ttl;
+    }
+
+    auto GetList(const std::string& path) -> std::shared_ptr<const CachedDirEntries> {
+        const auto it = m_lists.find(path);
+        if (it == m_lists.end()) {
+            return {};
+        }
+
+        if (it->second.expire <= armGetSystemTick()) {
+            m_lists.erase(it);
+            return {};
+        }
+
+        return it->second.entries;
+    }
+
+    void SetList(const std::string& path, std::shared_ptr<const CachedDirEntries> entries) {
+        if (m_lists.size() >= METADATA_CACHE_MAX_LISTS) {
+            m_lists.clear();
+        }
+
+        m_lists.insert_or_assign(path, ListEntry{entries, armGetSystemTick() + m_ttl});
+    }
+
+    // removes the path, anything below it and the listing of its parent.
+    void Invalidate(const std::string& path) {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        const auto prefix = JoinPath(path, "");
+        const auto is_below = [&](const std::string& key) {
+            return key == path || key.starts_with(prefix);
+        };
+
+        std::erase_if(m_stats, [&](auto& e) { return is_below(e.first); });
+        std::erase_if(m_lists, [&](auto& e) { return is_below(e.first); });
+        m_lists.erase(std::string{GetParentPath(path)});
+    }
+
+private:
+    std::unordered_map<std::string, StatEntry> m_stats{};
+    std::unordered_map<std::string, ListEntry> m_lists{};
+    u64 m_ttl{};
+};
+
 struct Device {
     std::unique_ptr<MountDevice> mount_device;
     size_t file_size;
     size_t dir_size;
 
     MountConfig config{};
+    MetadataCache cache{};
     Mutex mutex{};
 };
 
 struct File {
     Device* device;
     void* fd;
+    // set if opened for writing, the cache is invalidated on close.
+    char* path;
+    // used instead of the device mutex if the device supports concurrent files.
+    Mutex mutex;
+};
+
+// listing that is served from, or being recorded into the cache.
+struct CachedDir {
+    std::string path;
+    std::shared_ptr<const CachedDirEntries> entries;
+    size_t index;
+    // set whilst reading from the device, the listing is cached once complete.
+    std::shared_ptr<CachedDirEntries> recording;
 };
 
 struct Dir {
     Device* device;
     void* fd;
+    CachedDir* cached;
 };
 
 int set_errno(struct _reent *r, int err) {
@@ -71,6 +245,15 @@ int set_errno(struct _reent *r, int err) {
     return -1;
 }
 
+// file calls only lock the file if the device supports it, so that a slow
+// read doesn't block every other call on the device.
+auto GetFileMutex(File* file) -> Mutex* {
+    if (file->device->mount_device->supports_concurrent_files()) {
+        return &file->mutex;
+    }
+    return &file->device->mutex;
+}
+
 int devoptab_open(struct _reent *r, void *fileStruct, const char *_path, int flags, int mode) {
     auto device = static_cast<Device*>(r->deviceData);
     auto file = static_cast<File*>(fileStruct);
@@ -96,6 +279,11 @@ int devoptab_open(struct _reent *r, void *fileStruct, const char *_path, int fla
         return set_errno(r, ENOMEM);
     }
 
+    const auto is_write = flags & (O_WRONLY | O_RDWR | O_CREAT | O_TRUNC | O_APPEND);
+    if (is_write) {
+        device->cache.Invalidate(path);
+    }
+
     const auto ret = device->mount_device->devoptab_open(file->fd, path, flags, mode);
     if (ret) {
         free(file->fd);
@@ -103,6 +291,10 @@ int devoptab_open(struct _reent *r, void *fileStruct, const char *_path, int fla
         return set_errno(r, -ret);
     }
 
+    if (is_write && device->cache.IsEnabled()) {
+        file->path = strdup(path);
+    }
+
     file->device = device;
     return r->_errno = 0;
 }
@@ -110,11 +302,19 @@ int devoptab_open(struct _reent *r, void *fileStruct, const char *_path, int fla
 int devoptab_close(struct _reent *r, void *fd) {
     auto file = static_cast<File*>(fd);
     SCOPED_RWLOCK(&g_rwlock, false);
-    SCOPED_MUTEX(&file->device->mutex);
 
-    if (file->fd) {
-        file->device->mount_device->devoptab_close(file->fd);
-        free(file->fd);
+    {
+        SCOPED_MUTEX(GetFileMutex(file));
+        if (file->fd) {
+            file->device->mount_device->devoptab_close(file->fd);
+            free(file->fd);
+        }
+    }
+
+    if (file->path) {
+        SCOPED_MUTEX(&file->device->mutex);
+        file->device->cache.Invalidate(file->path);
+        free(file->path);
     }
 
     std::memset(file, 0, sizeof(*file));
@@ -124,7 +324,7 @@ int devoptab_close(struct _reent *r, void *fd) {
 ssize_t devoptab_read(struct _reent *r, void *fd, char *ptr, size_t len) {
     auto file = static_cast<File*>(fd);
     SCOPED_RWLOCK(&g_rwlock, false);
-    SCOPED_MUTEX(&file->device->mutex);
+    SCOPED_MUTEX(GetFileMutex(file));
 
     const auto ret = file->device->mount_device->devoptab_read(file->fd, ptr, len);
     if (ret < 0) {
@@ -137,7 +337,7 @@ ssize_t devoptab_read(struct _reent *r, void *fd, char *ptr, size_t len) {
 ssize_t devoptab_write(struct _reent *r, void *fd, const char *ptr, size_t len) {
     auto file = static_cast<File*>(fd);
     SCOPED_RWLOCK(&g_rwlock, false);
-    SCOPED_MUTEX(&file->device->mutex);
+    SCOPED_MUTEX(GetFileMutex(file));
 
     const auto ret = file->device->mount_device->devoptab_write(file->fd, ptr, len);
     if (ret < 0) {
@@ -150,7 +350,7 @@ ssize_t devoptab_write(struct _reent *r, void *fd, const char *ptr, size_t len)
 off_t devoptab_seek(struct _reent *r, void *fd, off_t pos, int dir) {
     auto file = static_cast<File*>(fd);
     SCOPED_RWLOCK(&g_rwlock, false);
-    SCOPED_MUTEX(&file->device->mutex);
+    SCOPED_MUTEX(GetFileMutex(file));
 
     const auto ret = file->device->mount_device->devoptab_seek(file->fd, pos, dir);
     if (ret < 0) {
@@ -166,7 +366,7 @@ int devoptab_fstat(struct _reent *r, void *fd, struct stat *st) {
     auto file = static_cast<File*>(fd);
     std::memset(st, 0, sizeof(*st));
     SCOPED_RWLOCK(&g_rwlock, false);
-    SCOPED_MUTEX(&file->device->mutex);
+    SCOPED_MUTEX(GetFileMutex(file));
 
     const auto ret = file->device->mount_device->devoptab_fstat(file->fd, st);
     if (ret) {
@@ -194,6 +394,7 @@ int devoptab_unlink(struct _reent *r, const char *_path) {
         return set_errno(r, EIO);
     }
 
+    device->cache.Invalidate(path);
     const auto ret = device->mount_device->devoptab_unlink(path);
     if (ret) {
         return set_errno(r, -ret);
@@ -225,6 +426,8 @@ int devoptab_rename(struct _reent *r, const char *_oldName, const char *_newName
         return set_errno(r, EIO);
     }
 
+    device->cache.Invalidate(oldName);
+    device->cache.Invalidate(newName);
     const auto ret = device->mount_device->devoptab_rename(oldName, newName);
     if (ret) {
         return set_errno(r, -ret);
@@ -251,6 +454,7 @@ int devoptab_mkdir(struct _reent *r, const char *_path, int mode) {
         return set_errno(r, EIO);
     }
 
+    device->cache.Invalidate(path);
     const auto ret = device->mount_device->devoptab_mkdir(path, mode);
     if (ret) {
         return set_errno(r, -ret);
@@ -277,6 +481,7 @@ int devoptab_rmdir(struct _reent *r, const char *_path) {
         return set_errno(r, EIO);
     }
 
+    device->cache.Invalidate(path);
     const auto ret = device->mount_device->devoptab_rmdir(path);
     if (ret) {
         return set_errno(r, -ret);
@@ -315,6 +520,15 @@ DIR_ITER* devoptab_diropen(struct _reent *r, DIR_ITER *dirState, const char *_pa
 
     log_write("[DEVOPTAB] diropen mounted\n");
 
+    if (device->cache.IsEnabled()) {
+        if (auto entries = device->cache.GetList(path)) {
+            log_write("[DEVOPTAB] diropen cached: %zu entries\n", entries->size());
+            dir->cached = new CachedDir{path, entries};
+            dir->device = device;
+            return dirState;
+        }
+    }
+
     dir->fd = calloc(1, device->dir_size);
     if (!dir->fd) {
         set_errno(r, ENOMEM);
@@ -333,6 +547,10 @@ DIR_ITER* devoptab_diropen(struct _reent *r, DIR_ITER *dirState, const char *_pa
 
     log_write("[DEVOPTAB] diropen opened dir\n");
 
+    if (device->cache.IsEnabled()) {
+        dir->cached = new CachedDir{path, {}, 0, std::make_shared<CachedDirEntries>()};
+    }
+
     dir->device = device;
     return dirState;
 }
@@ -342,6 +560,17 @@ int devoptab_dirreset(struct _reent *r, DIR_ITER *dirState) {
     SCOPED_RWLOCK(&g_rwlock, false);
     SCOPED_MUTEX(&dir->device->mutex);
 
+    if (dir->cached) {
+        dir->cached->index = 0;
+        if (dir->cached->recording) {
+            dir->cached->recording->clear();
+        }
+
+        if (!dir->fd) {
+            return r->_errno = 0;
+        }
+    }
+
     const auto ret = dir->device->mount_device->devoptab_dirreset(dir->fd);
     if (ret) {
         return set_errno(r, -ret);
@@ -356,7 +585,33 @@ int devoptab_dirnext(struct _reent *r, DIR_ITER *dirState, char *filename, struc
     SCOPED_RWLOCK(&g_rwlock, false);
     SCOPED_MUTEX(&dir->device->mutex);
 
+    auto cached = dir->cached;
+    if (cached && !cached->recording) {
+        if (!cached->entries || cached->index >= cached->entries->size()) {
+            return set_errno(r, ENOENT);
+        }
+
+        const auto& entry = (*cached->entries)[cached->index++];
+        std::strcpy(filename, entry.name.c_str());
+        std::memcpy(filestat, &entry.st, sizeof(*filestat));
+        return r->_errno = 0;
+    }
+
     const auto ret = dir->device->mount_device->devoptab_dirnext(dir->fd, filename, filestat);
+    if (cached) {
+        if (!ret) {
+            cached->recording->push_back({filename, *filestat});
+        } else if (ret == -ENOENT) {
+            // only complete listings are cached.
+            dir->device->cache.SetList(cached->path, cached->recording);
+            cached->entries = std::move(cached->recording);
+            cached->index = cached->entries->size();
+        } else {
+            delete dir->cached;
+            dir->cached = nullptr;
+        }
+    }
+
     if (ret) {
         return set_errno(r, -ret);
     }
@@ -374,6 +629,8 @@ int devoptab_dirclose(struct _reent *r, DIR_ITER *dirState) {
         free(dir->fd);
     }
 
+    delete dir->cached;
+
     std::memset(dir, 0, sizeof(*dir));
     return r->_errno = 0;
 }
@@ -401,7 +658,21 @@ int devoptab_lstat(struct _reent *r, const char *_path, struct stat *st) {
         return set_errno(r, EIO);
     }
 
+    if (device->cache.IsEnabled()) {
+        int ret;
+        if (device->cache.GetStat(path, st, ret, device->mount_device->dirnext_has_full_stat())) {
+            if (ret) {
+                return set_errno(r, -ret);
+            }
+            return r->_errno = 0;
+        }
+    }
+
     const auto ret = device->mount_device->devoptab_lstat(path, st);
+    if (device->cache.IsEnabled()) {
+        device->cache.SetStat(path, st, ret);
+    }
+
     if (ret) {
         return set_errno(r, -ret);
     }
@@ -411,7 +682,14 @@ int devoptab_lstat(struct _reent *r, const char *_path, struct stat *st) {
 
 int devoptab_ftruncate(struct _reent *r, void *fd, off_t len) {
     auto file = static_cast<File*>(fd);
-    SCOPED_MUTEX(&file->device->mutex);
+
+    // the cache is locked by the device mutex, which may also be the file mutex.
+    if (file && file->path) {
+        SCOPED_MUTEX(&file->device->mutex);
+        file->device->cache.Invalidate(file->path);
+    }
+
+    SCOPED_MUTEX(GetFileMutex(file));
 
     if (!file || !file->fd) {
         return set_errno(r, EBADF);
@@ -454,7 +732,7 @@ int devoptab_statvfs(struct _reent *r, const char *_path, struct statvfs *buf) {
 
 int devoptab_fsync(struct _reent *r, void *fd) {
     auto file = static_cast<File*>(fd);
-    SCOPED_MUTEX(&file->device->mutex);
+    SCOPED_MUTEX(GetFileMutex(file));
 
     if (!file || !file->fd) {
         return set_errno(r, EBADF);
@@ -495,6 +773,7 @@ int devoptab_utimes(struct _reent *r, const char *_path, const struct timeval ti
         return set_errno(r, EIO);
     }
 
+    device->cache.Invalidate(path);
     const auto ret = device->mount_device->devoptab_utimes(path, times);
     if (ret) {
         return set_errno(r, -ret);
@@ -762,7 +1041,7 @@ void LoadConfigsFromIni(const fs::FsPath& path, MountConfigs& out_configs) {
 
         // add new entry if use section changed.
         if (e->empty() || std::strcmp(Section, e->back().name.c_str())) {
-            e->emplace_back(Section);
+            e->emplace_back(Section).cache_ttl = METADATA_CACHE_TTL_DEFAULT;
         }
 
         if (!std::strcmp(Key, "url")) {
@@ -792,6 +1071,8 @@ void LoadConfigsFromIni(const fs::FsPath& path, MountConfigs& out_configs) {
             e->back().fs_hidden = ini_parse_getbool(Value, e->back().fs_hidden);
         } else if (!std::strcmp(Key, "dump_hidden")) {
             e->back().dump_hidden = ini_parse_getbool(Value, e->back().dump_hidden);
+        } else if (!std::strcmp(Key, "cache_ttl")) {
+            e->back().cache_ttl = ini_parse_getl(Value, e->back().cache_ttl);
         } else {
             log_write("[DEVOPTAB] INI: extra key %s=%s\n", Key, Value);
             e->back().extra.emplace(Key, Value);
@@ -839,6 +1120,7 @@ bool MountNetworkDevice2(std::unique_ptr<MountDevice>&& device, const MountConfi
     entry->device.file_size = file_size;
     entry->device.dir_size = dir_size;
     entry->device.config = config;
+    entry->device.cache.Init(config.cache_ttl);
 
     if (!entry->device.mount_device) {
         log_write("[DEVOPTAB] Failed to create device for %s\n", config.url.c_str());
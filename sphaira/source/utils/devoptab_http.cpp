@@ -14,6 +14,7 @@
 #include <memory>
 #include <cstring>
 #include <optional>
+#include <atomic>
 #include <sys/stat.h>
 
 namespace sphaira::devoptab {
@@ -31,13 +32,62 @@ using DirEntries = std::vector<DirEntry>;
 struct FileEntry {
     std::string path{};
     struct stat st{};
+    // built on open, as building the url uses the device's curl url handle.
+    std::string url{};
+};
+
+// random reads are served from a cache of blocks, which are fetched with range requests.
+constexpr size_t BLOCK_SIZE = 1024 * 64;
+constexpr size_t CACHE_BLOCKS = 32;
+// max number of blocks fetched in a single request, doubles on each sequential miss.
+constexpr size_t READAHEAD_MAX = 16;
+// once this much has been read sequentially, switch to a single streaming request.
+constexpr size_t STREAM_THRESHOLD = 1024 * 1024 * 2;
+
+struct CacheBlock {
+    std::vector<char> data{};
+    size_t off{};
+    size_t size{};
+};
+
+struct FileCache {
+    FileCache() {
+        blocks.resize(CACHE_BLOCKS);
+        lru.Init(blocks);
+    }
+
+    auto Find(size_t off) -> CacheBlock* {
+        for (auto list = lru.begin(); list; list = list->next) {
+            auto block = list->data;
+            if (block->size && off >= block->off && off < block->off + block->size) {
+                lru.Update(list);
+                return block;
+            }
+        }
+
+        return nullptr;
+    }
+
+    std::vector<CacheBlock> blocks{};
+    utils::Lru<CacheBlock> lru{};
+    size_t readahead{1};
 };
 
 struct File {
     FileEntry* entry;
     common::PushPullThreadData* push_pull_thread_data;
+    FileCache* cache;
+    // each file has its own handles so that files can be read at the same time.
+    // connections are still shared between them.
+    CURL* curl;
+    CURL* stream_curl;
     size_t off;
+    // offset the stream will return data from next.
+    size_t stream_off;
+    // end of the last read, used to detect sequential reads.
     size_t last_off;
+    // number of bytes read sequentially since the last seek.
+    size_t sequential;
 };
 
 struct Dir {
@@ -49,6 +99,10 @@ struct Device final : common::MountCurlDevice {
     using MountCurlDevice::MountCurlDevice;
 
 private:
+    bool supports_concurrent_files() const override {
+        return true;
+    }
+
     bool Mount() override;
     int devoptab_open(void *fileStruct, const char *path, int flags, int mode) override;
     int devoptab_close(void *fd) override;
@@ -63,8 +117,18 @@ private:
 
     int http_dirlist(const std::string& path, DirEntries& out);
     int http_stat(const std::string& path, struct stat* st, bool is_dir);
+    int http_read_range(File* file, size_t off);
+    int http_start_stream(File* file);
 
 private:
+    enum class RangeSupport {
+        Unknown,
+        Supported,
+        Unsupported,
+    };
+
+    // set on the first range request, as not all servers send accept-ranges.
+    std::atomic<RangeSupport> range_support{};
     bool mounted{};
 };
 
@@ -268,6 +332,114 @@ int Device::http_stat(const std::string& path, struct stat* st, bool is_dir) {
     return 0;
 }
 
+// fetches blocks starting from the block containing off, into the cache.
+int Device::http_read_range(File* file, size_t off) {
+    auto& cache = *file->cache;
+    const auto file_size = (size_t)file->entry->st.st_size;
+    off -= off % BLOCK_SIZE;
+
+    // stop at the first block that's already cached.
+    size_t count = 0;
+    while (count < cache.readahead && off + count * BLOCK_SIZE < file_size && !cache.Find(off + count * BLOCK_SIZE)) {
+        count++;
+    }
+
+    const auto size = std::min(count * BLOCK_SIZE, file_size - off);
+
+    struct RangeData {
+        CURL* curl;
+        std::vector<CacheBlock*> blocks;
+        size_t size;
+        size_t written;
+        bool checked_code;
+        bool unsupported;
+    } data{file->curl, {}, size};
+
+    for (size_t i = 0; i < count; i++) {
+        auto block = cache.lru.GetNextFree();
+        block->data.resize(BLOCK_SIZE);
+        block->off = off + i * BLOCK_SIZE;
+        block->size = 0;
+        data.blocks.emplace_back(block);
+    }
+
+    const auto write_callback = [](char *ptr, size_t size, size_t nmemb, void *userdata) -> size_t {
+        auto data = static_cast<RangeData*>(userdata);
+        const auto realsize = size * nmemb;
+
+        // servers that don't support ranges reply with the entire file.
+        if (!data->checked_code) {
+            long response_code = 0;
+            curl_easy_getinfo(data->curl, CURLINFO_RESPONSE_CODE, &response_code);
+            if (response_code != 206) {
+                data->unsupported = response_code == 200;
+                return 0;
+            }
+            data->checked_code = true;
+        }
+
+        if (data->written + realsize > data->size) {
+            return 0;
+        }
+
+        for (size_t i = 0; i < realsize;) {
+            const auto block_off = data->written % BLOCK_SIZE;
+            const auto rsize = std::min(realsize - i, BLOCK_SIZE - block_off);
+            std::memcpy(data->blocks[data->written / BLOCK_SIZE]->data.data() + block_off, ptr + i, rsize);
+            data->written += rsize;
+            i += rsize;
+        }
+
+        return realsize;
+    };
+
+    char range[64];
+    std::snprintf(range, sizeof(range), "%zu-%zu", off, off + size - 1);
+
+    // uses the same handle for every request, so the connection is kept alive.
+    curl_set_common_options(file->curl, file->entry->url);
+    // ranges apply to the encoded data, so ask for the file as is.
+    curl_easy_setopt(file->curl, CURLOPT_ACCEPT_ENCODING, nullptr);
+    curl_easy_setopt(file->curl, CURLOPT_RANGE, range);
+    curl_easy_setopt(file->curl, CURLOPT_WRITEFUNCTION, +write_callback);
+    curl_easy_setopt(file->curl, CURLOPT_WRITEDATA, (void *)&data);
+
+    const auto res = curl_easy_perform(file->curl);
+
+    if (data.unsupported) {
+        log_write("[HTTP] Server does not support range requests\n");
+        range_support = RangeSupport::Unsupported;
+        return -ENOTSUP;
+    }
+
+    if (res != CURLE_OK || data.written != size) {
+        log_write("[HTTP] Range request %s failed: %s\n", range, curl_easy_strerror(res));
+        return -EIO;
+    }
+
+    range_support = RangeSupport::Supported;
+    for (size_t i = 0; i < count; i++) {
+        data.blocks[i]->size = std::min(BLOCK_SIZE, size - i * BLOCK_SIZE);
+    }
+
+    return 0;
+}
+
+int Device::http_start_stream(File* file) {
+    delete file->push_pull_thread_data;
+    file->push_pull_thread_data = nullptr;
+
+    log_write("[HTTP] Creating download thread data for file: %s offset: %zu\n", file->entry->path.c_str(), file->off);
+    file->push_pull_thread_data = CreatePushData(file->stream_curl, file->entry->url, file->off);
+    if (!file->push_pull_thread_data) {
+        log_write("[HTTP] Failed to create download thread data for file: %s\n", file->entry->path.c_str());
+        return -EIO;
+    }
+
+    file->stream_off = file->off;
+    return 0;
+}
+
 bool Device::Mount() {
     if (mounted) {
         return true;
@@ -277,9 +449,6 @@ bool Device::Mount() {
         return false;
     }
 
-    // todo: query server with OPTIONS to see if it supports range requests.
-    // todo: see ftp for example.
-
     return mounted = true;
 }
 
@@ -298,7 +467,16 @@ int Device::devoptab_open(void *fileStruct, const char *path, int flags, int mod
         return -EISDIR;
     }
 
-    file->entry = new FileEntry{path, st};
+    file->curl = curl_easy_init();
+    file->stream_curl = curl_easy_init();
+    if (!file->curl || !file->stream_curl) {
+        log_write("[HTTP] curl_easy_init() failed for file: %s\n", path);
+        devoptab_close(file);
+        return -ENOMEM;
+    }
+
+    file->entry = new FileEntry{path, st, build_url(path, false)};
+    file->cache = new FileCache();
     return 0;
 }
 
@@ -306,12 +484,23 @@ int Device::devoptab_close(void *fd) {
     auto file = static_cast<File*>(fd);
 
     delete file->push_pull_thread_data;
+    delete file->cache;
     delete file->entry;
+
+    if (file->stream_curl) {
+        curl_easy_cleanup(file->stream_curl);
+    }
+
+    if (file->curl) {
+        curl_easy_cleanup(file->curl);
+    }
+
     return 0;
 }
 
 ssize_t Device::devoptab_read(void *fd, char *ptr, size_t len) {
     auto file = static_cast<File*>(fd);
+    auto& cache = *file->cache;
     len = std::min(len, file->entry->st.st_size - file->off);
 
     if (!len) {
@@ -319,26 +508,71 @@ ssize_t Device::devoptab_read(void *fd, char *ptr, size_t len) {
     }
 
     if (file->off != file->last_off) {
-        log_write("[HTTP] File offset changed from %zu to %zu, resetting download thread\n", file->last_off, file->off);
-        file->last_off = file->off;
-        delete file->push_pull_thread_data;
-        file->push_pull_thread_data = nullptr;
+        file->sequential = 0;
+        cache.readahead = 1;
     }
 
-    if (!file->push_pull_thread_data) {
-        log_write("[HTTP] Creating download thread data for file: %s\n", file->entry->path.c_str());
-        file->push_pull_thread_data = CreatePushData(this->transfer_curl, build_url(file->entry->path, false), file->off);
-        if (!file->push_pull_thread_data) {
-            log_write("[HTTP] Failed to create download thread data for file: %s\n", file->entry->path.c_str());
-            return -EIO;
+    size_t total = 0;
+    while (len) {
+        // the stream is left open on seek, so that it can be continued if the
+        // reads come back to it, such as after reading a header at the end of the file.
+        if (file->push_pull_thread_data && file->stream_off == file->off) {
+            const auto ret = file->push_pull_thread_data->PullData(ptr, len);
+            if (!ret) {
+                log_write("[HTTP] Stream ended at: %zu\n", file->off);
+                delete file->push_pull_thread_data;
+                file->push_pull_thread_data = nullptr;
+                file->sequential = 0;
+                if (range_support != RangeSupport::Supported) {
+                    break;
+                }
+                continue;
+            }
+
+            file->stream_off += ret;
+            file->off += ret;
+            ptr += ret;
+            len -= ret;
+            total += ret;
+            continue;
+        }
+
+        if (auto block = cache.Find(file->off)) {
+            const auto block_off = file->off - block->off;
+            const auto size = std::min(len, block->size - block_off);
+            std::memcpy(ptr, block->data.data() + block_off, size);
+
+            file->off += size;
+            ptr += size;
+            len -= size;
+            total += size;
+            continue;
         }
-    }
 
-    const auto ret = file->push_pull_thread_data->PullData(ptr, len);
+        // long sequential reads are faster as a single request.
+        if (range_support == RangeSupport::Unsupported || file->sequential + total >= STREAM_THRESHOLD) {
+            if (const auto ret = http_start_stream(file); ret < 0) {
+                return total ? total : ret;
+            }
+            continue;
+        }
+
+        // fetch more blocks at a time while the reads are sequential.
+        if (file->sequential + total) {
+            cache.readahead = std::min(cache.readahead * 2, READAHEAD_MAX);
+        }
+
+        if (const auto ret = http_read_range(file, file->off); ret < 0) {
+            if (ret == -ENOTSUP) {
+                continue;
+            }
+            return total ? total : ret;
+        }
+    }
 
-    file->off += ret;
+    file->sequential += total;
     file->last_off = file->off;
-    return ret;
+    return total;
 }
 
 ssize_t Device::devoptab_seek(void *fd, off_t pos, int dir) {
@@ -375,10 +375,14 @@ Result MountNcaInternal(fs::Fs* fs, const std::shared_ptr<yati::source::Base>& s
 
         // create nca reader which will handle decryption for us.
         // create a LRU buffer cache as the source in order to reduce small reads.
-        nca_reader = std::make_unique<nca::NcaReader>(
+        auto reader = std::make_unique<nca::NcaReader>(
             header, &title_key, size,
             std::make_shared<common::LruBufferedData>(source, size)
         );
+
+        // catch corrupted data on read rather than returning garbage.
+        reader->SetVerify(true);
+        nca_reader = std::move(reader);
     }
 
     std::vector<NamedCollection> collections{};
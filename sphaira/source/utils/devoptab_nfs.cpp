@@ -18,6 +18,10 @@ struct Device final : common::MountDevice {
     ~Device();
 
 private:
+    bool dirnext_has_full_stat() const override {
+        return true;
+    }
+
     bool Mount() override;
     int devoptab_open(void *fileStruct, const char *path, int flags, int mode) override;
     int devoptab_close(void *fd) override;
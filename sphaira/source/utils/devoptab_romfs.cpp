@@ -10,87 +10,129 @@
 namespace sphaira::devoptab::romfs {
 namespace {
 
-auto find_romfs_relative_dir(const RomfsCollection& romfs, std::string_view path) -> const romfs_dir* {
-    if (path.starts_with('/')) {
-        path = path.substr(1);
+constexpr u32 ROMFS_NONE = ~0U;
+
+// same hash as used by nintendo (and libnx).
+auto calc_hash(u32 parent, std::string_view name, u32 total) -> u32 {
+    u32 hash = parent ^ 123456789;
+    for (const auto c : name) {
+        hash = (hash >> 5) | (hash << 27);
+        hash ^= (u8)c;
     }
+    return hash % total;
+}
 
-    const auto root = (const romfs_dir*)romfs.dir_table.data();
-    const auto rel_index = path.find_last_of('/');
-    path = path.substr(0, rel_index);
+auto get_romfs_dir(const RomfsCollection& romfs, u32 off) -> const romfs_dir* {
+    if (off == ROMFS_NONE || off + sizeof(romfs_dir) > romfs.dir_table.size()) {
+        return nullptr;
+    }
+    return (const romfs_dir*)(romfs.dir_table.data() + off);
+}
 
-    if (rel_index == path.npos) {
-        return root;
+auto get_romfs_file(const RomfsCollection& romfs, u32 off) -> const romfs_file* {
+    if (off == ROMFS_NONE || off + sizeof(romfs_file) > romfs.file_table.size()) {
+        return nullptr;
     }
+    return (const romfs_file*)(romfs.file_table.data() + off);
+}
 
-    u32 childDir = root->childDir;
-    while (path.length() && (childDir != ~0)) {
-        const auto sub = path.substr(0, path.find_first_of('/'));
-        const auto dir = (const romfs_dir*)(romfs.dir_table.data() + childDir);
+auto get_romfs_dir_offset(const RomfsCollection& romfs, const romfs_dir* dir) -> u32 {
+    return (const u8*)dir - romfs.dir_table.data();
+}
+
+template<typename T>
+auto is_name_equal(const T* entry, std::string_view name) -> bool {
+    return entry->nameLen == name.length() && !std::memcmp(name.data(), entry->name, entry->nameLen);
+}
+
+auto find_romfs_child_dir(const RomfsCollection& romfs, const romfs_dir* parent, std::string_view name) -> const romfs_dir* {
+    const auto parent_off = get_romfs_dir_offset(romfs, parent);
 
-        if (dir->nameLen == sub.length() && !std::memcmp(sub.data(), dir->name, dir->nameLen)) {
-            if (path == sub) {
+    // use the hash table if we have it, otherwise walk all siblings.
+    if (!romfs.dir_hash_table.empty()) {
+        const auto hash = calc_hash(parent_off, name, romfs.dir_hash_table.size());
+        for (auto dir = get_romfs_dir(romfs, romfs.dir_hash_table[hash]); dir; dir = get_romfs_dir(romfs, dir->nextHash)) {
+            if (dir->parent == parent_off && is_name_equal(dir, name)) {
+                return dir; // bingo
+            }
+        }
+    } else {
+        for (auto dir = get_romfs_dir(romfs, parent->childDir); dir; dir = get_romfs_dir(romfs, dir->sibling)) {
+            if (is_name_equal(dir, name)) {
                 return dir; // bingo
-            } else {
-                childDir = dir->childDir;
-                path = path.substr(sub.length() + 1);
             }
-        } else {
-            childDir = dir->sibling;
         }
     }
 
     return nullptr;
 }
 
-auto find_romfs_dir(const romfs_dir* parent, const RomfsCollection& romfs, std::string_view path) -> const romfs_dir* {
-    if (path.starts_with('/')) {
-        path = path.substr(1);
-    }
-
-    if (!path.length()) {
-        return parent;
-    }
-
-    if (auto idx = path.find_last_of('/'); idx != path.npos) {
-        path = path.substr(idx + 1);
-    }
+auto find_romfs_child_file(const RomfsCollection& romfs, const romfs_dir* parent, std::string_view name) -> const romfs_file* {
+    const auto parent_off = get_romfs_dir_offset(romfs, parent);
 
-    u32 childDir = parent->childDir;
-    while (path.length() && (childDir != ~0)) {
-        const auto dir = (const romfs_dir*)(romfs.dir_table.data() + childDir);
-
-        if (dir->nameLen == path.length() && !std::memcmp(path.data(), dir->name, dir->nameLen)) {
-            return dir; // bingo
-        } else {
-            childDir = dir->sibling;
+    if (!romfs.file_hash_table.empty()) {
+        const auto hash = calc_hash(parent_off, name, romfs.file_hash_table.size());
+        for (auto file = get_romfs_file(romfs, romfs.file_hash_table[hash]); file; file = get_romfs_file(romfs, file->nextHash)) {
+            if (file->parent == parent_off && is_name_equal(file, name)) {
+                return file; // bingo
+            }
+        }
+    } else {
+        for (auto file = get_romfs_file(romfs, parent->childFile); file; file = get_romfs_file(romfs, file->sibling)) {
+            if (is_name_equal(file, name)) {
+                return file; // bingo
+            }
         }
     }
 
     return nullptr;
 }
 
-auto find_romfs_file(const romfs_dir* parent, const RomfsCollection& romfs, std::string_view path) -> const romfs_file* {
+// returns the parent dir of the last component in the path.
+auto find_romfs_relative_dir(const RomfsCollection& romfs, std::string_view path) -> const romfs_dir* {
     if (path.starts_with('/')) {
         path = path.substr(1);
     }
 
+    auto dir = get_romfs_dir(romfs, 0);
+    const auto rel_index = path.find_last_of('/');
+    if (rel_index == path.npos) {
+        return dir;
+    }
+
+    path = path.substr(0, rel_index);
+    while (dir && path.length()) {
+        const auto sub = path.substr(0, path.find_first_of('/'));
+        dir = find_romfs_child_dir(romfs, dir, sub);
+        path = path.substr(std::min(sub.length() + 1, path.length()));
+    }
+
+    return dir;
+}
+
+auto get_last_path_component(std::string_view path) -> std::string_view {
     if (auto idx = path.find_last_of('/'); idx != path.npos) {
         path = path.substr(idx + 1);
     }
+    return path;
+}
 
-    u32 childFile = parent->childFile;
-    while (path.length() && (childFile != ~0)) {
-        const auto file = (const romfs_file*)(romfs.file_table.data() + childFile);
+auto find_romfs_dir(const romfs_dir* parent, const RomfsCollection& romfs, std::string_view path) -> const romfs_dir* {
+    const auto name = get_last_path_component(path);
+    if (!name.length()) {
+        return parent;
+    }
 
-        if (file->nameLen == path.length() && !std::memcmp(path.data(), file->name, file->nameLen)) {
-            return file; // bingo
-        } else {
-            childFile = file->sibling;
-        }
+    return find_romfs_child_dir(romfs, parent, name);
+}
+
+auto find_romfs_file(const romfs_dir* parent, const RomfsCollection& romfs, std::string_view path) -> const romfs_file* {
+    const auto name = get_last_path_component(path);
+    if (!name.length()) {
+        return nullptr;
     }
 
-    return nullptr;
+    return find_romfs_child_file(romfs, parent, name);
 }
 
 } // namespace
@@ -186,6 +228,18 @@ Result LoadRomfsCollection(yati::source::Base* source, u64 offset, RomfsCollecti
 
     log_write("read romfs file\n");
 
+    // the hash tables are optional, lookups fallback to walking the siblings if missing.
+    const auto load_hash_table = [&](std::vector<u32>& table, u64 off, u64 size) {
+        table.resize(size / sizeof(u32));
+        if (!table.empty() && R_FAILED(source->Read2(table.data(), out.offset + off, table.size() * sizeof(u32)))) {
+            log_write("[RomFS] failed to read hash table\n");
+            table.clear();
+        }
+    };
+
+    load_hash_table(out.dir_hash_table, out.header.dirHashTableOff, out.header.dirHashTableSize);
+    load_hash_table(out.file_hash_table, out.header.fileHashTableOff, out.header.fileHashTableSize);
+
     R_SUCCEED();
 }
 
@@ -23,6 +23,10 @@ private:
         return common::fix_path(str, out, true);
     }
 
+    bool dirnext_has_full_stat() const override {
+        return true;
+    }
+
     bool Mount() override;
     int devoptab_open(void *fileStruct, const char *path, int flags, int mode) override;
     int devoptab_close(void *fd) override;
@@ -29,6 +29,11 @@ private:
         return true;
     }
 
+    // each file is its own fd on the underlying device.
+    bool supports_concurrent_files() const override {
+        return true;
+    }
+
     bool Mount() override;
     int devoptab_open(void *fileStruct, const char *path, int flags, int mode) override;
     int devoptab_close(void *fd) override;
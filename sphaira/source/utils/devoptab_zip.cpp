@@ -10,6 +10,8 @@
 #include <array>
 #include <memory>
 #include <algorithm>
+#include <iterator>
+#include <unordered_map>
 #include <zlib.h>
 
 namespace sphaira::devoptab {
@@ -112,11 +114,52 @@ struct DirectoryEntry {
 
 using FileTableEntries = std::vector<FileEntry>;
 
+// add a seek checkpoint every 1MiB of output.
+constexpr u64 CHECKPOINT_SPAN_MIN = 1024 * 1024;
+// limits windows to 8MiB per file, the span is increased for larger files.
+constexpr u64 CHECKPOINT_MAX = 256;
+// max size of the deflate window.
+constexpr u32 CHECKPOINT_WINDOW_SIZE = 1024 * 32;
+
+// a point in the deflate stream that inflate can be restarted from (see zran.c).
+struct Checkpoint {
+    u64 out_off; // uncompressed offset.
+    u64 in_off; // compressed offset of the first full byte.
+    u8 bits; // number of bits of the previous byte that belong to this block.
+    std::vector<u8> window; // the last 32k of output before this point.
+};
+
+// checkpoints are added lazily whilst inflating, in stream order.
+struct SeekIndex {
+    std::vector<Checkpoint> points;
+    u64 span; // minimum distance between checkpoints.
+    u32 refs{}; // open files using this index, it is freed on the last close.
+
+    explicit SeekIndex(u64 uncompressed_size) {
+        // scale the span for large files to cap the memory used by windows.
+        span = std::max(CHECKPOINT_SPAN_MIN, (uncompressed_size + CHECKPOINT_MAX - 1) / CHECKPOINT_MAX);
+        // the start of the stream needs no window.
+        points.push_back({});
+    }
+
+    // returns the closest checkpoint at or before off.
+    auto Find(u64 off) const -> const Checkpoint& {
+        const auto it = std::ranges::upper_bound(points, off, {}, &Checkpoint::out_off);
+        return *std::prev(it);
+    }
+
+    auto ShouldAdd(u64 off) const -> bool {
+        return off >= points.back().out_off + span;
+    }
+};
+
 struct Zfile {
     z_stream z; // zlib stream.
     Bytef* buffer; // buffer that compressed data is read into.
     size_t buffer_size; // size of the above buffer.
     size_t compressed_off; // offset of the compressed file.
+    size_t uncompressed_off; // offset of the inflate output, may differ from File::off after a seek.
+    SeekIndex* index; // owned by the device, see Device::indexes.
 };
 
 struct File {
@@ -207,11 +250,138 @@ private:
     int devoptab_dirclose(void* fd) override;
     int devoptab_lstat(const char *path, struct stat *st) override;
 
+    auto inflate_restore(File* file, const Checkpoint& point) -> int;
+    auto inflate_data(File* file, void* buf, size_t len) -> ssize_t;
+    auto inflate_seek(File* file) -> int;
+
 private:
     std::unique_ptr<common::LruBufferedData> source;
     const DirectoryEntry root;
+    // seek indexes are shared between open files of the same entry, keyed by local header offset.
+    // each can be up to CHECKPOINT_MAX windows (8MiB), so they are freed when the last file closes.
+    std::unordered_map<u32, std::unique_ptr<SeekIndex>> indexes;
 };
 
+auto Device::inflate_restore(File* file, const Checkpoint& point) -> int {
+    auto& zfile = file->zfile;
+
+    if (Z_OK != inflateReset(&zfile.z)) {
+        return -EIO;
+    }
+
+    zfile.z.next_in = nullptr;
+    zfile.z.avail_in = 0;
+    zfile.compressed_off = point.in_off;
+    zfile.uncompressed_off = point.out_off;
+
+    // the block may start part way into the previous byte.
+    if (point.bits) {
+        u8 byte;
+        if (R_FAILED(this->source->Read2(&byte, file->data_off + point.in_off - 1, sizeof(byte)))) {
+            return -EIO;
+        }
+
+        if (Z_OK != inflatePrime(&zfile.z, point.bits, byte >> (8 - point.bits))) {
+            return -EIO;
+        }
+    }
+
+    if (!point.window.empty()) {
+        if (Z_OK != inflateSetDictionary(&zfile.z, point.window.data(), point.window.size())) {
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+auto Device::inflate_data(File* file, void* buf, size_t len) -> ssize_t {
+    auto& zfile = file->zfile;
+    auto index = zfile.index;
+    zfile.z.next_out = (Bytef*)buf;
+    zfile.z.avail_out = len;
+
+    // run until we have inflated enough data.
+    while (zfile.z.avail_out) {
+        // check if we need to fetch more data.
+        if (!zfile.z.next_in || !zfile.z.avail_in) {
+            const auto clen = std::min(zfile.buffer_size, file->entry->compressed_size - zfile.compressed_off);
+            if (!clen) {
+                log_write("[ZLIB] unexpected end of compressed data\n");
+                return -EIO;
+            }
+
+            if (R_FAILED(this->source->Read2(zfile.buffer, file->data_off + zfile.compressed_off, clen))) {
+                return -ENOENT;
+            }
+
+            zfile.compressed_off += clen;
+            zfile.z.next_in = zfile.buffer;
+            zfile.z.avail_in = clen;
+        }
+
+        // stop at the end of each block so that checkpoints can be added.
+        const auto avail_out = zfile.z.avail_out;
+        const auto rc = inflate(&zfile.z, Z_BLOCK);
+        zfile.uncompressed_off += avail_out - zfile.z.avail_out;
+
+        if (Z_STREAM_END == rc) {
+            len -= zfile.z.avail_out;
+            break;
+        } else if (Z_OK != rc) {
+            log_write("[ZLIB] failed to inflate: %d %s\n", rc, zfile.z.msg);
+            return -ENOENT;
+        }
+
+        // bit 7 is set at the end of a block, bit 6 if it was the last block.
+        if ((zfile.z.data_type & 128) && !(zfile.z.data_type & 64) && index->ShouldAdd(zfile.uncompressed_off)) {
+            Checkpoint point{};
+            point.out_off = zfile.uncompressed_off;
+            point.in_off = zfile.compressed_off - zfile.z.avail_in;
+            point.bits = zfile.z.data_type & 7;
+            point.window.resize(CHECKPOINT_WINDOW_SIZE);
+
+            uInt window_size = point.window.size();
+            if (Z_OK == inflateGetDictionary(&zfile.z, point.window.data(), &window_size)) {
+                point.window.resize(window_size);
+                index->points.emplace_back(std::move(point));
+            }
+        }
+    }
+
+    return len;
+}
+
+auto Device::inflate_seek(File* file) -> int {
+    auto& zfile = file->zfile;
+    if (file->off == zfile.uncompressed_off) {
+        return 0;
+    }
+
+    // restart from the closest checkpoint if seeking backwards or if it
+    // saves inflating data that we'd otherwise skip.
+    const auto& point = zfile.index->Find(file->off);
+    if (file->off < zfile.uncompressed_off || point.out_off > zfile.uncompressed_off) {
+        if (const auto rc = inflate_restore(file, point)) {
+            return rc;
+        }
+    }
+
+    // inflate and discard up to the requested offset.
+    std::vector<u8> skip_buf(std::min<u64>(zfile.buffer_size, file->off - zfile.uncompressed_off));
+    while (zfile.uncompressed_off < file->off) {
+        const auto size = std::min<u64>(skip_buf.size(), file->off - zfile.uncompressed_off);
+        const auto rc = inflate_data(file, skip_buf.data(), size);
+        if (rc < 0) {
+            return rc;
+        } else if (!rc) {
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
 int Device::devoptab_open(void *fileStruct, const char *path, int flags, int mode) {
     auto file = static_cast<File*>(fileStruct);
 
@@ -270,6 +440,13 @@ int Device::devoptab_open(void *fileStruct, const char *path, int flags, int mod
             zfile.buffer = nullptr;
             return -ENOENT;
         }
+
+        auto& index = this->indexes[entry->local_file_header_off];
+        if (!index) {
+            index = std::make_unique<SeekIndex>(entry->uncompressed_size);
+        }
+        zfile.index = index.get();
+        zfile.index->refs++;
     }
 
     file->entry = entry;
@@ -286,6 +463,10 @@ int Device::devoptab_close(void *fd) {
         if (file->zfile.buffer) {
             std::free(file->zfile.buffer);
         }
+
+        if (!--file->zfile.index->refs) {
+            this->indexes.erase(file->entry->local_file_header_off);
+        }
     }
 
     return 0;
@@ -304,34 +485,15 @@ ssize_t Device::devoptab_read(void *fd, char *ptr, size_t len) {
             return -ENOENT;
         }
     } else if (file->entry->compression_type == mmz_Compression_Deflate) {
-        auto& zfile = file->zfile;
-        zfile.z.next_out = (Bytef*)ptr;
-        zfile.z.avail_out = len;
-
-        // run until we have inflated enough data.
-        while (zfile.z.avail_out) {
-            // check if we need to fetch more data.
-            if (!zfile.z.next_in || !zfile.z.avail_in) {
-                const auto clen = std::min(zfile.buffer_size, file->entry->compressed_size - zfile.compressed_off);
-                if (R_FAILED(this->source->Read2(zfile.buffer, file->data_off + zfile.compressed_off, clen))) {
-                    return -ENOENT;
-                }
-
-                zfile.compressed_off += clen;
-                zfile.z.next_in = zfile.buffer;
-                zfile.z.avail_in = clen;
-            }
+        if (const auto rc = inflate_seek(file)) {
+            return rc;
+        }
 
-            const auto rc = inflate(&zfile.z, Z_SYNC_FLUSH);
-            if (Z_OK != rc) {
-                if (Z_STREAM_END == rc) {
-                    len -= zfile.z.avail_out;
-                } else {
-                    log_write("[ZLIB] failed to inflate: %d %s\n", rc, zfile.z.msg);
-                    return -ENOENT;
-                }
-            }
+        const auto rc = inflate_data(file, ptr, len);
+        if (rc < 0) {
+            return rc;
         }
+        len = rc;
     }
 
     file->off += len;
@@ -341,32 +503,11 @@ ssize_t Device::devoptab_read(void *fd, char *ptr, size_t len) {
 ssize_t Device::devoptab_seek(void *fd, off_t pos, int dir) {
     auto file = static_cast<File*>(fd);
 
-    // seek like normal.
-    if (file->entry->compression_type == mmz_Compression_None) {
-        if (dir == SEEK_CUR) {
-            pos += file->off;
-        } else if (dir == SEEK_END) {
-            pos = file->entry->uncompressed_size;
-        }
-    } else if (file->entry->compression_type == mmz_Compression_Deflate) {
-        // limited seek options.
-        // todo: support seeking to end and then back to orig position.
-        if (dir == SEEK_SET) {
-            if (pos == 0) {
-                inflateReset(&file->zfile.z);
-            } else if (pos != file->off) {
-                // seeking to the end is fine as it may be used to calc size.
-                if (pos != file->entry->uncompressed_size) {
-                    // random access seek is not supported.
-                    pos = file->off;
-                }
-            }
-        } else if (dir == SEEK_CUR) {
-            // random access seek is not supported.
-            pos = file->off;
-        } else if (dir == SEEK_END) {
-            pos = file->entry->uncompressed_size;
-        }
+    // compressed files are inflated up to the offset on the next read.
+    if (dir == SEEK_CUR) {
+        pos += file->off;
+    } else if (dir == SEEK_END) {
+        pos = file->entry->uncompressed_size;
     }
 
     return file->off = std::clamp<u64>(pos, 0, file->entry->uncompressed_size);
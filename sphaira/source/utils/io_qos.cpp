@@ -0,0 +1,77 @@
+#include "utils/io_qos.hpp"
+#include "defines.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+
+namespace sphaira::utils::qos {
+namespace {
+
+struct DeviceState {
+    Mutex mutex{};
+    TokenBucket bucket{};
+};
+
+DeviceState g_devices[Device_Count][Direction_Count]{};
+
+auto GetTimeNs() -> u64 {
+    return armTicksToNs(armGetSystemTick());
+}
+
+} // namespace
+
+void TokenBucket::SetBudget(const Budget& budget, u64 now) {
+    m_budget = budget;
+    m_tat = now;
+}
+
+auto TokenBucket::Reserve(u64 now, s64 size, Priority priority) -> u64 {
+    if (m_budget.rate <= 0 || size <= 0) {
+        return 0;
+    }
+
+    const auto cost = u64(size) * 1'000'000'000ULL / m_budget.rate;
+    const auto burst = u64(std::max<s64>(m_budget.burst, 0)) * 1'000'000'000ULL / m_budget.rate;
+
+    // unused budget does not carry over past the burst.
+    m_tat = std::max(m_tat, now);
+
+    // this io is included, otherwise one extra request gets through on top of the burst.
+    m_tat += cost;
+
+    // the cost is paid by the bulk io that reserves after it.
+    if (priority == Priority_Foreground) {
+        return 0;
+    }
+
+    u64 wait = 0;
+    if (m_tat > now + burst) {
+        wait = m_tat - burst - now;
+    }
+
+    return wait;
+}
+
+void SetBudget(Device device, Direction direction, const Budget& budget) {
+    log_write("[QOS] device: %u direction: %u rate: %zd burst: %zd\n", device, direction, budget.rate, budget.burst);
+
+    auto& e = g_devices[device][direction];
+    SCOPED_MUTEX(&e.mutex);
+    e.bucket.SetBudget(budget, GetTimeNs());
+}
+
+void Acquire(Device device, Direction direction, Priority priority, s64 size) {
+    auto& e = g_devices[device][direction];
+    u64 wait;
+
+    {
+        SCOPED_MUTEX(&e.mutex);
+        wait = e.bucket.Reserve(GetTimeNs(), size, priority);
+    }
+
+    if (wait) {
+        svcSleepThread(wait);
+    }
+}
+
+} // namespace sphaira::utils::qos
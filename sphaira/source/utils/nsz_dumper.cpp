@@ -10,6 +10,7 @@
 #include "image.hpp"
 #include "swkbd.hpp"
 #include "threaded_file_transfer.hpp"
+#include "utils/thread.hpp"
 
 #include "yati/nx/ncm.hpp"
 #include "yati/nx/nca.hpp"
@@ -21,6 +22,8 @@
 #include <utility>
 #include <cstring>
 #include <algorithm>
+#include <functional>
+#include <span>
 #include <minIni.h>
 #include <zstd.h>
 
@@ -35,6 +38,264 @@ struct NszInfo {
     u8 block_exponent;
 };
 
+// max memory used by the block slots (in + out buffer).
+constexpr u64 BLOCK_COMPRESSOR_MEMORY_MAX = 1024 * 1024 * 64;
+
+// compresses ncz blocks in parallel, each worker owns its own zstd context.
+// blocks are submitted in order and flushed in the same order, so the caller
+// sees the same output as compressing each block one at a time.
+struct BlockCompressor final {
+    using FlushCallback = std::function<Result(std::span<const u8> data)>;
+
+    ~BlockCompressor();
+
+    Result Create(u32 workers, int level, bool ldm, u64 block_size);
+
+    // copies data into the current block, submitting it once full.
+    Result Write(const void* data, s64 size, const FlushCallback& callback);
+    // submits the partial block (if any) and flushes all pending blocks.
+    Result Finish(const FlushCallback& callback);
+
+private:
+    struct Slot {
+        std::vector<u8> in{};
+        std::vector<u8> out{};
+        std::span<const u8> output{};
+        Result rc{};
+        bool done{};
+    };
+
+    struct Worker {
+        BlockCompressor* self{};
+        ZSTD_CCtx* cctx{};
+        Thread thread{};
+        bool created{};
+    };
+
+    Result Acquire(const FlushCallback& callback);
+    void Submit();
+    Result FlushOne(const FlushCallback& callback);
+    Result FlushReady(const FlushCallback& callback);
+
+    void Compress(ZSTD_CCtx* cctx, Slot& slot);
+    static void WorkerFunc(void* arg);
+
+private:
+    Mutex m_mutex{};
+    CondVar m_can_work{};
+    CondVar m_can_flush{};
+
+    std::vector<Slot> m_slots{};
+    std::vector<Worker> m_workers{};
+    Slot* m_current{};
+    u64 m_block_size{};
+
+    // index of the next block to be submitted, picked up by a worker and flushed.
+    u64 m_submit_index{};
+    u64 m_work_index{};
+    u64 m_flush_index{};
+
+    bool m_quit{};
+};
+
+BlockCompressor::~BlockCompressor() {
+    mutexLock(&m_mutex);
+    m_quit = true;
+    condvarWakeAll(&m_can_work);
+    mutexUnlock(&m_mutex);
+
+    for (auto& worker : m_workers) {
+        if (worker.created) {
+            threadWaitForExit(&worker.thread);
+            threadClose(&worker.thread);
+        }
+
+        ZSTD_freeCCtx(worker.cctx);
+    }
+}
+
+Result BlockCompressor::Create(u32 workers, int level, bool ldm, u64 block_size) {
+    mutexInit(&m_mutex);
+    condvarInit(&m_can_work);
+    condvarInit(&m_can_flush);
+
+    // keep 2 blocks per worker so that workers do not wait on the flush,
+    // limited by memory as the block size can be up to 16MiB.
+    const auto slot_count = std::clamp<u64>(BLOCK_COMPRESSOR_MEMORY_MAX / (block_size * 2), 2, workers * 2);
+    log_write("[NSZ] block compressor workers: %u slots: %zu\n", workers, slot_count);
+
+    m_block_size = block_size;
+    m_slots.resize(slot_count);
+    for (auto& slot : m_slots) {
+        slot.in.reserve(block_size);
+        slot.out.reserve(block_size);
+    }
+
+    m_workers.resize(workers);
+    for (auto& worker : m_workers) {
+        worker.self = this;
+        worker.cctx = ZSTD_createCCtx();
+        R_UNLESS(worker.cctx, Result_NszFailedCreateCctx);
+
+        R_UNLESS(!ZSTD_isError(ZSTD_CCtx_setParameter(worker.cctx, ZSTD_c_compressionLevel, level)), Result_NszFailedSetCompressionLevel);
+        R_UNLESS(!ZSTD_isError(ZSTD_CCtx_setParameter(worker.cctx, ZSTD_c_enableLongDistanceMatching, ldm)), Result_NszFailedSetLongDistanceMode);
+    }
+
+    for (auto& worker : m_workers) {
+        R_TRY(utils::CreateThread(&worker.thread, WorkerFunc, &worker));
+        if (R_FAILED(threadStart(&worker.thread))) {
+            threadClose(&worker.thread);
+            R_THROW(Result_NszFailedCreateCctx);
+        }
+        worker.created = true;
+    }
+
+    R_SUCCEED();
+}
+
+Result BlockCompressor::Write(const void* _data, s64 size, const FlushCallback& callback) {
+    auto data = (const u8*)_data;
+
+    while (size) {
+        if (!m_current) {
+            R_TRY(Acquire(callback));
+        }
+
+        auto& in = m_current->in;
+        const auto block_off = in.size();
+        const auto rsize = std::min<s64>(size, m_block_size - block_off);
+
+        in.resize(block_off + rsize);
+        std::memcpy(in.data() + block_off, data, rsize);
+
+        // check if we've filled the block.
+        if (in.size() == m_block_size) {
+            Submit();
+            R_TRY(FlushReady(callback));
+        }
+
+        size -= rsize;
+        data += rsize;
+    }
+
+    R_SUCCEED();
+}
+
+Result BlockCompressor::Finish(const FlushCallback& callback) {
+    if (m_current && !m_current->in.empty()) {
+        log_write("\t\t[NSZ] flushing block end: %zu\n", m_current->in.size());
+        Submit();
+    }
+
+    while (m_flush_index < m_submit_index) {
+        R_TRY(FlushOne(callback));
+    }
+
+    R_SUCCEED();
+}
+
+Result BlockCompressor::Acquire(const FlushCallback& callback) {
+    // wait for the oldest block to finish if all slots are in use.
+    while (m_submit_index - m_flush_index >= m_slots.size()) {
+        R_TRY(FlushOne(callback));
+    }
+
+    m_current = &m_slots[m_submit_index % m_slots.size()];
+    m_current->in.resize(0);
+    R_SUCCEED();
+}
+
+void BlockCompressor::Submit() {
+    SCOPED_MUTEX(&m_mutex);
+    m_current = nullptr;
+    m_submit_index++;
+    condvarWakeOne(&m_can_work);
+}
+
+Result BlockCompressor::FlushOne(const FlushCallback& callback) {
+    auto& slot = m_slots[m_flush_index % m_slots.size()];
+
+    mutexLock(&m_mutex);
+    while (!slot.done) {
+        condvarWait(&m_can_flush, &m_mutex);
+    }
+    mutexUnlock(&m_mutex);
+
+    // the slot is not touched by the workers until it is submitted again.
+    R_TRY(slot.rc);
+    R_TRY(callback(slot.output));
+
+    slot.done = false;
+    m_flush_index++;
+    R_SUCCEED();
+}
+
+Result BlockCompressor::FlushReady(const FlushCallback& callback) {
+    while (m_flush_index < m_submit_index) {
+        bool done;
+        {
+            SCOPED_MUTEX(&m_mutex);
+            done = m_slots[m_flush_index % m_slots.size()].done;
+        }
+
+        if (!done) {
+            break;
+        }
+
+        R_TRY(FlushOne(callback));
+    }
+
+    R_SUCCEED();
+}
+
+void BlockCompressor::Compress(ZSTD_CCtx* cctx, Slot& slot) {
+    slot.rc = 0;
+    slot.out.resize(slot.in.size());
+    const auto result = ZSTD_compress2(cctx, slot.out.data(), slot.out.size(), slot.in.data(), slot.in.size());
+
+    // check if we got an error, ignoring if the dst buffer was too small.
+    const auto error_code = ZSTD_getErrorCode(result);
+    if (error_code != ZSTD_error_no_error && error_code != ZSTD_error_dstSize_tooSmall) {
+        log_write("[ZSTD] error: %zu %s\n", result, ZSTD_getErrorName(result));
+        slot.rc = Result_NszFailedCompress2;
+        return;
+    }
+
+    // use src buffer instead if zstd failed to compress.
+    if (error_code == ZSTD_error_dstSize_tooSmall || result >= slot.in.size()) {
+        slot.output = slot.in;
+    } else {
+        slot.output = std::span{slot.out.data(), result};
+    }
+}
+
+void BlockCompressor::WorkerFunc(void* arg) {
+    auto worker = static_cast<Worker*>(arg);
+    auto self = worker->self;
+
+    for (;;) {
+        mutexLock(&self->m_mutex);
+        while (!self->m_quit && self->m_work_index == self->m_submit_index) {
+            condvarWait(&self->m_can_work, &self->m_mutex);
+        }
+
+        if (self->m_quit) {
+            mutexUnlock(&self->m_mutex);
+            break;
+        }
+
+        auto& slot = self->m_slots[self->m_work_index++ % self->m_slots.size()];
+        mutexUnlock(&self->m_mutex);
+
+        self->Compress(worker->cctx, slot);
+
+        mutexLock(&self->m_mutex);
+        slot.done = true;
+        condvarWakeAll(&self->m_can_flush);
+        mutexUnlock(&self->m_mutex);
+    }
+}
+
 } // namespace
 
 Result NszExport(ui::ProgressBox* pbox, const NcaReaderCreator& nca_creator, s64& read_offset, s64& write_offset, Collections& collections, const keys::Keys& keys, dump::BaseSource* source, dump::WriteSource* writer, const fs::FsPath& path) {
@@ -71,6 +332,8 @@ Result NszExport(ui::ProgressBox* pbox, const NcaReaderCreator& nca_creator, s64
     // enable to use block over solid.
     const auto use_block = App::GetApp()->m_nsz_compress_block.Get();
     const auto block_exponent = App::GetNszBlockExponent();
+    // in block mode, the thread count is the number of blocks compressed in parallel.
+    const auto block_workers = std::clamp<u32>(threads, 1, utils::GetCoreCount());
 
     log_write("[NSZ] start\n");
 
@@ -167,11 +430,12 @@ Result NszExport(ui::ProgressBox* pbox, const NcaReaderCreator& nca_creator, s64
             std::vector<ncz::Block> ncz_blocks(ncz_block_header.total_blocks);
             u32 ncz_block_index = 0;
 
-            // buffer that zstd compresses into.
-            std::vector<u8> ncz_block_out_buffer;
-            // buffer that is written into.
-            std::vector<u8> ncz_block_in_buffer;
-            ncz_block_in_buffer.reserve(blockSize);
+            // blocks are compressed in parallel and written back in order.
+            std::unique_ptr<BlockCompressor> block_compressor;
+            if (use_block) {
+                block_compressor = std::make_unique<BlockCompressor>();
+                R_TRY(block_compressor->Create(block_workers, level, ldm, blockSize));
+            }
 
             const auto ncz_header_off = file_off + NCZ_NORMAL_SIZE;
             const auto ncz_header_size = sizeof(ncz_header);
@@ -239,55 +503,21 @@ Result NszExport(ui::ProgressBox* pbox, const NcaReaderCreator& nca_creator, s64
                         auto data = (const u8*)_data;
 
                         if (use_block) {
-                            const auto flush_block = [&]() -> Result {
-                                R_UNLESS(ncz_block_index <= ncz_blocks.size(), Result_NszTooManyBlocks);
-                                ncz_block_out_buffer.resize(ncz_block_in_buffer.size());
-                                const auto result = ZSTD_compress2(cctx, ncz_block_out_buffer.data(), ncz_block_out_buffer.size(), ncz_block_in_buffer.data(), ncz_block_in_buffer.size());
-
-                                // check if we got an error, ignoring if the dst buffer was too small.
-                                const auto error_code = ZSTD_getErrorCode(result);
-                                R_UNLESS(error_code == ZSTD_error_no_error || error_code == ZSTD_error_dstSize_tooSmall, Result_NszFailedCompress2);
-
-                                // use src buffer instead if zstd failed to compress.
-                                auto output = std::span{ncz_block_out_buffer.data(), result};
-                                if (error_code == ZSTD_error_dstSize_tooSmall || result >= ncz_block_in_buffer.size()) {
-                                    output = ncz_block_in_buffer;
-                                }
+                            const auto flush_block = [&](std::span<const u8> output) -> Result {
+                                R_UNLESS(ncz_block_index < ncz_blocks.size(), Result_NszTooManyBlocks);
 
                                 // write block data, advance the block index.
                                 R_TRY(callback(output.data(), output.size()));
                                 ncz_blocks[ncz_block_index++].size = output.size();
-
-                                ncz_block_in_buffer.resize(0);
                                 R_SUCCEED();
                             };
 
                             const auto last_chunk = off + size >= size_remaining;
-
-                            while (size) {
-                                const auto block_off = ncz_block_in_buffer.size();
-                                const auto rsize = std::min<s64>(size, blockSize - block_off);
-
-                                ncz_block_in_buffer.resize(block_off + rsize);
-                                std::memcpy(ncz_block_in_buffer.data() + block_off, data, rsize);
-
-                                // check if we've filled the block.
-                                if (ncz_block_in_buffer.size() == blockSize) {
-                                    // log_write("\t\t[NSZ] flushing block\n");
-                                    R_TRY(flush_block());
-                                }
-
-                                size -= rsize;
-                                off += rsize;
-                                data += rsize;
-                            }
+                            R_TRY(block_compressor->Write(data, size, flush_block));
 
                             // flush last block.
                             if (last_chunk) {
-                                if (!ncz_block_in_buffer.empty()) {
-                                    log_write("\t\t[NSZ] flushing block end: %zu\n", ncz_block_in_buffer.size());
-                                    R_TRY(flush_block());
-                                }
+                                R_TRY(block_compressor->Finish(flush_block));
 
                                 // ensure that we are at the last block.
                                 log_write("block index: %u vs %zu\n", ncz_block_index, ncz_blocks.size());
@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <cstdio>
+#include <bit>
 
 namespace sphaira::utils {
 namespace {
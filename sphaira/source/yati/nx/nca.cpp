@@ -3,8 +3,11 @@
 #include "yati/nx/es.hpp"
 #include "yati/nx/nxdumptool_rsa.h"
 #include "utils/utils.hpp"
+#include "utils/lru.hpp"
 #include "log.hpp"
 
+#include <functional>
+
 namespace sphaira::nca {
 namespace {
 
@@ -96,8 +99,183 @@ const unsigned char acid_fixed_key_moduli_retail[0x2][0x100] = { /* Fixed RSA ke
     }
 };
 
+// number of verified hash blocks to keep around.
+constexpr u32 HASH_CACHE_BLOCKS = 16;
+
 } // namespace
 
+// hierarchical sha256 (pfs0) and ivfc (romfs) are handled the same way.
+// each block of a level is hashed into the level before it, with the first
+// level being checked against the master hash in the fs header.
+struct HashTree {
+    using ReadFunc = std::function<Result(void* buf, s64 off, s64 size)>;
+
+    struct Level {
+        u64 offset; // relative to the section.
+        u64 size;
+        u64 block_size;
+    };
+
+    struct HashBlock {
+        std::vector<u8> data;
+        u64 index;
+        u32 level;
+        bool valid;
+    };
+
+    HashTree(const FsHeader& fs_header, u64 section_size) {
+        auto hash_type = fs_header.hash_type;
+        if (hash_type == HashType_Auto) {
+            hash_type = fs_header.fs_type == FileSystemType_PFS0 ? HashType_HierarchicalSha256 : HashType_HierarchicalIntegrity;
+        }
+
+        // the hash layers of AesCtrEx / SkipLayerHash sections are not readable with a single ctr.
+        if (fs_header.encryption_type != EncryptionType_None && fs_header.encryption_type != EncryptionType_AesCtr) {
+            log_write("[NCA] unable to verify encryption type: %u\n", fs_header.encryption_type);
+            return;
+        }
+
+        if (hash_type == HashType_HierarchicalSha256) {
+            const auto& hash_data = fs_header.hash_data.hierarchical_sha256_data;
+            if (hash_data.layer_count != 2 || !hash_data.block_size) {
+                return;
+            }
+
+            std::memcpy(master_hash, hash_data.master_hash, sizeof(master_hash));
+            levels.push_back({hash_data.hash_layer.offset, hash_data.hash_layer.size, hash_data.hash_layer.size});
+            levels.push_back({hash_data.pfs0_layer.offset, hash_data.pfs0_layer.size, hash_data.block_size});
+        } else if (hash_type == HashType_HierarchicalIntegrity) {
+            const auto& meta_info = fs_header.hash_data.integrity_meta_info;
+            const auto& info_level_hash = meta_info.info_level_hash;
+            if (meta_info.magic != 0x43465649 || meta_info.master_hash_size != SHA256_HASH_SIZE) {
+                return;
+            }
+
+            if (info_level_hash.max_layers < 3 || info_level_hash.max_layers - 1 > std::size(info_level_hash.levels)) {
+                return;
+            }
+
+            std::memcpy(master_hash, meta_info.master_hash, sizeof(master_hash));
+            for (u32 i = 0; i < info_level_hash.max_layers - 1; i++) {
+                const auto& level = info_level_hash.levels[i];
+                if (level.block_size >= 32) {
+                    levels.clear();
+                    return;
+                }
+
+                levels.push_back({level.logical_offset, level.hash_data_size, 1ULL << level.block_size});
+            }
+
+            // the first level is checked as a whole against the master hash.
+            levels[0].block_size = levels[0].size;
+            // ivfc hashes are over the full block, the last block is zero padded.
+            pad = true;
+        }
+
+        for (const auto& level : levels) {
+            if (!level.size || !level.block_size || level.offset + level.size > section_size) {
+                log_write("[NCA] invalid hash level, skipping verify\n");
+                levels.clear();
+                return;
+            }
+        }
+
+        blocks.resize(HASH_CACHE_BLOCKS);
+        lru.Init(blocks);
+    }
+
+    auto IsValid() const -> bool {
+        return !levels.empty();
+    }
+
+    Result VerifyBlock(const ReadFunc& read, u32 level, u64 index, const void* data, u64 size) {
+        u8 expected[SHA256_HASH_SIZE];
+        if (!level) {
+            std::memcpy(expected, master_hash, sizeof(expected));
+        } else {
+            R_TRY(GetHash(read, level, index, expected));
+        }
+
+        Sha256Context ctx;
+        sha256ContextCreate(&ctx);
+        sha256ContextUpdate(&ctx, data, size);
+
+        if (pad && level) {
+            static const u8 zeros[0x1000]{};
+            for (auto remaining = levels[level].block_size - size; remaining;) {
+                const auto rsize = std::min<u64>(remaining, sizeof(zeros));
+                sha256ContextUpdate(&ctx, zeros, rsize);
+                remaining -= rsize;
+            }
+        }
+
+        u8 hash[SHA256_HASH_SIZE];
+        sha256ContextGetHash(&ctx, hash);
+
+        if (std::memcmp(hash, expected, sizeof(hash))) {
+            log_write("[NCA] hash missmatch at level: %u block: %zu\n", level, index);
+            R_THROW(Result_NcaFailedHashVerify);
+        }
+
+        R_SUCCEED();
+    }
+
+private:
+    // fetches the expected hash of a block from the level before it.
+    Result GetHash(const ReadFunc& read, u32 level, u64 index, u8* out) {
+        const auto& parent = levels[level - 1];
+        const auto off = index * SHA256_HASH_SIZE;
+        R_UNLESS(off + SHA256_HASH_SIZE <= parent.size, Result_NcaFailedHashVerify);
+
+        const u8* block;
+        R_TRY(GetHashBlock(read, level - 1, off / parent.block_size, &block));
+        std::memcpy(out, block + off % parent.block_size, SHA256_HASH_SIZE);
+        R_SUCCEED();
+    }
+
+    // returns a verified block of a hash level, verified blocks are cached
+    // so that sequential reads don't have to walk the tree each time.
+    Result GetHashBlock(const ReadFunc& read, u32 level, u64 index, const u8** out) {
+        for (auto list = lru.begin(); list; list = list->next) {
+            const auto entry = list->data;
+            if (entry->valid && entry->level == level && entry->index == index) {
+                lru.Update(list);
+                *out = entry->data.data();
+                R_SUCCEED();
+            }
+        }
+
+        const auto& l = levels[level];
+        const auto off = index * l.block_size;
+        const auto size = std::min(l.block_size, l.size - off);
+
+        auto entry = lru.GetNextFree();
+        entry->valid = false;
+        entry->level = level;
+        entry->index = index;
+        entry->data.resize(size);
+
+        R_TRY(read(entry->data.data(), l.offset + off, size));
+        R_TRY(VerifyBlock(read, level, index, entry->data.data(), size));
+
+        entry->valid = true;
+        *out = entry->data.data();
+        R_SUCCEED();
+    }
+
+public:
+    std::vector<Level> levels{};
+    // last verified data block, small reads within the same block are not re-hashed.
+    std::vector<u8> data_block{};
+    u64 data_block_index{UINT64_MAX};
+
+private:
+    u8 master_hash[SHA256_HASH_SIZE]{};
+    bool pad{};
+    std::vector<HashBlock> blocks{};
+    utils::Lru<HashBlock> lru{};
+};
+
 auto GetContentTypeStr(u8 content_type) -> const char* {
     switch (content_type) {
         case ContentType_Program: return "Program";
@@ -351,35 +529,73 @@ DecyptedData::DecyptedData(u64 align, const std::shared_ptr<yati::source::Base>&
 }
 
 Result DecyptedData::Read(void *_buf, s64 _off, s64 _size, u64* _bytes_read) {
-    const auto aligned_off = utils::AlignDown<s64>(_off, m_align);
-    auto aligned_size = utils::AlignUp<s64>(_size, m_align);
-    if (aligned_off != _off) {
-        aligned_size += m_align;
-    }
+    auto buf = (u8*)_buf;
+    auto off = _off;
+    auto size = _size;
 
-    u8* buf = (u8*)_buf;
-    std::unique_ptr<u8[]> aligned_buf{};
-    const auto use_align = _off != aligned_off || _size != aligned_size;
+    while (size) {
+        const auto aligned_off = utils::AlignDown<s64>(off, m_align);
 
-    if (use_align) {
-        aligned_buf = std::make_unique_for_overwrite<u8[]>(aligned_size);
-        buf = aligned_buf.get();
-    }
+        if (aligned_off != off || size < m_align) {
+            // unaligned head or tail, decrypt the whole block and copy out what we need.
+            const auto block_off = off - aligned_off;
+            const auto rsize = std::min<s64>(size, m_align - block_off);
 
-    u64 bytes_read;
-    R_TRY(m_source->Read(buf, aligned_off, aligned_size, &bytes_read));
-    R_UNLESS(bytes_read == aligned_size, 18);
+            const u8* block;
+            R_TRY(ReadBlock(aligned_off, &block));
+            std::memcpy(buf, block + block_off, rsize);
 
-    R_TRY(Decrypt(buf, aligned_off, aligned_size));
+            size -= rsize;
+            off += rsize;
+            buf += rsize;
+        } else {
+            // aligned middle, decrypt in place.
+            const auto rsize = utils::AlignDown<s64>(size, m_align);
 
-    if (use_align) {
-        std::memcpy(_buf, buf + (_off - aligned_off), _size);
+            u64 bytes_read;
+            R_TRY(m_source->Read(buf, off, rsize, &bytes_read));
+            R_UNLESS(bytes_read == rsize, 18);
+            R_TRY(Decrypt(buf, off, rsize));
+
+            size -= rsize;
+            off += rsize;
+            buf += rsize;
+        }
     }
 
     *_bytes_read = _size;
     R_SUCCEED();
 }
 
+void DecyptedData::InvalidateCache() {
+    for (auto& e : m_cache) {
+        e.valid = false;
+    }
+}
+
+Result DecyptedData::ReadBlock(s64 off, const u8** out) {
+    for (auto& e : m_cache) {
+        if (e.valid && e.off == off) {
+            *out = e.data;
+            R_SUCCEED();
+        }
+    }
+
+    auto& e = m_cache[m_cache_next];
+    m_cache_next = (m_cache_next + 1) % std::size(m_cache);
+    e.valid = false;
+    e.off = off;
+
+    u64 bytes_read;
+    R_TRY(m_source->Read(e.data, off, m_align, &bytes_read));
+    R_UNLESS(bytes_read == m_align, 18);
+    R_TRY(Decrypt(e.data, off, m_align));
+
+    e.valid = true;
+    *out = e.data;
+    R_SUCCEED();
+}
+
 DecyptedDataCtr::DecyptedDataCtr(const void* key, u64 ctr, const std::shared_ptr<yati::source::Base>& source)
 : DecyptedData{AES_BLOCK_SIZE, source} {
     SetCtr(ctr);
@@ -387,6 +603,12 @@ DecyptedDataCtr::DecyptedDataCtr(const void* key, u64 ctr, const std::shared_ptr
 }
 
 Result DecyptedDataCtr::SetCtr(u64 ctr) {
+    // the ctr is set before every read, only drop the cache if it changed.
+    if (m_section_ctr != ctr) {
+        m_section_ctr = ctr;
+        InvalidateCache();
+    }
+
     crypto::SetCtr(m_ctr, ctr);
     R_SUCCEED();
 }
@@ -406,6 +628,8 @@ NcaReader::NcaReader(const nca::Header& decrypted_header, const void* key, u64 s
     std::memcpy(m_key, key, sizeof(m_key));
 }
 
+NcaReader::~NcaReader() = default;
+
 Result NcaReader::Read(void *_buf, s64 off, s64 size, u64* bytes_read) {
     return ReadInternal(_buf, off, size, bytes_read, true);
 }
@@ -423,41 +647,33 @@ Result NcaReader::ReadInternal(void *_buf, s64 off, s64 size, u64* bytes_read_ou
     u8* buf = (u8*)_buf;
 
     while (size) {
-        u64 ctr = 0;
-        bool encrypted = false;
+        s32 section = -1;
         auto rsize = size;
 
         if (decrypt) {
             // try and find a section.
             for (u32 i = 0; i < m_header.GetSectionCount(); i++) {
-                const auto& fs_header = m_header.fs_header[i];
                 const auto& fs_table = m_header.fs_table[i];
 
                 // check if this is the section we want.
                 if (off >= fs_table.GetOffset() && off < fs_table.GetOffsetEnd()) {
                     rsize = std::min<s64>(rsize, fs_table.GetOffsetEnd() - off);
-
-                    // check if this is compressed.
-                    if (fs_header.encryption_type >= nca::EncryptionType::EncryptionType_AesCtr) {
-                        ctr = fs_header.section_ctr;
-                        encrypted = true;
-                    }
-
+                    section = i;
                     break;
                 }
             }
         }
 
-        u64 bytes_read;
-        if (encrypted) {
-            R_TRY(m_decryptor->SetCtr(ctr));
-            R_TRY(m_decryptor->Read(buf, off, rsize, &bytes_read));
+        if (section >= 0 && m_verify) {
+            R_TRY(ReadVerified(section, buf, off, rsize));
+        } else if (section >= 0) {
+            R_TRY(ReadSection(section, buf, off, rsize));
         } else {
+            u64 bytes_read;
             R_TRY(m_source->Read(buf, off, rsize, &bytes_read));
+            R_UNLESS(bytes_read == rsize, 16);
         }
 
-        R_UNLESS(bytes_read == rsize, 16);
-
         size -= rsize;
         off += rsize;
         buf += rsize;
@@ -467,4 +683,87 @@ Result NcaReader::ReadInternal(void *_buf, s64 off, s64 size, u64* bytes_read_ou
     R_SUCCEED();
 }
 
+Result NcaReader::ReadSection(u32 index, void *_buf, s64 off, s64 size) {
+    const auto& fs_header = m_header.fs_header[index];
+    u64 bytes_read;
+
+    // check if this is encrypted.
+    if (fs_header.encryption_type >= nca::EncryptionType::EncryptionType_AesCtr) {
+        R_TRY(m_decryptor->SetCtr(fs_header.section_ctr));
+        R_TRY(m_decryptor->Read(_buf, off, size, &bytes_read));
+    } else {
+        R_TRY(m_source->Read(_buf, off, size, &bytes_read));
+    }
+
+    R_UNLESS(bytes_read == size, 16);
+    R_SUCCEED();
+}
+
+Result NcaReader::ReadVerified(u32 index, void *_buf, s64 off, s64 size) {
+    const auto section_off = m_header.fs_table[index].GetOffset();
+
+    auto& tree = m_hash_tree[index];
+    if (!tree) {
+        tree = std::make_unique<HashTree>(m_header.fs_header[index], m_header.fs_table[index].GetSize());
+    }
+
+    // fallback to normal reads for sections that can't be verified.
+    if (!tree->IsValid()) {
+        return ReadSection(index, _buf, off, size);
+    }
+
+    const auto read = [this, index, section_off](void* buf, s64 off, s64 size) -> Result {
+        return ReadSection(index, buf, section_off + off, size);
+    };
+
+    const auto& data = tree->levels.back();
+    const auto data_level = tree->levels.size() - 1;
+    auto buf = (u8*)_buf;
+    u64 rel = off - section_off;
+
+    while (size) {
+        // anything outside of the data level is read as is, hash levels are
+        // verified when they are used.
+        if (rel < data.offset || rel >= data.offset + data.size) {
+            auto rsize = size;
+            if (rel < data.offset) {
+                rsize = std::min<s64>(rsize, data.offset - rel);
+            }
+
+            R_TRY(read(buf, rel, rsize));
+            size -= rsize;
+            rel += rsize;
+            buf += rsize;
+            continue;
+        }
+
+        const auto block = (rel - data.offset) / data.block_size;
+        const auto block_off = block * data.block_size;
+        const auto block_size = std::min<u64>(data.block_size, data.size - block_off);
+        const auto in_block = rel - data.offset - block_off;
+        const auto rsize = std::min<s64>(size, block_size - in_block);
+
+        if (block == tree->data_block_index) {
+            std::memcpy(buf, tree->data_block.data() + in_block, rsize);
+        } else if (!in_block && static_cast<u64>(rsize) == block_size) {
+            // full block, read and verify in place.
+            R_TRY(read(buf, data.offset + block_off, block_size));
+            R_TRY(tree->VerifyBlock(read, data_level, block, buf, block_size));
+        } else {
+            tree->data_block_index = UINT64_MAX;
+            tree->data_block.resize(block_size);
+            R_TRY(read(tree->data_block.data(), data.offset + block_off, block_size));
+            R_TRY(tree->VerifyBlock(read, data_level, block, tree->data_block.data(), block_size));
+            tree->data_block_index = block;
+            std::memcpy(buf, tree->data_block.data() + in_block, rsize);
+        }
+
+        size -= rsize;
+        rel += rsize;
+        buf += rsize;
+    }
+
+    R_SUCCEED();
+}
+
 } // namespace sphaira::nca
@@ -1,11 +1,26 @@
 #include "yati/nx/ncz.hpp"
+#include "utils/thread.hpp"
 
 #include "defines.hpp"
 #include "log.hpp"
 
 #include <cstring>
+#include <algorithm>
 
 namespace sphaira::ncz {
+namespace {
+
+// max size of all cached blocks.
+constexpr u64 CACHE_SIZE_MAX = 1024 * 1024 * 32;
+// max size of data that is decompressed ahead of the reader.
+constexpr u64 READAHEAD_SIZE_MAX = 1024 * 1024 * 8;
+// 1 block being read, 1 block being prefetched and 1 spare.
+constexpr u64 SLOT_COUNT_MIN = 3;
+constexpr u64 SLOT_COUNT_MAX = 64;
+// the reader thread also decompresses, so this is in addition to it.
+constexpr u32 WORKER_COUNT_MAX = 3;
+
+} // namespace
 
 NczBlockReader::NczBlockReader(const Header& header, const Sections& sections, const BlockHeader& block_header, const Blocks& blocks, u64 offset, const std::shared_ptr<yati::source::Base>& source)
 : m_header{header}
@@ -14,15 +29,19 @@ NczBlockReader::NczBlockReader(const Header& header, const Sections& sections, c
 , m_blocks{blocks}
 , m_block_offset{offset}
 , m_source{source} {
+    mutexInit(&m_mutex);
+    mutexInit(&m_source_mutex);
+    condvarInit(&m_can_work);
+    condvarInit(&m_can_read);
+
     // calculate the block size.
     m_block_size = 1UL << m_block_header.block_size_exponent;
 
-    // setup lru block cache.
-    // this isn't needed in sphaira as i am usually reading in 4mb chunks.
-    const auto max_lru_total_size = 1024*1024*32;
-    const auto lru_count = std::max<s64>(1, max_lru_total_size / m_block_size);
-    m_lru_data.resize(lru_count);
-    m_lru.Init(m_lru_data);
+    // setup the block cache, buffers are allocated on first use and then reused.
+    const auto slot_count = std::clamp<u64>(CACHE_SIZE_MAX / m_block_size, SLOT_COUNT_MIN, SLOT_COUNT_MAX);
+    m_slots.resize(slot_count);
+    m_readahead = std::clamp<u64>(READAHEAD_SIZE_MAX / m_block_size, 1, slot_count - 2);
+    m_dctx = ZSTD_createDCtx();
 
     // calculate offsets for each block.
     auto block_offset = offset;
@@ -30,6 +49,26 @@ NczBlockReader::NczBlockReader(const Header& header, const Sections& sections, c
         m_block_infos.emplace_back(block_offset, block.size);
         block_offset += block.size;
     }
+
+    m_block_slots.resize(m_block_infos.size(), -1);
+}
+
+NczBlockReader::~NczBlockReader() {
+    mutexLock(&m_mutex);
+    m_quit = true;
+    condvarWakeAll(&m_can_work);
+    mutexUnlock(&m_mutex);
+
+    for (auto& worker : m_workers) {
+        if (worker.created) {
+            threadWaitForExit(&worker.thread);
+            threadClose(&worker.thread);
+        }
+
+        ZSTD_freeDCtx(worker.dctx);
+    }
+
+    ZSTD_freeDCtx(m_dctx);
 }
 
 Result NczBlockReader::Read(void *_buf, s64 off, s64 size, u64* bytes_read_out) {
@@ -41,63 +80,25 @@ Result NczBlockReader::Read(void *_buf, s64 off, s64 size, u64* bytes_read_out)
     off -= NCZ_NORMAL_SIZE;
 
     while (size) {
-        // see if we have a cached block.
-        LruData* lru_data{};
-        for (auto list = m_lru.begin(); list; list = list->next) {
-            if (list->data->InRange(off)) {
-                lru_data = list->data;
-                m_lru.Update(list);
-                break;
-            }
-        }
-
-        // otherwise, read new block.
-        if (!lru_data) {
-            // get block id and ensure we are in bounds.
-            const auto block_id = off / m_block_size;
-            R_UNLESS(block_id < m_block_infos.size(), Result_YatiInvalidNczBlockTotal);
-            const auto& block = m_block_infos[block_id];
-
-            // read entire block.
-            std::vector<u8> temp(block.size);
-            R_TRY(m_source->Read2(temp.data(), block.offset, temp.size()));
-
-            // https://github.com/nicoboss/nsz/issues/79
-            auto decompressedBlockSize = m_block_size;
-            // special handling for the last block to check it's actually compressed
-            if (block_id == m_block_infos.size() - 1) {
-                log_write("[NCZ] last block special handling\n");
-                // https://github.com/nicoboss/nsz/issues/210
-                const auto remainder = m_block_header.decompressed_size % decompressedBlockSize;
-                if (remainder) {
-                    decompressedBlockSize = remainder;
-                }
-            }
+        // get block id and ensure we are in bounds.
+        const s64 block_id = off / m_block_size;
+        R_UNLESS(block_id < m_block_infos.size(), Result_YatiInvalidNczBlockTotal);
 
-            // new block.
-            lru_data = m_lru.GetNextFree();
-            lru_data->offset = block.offset;
+        Slot* slot;
+        R_TRY(GetBlock(block_id, slot));
 
-            // check if this block is compressed.
-            const auto compressed = block.size < decompressedBlockSize;
-
-            if (compressed) {
-                // decompress block.
-                lru_data->data.resize(decompressedBlockSize);
-                const auto res = ZSTD_decompress(lru_data->data.data(), lru_data->data.size(), temp.data(), temp.size());
-
-                // the output should be exactly the size of the block.
-                R_UNLESS(!ZSTD_isError(res), Result_YatiInvalidNczZstdError);
-                R_UNLESS(res == decompressedBlockSize, 3);
-            } else {
-                // saves a copy by swapping the vector.
-                std::swap(lru_data->data, temp);
+        // only start read-ahead once the reader moves onto the next block.
+        if (block_id != m_last_block_id) {
+            if (block_id == m_last_block_id + 1) {
+                Prefetch(block_id);
             }
+            m_last_block_id = block_id;
         }
 
+        // the slot is only evicted by this thread, so it is safe to read from.
         const auto buf_off = off % m_block_size;
-        const auto rsize = std::min<s64>(size, lru_data->data.size() - buf_off);
-        std::memcpy(buf, lru_data->data.data() + buf_off, rsize);
+        const auto rsize = std::min<s64>(size, slot->data.size() - buf_off);
+        std::memcpy(buf, slot->data.data() + buf_off, rsize);
 
         size -= rsize;
         off += rsize;
@@ -108,4 +109,219 @@ Result NczBlockReader::Read(void *_buf, s64 off, s64 size, u64* bytes_read_out)
     R_SUCCEED();
 }
 
+Result NczBlockReader::GetBlock(s64 block_id, Slot*& slot_out) {
+    mutexLock(&m_mutex);
+
+    // see if we have a cached block.
+    if (const auto index = m_block_slots[block_id]; index >= 0) {
+        auto& slot = m_slots[index];
+        while (slot.state == SlotState::Pending) {
+            condvarWait(&m_can_read, &m_mutex);
+        }
+
+        if (R_SUCCEEDED(slot.rc)) {
+            slot.last_use = ++m_tick;
+            slot_out = &slot;
+            mutexUnlock(&m_mutex);
+            R_SUCCEED();
+        }
+
+        // the previous read failed, retry on this thread so that the error is returned.
+        log_write("[NCZ] failed cached block: %zd 0x%X\n", block_id, slot.rc);
+        slot.block_id = -1;
+        m_block_slots[block_id] = -1;
+    }
+
+    // otherwise, read new block.
+    s32 index;
+    while ((index = GetFreeSlot(-1, -1)) < 0) {
+        condvarWait(&m_can_read, &m_mutex);
+    }
+
+    AssignSlot(index, block_id);
+    auto& slot = m_slots[index];
+    mutexUnlock(&m_mutex);
+
+    const auto rc = DecompressBlock(block_id, m_dctx, m_temp, slot.data);
+
+    mutexLock(&m_mutex);
+    slot.rc = rc;
+    slot.state = SlotState::Ready;
+    mutexUnlock(&m_mutex);
+
+    R_TRY(rc);
+    slot_out = &slot;
+    R_SUCCEED();
+}
+
+Result NczBlockReader::DecompressBlock(s64 block_id, ZSTD_DCtx* dctx, std::vector<u8>& temp, std::vector<u8>& out) {
+    const auto& block = m_block_infos[block_id];
+
+    // https://github.com/nicoboss/nsz/issues/79
+    auto decompressedBlockSize = m_block_size;
+    // special handling for the last block to check it's actually compressed
+    if (block_id == m_block_infos.size() - 1) {
+        log_write("[NCZ] last block special handling\n");
+        // https://github.com/nicoboss/nsz/issues/210
+        const auto remainder = m_block_header.decompressed_size % decompressedBlockSize;
+        if (remainder) {
+            decompressedBlockSize = remainder;
+        }
+    }
+
+    // check if this block is compressed.
+    const auto compressed = block.size < decompressedBlockSize;
+
+    // read entire block, directly into the output if it's not compressed.
+    auto& dst = compressed ? temp : out;
+    dst.resize(block.size);
+    {
+        SCOPED_MUTEX(&m_source_mutex);
+        R_TRY(m_source->Read2(dst.data(), block.offset, dst.size()));
+    }
+
+    if (compressed) {
+        // decompress block.
+        out.resize(decompressedBlockSize);
+        size_t res;
+        if (dctx) {
+            res = ZSTD_decompressDCtx(dctx, out.data(), out.size(), temp.data(), temp.size());
+        } else {
+            res = ZSTD_decompress(out.data(), out.size(), temp.data(), temp.size());
+        }
+
+        // the output should be exactly the size of the block.
+        R_UNLESS(!ZSTD_isError(res), Result_YatiInvalidNczZstdError);
+        R_UNLESS(res == decompressedBlockSize, 3);
+    }
+
+    R_SUCCEED();
+}
+
+void NczBlockReader::Prefetch(s64 block_id) {
+    CreateWorkers();
+    if (!m_worker_count) {
+        return;
+    }
+
+    SCOPED_MUTEX(&m_mutex);
+    const auto block_hi = block_id + m_readahead;
+
+    for (auto i = block_id + 1; i <= block_hi && i < m_block_infos.size(); i++) {
+        if (m_block_slots[i] >= 0) {
+            continue;
+        }
+
+        // don't evict the current block or blocks that are already prefetched.
+        const auto index = GetFreeSlot(block_id, block_hi);
+        if (index < 0) {
+            break;
+        }
+
+        AssignSlot(index, i);
+        m_jobs.emplace_back(index);
+        condvarWakeOne(&m_can_work);
+    }
+}
+
+void NczBlockReader::CreateWorkers() {
+    if (m_workers_created) {
+        return;
+    }
+
+    m_workers_created = true;
+    const auto count = std::min<u32>(std::max<u32>(utils::GetCoreCount(), 2) - 1, WORKER_COUNT_MAX);
+
+    // resize once as the threads keep a pointer to their worker.
+    m_workers.resize(count);
+    for (auto& worker : m_workers) {
+        worker.self = this;
+        worker.dctx = ZSTD_createDCtx();
+        worker.temp.reserve(m_block_size);
+
+        if (R_FAILED(utils::CreateThread(&worker.thread, WorkerFunc, &worker))) {
+            log_write("[NCZ] failed to create worker\n");
+            break;
+        }
+
+        if (R_FAILED(threadStart(&worker.thread))) {
+            log_write("[NCZ] failed to start worker\n");
+            threadClose(&worker.thread);
+            break;
+        }
+
+        worker.created = true;
+        m_worker_count++;
+    }
+
+    log_write("[NCZ] created %u workers, readahead: %u slots: %zu\n", m_worker_count, m_readahead, m_slots.size());
+}
+
+auto NczBlockReader::GetFreeSlot(s64 block_lo, s64 block_hi) const -> s32 {
+    s32 index = -1;
+
+    for (s32 i = 0; i < m_slots.size(); i++) {
+        const auto& slot = m_slots[i];
+        if (slot.state == SlotState::Pending) {
+            continue;
+        }
+
+        if (slot.block_id >= 0 && slot.block_id >= block_lo && slot.block_id <= block_hi) {
+            continue;
+        }
+
+        if (index < 0 || slot.last_use < m_slots[index].last_use) {
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+void NczBlockReader::AssignSlot(s32 index, s64 block_id) {
+    auto& slot = m_slots[index];
+
+    // evict the old block.
+    if (slot.block_id >= 0) {
+        m_block_slots[slot.block_id] = -1;
+    }
+
+    slot.block_id = block_id;
+    slot.last_use = ++m_tick;
+    slot.rc = 0;
+    slot.state = SlotState::Pending;
+    m_block_slots[block_id] = index;
+}
+
+void NczBlockReader::WorkerFunc(void* arg) {
+    auto worker = static_cast<Worker*>(arg);
+    auto self = worker->self;
+
+    for (;;) {
+        mutexLock(&self->m_mutex);
+        while (!self->m_quit && self->m_jobs.empty()) {
+            condvarWait(&self->m_can_work, &self->m_mutex);
+        }
+
+        if (self->m_quit) {
+            mutexUnlock(&self->m_mutex);
+            break;
+        }
+
+        auto& slot = self->m_slots[self->m_jobs.front()];
+        self->m_jobs.pop_front();
+        const auto block_id = slot.block_id;
+        mutexUnlock(&self->m_mutex);
+
+        // pending slots are never evicted, so the slot is owned by this worker.
+        const auto rc = self->DecompressBlock(block_id, worker->dctx, worker->temp, slot.data);
+
+        mutexLock(&self->m_mutex);
+        slot.rc = rc;
+        slot.state = SlotState::Ready;
+        condvarWakeAll(&self->m_can_read);
+        mutexUnlock(&self->m_mutex);
+    }
+}
+
 } // namespace sphaira::ncz
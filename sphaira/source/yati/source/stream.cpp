@@ -1,6 +1,7 @@
 #include "yati/source/stream.hpp"
 #include "defines.hpp"
 #include "log.hpp"
+#include <algorithm>
 
 namespace sphaira::yati::source {
 
@@ -15,14 +16,9 @@ Result Stream::Read(void* _buf, s64 off, s64 size, u64* bytes_read_out) {
     while (size) {
         // while it is invalid to seek backwards, it is valid to seek forwards.
         // this can be done to skip padding, skip undeeded files etc.
-        // to handle this, simply read the data into a buffer and discard it.
         if (off > m_offset) {
-            const auto skip_size = off - m_offset;
-            std::vector<u8> temp_buf(skip_size);
-            u64 bytes_read;
-            R_TRY(ReadChunk(temp_buf.data(), temp_buf.size(), &bytes_read));
-
-            m_offset += bytes_read;
+            R_TRY(Skip(m_offset, off - m_offset));
+            m_offset = off;
         } else {
             u64 bytes_read;
             R_TRY(ReadChunk(buf, size, &bytes_read));
@@ -38,4 +34,20 @@ Result Stream::Read(void* _buf, s64 off, s64 size, u64* bytes_read_out) {
     R_SUCCEED();
 }
 
+Result Stream::Skip(s64 off, s64 size) {
+    // read the data into a small buffer and discard it, the buffer is kept
+    // as skips happen often (padding between files).
+    m_skip_buffer.resize(std::min(size, SKIP_BUFFER_SIZE));
+
+    while (size) {
+        u64 bytes_read;
+        R_TRY(ReadChunk(m_skip_buffer.data(), std::min<s64>(size, m_skip_buffer.size()), &bytes_read));
+        R_UNLESS(bytes_read, Result_StreamBadSeek);
+
+        size -= bytes_read;
+    }
+
+    R_SUCCEED();
+}
+
 } // namespace sphaira::yati::source
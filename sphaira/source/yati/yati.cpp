@@ -14,6 +14,8 @@
 
 #include "utils/utils.hpp"
 #include "utils/thread.hpp"
+#include "utils/buffer_pool.hpp"
+#include "utils/io_qos.hpp"
 
 #include "ui/progress_box.hpp"
 #include "ui/menus/game_menu.hpp"
@@ -88,7 +90,7 @@ struct ThreadBuffer {
         buf.reserve(INFLATE_BUFFER_MAX);
     }
 
-    std::vector<u8> buf;
+    utils::PageBuffer buf;
     s64 off;
 };
 
@@ -118,7 +120,7 @@ public:
         return ringbuf_capacity() - ringbuf_size();
     }
 
-    void ringbuf_push(std::vector<u8>& buf_in, s64 off_in) {
+    void ringbuf_push(utils::PageBuffer& buf_in, s64 off_in) {
         auto& value = this->buf[this->w_index % ringbuf_capacity()];
         value.off = off_in;
         std::swap(value.buf, buf_in);
@@ -126,7 +128,7 @@ public:
         this->w_index = (this->w_index + 1U) % (ringbuf_capacity() * 2U);
     }
 
-    void ringbuf_pop(std::vector<u8>& buf_out, s64& off_out) {
+    void ringbuf_pop(utils::PageBuffer& buf_out, s64& off_out) {
         auto& value = this->buf[this->r_index % ringbuf_capacity()];
         off_out = value.off;
         std::swap(value.buf, buf_out);
@@ -219,7 +221,7 @@ struct ThreadData {
 
     Result Read(void* buf, s64 size, u64* bytes_read);
 
-    Result SetDecompressBuf(std::vector<u8>& buf, s64 off, s64 size) {
+    Result SetDecompressBuf(utils::PageBuffer& buf, s64 off, s64 size) {
         buf.resize(size);
 
         mutexLock(std::addressof(read_mutex));
@@ -236,7 +238,7 @@ struct ThreadData {
         return condvarWakeOne(std::addressof(can_decompress));
     }
 
-    Result GetDecompressBuf(std::vector<u8>& buf_out, s64& off_out) {
+    Result GetDecompressBuf(utils::PageBuffer& buf_out, s64& off_out) {
         mutexLock(std::addressof(read_mutex));
         if (!read_buffers.ringbuf_size()) {
             if (!read_running) {
@@ -252,7 +254,7 @@ struct ThreadData {
         return condvarWakeOne(std::addressof(can_read));
     }
 
-    Result SetWriteBuf(std::vector<u8>& buf, s64 size, bool skip_verify) {
+    Result SetWriteBuf(utils::PageBuffer& buf, s64 size, bool skip_verify) {
         buf.resize(size);
         if (!skip_verify) {
             sha256ContextUpdate(std::addressof(sha256), buf.data(), buf.size());
@@ -272,7 +274,7 @@ struct ThreadData {
         return condvarWakeOne(std::addressof(can_write));
     }
 
-    Result GetWriteBuf(std::vector<u8>& buf_out, s64& off_out) {
+    Result GetWriteBuf(utils::PageBuffer& buf_out, s64& off_out) {
         mutexLock(std::addressof(write_mutex));
         if (!write_buffers.ringbuf_size()) {
             if (!decompress_running) {
@@ -368,6 +370,9 @@ struct Yati {
     std::unique_ptr<container::Base> container{};
     Config config{};
     keys::Keys keys{};
+
+    // pipeline buffers are reused between each nca.
+    utils::ScopedBufferPool buffer_pool{};
 };
 
 auto ThreadData::GetResults() volatile -> Result {
@@ -436,11 +441,11 @@ Result Yati::readFuncInternal(ThreadData* t) {
     ON_SCOPE_EXIT( t->read_running = false; );
 
     // the main buffer which data is read into.
-    std::vector<u8> buf;
+    utils::PageBuffer buf;
     // workaround ncz block reading ahead. if block isn't found, we usually
     // would seek back to the offset, however this is not possible in stream
     // mode, so we instead store the data to the temp buffer and pre-pend it.
-    std::vector<u8> temp_buf;
+    utils::PageBuffer temp_buf;
     buf.reserve(t->max_buffer_size);
     temp_buf.reserve(t->max_buffer_size);
 
@@ -530,12 +535,12 @@ Result Yati::decompressFuncInternal(ThreadData* t) {
 
     s64 inflate_offset{};
     Aes128CtrContext ctx{};
-    std::vector<u8> inflate_buf{};
+    utils::PageBuffer inflate_buf{};
     inflate_buf.reserve(t->max_buffer_size);
 
     s64 written{};
     s64 block_offset{};
-    std::vector<u8> buf{};
+    utils::PageBuffer buf{};
     buf.reserve(t->max_buffer_size);
 
     // encrypts the nca and passes the buffer to the write thread.
@@ -548,7 +553,7 @@ Result Yati::decompressFuncInternal(ThreadData* t) {
         // the remaining data.
         // rather that copying the entire vector to the write thread,
         // only copy (store) the remaining amount.
-        std::vector<u8> temp_vector{};
+        utils::PageBuffer temp_vector{};
         if (size < inflate_offset) {
             temp_vector.resize(inflate_offset - size);
             std::memcpy(temp_vector.data(), inflate_buf.data() + size, temp_vector.size());
@@ -776,9 +781,8 @@ Result Yati::decompressFuncInternal(ThreadData* t) {
 Result Yati::writeFuncInternal(ThreadData* t) {
     ON_SCOPE_EXIT( t->write_running = false; );
 
-    std::vector<u8> buf;
+    utils::PageBuffer buf;
     buf.reserve(t->max_buffer_size);
-    const auto is_file_based_emummc = App::IsFileBaseEmummc();
 
     while (t->write_offset < t->write_size && R_SUCCEEDED(t->GetResults())) {
         s64 dummy_off;
@@ -790,18 +794,12 @@ Result Yati::writeFuncInternal(ThreadData* t) {
         s64 off{};
         while (off < buf.size() && t->write_offset < t->write_size && R_SUCCEEDED(t->GetResults())) {
             const auto wsize = std::min<s64>(t->read_buffer_size, buf.size() - off);
+            utils::qos::Acquire(utils::qos::Device_Sd, utils::qos::Direction_Write, utils::qos::Priority_Bulk, wsize);
             R_TRY(ncmContentStorageWritePlaceHolder(std::addressof(cs), std::addressof(t->nca->placeholder_id), t->write_offset, buf.data() + off, wsize));
 
             off += wsize;
             t->write_offset += wsize;
             ueventSignal(t->GetProgressEvent());
-
-            // todo: check how much time elapsed and sleep the diff
-            // rather than always sleeping a fixed amount.
-            // ie, writing a small buffer (nca header) should not sleep the full 2 ms.
-            if (is_file_based_emummc) {
-                svcSleepThread(2e+6); // 2ms
-            }
         }
     }
 
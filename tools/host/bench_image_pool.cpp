@@ -0,0 +1,294 @@
+// benchmarks loading the icons of a menu, image_pool::Queue against the old
+// per frame loading (2 icons per frame, decoded on the ui thread).
+// reports the time until every visible icon is shown, the longest frame and
+// how many icons were decoded.
+//
+// bench_image_pool [--entries n] [--row n] [--page n] [--read ms] [--decode ms]
+//                  [--resize ms] [--upload ms] [--large_every n] [--only name] [--log]
+//
+// the costs are modelled rather than measured on the host, as stb / nvjpg
+// aren't built here. --decode is for a 256x256 icon and scales with the pixel
+// count, decodes are serialised as nvjpg is a single engine. every
+// large_every icon is 1024x1024, which the pool resizes before uploading.
+
+#include "image_pool.hpp"
+#include "host.hpp"
+#include "defines.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+using namespace sphaira;
+
+constexpr u64 FRAME_NS = 16'666'667;
+constexpr double ICON_PIXELS = 256.0 * 256.0;
+
+struct Costs {
+    double read_ms{1.5};
+    double decode_ms{4};
+    double resize_ms{6};
+    double upload_ms{0.4};
+    u32 large_every{10};
+};
+
+Costs g_costs{};
+Mutex g_decode_mutex{};
+
+void SleepMs(double ms) {
+    if (ms > 0) {
+        svcSleepThread(s64(ms * 1e+6));
+    }
+}
+
+// the encoded icon is just its size.
+struct Encoded {
+    int w, h;
+};
+
+auto IconSize(u32 index) -> int {
+    return g_costs.large_every && index % g_costs.large_every == g_costs.large_every - 1 ? 1024 : 256;
+}
+
+// nro_get_icon().
+auto ReadIcon(u32 index) -> std::vector<u8> {
+    SleepMs(g_costs.read_ms);
+
+    const auto size = IconSize(index);
+    const Encoded e{size, size};
+    std::vector<u8> data(sizeof(e));
+    std::memcpy(data.data(), &e, sizeof(e));
+    return data;
+}
+
+void Upload(const ImageResult& image) {
+    SleepMs(g_costs.upload_ms * (image.w * image.h) / ICON_PIXELS);
+}
+
+} // namespace
+
+// modelled versions of image.cpp, used by image_pool.cpp.
+namespace sphaira {
+
+auto ImageLoadFromMemory(std::span<const u8> data, u32 flags) -> ImageResult {
+    Encoded e;
+    if (data.size() != sizeof(e)) {
+        return {};
+    }
+    std::memcpy(&e, data.data(), sizeof(e));
+
+    SCOPED_MUTEX(&g_decode_mutex);
+    SleepMs(g_costs.decode_ms * (e.w * e.h) / ICON_PIXELS);
+    return { std::vector<u8>(e.w * e.h * 4), e.w, e.h };
+}
+
+auto ImageResize(std::span<const u8> data, int inx, int iny, int outx, int outy) -> ImageResult {
+    SleepMs(g_costs.resize_ms * (inx * iny) / (1024.0 * 1024.0));
+    return { std::vector<u8>(outx * outy * 4), outx, outy };
+}
+
+} // namespace sphaira
+
+namespace {
+
+enum class Mode {
+    // image_pool::Queue, up to 4 uploads per frame.
+    Pool,
+    // the old loading, up to 2 icons read, decoded and uploaded per frame.
+    PerFrame,
+};
+
+struct Scenario {
+    const char* name;
+    // number of rows scrolled, one every scroll_frames.
+    u32 scroll_rows;
+    u32 scroll_frames;
+};
+
+struct Options {
+    u32 entries{300};
+    u32 row{6};
+    u32 page{12};
+    const char* only{};
+};
+
+struct Report {
+    u32 frames;
+    // from the last scroll until every visible icon was uploaded.
+    u64 visible_ns;
+    u64 worst_frame_ns;
+    u32 decoded;
+    bool done;
+};
+
+struct Entry {
+    bool image;
+};
+
+auto Run(const Options& options, const Scenario& s, Mode mode) -> Report {
+    Report report{};
+    std::vector<Entry> entries(options.entries);
+    image_pool::Queue icons{};
+
+    u32 start = 0;
+    u64 settle_start = host::GetTimeNs();
+    const u32 max_frames = s.scroll_rows * s.scroll_frames + 60 * 60;
+
+    for (u32 frame = 0; frame < max_frames; frame++) {
+        const auto frame_start = host::GetTimeNs();
+
+        if (frame && s.scroll_frames && frame % s.scroll_frames == 0 && frame / s.scroll_frames <= s.scroll_rows) {
+            start = std::min<u32>(start + options.row, options.entries - options.page);
+            settle_start = frame_start;
+        }
+
+        const auto end = std::min<u32>(start + options.page, options.entries);
+
+        if (mode == Mode::Pool) {
+            u64 id;
+            ImageResult image;
+            for (int i = 0; i < 4 && icons.Pop(&id, &image); i++) {
+                if (!entries[id].image) {
+                    Upload(image);
+                    entries[id].image = true;
+                    report.decoded++;
+                }
+            }
+
+            icons.BeginFrame();
+            for (u32 i = start; i < end; i++) {
+                if (!entries[i].image && !icons.Touch(i)) {
+                    icons.Push(i, [i]() {
+                        return ReadIcon(i);
+                    });
+                }
+            }
+        } else {
+            int count = 0;
+            for (u32 i = start; i < end && count < 2; i++) {
+                if (!entries[i].image) {
+                    const auto image = ImageLoadFromMemory(ReadIcon(i), ImageFlag_JPEG);
+                    Upload(image);
+                    entries[i].image = true;
+                    report.decoded++;
+                    count++;
+                }
+            }
+        }
+
+        const auto now = host::GetTimeNs();
+        report.worst_frame_ns = std::max(report.worst_frame_ns, now - frame_start);
+        report.frames = frame + 1;
+
+        const auto scrolling = s.scroll_frames && frame / s.scroll_frames < s.scroll_rows;
+        const auto all_visible = std::all_of(entries.begin() + start, entries.begin() + end, [](auto& e) {
+            return e.image;
+        });
+
+        if (!scrolling && all_visible) {
+            report.visible_ns = now - settle_start;
+            report.done = true;
+            break;
+        }
+
+        // wait for vsync, a long frame misses it.
+        const auto elapsed = now - frame_start;
+        SleepMs((FRAME_NS - elapsed % FRAME_NS) / 1e+6);
+    }
+
+    return report;
+}
+
+bool ParseU32(const char* arg, u32& out) {
+    char* end;
+    out = std::strtoul(arg, &end, 10);
+    return end != arg && !*end;
+}
+
+bool ParseDouble(const char* arg, double& out) {
+    char* end;
+    out = std::strtod(arg, &end);
+    return end != arg && !*end && out >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options{};
+    bool log{};
+
+    for (int i = 1; i < argc; i++) {
+        const auto arg = argv[i];
+        const auto next = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = next;
+
+        if (!std::strcmp(arg, "--log")) {
+            log = true;
+            continue;
+        } else if (ok && !std::strcmp(arg, "--entries")) {
+            ok = ParseU32(next, options.entries);
+        } else if (ok && !std::strcmp(arg, "--row")) {
+            ok = ParseU32(next, options.row);
+        } else if (ok && !std::strcmp(arg, "--page")) {
+            ok = ParseU32(next, options.page);
+        } else if (ok && !std::strcmp(arg, "--read")) {
+            ok = ParseDouble(next, g_costs.read_ms);
+        } else if (ok && !std::strcmp(arg, "--decode")) {
+            ok = ParseDouble(next, g_costs.decode_ms);
+        } else if (ok && !std::strcmp(arg, "--resize")) {
+            ok = ParseDouble(next, g_costs.resize_ms);
+        } else if (ok && !std::strcmp(arg, "--upload")) {
+            ok = ParseDouble(next, g_costs.upload_ms);
+        } else if (ok && !std::strcmp(arg, "--large_every")) {
+            ok = ParseU32(next, g_costs.large_every);
+        } else if (ok && !std::strcmp(arg, "--only")) {
+            options.only = next;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "usage: %s [--entries n] [--row n] [--page n] [--read ms] [--decode ms] [--resize ms] [--upload ms] [--large_every n] [--only name] [--log]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (!options.row || options.page < options.row || options.entries < options.page) {
+        std::fprintf(stderr, "entries must be >= page >= row > 0\n");
+        return 1;
+    }
+
+    host::SetLogEnabled(log);
+
+    const Scenario scenarios[] = {
+        // open the menu and wait.
+        { "open", 0, 0 },
+        // hold down, a row every 8 frames.
+        { "scroll", 20, 8 },
+        // flick through the list, a row every 2 frames.
+        { "fast_scroll", 40, 2 },
+    };
+
+    std::printf("%-12s %-9s %7s %15s %15s %8s\n", "scenario", "mode", "frames", "all visible ms", "worst frame ms", "decoded");
+
+    int failed = 0;
+    for (const auto& s : scenarios) {
+        if (options.only && std::strcmp(options.only, s.name)) {
+            continue;
+        }
+
+        for (const auto mode : { Mode::PerFrame, Mode::Pool }) {
+            const auto r = Run(options, s, mode);
+            std::printf("%-12s %-9s %7u %15.1f %15.1f %8u%s\n",
+                s.name, mode == Mode::Pool ? "pool" : "per_frame", r.frames, r.visible_ns / 1e+6, r.worst_frame_ns / 1e+6, r.decoded, r.done ? "" : " (timed out)");
+            failed += !r.done;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
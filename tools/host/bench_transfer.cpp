@@ -0,0 +1,302 @@
+// benchmarks thread::Transfer, TransferPull and TransferUnzip against simulated
+// sources and sinks, reports the throughput, the time each stage spent stalled
+// on another and the average ring occupancy.
+//
+// bench_transfer [--size MiB] [--only name] [--emummc] [--log]
+//                [--read latency_ms:MiB/s] [--write latency_ms:MiB/s[:stall_every_MiB:stall_ms]]
+//
+// --read / --write override the source / sink of every scenario.
+
+#include "threaded_file_transfer.hpp"
+#include "minizip_helper.hpp"
+#include "host.hpp"
+#include "app.hpp"
+#include "defines.hpp"
+
+#include <minizip/unzip.h>
+#include <minizip/zip.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+using namespace sphaira;
+
+enum class Kind {
+    Transfer,
+    Decompress,
+    Pull,
+    Unzip,
+};
+
+struct Scenario {
+    const char* name;
+    Kind kind;
+    host::DeviceModel read;
+    host::DeviceModel write;
+    // cpu cost of the decompress stage, only used by Kind::Decompress.
+    host::DeviceModel decompress;
+};
+
+constexpr u64 MiB = 1024 * 1024;
+
+// rough speeds of the devices that sphaira transfers between.
+Scenario g_scenarios[] = {
+    // sd to sd copy, sd cards flush every so often.
+    { "sd_copy", Kind::Transfer, { 0.1, 90 }, { 0.1, 70, 16 * MiB, 30 } },
+    // usb 2.0 install, the source is slower than the sink.
+    { "usb_install", Kind::Transfer, { 0.5, 38 }, { 0.1, 90, 32 * MiB, 60 } },
+    // fast source into a sink with long stalls, such as a network mount.
+    { "bursty_sink", Kind::Transfer, { 0.05, 200 }, { 0, 150, 8 * MiB, 80 } },
+    // ncz style decompression in the middle stage.
+    { "decompress", Kind::Decompress, { 0.1, 200 }, { 0.1, 150 }, { 0, 120 } },
+    // pull api, such as the usb export, consumer pulls 1MiB at a time.
+    { "pull", Kind::Pull, { 0.1, 90 }, { 0.2, 60 } },
+    // deflated zip read from a slow source into a file on the sd card.
+    { "unzip", Kind::Unzip, { 0.1, 90 }, { 0.1, 70, 16 * MiB, 30 } },
+};
+
+struct Options {
+    s64 size{256 * MiB};
+    const char* only{};
+    bool emummc{};
+    bool log{};
+};
+
+// byte at offset x is a function of x, so that the sink can verify what it got.
+void FillPattern(void* buf, s64 off, s64 size) {
+    auto p = static_cast<u8*>(buf);
+    for (s64 i = 0; i < size; i++) {
+        const auto x = off + i;
+        p[i] = u8(x ^ (x >> 11) ^ (x >> 19));
+    }
+}
+
+bool CheckPattern(const void* buf, s64 off, s64 size) {
+    auto p = static_cast<const u8*>(buf);
+    for (s64 i = 0; i < size; i++) {
+        const auto x = off + i;
+        if (p[i] != u8(x ^ (x >> 11) ^ (x >> 19))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// wraps the minizip read function so that the zip is read at the speed of the source.
+host::DeviceModel* g_zip_read_model{};
+read_file_func g_zip_read_func{};
+
+uLong zip_read_file_func_model(voidpf opaque, voidpf stream, void* buf, uLong size) {
+    const auto ret = g_zip_read_func(opaque, stream, buf, size);
+    g_zip_read_model->Apply(ret);
+    return ret;
+}
+
+Result CreateZip(mz::MzMem& mem, s64 size, u32* crc32) {
+    zlib_filefunc64_def funcs;
+    mz::FileFuncMem(&mem, &funcs);
+
+    auto zfile = zipOpen2_64("bench.zip", APPEND_STATUS_CREATE, nullptr, &funcs);
+    R_UNLESS(zfile, 0x1);
+    ON_SCOPE_EXIT(zipClose(zfile, nullptr));
+
+    R_UNLESS(ZIP_OK == zipOpenNewFileInZip(zfile, "data.bin", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_SPEED), 0x2);
+    ON_SCOPE_EXIT(zipCloseFileInZip(zfile));
+
+    std::vector<u8> buf(MiB);
+    *crc32 = 0;
+    for (s64 off = 0; off < size; off += buf.size()) {
+        const auto chunk = std::min<s64>(buf.size(), size - off);
+        FillPattern(buf.data(), off, chunk);
+        *crc32 = crc32CalculateWithSeed(*crc32, buf.data(), chunk);
+        R_UNLESS(ZIP_OK == zipWriteInFileInZip(zfile, buf.data(), chunk), 0x3);
+    }
+
+    R_SUCCEED();
+}
+
+Result RunUnzip(ui::ProgressBox* pbox, Scenario& s, s64 size) {
+    mz::MzMem mem{};
+    u32 crc32;
+    R_TRY(CreateZip(mem, size, &crc32));
+    mem.offset = 0;
+
+    char dir[] = "/tmp/sphaira_bench_XXXXXX";
+    R_UNLESS(mkdtemp(dir), 0x4);
+    ON_SCOPE_EXIT(std::filesystem::remove_all(dir));
+    host::SetSdRoot(dir);
+
+    zlib_filefunc64_def funcs;
+    mz::FileFuncMem(&mem, &funcs);
+    g_zip_read_model = &s.read;
+    g_zip_read_func = funcs.zread_file;
+    funcs.zread_file = zip_read_file_func_model;
+
+    auto zfile = unzOpen2_64("bench.zip", &funcs);
+    R_UNLESS(zfile, 0x5);
+    ON_SCOPE_EXIT(unzClose(zfile));
+
+    R_UNLESS(UNZ_OK == unzGoToFirstFile(zfile), 0x6);
+    R_UNLESS(UNZ_OK == unzOpenCurrentFile(zfile), 0x7);
+    ON_SCOPE_EXIT(unzCloseCurrentFile(zfile));
+
+    // only the writes are of interest, the zip was created above.
+    host::SetFsWriteModel(&s.write);
+    ON_SCOPE_EXIT(host::SetFsWriteModel(nullptr));
+
+    fs::FsNativeSd fs;
+    return thread::TransferUnzip(pbox, zfile, &fs, "/data.bin", size, crc32, thread::Mode::MultiThreaded);
+}
+
+Result Run(Scenario& s, s64 size) {
+    ui::ProgressBox pbox{};
+    bool valid = true;
+
+    const auto rfunc = [&](void* data, s64 off, s64 size, u64* bytes_read) -> Result {
+        s.read.Apply(size);
+        FillPattern(data, off, size);
+        *bytes_read = size;
+        R_SUCCEED();
+    };
+
+    const auto wfunc = [&](const void* data, s64 off, s64 size) -> Result {
+        s.write.Apply(size);
+        valid &= CheckPattern(data, off, size);
+        R_SUCCEED();
+    };
+
+    switch (s.kind) {
+        case Kind::Transfer:
+            R_TRY(thread::Transfer(&pbox, size, rfunc, wfunc));
+            break;
+
+        case Kind::Decompress:
+            R_TRY(thread::Transfer(&pbox, size, rfunc, [&](void* data, s64 off, s64 size, const thread::DecompressWriteCallback& callback) -> Result {
+                s.decompress.Apply(size);
+                return callback(data, size);
+            }, wfunc));
+            break;
+
+        case Kind::Pull:
+            R_TRY(thread::TransferPull(&pbox, size, rfunc, [&](thread::PullCallback pull) -> Result {
+                std::vector<u8> buf(MiB);
+                for (s64 off = 0; off < size; ) {
+                    u64 bytes_read;
+                    R_TRY(pull(buf.data(), std::min<s64>(buf.size(), size - off), &bytes_read));
+                    R_UNLESS(bytes_read, 0x8);
+                    s.write.Apply(bytes_read);
+                    valid &= CheckPattern(buf.data(), off, bytes_read);
+                    off += bytes_read;
+                }
+                R_SUCCEED();
+            }));
+            break;
+
+        case Kind::Unzip:
+            R_TRY(RunUnzip(&pbox, s, size));
+            break;
+    }
+
+    R_UNLESS(valid, 0x9);
+    R_SUCCEED();
+}
+
+bool ParseModel(const char* arg, host::DeviceModel& out) {
+    double latency{}, bandwidth{}, stall_every{}, stall_ms{};
+    const auto n = std::sscanf(arg, "%lf:%lf:%lf:%lf", &latency, &bandwidth, &stall_every, &stall_ms);
+    if (n != 2 && n != 4) {
+        return false;
+    }
+
+    out.latency_ms = latency;
+    out.bandwidth = bandwidth;
+    out.stall_every = u64(stall_every * MiB);
+    out.stall_ms = stall_ms;
+    return true;
+}
+
+void PrintStage(const thread::TransferStats& stats, const thread::TransferStageStats& stage) {
+    std::printf(" %8.1f (%4.1f%%)", stage.stall_ns / 1e+6, stage.stall_ns * 100.0 / stats.elapsed_ns);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options{};
+    host::DeviceModel read_override{}, write_override{};
+    bool has_read_override{}, has_write_override{};
+
+    for (int i = 1; i < argc; i++) {
+        const auto arg = argv[i];
+        const auto next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (!std::strcmp(arg, "--size") && next) {
+            options.size = std::atoll(next) * MiB;
+            i++;
+        } else if (!std::strcmp(arg, "--only") && next) {
+            options.only = next;
+            i++;
+        } else if (!std::strcmp(arg, "--read") && next && ParseModel(next, read_override)) {
+            has_read_override = true;
+            i++;
+        } else if (!std::strcmp(arg, "--write") && next && ParseModel(next, write_override)) {
+            has_write_override = true;
+            i++;
+        } else if (!std::strcmp(arg, "--emummc")) {
+            options.emummc = true;
+        } else if (!std::strcmp(arg, "--log")) {
+            options.log = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--size MiB] [--only name] [--emummc] [--log] [--read latency_ms:MiB/s] [--write latency_ms:MiB/s[:stall_every_MiB:stall_ms]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    host::SetLogEnabled(options.log);
+    App::file_based_emummc = options.emummc;
+
+    std::printf("%-12s %8s %7s %9s %17s %17s %17s %17s %11s %11s\n",
+        "scenario", "MiB/s", "time", "buffer", "read stall ms", "decomp stall ms", "write stall ms", "pull stall ms", "read ring", "write ring");
+
+    int failed = 0;
+    for (auto& s : g_scenarios) {
+        if (options.only && std::strcmp(options.only, s.name)) {
+            continue;
+        }
+
+        if (has_read_override) {
+            s.read.latency_ms = read_override.latency_ms;
+            s.read.bandwidth = read_override.bandwidth;
+            s.read.stall_every = read_override.stall_every;
+            s.read.stall_ms = read_override.stall_ms;
+        }
+
+        if (has_write_override) {
+            s.write.latency_ms = write_override.latency_ms;
+            s.write.bandwidth = write_override.bandwidth;
+            s.write.stall_every = write_override.stall_every;
+            s.write.stall_ms = write_override.stall_ms;
+        }
+
+        if (const auto rc = Run(s, options.size); R_FAILED(rc)) {
+            std::printf("%-12s failed: 0x%X\n", s.name, rc);
+            failed++;
+            continue;
+        }
+
+        const auto stats = thread::GetLastTransferStats();
+        std::printf("%-12s %8.1f %6.2fs %5zu KiB",
+            s.name, options.size / double(MiB) / (stats.elapsed_ns / 1e+9), stats.elapsed_ns / 1e+9, stats.buffer_size / 1024);
+        PrintStage(stats, stats.read);
+        PrintStage(stats, stats.decompress);
+        PrintStage(stats, stats.write);
+        PrintStage(stats, stats.pull);
+        std::printf(" %6.2f / %u %6.2f / %u\n", stats.read_occupancy, stats.read_depth, stats.write_occupancy, stats.write_depth);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// the parts of App that the host built sources call, the values are set by the benchmarks.
+#include "fs.hpp"
+#include "log.hpp"
+#include <switch.h>
+
+namespace sphaira {
+
+struct App {
+    // stand in for option::OptionLong.
+    struct OptionLong {
+        s64 value;
+
+        auto Get() const -> s64 {
+            return value;
+        }
+
+        void Set(s64 v) {
+            value = v;
+        }
+    };
+
+    static auto GetApp() -> App* {
+        static App app{};
+        return &app;
+    }
+
+    static auto IsFileBaseEmummc() -> bool {
+        return file_based_emummc;
+    }
+
+    static inline bool file_based_emummc{};
+
+    OptionLong m_audio_decode_ahead{2}; // seconds
+};
+
+} // namespace sphaira
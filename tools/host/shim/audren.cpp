@@ -0,0 +1,311 @@
+// fake audio renderer and pulsar player.
+// voices consume their wave buffers at the sample rate (times the speed set
+// with host::SetAudioSpeed) as audrvUpdate() is called, the pcm is handed to
+// the played callback and a voice that runs dry is counted as an underrun.
+// time is either real or stepped by the audio thread, see host.hpp.
+
+#include "host.hpp"
+#include <pulsar.h>
+
+#include <deque>
+#include <mutex>
+
+namespace {
+
+struct Voice {
+    int channels;
+    int sample_rate;
+    bool started;
+    bool paused;
+    std::deque<AudioDriverWaveBuf*> queue;
+    // frames of the front buffer already played.
+    double consumed;
+    u64 played;
+    u64 last_update;
+    // ran out of buffers after having played some.
+    bool starved;
+    u64 starved_since;
+};
+
+std::mutex g_mutex{};
+Voice g_voices[AUDIO_DRIVER_MAX_VOICES]{};
+double g_speed{1};
+bool g_stepped{};
+u64 g_stepped_ns{};
+sphaira::host::AudioStats g_stats{};
+sphaira::host::AudioPlayedCallback g_played_callback{};
+
+PLSR_Player g_player{};
+bool g_player_init{};
+
+// lock must be held.
+auto GetAudioTimeNs() -> u64 {
+    return g_stepped ? g_stepped_ns : sphaira::host::GetTimeNs();
+}
+
+void UpdateVoice(Voice& v, u64 now) {
+    if (!v.started || v.paused) {
+        v.last_update = now;
+        return;
+    }
+
+    v.consumed += (now - v.last_update) / 1e+9 * v.sample_rate * g_speed;
+    v.last_update = now;
+
+    while (!v.queue.empty()) {
+        auto buf = v.queue.front();
+        const auto frames = buf->end_sample_offset - buf->start_sample_offset;
+        buf->state = AudioDriverWaveBufState_Playing;
+
+        if (v.consumed < frames) {
+            break;
+        }
+
+        if (g_played_callback) {
+            g_played_callback(buf->data_pcm16 + buf->start_sample_offset * v.channels, frames, v.channels);
+        }
+
+        v.consumed -= frames;
+        v.played += frames;
+        g_stats.played_frames += frames;
+        g_stats.buffers++;
+        buf->state = AudioDriverWaveBufState_Done;
+        v.queue.pop_front();
+    }
+
+    // time spent with nothing to play is lost, as it would be on hardware.
+    if (v.queue.empty()) {
+        v.consumed = 0;
+        if (v.played && !v.starved) {
+            v.starved = true;
+            v.starved_since = now;
+        }
+    }
+}
+
+} // namespace
+
+namespace sphaira::host {
+
+void SetAudioSpeed(double speed) {
+    std::scoped_lock lock{g_mutex};
+    g_speed = speed;
+}
+
+void SetAudioClockStepped(bool stepped) {
+    std::scoped_lock lock{g_mutex};
+    if (g_stepped != stepped) {
+        // carry on from the current time, so voices don't jump.
+        const auto now = GetAudioTimeNs();
+        g_stepped = stepped;
+        g_stepped_ns = now;
+    }
+}
+
+void AdvanceAudioClock(u64 ns) {
+    std::scoped_lock lock{g_mutex};
+    g_stepped_ns += ns;
+}
+
+auto GetAudioStats() -> AudioStats {
+    std::scoped_lock lock{g_mutex};
+    return g_stats;
+}
+
+void ResetAudioStats() {
+    std::scoped_lock lock{g_mutex};
+    g_stats = {};
+}
+
+void SetAudioPlayedCallback(const AudioPlayedCallback& callback) {
+    std::scoped_lock lock{g_mutex};
+    g_played_callback = callback;
+}
+
+} // namespace sphaira::host
+
+Result audrvUpdate(AudioDriver* d) {
+    std::scoped_lock lock{g_mutex};
+    const auto now = GetAudioTimeNs();
+
+    for (int i = 0; i < AUDIO_DRIVER_MAX_VOICES; i++) {
+        if (d->in_voices[i].is_used) {
+            UpdateVoice(g_voices[i], now);
+        }
+    }
+
+    return 0;
+}
+
+int audrvMemPoolAdd(AudioDriver* d, void* buffer, size_t size) {
+    std::scoped_lock lock{g_mutex};
+    for (int i = 0; i < AUDIO_DRIVER_MAX_MEMPOOLS; i++) {
+        if (d->in_mempools[i].state == AudioRendererMemPoolState_Invalid) {
+            d->in_mempools[i].state = AudioRendererMemPoolState_Attached;
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool audrvMemPoolRemove(AudioDriver* d, int id) {
+    std::scoped_lock lock{g_mutex};
+    d->in_mempools[id].state = AudioRendererMemPoolState_Invalid;
+    return true;
+}
+
+bool audrvMemPoolAttach(AudioDriver* d, int id) {
+    return true;
+}
+
+bool audrvMemPoolDetach(AudioDriver* d, int id) {
+    return true;
+}
+
+bool audrvVoiceInit(AudioDriver* d, int id, int num_channels, PcmFormat format, int sample_rate) {
+    std::scoped_lock lock{g_mutex};
+    d->in_voices[id] = { .is_used = true, .volume = 1, .pitch = 1 };
+    g_voices[id] = {};
+    g_voices[id].channels = num_channels;
+    g_voices[id].sample_rate = sample_rate;
+    return true;
+}
+
+void audrvVoiceDrop(AudioDriver* d, int id) {
+    std::scoped_lock lock{g_mutex};
+    for (auto buf : g_voices[id].queue) {
+        buf->state = AudioDriverWaveBufState_Done;
+    }
+    g_voices[id] = {};
+    d->in_voices[id] = {};
+}
+
+void audrvVoiceStart(AudioDriver* d, int id) {
+    std::scoped_lock lock{g_mutex};
+    g_voices[id].started = true;
+    g_voices[id].last_update = GetAudioTimeNs();
+}
+
+void audrvVoiceSetDestinationMix(AudioDriver* d, int id, int mix_id) {
+}
+
+void audrvVoiceSetMixFactor(AudioDriver* d, int id, float factor, int src_channel_id, int dest_channel_id) {
+}
+
+void audrvVoiceSetVolume(AudioDriver* d, int id, float volume) {
+    d->in_voices[id].volume = volume;
+}
+
+void audrvVoiceSetPitch(AudioDriver* d, int id, float pitch) {
+    d->in_voices[id].pitch = pitch;
+}
+
+void audrvVoiceSetPaused(AudioDriver* d, int id, bool paused) {
+    std::scoped_lock lock{g_mutex};
+    g_voices[id].paused = paused;
+}
+
+bool audrvVoiceAddWaveBuf(AudioDriver* d, int id, AudioDriverWaveBuf* wavebuf) {
+    std::scoped_lock lock{g_mutex};
+    auto& v = g_voices[id];
+    const auto now = GetAudioTimeNs();
+
+    if (v.starved) {
+        v.starved = false;
+        g_stats.underruns++;
+        g_stats.starved_ns += now - v.starved_since;
+        v.last_update = now;
+    }
+
+    wavebuf->state = AudioDriverWaveBufState_Queued;
+    v.queue.emplace_back(wavebuf);
+    return true;
+}
+
+u32 audrvVoiceGetPlayedSampleCount(AudioDriver* d, int id) {
+    std::scoped_lock lock{g_mutex};
+    return g_voices[id].played;
+}
+
+Result plsrPlayerInit() {
+    g_player = {};
+    g_player.config = { .startVoiceId = 0, .endVoiceId = AUDIO_DRIVER_MAX_VOICES - 1 };
+    g_player_init = true;
+    return 0;
+}
+
+void plsrPlayerExit() {
+    g_player_init = false;
+}
+
+PLSR_Player* plsrPlayerGetInstance() {
+    return g_player_init ? &g_player : nullptr;
+}
+
+Result plsrPlayerPlay(PLSR_PlayerSoundId id) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+Result plsrPlayerStop(PLSR_PlayerSoundId id) {
+    return 0;
+}
+
+void plsrPlayerFree(PLSR_PlayerSoundId id) {
+}
+
+bool plsrPlayerIsPlaying(PLSR_PlayerSoundId id) {
+    return false;
+}
+
+Result plsrPlayerSetVolume(PLSR_PlayerSoundId id, float volume) {
+    return 0;
+}
+
+Result plsrPlayerWaitNextFrame() {
+    return 0;
+}
+
+Result plsrPlayerLoadSoundByName(const PLSR_BFSAR* bfsar, const char* name, PLSR_PlayerSoundId* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+}
+
+Result plsrPlayerLoadStream(const PLSR_BFSTM* bfstm, PLSR_PlayerSoundId* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+Result plsrPlayerLoadWave(const PLSR_BFWAV* bfwav, PLSR_PlayerSoundId* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+Result plsrBFSAROpen(const char* path, PLSR_BFSAR* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+}
+
+void plsrBFSARClose(PLSR_BFSAR* bfsar) {
+}
+
+Result plsrBFSTMOpenMem(const void* data, size_t size, PLSR_BFSTM* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+Result plsrBFSTMReadInfo(PLSR_BFSTM* bfstm, PLSR_BFSTMInfo* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+void plsrBFSTMClose(PLSR_BFSTM* bfstm) {
+}
+
+Result plsrBFWAVOpen(const char* path, PLSR_BFWAV* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+}
+
+Result plsrBFWAVOpenMem(const void* data, size_t size, PLSR_BFWAV* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+Result plsrBFWAVReadInfo(PLSR_BFWAV* bfwav, PLSR_BFWAVInfo* out) {
+    return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+}
+
+void plsrBFWAVClose(PLSR_BFWAV* bfwav) {
+}
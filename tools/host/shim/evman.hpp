@@ -0,0 +1,33 @@
+#pragma once
+
+// the events that the host built sources push, the pushed events are kept so
+// that the tests can check them.
+#include <string>
+#include <vector>
+#include <variant>
+#include <switch.h>
+
+namespace sphaira::evman {
+
+struct LaunchNroEventData {
+    std::string path;
+    std::string argv;
+};
+
+struct ExitEventData {
+    bool dummy;
+};
+
+using EventData = std::variant<
+    LaunchNroEventData,
+    ExitEventData
+>;
+
+inline std::vector<EventData> g_events{};
+
+inline auto push(const EventData& e, bool remove_matching = true) -> bool {
+    g_events.emplace_back(e);
+    return true;
+}
+
+} // namespace sphaira::evman
@@ -0,0 +1,89 @@
+#pragma once
+
+// host only controls for the libnx shim, used by the benchmarks and tests.
+
+#include <switch.h>
+#include <cstdarg>
+#include <atomic>
+#include <functional>
+
+namespace sphaira::host {
+
+// host directory that every FsFileSystem (and "sdmc:") maps onto.
+void SetSdRoot(const char* path);
+auto GetSdRoot() -> const char*;
+
+// makes fsFsGetFileTimeStampRaw fail, as it does on some custom filesystems.
+void SetTimeStampFail(bool fail);
+
+// memory reported by svcGetInfo, used to size the transfer buffers.
+void SetMemory(u64 total, u64 used);
+
+// simulated device speed, Apply() sleeps for as long as the device would take.
+struct DeviceModel {
+    // per request.
+    double latency_ms{};
+    // MiB/s, 0 for unlimited.
+    double bandwidth{};
+    // a stall of stall_ms every stall_every bytes, such as an sd card flush.
+    u64 stall_every{};
+    double stall_ms{};
+
+    // bytes seen so far, used for the stalls.
+    std::atomic<u64> total{};
+
+    void Apply(u64 bytes);
+};
+
+// models applied to fsFileRead / fsFileWrite, default is unlimited.
+void SetFsReadModel(DeviceModel* model);
+void SetFsWriteModel(DeviceModel* model);
+
+// log_write goes to stderr when enabled, off by default.
+void SetLogEnabled(bool enable);
+
+// process wide counters read by the benchmarks.
+struct Counters {
+    u64 fs_file_reads;
+    u64 fs_file_read_bytes;
+    u64 fs_file_opens;
+    u64 fs_dir_reads;
+    u64 fs_timestamp_calls;
+};
+
+auto GetCounters() -> Counters;
+void ResetCounters();
+
+// fake audio renderer, see audren.cpp.
+// voices play their wave buffers at speed times real time.
+void SetAudioSpeed(double speed);
+
+// by default the voices play against real time, so an audio thread that is
+// scheduled late runs them dry. a stepped clock only moves forward by the
+// timeout of each waitObjects() that timed out, which is the time the audio
+// thread expects to have passed, so underruns only depend on the decoding.
+// assumes the audio thread is the only one waiting with a timeout.
+void SetAudioClockStepped(bool stepped);
+void AdvanceAudioClock(u64 ns);
+
+struct AudioStats {
+    u64 played_frames;
+    u64 buffers;
+    // times a voice ran out of wave buffers and was later given more.
+    u32 underruns;
+    u64 starved_ns;
+};
+
+auto GetAudioStats() -> AudioStats;
+void ResetAudioStats();
+
+// called with the pcm of every wave buffer once it has been played.
+using AudioPlayedCallback = std::function<void(const s16* data, u32 frames, u32 channels)>;
+void SetAudioPlayedCallback(const AudioPlayedCallback& callback);
+
+auto GetTimeNs() -> u64;
+
+// peak resident memory of the process in bytes.
+auto GetPeakRss() -> u64;
+
+} // namespace sphaira::host
@@ -0,0 +1,4 @@
+#pragma once
+
+// minIni isn't built on the host, this is only here for the sources that
+// include it without using it.
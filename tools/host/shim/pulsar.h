@@ -0,0 +1,63 @@
+#pragma once
+
+// the subset of pulsar used by audio.cpp, the player only owns the fake audio
+// driver, loading bfstm / bfwav / bfsar always fails.
+#include <switch.h>
+
+typedef struct {
+    int startVoiceId;
+    int endVoiceId;
+} PLSR_PlayerConfig;
+
+typedef struct {
+    AudioDriver driver;
+    PLSR_PlayerConfig config;
+} PLSR_Player;
+
+typedef struct {
+    int voiceId;
+} PLSR_PlayerSoundChannel;
+
+typedef struct {
+    u32 channelCount;
+    PLSR_PlayerSoundChannel channels[2];
+} PLSR_PlayerSound;
+
+typedef PLSR_PlayerSound* PLSR_PlayerSoundId;
+
+typedef struct { int unused; } PLSR_BFSAR;
+typedef struct { int unused; } PLSR_BFSTM;
+typedef struct { int unused; } PLSR_BFWAV;
+
+typedef struct {
+    u32 sampleCount;
+    u32 sampleRate;
+    u32 loopStartSample;
+    bool looping;
+} PLSR_BFSTMInfo;
+
+typedef PLSR_BFSTMInfo PLSR_BFWAVInfo;
+
+Result plsrPlayerInit();
+void plsrPlayerExit();
+PLSR_Player* plsrPlayerGetInstance();
+
+Result plsrPlayerPlay(PLSR_PlayerSoundId id);
+Result plsrPlayerStop(PLSR_PlayerSoundId id);
+void plsrPlayerFree(PLSR_PlayerSoundId id);
+bool plsrPlayerIsPlaying(PLSR_PlayerSoundId id);
+Result plsrPlayerSetVolume(PLSR_PlayerSoundId id, float volume);
+Result plsrPlayerWaitNextFrame();
+Result plsrPlayerLoadSoundByName(const PLSR_BFSAR* bfsar, const char* name, PLSR_PlayerSoundId* out);
+Result plsrPlayerLoadStream(const PLSR_BFSTM* bfstm, PLSR_PlayerSoundId* out);
+Result plsrPlayerLoadWave(const PLSR_BFWAV* bfwav, PLSR_PlayerSoundId* out);
+
+Result plsrBFSAROpen(const char* path, PLSR_BFSAR* out);
+void plsrBFSARClose(PLSR_BFSAR* bfsar);
+Result plsrBFSTMOpenMem(const void* data, size_t size, PLSR_BFSTM* out);
+Result plsrBFSTMReadInfo(PLSR_BFSTM* bfstm, PLSR_BFSTMInfo* out);
+void plsrBFSTMClose(PLSR_BFSTM* bfstm);
+Result plsrBFWAVOpen(const char* path, PLSR_BFWAV* out);
+Result plsrBFWAVOpenMem(const void* data, size_t size, PLSR_BFWAV* out);
+Result plsrBFWAVReadInfo(PLSR_BFWAV* bfwav, PLSR_BFWAVInfo* out);
+void plsrBFWAVClose(PLSR_BFWAV* bfwav);
@@ -0,0 +1,848 @@
+#include "host.hpp"
+#include "log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace {
+
+// fs result values, see FsError in defines.hpp.
+constexpr Result FsError_PathNotFound = 0x202;
+constexpr Result FsError_PathAlreadyExists = 0x402;
+constexpr Result FsError_TargetLocked = 0xE02;
+constexpr Result FsError_DirectoryNotEmpty = 0x1002;
+constexpr Result FsError_UnexpectedInFindFileSystemE = 0x177202;
+constexpr Result FsError_NotImplemented = 0x177A02;
+
+std::atomic<u64> g_total_memory{4ULL * 1024 * 1024 * 1024};
+std::atomic<u64> g_used_memory{};
+std::atomic_bool g_timestamp_fail{};
+std::atomic_bool g_log_enabled{};
+std::string g_sd_root{"."};
+thread_local Result g_last_result{};
+std::atomic<sphaira::host::DeviceModel*> g_read_model{};
+std::atomic<sphaira::host::DeviceModel*> g_write_model{};
+
+struct AtomicCounters {
+    std::atomic<u64> fs_file_reads;
+    std::atomic<u64> fs_file_read_bytes;
+    std::atomic<u64> fs_file_opens;
+    std::atomic<u64> fs_dir_reads;
+    std::atomic<u64> fs_timestamp_calls;
+} g_counters{};
+
+auto Atomic(u32* p) -> std::atomic_ref<u32> {
+    return std::atomic_ref<u32>{*p};
+}
+
+long Futex(u32* addr, int op, u32 val, const timespec* timeout = nullptr) {
+    return syscall(SYS_futex, addr, op | FUTEX_PRIVATE_FLAG, val, timeout, nullptr, 0);
+}
+
+auto ToTimespec(u64 ns) -> timespec {
+    return { static_cast<time_t>(ns / 1'000'000'000ULL), static_cast<long>(ns % 1'000'000'000ULL) };
+}
+
+// bumped on every event signal and thread exit, waitObjects sleeps on it.
+u32 g_wait_seq{};
+
+void WakeWaiters() {
+    Atomic(&g_wait_seq).fetch_add(1);
+    Futex(&g_wait_seq, FUTEX_WAKE, INT_MAX);
+}
+
+struct ThreadState {
+    ThreadFunc entry{};
+    void* arg{};
+    std::thread thread{};
+    std::atomic_bool exited{};
+};
+
+std::mutex g_thread_mutex{};
+std::unordered_map<Handle, std::unique_ptr<ThreadState>> g_threads{};
+Handle g_next_handle{0x1000};
+thread_local Handle g_cur_handle{};
+
+auto GetThread(Handle handle) -> ThreadState* {
+    std::scoped_lock lock{g_thread_mutex};
+    if (auto it = g_threads.find(handle); it != g_threads.end()) {
+        return it->second.get();
+    }
+    return nullptr;
+}
+
+auto ResultFromErrno(int err) -> Result {
+    switch (err) {
+        case ENOENT: case ENOTDIR: return FsError_PathNotFound;
+        case EEXIST: return FsError_PathAlreadyExists;
+        case ENOTEMPTY: return FsError_DirectoryNotEmpty;
+        case EBUSY: return FsError_TargetLocked;
+        default: return FsError_UnexpectedInFindFileSystemE;
+    }
+}
+
+auto HostPath(const char* path) -> std::string {
+    // strip the device, "sdmc:/foo" -> "/foo".
+    if (auto colon = std::strchr(path, ':')) {
+        path = colon + 1;
+    }
+    return g_sd_root + path;
+}
+
+struct HostDir {
+    DIR* dir;
+    std::string path;
+    u32 mode;
+};
+
+std::mutex g_dir_mutex{};
+std::unordered_map<Handle, HostDir> g_dirs{};
+Handle g_next_dir{1};
+
+bool ReadDirEntry(HostDir& d, FsDirectoryEntry& out) {
+    while (auto e = readdir(d.dir)) {
+        if (!std::strcmp(e->d_name, ".") || !std::strcmp(e->d_name, "..")) {
+            continue;
+        }
+
+        const auto full = d.path + "/" + e->d_name;
+        struct stat st;
+        if (stat(full.c_str(), &st)) {
+            continue;
+        }
+
+        const auto is_dir = S_ISDIR(st.st_mode);
+        if ((is_dir && !(d.mode & FsDirOpenMode_ReadDirs)) || (!is_dir && !(d.mode & FsDirOpenMode_ReadFiles))) {
+            continue;
+        }
+
+        out = {};
+        std::snprintf(out.name, sizeof(out.name), "%s", e->d_name);
+        out.type = is_dir ? FsDirEntryType_Dir : FsDirEntryType_File;
+        if (!is_dir && !(d.mode & FsDirOpenMode_NoFileSize)) {
+            out.file_size = st.st_size;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+int RemoveRecursive(const std::string& path) {
+    if (auto dir = opendir(path.c_str())) {
+        while (auto e = readdir(dir)) {
+            if (!std::strcmp(e->d_name, ".") || !std::strcmp(e->d_name, "..")) {
+                continue;
+            }
+            const auto full = path + "/" + e->d_name;
+            if (e->d_type == DT_DIR) {
+                RemoveRecursive(full);
+            } else {
+                unlink(full.c_str());
+            }
+        }
+        closedir(dir);
+    }
+    return rmdir(path.c_str());
+}
+
+} // namespace
+
+namespace sphaira::host {
+
+void SetSdRoot(const char* path) {
+    g_sd_root = path;
+    while (!g_sd_root.empty() && g_sd_root.back() == '/') {
+        g_sd_root.pop_back();
+    }
+}
+
+auto GetSdRoot() -> const char* {
+    return g_sd_root.c_str();
+}
+
+void SetTimeStampFail(bool fail) {
+    g_timestamp_fail = fail;
+}
+
+void SetMemory(u64 total, u64 used) {
+    g_total_memory = total;
+    g_used_memory = used;
+}
+
+void DeviceModel::Apply(u64 bytes) {
+    double ms = latency_ms;
+    if (bandwidth > 0) {
+        ms += bytes / (bandwidth * 1024.0 * 1024.0) * 1000.0;
+    }
+
+    if (stall_every) {
+        const auto before = total.fetch_add(bytes);
+        if ((before + bytes) / stall_every != before / stall_every) {
+            ms += stall_ms;
+        }
+    }
+
+    if (ms > 0) {
+        svcSleepThread(s64(ms * 1e+6));
+    }
+}
+
+void SetFsReadModel(DeviceModel* model) {
+    g_read_model = model;
+}
+
+void SetFsWriteModel(DeviceModel* model) {
+    g_write_model = model;
+}
+
+void SetLogEnabled(bool enable) {
+    g_log_enabled = enable;
+}
+
+auto GetCounters() -> Counters {
+    return {
+        g_counters.fs_file_reads.load(),
+        g_counters.fs_file_read_bytes.load(),
+        g_counters.fs_file_opens.load(),
+        g_counters.fs_dir_reads.load(),
+        g_counters.fs_timestamp_calls.load(),
+    };
+}
+
+void ResetCounters() {
+    g_counters.fs_file_reads = 0;
+    g_counters.fs_file_read_bytes = 0;
+    g_counters.fs_file_opens = 0;
+    g_counters.fs_dir_reads = 0;
+    g_counters.fs_timestamp_calls = 0;
+}
+
+auto GetTimeNs() -> u64 {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+auto GetPeakRss() -> u64 {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return u64(usage.ru_maxrss) * 1024;
+}
+
+} // namespace sphaira::host
+
+extern "C" {
+
+bool log_file_init() { return true; }
+bool log_nxlink_init() { return true; }
+void log_file_exit() {}
+void log_nxlink_exit() {}
+bool log_is_init() { return g_log_enabled; }
+
+void log_write(const char* s, ...) {
+    if (g_log_enabled) {
+        std::va_list v;
+        va_start(v, s);
+        std::vfprintf(stderr, s, v);
+        va_end(v);
+    }
+}
+
+void log_write_arg(const char* s, va_list* v) {
+    if (g_log_enabled) {
+        std::vfprintf(stderr, s, *v);
+    }
+}
+
+} // extern "C"
+
+// 19.2MHz, same as the switch.
+u64 armGetSystemTickFreq() {
+    return 19'200'000;
+}
+
+u64 armTicksToNs(u64 tick) {
+    return tick * 625 / 12;
+}
+
+u64 armNsToTicks(u64 ns) {
+    return ns * 12 / 625;
+}
+
+u64 armGetSystemTick() {
+    return armNsToTicks(sphaira::host::GetTimeNs());
+}
+
+Result svcGetInfo(u64* out, u32 id0, Handle handle, u64 id1) {
+    switch (id0) {
+        case InfoType_CoreMask: *out = 0b111; break;
+        case InfoType_TotalMemorySize: *out = g_total_memory; break;
+        case InfoType_UsedMemorySize: *out = g_used_memory; break;
+        default: *out = 0; break;
+    }
+    return 0;
+}
+
+Result svcSetThreadCoreMask(Handle handle, s32 preferred_core, u32 affinity_mask) {
+    return 0;
+}
+
+void svcSleepThread(s64 nano) {
+    if (nano <= 0) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(nano));
+    }
+}
+
+void mutexInit(Mutex* m) {
+    *m = 0;
+}
+
+void mutexLock(Mutex* m) {
+    u32 c = 0;
+    if (Atomic(m).compare_exchange_strong(c, 1)) {
+        return;
+    }
+
+    if (c != 2) {
+        c = Atomic(m).exchange(2);
+    }
+
+    while (c) {
+        Futex(m, FUTEX_WAIT, 2);
+        c = Atomic(m).exchange(2);
+    }
+}
+
+bool mutexTryLock(Mutex* m) {
+    u32 c = 0;
+    return Atomic(m).compare_exchange_strong(c, 1);
+}
+
+// like libnx, unlocking a mutex that is not locked is allowed.
+void mutexUnlock(Mutex* m) {
+    if (Atomic(m).exchange(0) == 2) {
+        Futex(m, FUTEX_WAKE, 1);
+    }
+}
+
+bool mutexIsLockedByCurrentThread(const Mutex* m) {
+    return Atomic(const_cast<Mutex*>(m)).load() != 0;
+}
+
+void rmutexInit(RMutex* m) {
+    *m = {};
+}
+
+void rmutexLock(RMutex* m) {
+    const auto tag = threadGetCurHandle() + 1;
+    if (std::atomic_ref<u32>{m->thread_tag}.load() != tag) {
+        mutexLock(&m->lock);
+        std::atomic_ref<u32>{m->thread_tag}.store(tag);
+    }
+    m->counter++;
+}
+
+void rmutexUnlock(RMutex* m) {
+    if (!--m->counter) {
+        std::atomic_ref<u32>{m->thread_tag}.store(0);
+        mutexUnlock(&m->lock);
+    }
+}
+
+void rwlockInit(RwLock* r) {
+    *r = {};
+}
+
+void rwlockReadLock(RwLock* r) {
+    mutexLock(&r->mutex);
+    std::atomic_ref<u32>{r->readers}.fetch_add(1);
+    mutexUnlock(&r->mutex);
+}
+
+void rwlockReadUnlock(RwLock* r) {
+    std::atomic_ref<u32>{r->readers}.fetch_sub(1);
+}
+
+void rwlockWriteLock(RwLock* r) {
+    mutexLock(&r->mutex);
+    while (std::atomic_ref<u32>{r->readers}.load()) {
+        std::this_thread::yield();
+    }
+}
+
+void rwlockWriteUnlock(RwLock* r) {
+    mutexUnlock(&r->mutex);
+}
+
+void condvarInit(CondVar* c) {
+    *c = 0;
+}
+
+Result condvarWaitTimeout(CondVar* c, Mutex* m, u64 timeout) {
+    const auto seq = Atomic(c).load();
+    mutexUnlock(m);
+
+    long ret;
+    if (timeout == UINT64_MAX) {
+        ret = Futex(c, FUTEX_WAIT, seq);
+    } else {
+        const auto ts = ToTimespec(timeout);
+        ret = Futex(c, FUTEX_WAIT, seq, &ts);
+    }
+    const auto err = errno;
+
+    mutexLock(m);
+    if (ret == -1 && err == ETIMEDOUT) {
+        return KERNELRESULT(TimedOut);
+    }
+    return 0;
+}
+
+Result condvarWait(CondVar* c, Mutex* m) {
+    return condvarWaitTimeout(c, m, UINT64_MAX);
+}
+
+Result condvarWakeOne(CondVar* c) {
+    Atomic(c).fetch_add(1);
+    Futex(c, FUTEX_WAKE, 1);
+    return 0;
+}
+
+Result condvarWakeAll(CondVar* c) {
+    Atomic(c).fetch_add(1);
+    Futex(c, FUTEX_WAKE, INT_MAX);
+    return 0;
+}
+
+Result threadCreate(Thread* t, ThreadFunc entry, void* arg, void* stack_mem, size_t stack_sz, int prio, int cpuid) {
+    auto state = std::make_unique<ThreadState>();
+    state->entry = entry;
+    state->arg = arg;
+
+    std::scoped_lock lock{g_thread_mutex};
+    t->handle = g_next_handle++;
+    g_threads.emplace(t->handle, std::move(state));
+    return 0;
+}
+
+Result threadStart(Thread* t) {
+    auto state = GetThread(t->handle);
+    if (!state) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+
+    const auto handle = t->handle;
+    state->thread = std::thread([state, handle]() {
+        g_cur_handle = handle;
+        state->entry(state->arg);
+        state->exited = true;
+        WakeWaiters();
+    });
+    return 0;
+}
+
+Result threadWaitForExit(Thread* t) {
+    auto state = GetThread(t->handle);
+    if (state && state->thread.joinable()) {
+        state->thread.join();
+    }
+    return 0;
+}
+
+Result threadClose(Thread* t) {
+    std::unique_ptr<ThreadState> state;
+    {
+        std::scoped_lock lock{g_thread_mutex};
+        if (auto it = g_threads.find(t->handle); it != g_threads.end()) {
+            state = std::move(it->second);
+            g_threads.erase(it);
+        }
+    }
+
+    if (state && state->thread.joinable()) {
+        state->thread.join();
+    }
+    return 0;
+}
+
+Handle threadGetCurHandle() {
+    return g_cur_handle;
+}
+
+void ueventCreate(UEvent* e, bool auto_clear) {
+    e->signal = false;
+    e->auto_clear = auto_clear;
+}
+
+void ueventClear(UEvent* e) {
+    std::atomic_ref<bool>{e->signal}.store(false);
+}
+
+void ueventSignal(UEvent* e) {
+    std::atomic_ref<bool>{e->signal}.store(true);
+    WakeWaiters();
+}
+
+Result waitObjects(s32* idx_out, const Waiter* objects, s32 num_objects, u64 timeout) {
+    const auto deadline = timeout == UINT64_MAX ? UINT64_MAX : sphaira::host::GetTimeNs() + timeout;
+
+    for (;;) {
+        const auto seq = Atomic(&g_wait_seq).load();
+
+        for (s32 i = 0; i < num_objects; i++) {
+            const auto& w = objects[i];
+            if (w.type == WaiterType_Waitable) {
+                std::atomic_ref<bool> signal{w.event->signal};
+                if (w.event->auto_clear ? signal.exchange(false) : signal.load()) {
+                    *idx_out = i;
+                    return 0;
+                }
+            } else {
+                auto state = GetThread(w.handle);
+                if (!state || state->exited) {
+                    *idx_out = i;
+                    return 0;
+                }
+            }
+        }
+
+        const auto now = sphaira::host::GetTimeNs();
+        if (now >= deadline) {
+            sphaira::host::AdvanceAudioClock(timeout);
+            return KERNELRESULT(TimedOut);
+        }
+
+        if (deadline == UINT64_MAX) {
+            Futex(&g_wait_seq, FUTEX_WAIT, seq);
+        } else {
+            const auto ts = ToTimespec(deadline - now);
+            Futex(&g_wait_seq, FUTEX_WAIT, seq, &ts);
+        }
+    }
+}
+
+u32 crc32Calculate(const void* src, size_t size) {
+    return crc32CalculateWithSeed(0, src, size);
+}
+
+u32 crc32CalculateWithSeed(u32 crc, const void* src, size_t size) {
+    return ::crc32(crc, static_cast<const Bytef*>(src), size);
+}
+
+ssize_t utf16_to_utf8(u8* out, const u16* in, size_t len) {
+    size_t written = 0;
+
+    while (*in) {
+        u32 c = *in++;
+        if (c >= 0xD800 && c <= 0xDBFF) {
+            if (*in < 0xDC00 || *in > 0xDFFF) {
+                return -1;
+            }
+            c = 0x10000 + ((c - 0xD800) << 10) + (*in++ - 0xDC00);
+        } else if (c >= 0xDC00 && c <= 0xDFFF) {
+            return -1;
+        }
+
+        u8 buf[4];
+        size_t size;
+        if (c < 0x80) {
+            buf[0] = c;
+            size = 1;
+        } else if (c < 0x800) {
+            buf[0] = 0xC0 | (c >> 6);
+            buf[1] = 0x80 | (c & 0x3F);
+            size = 2;
+        } else if (c < 0x10000) {
+            buf[0] = 0xE0 | (c >> 12);
+            buf[1] = 0x80 | ((c >> 6) & 0x3F);
+            buf[2] = 0x80 | (c & 0x3F);
+            size = 3;
+        } else {
+            buf[0] = 0xF0 | (c >> 18);
+            buf[1] = 0x80 | ((c >> 12) & 0x3F);
+            buf[2] = 0x80 | ((c >> 6) & 0x3F);
+            buf[3] = 0x80 | (c & 0x3F);
+            size = 4;
+        }
+
+        if (written + size > len) {
+            break;
+        }
+
+        std::memcpy(out + written, buf, size);
+        written += size;
+    }
+
+    return written;
+}
+
+Result fsOpenSdCardFileSystem(FsFileSystem* out) {
+    out->s.session = 1;
+    return 0;
+}
+
+Result fsOpenBisFileSystem(FsFileSystem* out, FsBisPartitionId id, const char* string) { return FsError_NotImplemented; }
+Result fsOpenImageDirectoryFileSystem(FsFileSystem* out, FsImageDirectoryId id) { return FsError_NotImplemented; }
+Result fsOpenContentStorageFileSystem(FsFileSystem* out, FsContentStorageId id) { return FsError_NotImplemented; }
+Result fsOpenGameCardFileSystem(FsFileSystem* out, const FsGameCardHandle* handle, FsGameCardPartition partition) { return FsError_NotImplemented; }
+Result fsOpenSaveDataFileSystem(FsFileSystem* out, FsSaveDataSpaceId save_data_space_id, const FsSaveDataAttribute* attr) { return FsError_NotImplemented; }
+Result fsOpenReadOnlySaveDataFileSystem(FsFileSystem* out, FsSaveDataSpaceId save_data_space_id, const FsSaveDataAttribute* attr) { return FsError_NotImplemented; }
+Result fsOpenSaveDataFileSystemBySystemSaveDataId(FsFileSystem* out, FsSaveDataSpaceId save_data_space_id, const FsSaveDataAttribute* attr) { return FsError_NotImplemented; }
+Result fsOpenFileSystemWithId(FsFileSystem* out, u64 id, FsFileSystemType fs_type, const char* content_path, FsContentAttributes attr) { return FsError_NotImplemented; }
+
+Result fsFsCreateFile(FsFileSystem* fs, const char* path, s64 size, u32 option) {
+    const auto fd = open(HostPath(path).c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return ResultFromErrno(errno);
+    }
+
+    const auto rc = ftruncate(fd, size);
+    close(fd);
+    return rc ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFsDeleteFile(FsFileSystem* fs, const char* path) {
+    return unlink(HostPath(path).c_str()) ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFsCreateDirectory(FsFileSystem* fs, const char* path) {
+    return mkdir(HostPath(path).c_str(), 0755) ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFsDeleteDirectory(FsFileSystem* fs, const char* path) {
+    return rmdir(HostPath(path).c_str()) ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFsDeleteDirectoryRecursively(FsFileSystem* fs, const char* path) {
+    return RemoveRecursive(HostPath(path)) ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFsRenameFile(FsFileSystem* fs, const char* cur_path, const char* new_path) {
+    return rename(HostPath(cur_path).c_str(), HostPath(new_path).c_str()) ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFsRenameDirectory(FsFileSystem* fs, const char* cur_path, const char* new_path) {
+    return fsFsRenameFile(fs, cur_path, new_path);
+}
+
+Result fsFsGetEntryType(FsFileSystem* fs, const char* path, FsDirEntryType* out) {
+    struct stat st;
+    if (stat(HostPath(path).c_str(), &st)) {
+        return ResultFromErrno(errno);
+    }
+    *out = S_ISDIR(st.st_mode) ? FsDirEntryType_Dir : FsDirEntryType_File;
+    return 0;
+}
+
+Result fsFsOpenFile(FsFileSystem* fs, const char* path, u32 mode, FsFile* out) {
+    int flags = O_RDONLY;
+    if (mode & (FsOpenMode_Write | FsOpenMode_Append)) {
+        flags = (mode & FsOpenMode_Read) ? O_RDWR : O_WRONLY;
+    }
+
+    const auto host_path = HostPath(path);
+    struct stat st;
+    if (stat(host_path.c_str(), &st)) {
+        return ResultFromErrno(errno);
+    }
+    if (S_ISDIR(st.st_mode)) {
+        return FsError_PathNotFound;
+    }
+
+    const auto fd = open(host_path.c_str(), flags);
+    if (fd < 0) {
+        return ResultFromErrno(errno);
+    }
+
+    g_counters.fs_file_opens++;
+    // fd + 1 as 0 is an invalid handle.
+    out->s.session = fd + 1;
+    return 0;
+}
+
+Result fsFsOpenDirectory(FsFileSystem* fs, const char* path, u32 mode, FsDir* out) {
+    const auto host_path = HostPath(path);
+    auto dir = opendir(host_path.c_str());
+    if (!dir) {
+        return ResultFromErrno(errno);
+    }
+
+    std::scoped_lock lock{g_dir_mutex};
+    out->s.session = g_next_dir++;
+    g_dirs.emplace(out->s.session, HostDir{dir, host_path, mode});
+    return 0;
+}
+
+Result fsFsCommit(FsFileSystem* fs) {
+    return 0;
+}
+
+Result fsFsGetFreeSpace(FsFileSystem* fs, const char* path, s64* out) {
+    *out = 1024LL * 1024 * 1024 * 64;
+    return 0;
+}
+
+Result fsFsGetTotalSpace(FsFileSystem* fs, const char* path, s64* out) {
+    *out = 1024LL * 1024 * 1024 * 128;
+    return 0;
+}
+
+Result fsFsGetFileTimeStampRaw(FsFileSystem* fs, const char* path, FsTimeStampRaw* out) {
+    g_counters.fs_timestamp_calls++;
+    if (g_timestamp_fail) {
+        return FsError_NotImplemented;
+    }
+
+    struct stat st;
+    if (stat(HostPath(path).c_str(), &st)) {
+        return ResultFromErrno(errno);
+    }
+
+    *out = {};
+    out->is_valid = true;
+    out->created = st.st_ctim.tv_sec;
+    out->modified = st.st_mtim.tv_sec;
+    out->accessed = st.st_atim.tv_sec;
+    return 0;
+}
+
+void fsFsClose(FsFileSystem* fs) {
+    fs->s.session = INVALID_HANDLE;
+}
+
+Result fsFileRead(FsFile* f, s64 off, void* buf, u64 read_size, u32 option, u64* bytes_read) {
+    const auto ret = pread(f->s.session - 1, buf, read_size, off);
+    if (ret < 0) {
+        return ResultFromErrno(errno);
+    }
+
+    if (auto model = g_read_model.load()) {
+        model->Apply(ret);
+    }
+
+    g_counters.fs_file_reads++;
+    g_counters.fs_file_read_bytes += ret;
+    *bytes_read = ret;
+    return 0;
+}
+
+Result fsFileWrite(FsFile* f, s64 off, const void* buf, u64 write_size, u32 option) {
+    const auto fd = f->s.session - 1;
+    if (auto model = g_write_model.load()) {
+        model->Apply(write_size);
+    }
+
+    // like fs, writing past the end grows the file.
+    auto data = static_cast<const u8*>(buf);
+    while (write_size) {
+        const auto ret = pwrite(fd, data, write_size, off);
+        if (ret <= 0) {
+            return ResultFromErrno(errno);
+        }
+        data += ret;
+        off += ret;
+        write_size -= ret;
+    }
+    return 0;
+}
+
+Result fsFileFlush(FsFile* f) {
+    return 0;
+}
+
+Result fsFileSetSize(FsFile* f, s64 sz) {
+    return ftruncate(f->s.session - 1, sz) ? ResultFromErrno(errno) : 0;
+}
+
+Result fsFileGetSize(FsFile* f, s64* out) {
+    struct stat st;
+    if (fstat(f->s.session - 1, &st)) {
+        return ResultFromErrno(errno);
+    }
+    *out = st.st_size;
+    return 0;
+}
+
+void fsFileClose(FsFile* f) {
+    if (f->s.session) {
+        close(f->s.session - 1);
+        f->s.session = INVALID_HANDLE;
+    }
+}
+
+Result fsDirRead(FsDir* d, s64* total_entries, size_t max_entries, FsDirectoryEntry* buf) {
+    std::scoped_lock lock{g_dir_mutex};
+    auto& dir = g_dirs.at(d->s.session);
+
+    g_counters.fs_dir_reads++;
+    *total_entries = 0;
+    while ((size_t)*total_entries < max_entries && ReadDirEntry(dir, buf[*total_entries])) {
+        (*total_entries)++;
+    }
+    return 0;
+}
+
+Result fsDirGetEntryCount(FsDir* d, s64* count) {
+    std::scoped_lock lock{g_dir_mutex};
+    auto& dir = g_dirs.at(d->s.session);
+
+    *count = 0;
+    rewinddir(dir.dir);
+    FsDirectoryEntry e;
+    while (ReadDirEntry(dir, e)) {
+        (*count)++;
+    }
+    rewinddir(dir.dir);
+    return 0;
+}
+
+void fsDirClose(FsDir* d) {
+    std::scoped_lock lock{g_dir_mutex};
+    if (auto it = g_dirs.find(d->s.session); it != g_dirs.end()) {
+        closedir(it->second.dir);
+        g_dirs.erase(it);
+    }
+    d->s.session = INVALID_HANDLE;
+}
+
+FsFileSystem* fsdevGetDeviceFileSystem(const char* name) {
+    static FsFileSystem sdmc{ { 1 } };
+    return &sdmc;
+}
+
+Result fsdevGetLastResult() {
+    return g_last_result;
+}
+
+u32 hosversionGet() {
+    return MAKEHOSVERSION(20, 0, 0);
+}
+
+Result nacpGetLanguageEntry(NacpStruct* nacp, NacpLanguageEntry** langentry) {
+    *langentry = &nacp->lang[0];
+    return 0;
+}
+
+Result envSetNextLoad(const char* path, const char* argv) {
+    return 0;
+}
@@ -0,0 +1,538 @@
+#pragma once
+
+// the subset of libnx used by the sources built on the host.
+// types match libnx, the implementation is in switch.cpp and is built on
+// top of std::thread, futexes and posix files.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <sys/types.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef volatile u32 vu32;
+
+typedef u32 Result;
+typedef u32 Handle;
+
+#define BIT(n) (1U<<(n))
+#define NX_INLINE __attribute__((always_inline)) static inline
+#define NX_PACKED __attribute__((packed))
+#define INVALID_HANDLE ((Handle)0)
+#define CUR_PROCESS_HANDLE 0xFFFF8001
+
+#define R_SUCCEEDED(res) ((res)==0)
+#define R_FAILED(res) ((res)!=0)
+#define R_MODULE(res) ((res)&0x1FF)
+#define R_DESCRIPTION(res) (((res)>>9)&0x1FFF)
+#define R_VALUE(res) ((res)&0x3FFFFF)
+#define MAKERESULT(module,description) ((((module)&0x1FF)) | ((description)&0x1FFF)<<9)
+
+enum {
+    Module_Kernel = 1,
+    Module_Libnx = 345,
+};
+
+enum {
+    KernelError_TimedOut = 117,
+    KernelError_Cancelled = 118,
+};
+
+enum {
+    LibnxError_BadInput = 14,
+    LibnxError_NotFound = 31,
+    LibnxError_IoError = 32,
+};
+
+#define KERNELRESULT(desc) MAKERESULT(Module_Kernel, KernelError_##desc)
+
+// -- arm --
+u64 armGetSystemTick();
+u64 armGetSystemTickFreq();
+u64 armTicksToNs(u64 tick);
+u64 armNsToTicks(u64 ns);
+
+// the host has coherent caches.
+static inline void armDCacheFlush(void* addr, size_t size) {
+}
+
+// -- svc --
+typedef enum {
+    InfoType_CoreMask = 0,
+    InfoType_TotalMemorySize = 6,
+    InfoType_UsedMemorySize = 7,
+} InfoType;
+
+Result svcGetInfo(u64* out, u32 id0, Handle handle, u64 id1);
+Result svcSetThreadCoreMask(Handle handle, s32 preferred_core, u32 affinity_mask);
+void svcSleepThread(s64 nano);
+
+// -- kernel sync --
+// 0 = unlocked, 1 = locked, 2 = locked with waiters.
+typedef u32 Mutex;
+
+void mutexInit(Mutex* m);
+void mutexLock(Mutex* m);
+bool mutexTryLock(Mutex* m);
+void mutexUnlock(Mutex* m);
+bool mutexIsLockedByCurrentThread(const Mutex* m);
+
+typedef struct {
+    Mutex lock;
+    u32 thread_tag;
+    u32 counter;
+} RMutex;
+
+void rmutexInit(RMutex* m);
+void rmutexLock(RMutex* m);
+void rmutexUnlock(RMutex* m);
+
+typedef struct {
+    Mutex mutex;
+    u32 readers;
+} RwLock;
+
+void rwlockInit(RwLock* r);
+void rwlockReadLock(RwLock* r);
+void rwlockReadUnlock(RwLock* r);
+void rwlockWriteLock(RwLock* r);
+void rwlockWriteUnlock(RwLock* r);
+
+typedef u32 CondVar;
+
+void condvarInit(CondVar* c);
+Result condvarWaitTimeout(CondVar* c, Mutex* m, u64 timeout);
+Result condvarWait(CondVar* c, Mutex* m);
+Result condvarWakeOne(CondVar* c);
+Result condvarWakeAll(CondVar* c);
+
+// -- thread --
+typedef void (*ThreadFunc)(void*);
+
+typedef struct {
+    Handle handle;
+} Thread;
+
+Result threadCreate(Thread* t, ThreadFunc entry, void* arg, void* stack_mem, size_t stack_sz, int prio, int cpuid);
+Result threadStart(Thread* t);
+Result threadWaitForExit(Thread* t);
+Result threadClose(Thread* t);
+Handle threadGetCurHandle();
+
+// -- wait --
+typedef struct {
+    bool signal;
+    bool auto_clear;
+} UEvent;
+
+void ueventCreate(UEvent* e, bool auto_clear);
+void ueventClear(UEvent* e);
+void ueventSignal(UEvent* e);
+
+typedef enum {
+    WaiterType_Handle,
+    WaiterType_Waitable,
+} WaiterType;
+
+typedef struct {
+    WaiterType type;
+    union {
+        Handle handle;
+        UEvent* event;
+    };
+} Waiter;
+
+static inline Waiter waiterForHandle(Handle h) {
+    Waiter w{};
+    w.type = WaiterType_Handle;
+    w.handle = h;
+    return w;
+}
+
+static inline Waiter waiterForUEvent(UEvent* e) {
+    Waiter w{};
+    w.type = WaiterType_Waitable;
+    w.event = e;
+    return w;
+}
+
+Result waitObjects(s32* idx_out, const Waiter* objects, s32 num_objects, u64 timeout);
+
+static inline Result waitSingle(Waiter w, u64 timeout) {
+    s32 idx;
+    return waitObjects(&idx, &w, 1, timeout);
+}
+
+static inline Result waitSingleHandle(Handle handle, u64 timeout) {
+    return waitSingle(waiterForHandle(handle), timeout);
+}
+
+#ifdef __cplusplus
+template<typename... W>
+static inline Result waitMulti(s32* idx_out, u64 timeout, W... w) {
+    const Waiter objects[] = { w... };
+    return waitObjects(idx_out, objects, sizeof...(W), timeout);
+}
+#endif
+
+// -- crc --
+u32 crc32Calculate(const void* src, size_t size);
+u32 crc32CalculateWithSeed(u32 crc, const void* src, size_t size);
+
+// -- utf --
+// converts until a nul or len bytes, returns the bytes written or -1 on error.
+ssize_t utf16_to_utf8(u8* out, const u16* in, size_t len);
+
+// -- sf --
+typedef struct {
+    Handle session;
+    u32 own_handle;
+    u32 object_id;
+    u16 pointer_buffer_size;
+} Service;
+
+static inline bool serviceIsActive(const Service* s) {
+    return s->session != INVALID_HANDLE;
+}
+
+// -- fs --
+// every filesystem maps onto the host directory set with shim::SetSdRoot().
+typedef struct { Service s; } FsFileSystem;
+typedef struct { Service s; } FsFile;
+typedef struct { Service s; } FsDir;
+
+typedef struct {
+    u8 c[0x10];
+} FsRightsId;
+
+typedef struct {
+    char name[0x301];
+    u8 pad[3];
+    s8 type;
+    u8 pad2[3];
+    s64 file_size;
+} FsDirectoryEntry;
+
+typedef struct {
+    u64 created;
+    u64 modified;
+    u64 accessed;
+    u8 is_valid;
+    u8 padding[7];
+} FsTimeStampRaw;
+
+typedef enum {
+    FsDirEntryType_Dir = 0,
+    FsDirEntryType_File = 1,
+} FsDirEntryType;
+
+typedef enum {
+    FsOpenMode_Read = BIT(0),
+    FsOpenMode_Write = BIT(1),
+    FsOpenMode_Append = BIT(2),
+} FsOpenMode;
+
+typedef enum {
+    FsDirOpenMode_ReadDirs = BIT(0),
+    FsDirOpenMode_ReadFiles = BIT(1),
+    FsDirOpenMode_NoFileSize = BIT(31),
+} FsDirOpenMode;
+
+typedef enum {
+    FsCreateOption_BigFile = BIT(0),
+} FsCreateOption;
+
+typedef enum {
+    FsReadOption_None = 0,
+} FsReadOption;
+
+typedef enum {
+    FsWriteOption_None = 0,
+    FsWriteOption_Flush = BIT(0),
+} FsWriteOption;
+
+typedef enum {
+    FsBisPartitionId_User = 30,
+} FsBisPartitionId;
+
+typedef enum {
+    FsImageDirectoryId_Nand = 0,
+    FsImageDirectoryId_Sd = 1,
+} FsImageDirectoryId;
+
+typedef enum {
+    FsContentStorageId_System = 0,
+    FsContentStorageId_User = 1,
+    FsContentStorageId_SdCard = 2,
+} FsContentStorageId;
+
+typedef struct {
+    u32 value;
+} FsGameCardHandle;
+
+typedef enum {
+    FsGameCardPartition_Update = 0,
+    FsGameCardPartition_Normal = 1,
+    FsGameCardPartition_Secure = 2,
+} FsGameCardPartition;
+
+typedef enum {
+    FsSaveDataSpaceId_System = 0,
+    FsSaveDataSpaceId_User = 1,
+} FsSaveDataSpaceId;
+
+typedef enum {
+    FsSaveDataType_System = 0,
+    FsSaveDataType_Account = 1,
+    FsSaveDataType_Bcat = 2,
+    FsSaveDataType_Device = 3,
+    FsSaveDataType_Temporary = 4,
+    FsSaveDataType_Cache = 5,
+    FsSaveDataType_SystemBcat = 6,
+} FsSaveDataType;
+
+typedef struct {
+    u64 application_id;
+    u8 uid[0x10];
+    u64 system_save_data_id;
+    u8 save_data_type;
+    u8 save_data_rank;
+    u16 save_data_index;
+    u32 pad_x24;
+    u64 unk_x28;
+    u64 unk_x30;
+    u64 unk_x38;
+} FsSaveDataAttribute;
+
+typedef enum {
+    FsFileSystemType_ContentControl = 3,
+    FsFileSystemType_ContentManual = 4,
+    FsFileSystemType_ContentMeta = 5,
+    FsFileSystemType_ContentData = 6,
+} FsFileSystemType;
+
+typedef enum {
+    FsContentAttributes_None = 0,
+    FsContentAttributes_All = 0xF,
+} FsContentAttributes;
+
+Result fsOpenSdCardFileSystem(FsFileSystem* out);
+Result fsOpenBisFileSystem(FsFileSystem* out, FsBisPartitionId id, const char* string);
+Result fsOpenImageDirectoryFileSystem(FsFileSystem* out, FsImageDirectoryId id);
+Result fsOpenContentStorageFileSystem(FsFileSystem* out, FsContentStorageId id);
+Result fsOpenGameCardFileSystem(FsFileSystem* out, const FsGameCardHandle* handle, FsGameCardPartition partition);
+Result fsOpenSaveDataFileSystem(FsFileSystem* out, FsSaveDataSpaceId save_data_space_id, const FsSaveDataAttribute* attr);
+Result fsOpenReadOnlySaveDataFileSystem(FsFileSystem* out, FsSaveDataSpaceId save_data_space_id, const FsSaveDataAttribute* attr);
+Result fsOpenSaveDataFileSystemBySystemSaveDataId(FsFileSystem* out, FsSaveDataSpaceId save_data_space_id, const FsSaveDataAttribute* attr);
+Result fsOpenFileSystemWithId(FsFileSystem* out, u64 id, FsFileSystemType fs_type, const char* content_path, FsContentAttributes attr);
+
+Result fsFsCreateFile(FsFileSystem* fs, const char* path, s64 size, u32 option);
+Result fsFsDeleteFile(FsFileSystem* fs, const char* path);
+Result fsFsCreateDirectory(FsFileSystem* fs, const char* path);
+Result fsFsDeleteDirectory(FsFileSystem* fs, const char* path);
+Result fsFsDeleteDirectoryRecursively(FsFileSystem* fs, const char* path);
+Result fsFsRenameFile(FsFileSystem* fs, const char* cur_path, const char* new_path);
+Result fsFsRenameDirectory(FsFileSystem* fs, const char* cur_path, const char* new_path);
+Result fsFsGetEntryType(FsFileSystem* fs, const char* path, FsDirEntryType* out);
+Result fsFsOpenFile(FsFileSystem* fs, const char* path, u32 mode, FsFile* out);
+Result fsFsOpenDirectory(FsFileSystem* fs, const char* path, u32 mode, FsDir* out);
+Result fsFsCommit(FsFileSystem* fs);
+Result fsFsGetFreeSpace(FsFileSystem* fs, const char* path, s64* out);
+Result fsFsGetTotalSpace(FsFileSystem* fs, const char* path, s64* out);
+Result fsFsGetFileTimeStampRaw(FsFileSystem* fs, const char* path, FsTimeStampRaw* out);
+void fsFsClose(FsFileSystem* fs);
+
+Result fsFileRead(FsFile* f, s64 off, void* buf, u64 read_size, u32 option, u64* bytes_read);
+Result fsFileWrite(FsFile* f, s64 off, const void* buf, u64 write_size, u32 option);
+Result fsFileFlush(FsFile* f);
+Result fsFileSetSize(FsFile* f, s64 sz);
+Result fsFileGetSize(FsFile* f, s64* out);
+void fsFileClose(FsFile* f);
+
+Result fsDirRead(FsDir* d, s64* total_entries, size_t max_entries, FsDirectoryEntry* buf);
+Result fsDirGetEntryCount(FsDir* d, s64* count);
+void fsDirClose(FsDir* d);
+
+FsFileSystem* fsdevGetDeviceFileSystem(const char* name);
+Result fsdevGetLastResult();
+
+// -- ncm --
+typedef struct {
+    u8 c[0x10];
+} NcmContentId;
+
+typedef struct {
+    FsRightsId rights_id;
+    u8 key_generation;
+    u8 pad[0x7];
+} NcmRightsId;
+
+// -- hos --
+#define MAKEHOSVERSION(_major,_minor,_micro) (((u32)(_major) << 16) | ((u32)(_minor) << 8) | (u32)(_micro))
+u32 hosversionGet();
+
+static inline bool hosversionAtLeast(u8 major, u8 minor, u8 micro) {
+    return hosversionGet() >= MAKEHOSVERSION(major, minor, micro);
+}
+
+static inline bool hosversionBefore(u8 major, u8 minor, u8 micro) {
+    return !hosversionAtLeast(major, minor, micro);
+}
+
+// -- nro --
+#define NROHEADER_MAGIC 0x304f524e
+#define NROASSETHEADER_MAGIC 0x54455341
+#define NROASSETHEADER_VERSION 0
+
+typedef struct {
+    u32 file_off;
+    u32 size;
+} NroSegment;
+
+typedef struct {
+    u32 unused;
+    u32 mod_offset;
+    u8 padding[8];
+} NroStart;
+
+typedef struct {
+    u32 magic;
+    u32 unk1;
+    u32 size;
+    u32 unk2;
+    NroSegment segments[3];
+    u32 bss_size;
+    u32 unk3;
+    u8 build_id[0x20];
+    u8 padding[0x20];
+} NroHeader;
+
+typedef struct {
+    u64 offset;
+    u64 size;
+} NroAssetSection;
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    NroAssetSection icon;
+    NroAssetSection nacp;
+    NroAssetSection romfs;
+} NroAssetHeader;
+
+// -- nacp --
+typedef struct {
+    char name[0x200];
+    char author[0x100];
+} NacpLanguageEntry;
+
+typedef struct {
+    NacpLanguageEntry lang[16];
+    u8 isbn[0x25];
+    u8 startup_user_account;
+    u8 user_account_switch_lock;
+    u8 add_on_content_registration_type;
+    u32 attribute_flag;
+    u32 supported_language_flag;
+    u32 parental_control_flag;
+    u8 screenshot;
+    u8 video_capture;
+    u8 data_loss_confirmation;
+    u8 play_log_policy;
+    u64 presence_group_id;
+    s8 rating_age[0x20];
+    char display_version[0x10];
+    u8 reserved[0x4000 - 0x3070];
+} NacpStruct;
+
+static_assert(sizeof(NacpStruct) == 0x4000);
+
+Result nacpGetLanguageEntry(NacpStruct* nacp, NacpLanguageEntry** langentry);
+
+// -- romfs --
+// there's no romfs on the host, callers fall back as they would on failure.
+static inline Result romfsMountDataStorageFromProgram(u64 program_id, const char* name) {
+    return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+}
+
+static inline Result romfsUnmount(const char* name) {
+    return 0;
+}
+
+// -- audren --
+// the audio driver is faked in audren.cpp, voices play their wave buffers in
+// real time (scaled by host::SetAudioSpeed) and nothing is output.
+#define AUDREN_MEMPOOL_ALIGNMENT 0x1000
+#define AUDREN_FINAL_MIX_ID 0
+
+typedef enum {
+    PcmFormat_Int16 = 2,
+} PcmFormat;
+
+typedef enum {
+    AudioDriverWaveBufState_Free,
+    AudioDriverWaveBufState_Waiting,
+    AudioDriverWaveBufState_Queued,
+    AudioDriverWaveBufState_Playing,
+    AudioDriverWaveBufState_Done,
+} AudioDriverWaveBufState;
+
+typedef enum {
+    AudioRendererMemPoolState_Invalid = 0,
+    AudioRendererMemPoolState_Attached = 5,
+} AudioRendererMemPoolState;
+
+typedef struct AudioDriverWaveBuf {
+    union {
+        s16* data_pcm16;
+        void* data_raw;
+    };
+    u64 size;
+    s32 start_sample_offset;
+    s32 end_sample_offset;
+    AudioDriverWaveBufState state;
+} AudioDriverWaveBuf;
+
+typedef struct {
+    bool is_used;
+    float volume;
+    float pitch;
+} AudioDriverInVoice;
+
+typedef struct {
+    AudioRendererMemPoolState state;
+} AudioDriverInMemPool;
+
+#define AUDIO_DRIVER_MAX_VOICES 24
+#define AUDIO_DRIVER_MAX_MEMPOOLS 8
+
+typedef struct {
+    AudioDriverInVoice in_voices[AUDIO_DRIVER_MAX_VOICES];
+    AudioDriverInMemPool in_mempools[AUDIO_DRIVER_MAX_MEMPOOLS];
+} AudioDriver;
+
+Result audrvUpdate(AudioDriver* d);
+int audrvMemPoolAdd(AudioDriver* d, void* buffer, size_t size);
+bool audrvMemPoolRemove(AudioDriver* d, int id);
+bool audrvMemPoolAttach(AudioDriver* d, int id);
+bool audrvMemPoolDetach(AudioDriver* d, int id);
+bool audrvVoiceInit(AudioDriver* d, int id, int num_channels, PcmFormat format, int sample_rate);
+void audrvVoiceDrop(AudioDriver* d, int id);
+void audrvVoiceStart(AudioDriver* d, int id);
+void audrvVoiceSetDestinationMix(AudioDriver* d, int id, int mix_id);
+void audrvVoiceSetMixFactor(AudioDriver* d, int id, float factor, int src_channel_id, int dest_channel_id);
+void audrvVoiceSetVolume(AudioDriver* d, int id, float volume);
+void audrvVoiceSetPitch(AudioDriver* d, int id, float pitch);
+void audrvVoiceSetPaused(AudioDriver* d, int id, bool paused);
+bool audrvVoiceAddWaveBuf(AudioDriver* d, int id, AudioDriverWaveBuf* wavebuf);
+u32 audrvVoiceGetPlayedSampleCount(AudioDriver* d, int id);
+
+// -- env --
+Result envSetNextLoad(const char* path, const char* argv);
@@ -0,0 +1,4 @@
+#pragma once
+
+// newlib header, PATH_MAX is in limits.h on the host.
+#include <limits.h>
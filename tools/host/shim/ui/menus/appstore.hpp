@@ -0,0 +1,20 @@
+#pragma once
+
+// the parts of the appstore menu that appstore_index.cpp uses.
+#include "ui/menus/appstore_index.hpp"
+
+namespace sphaira::ui::menu::appstore {
+
+enum Filter {
+    Filter_All,
+    Filter_Games,
+    Filter_Emulators,
+    Filter_Tools,
+    Filter_Advanced,
+    Filter_Themes,
+    Filter_Legacy,
+    Filter_Misc,
+    Filter_MAX,
+};
+
+} // namespace sphaira::ui::menu::appstore
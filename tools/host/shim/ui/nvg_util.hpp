@@ -0,0 +1,4 @@
+#pragma once
+
+// fs.cpp includes this but does not draw anything.
+#include "ui/types.hpp"
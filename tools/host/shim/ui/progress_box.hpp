@@ -0,0 +1,69 @@
+#pragma once
+
+// headless ProgressBox, records progress instead of drawing it.
+#include "fs.hpp"
+#include "defines.hpp"
+#include <string>
+#include <atomic>
+
+namespace sphaira::ui {
+
+struct ProgressBox {
+    ProgressBox() {
+        ueventCreate(&m_uevent, false);
+    }
+
+    auto NewTransfer(const std::string& transfer) -> ProgressBox& {
+        m_transfer = transfer;
+        m_offset = 0;
+        m_size = 0;
+        return *this;
+    }
+
+    auto UpdateTransfer(s64 offset, s64 size) -> ProgressBox& {
+        m_offset = offset;
+        m_size = size;
+        m_updates++;
+        return *this;
+    }
+
+    auto SetTransferInfo(const std::string& info) -> ProgressBox& {
+        m_transfer_info = info;
+        return *this;
+    }
+
+    void RequestExit() {
+        m_exit = true;
+        ueventSignal(&m_uevent);
+    }
+
+    auto ShouldExit() -> bool {
+        return m_exit;
+    }
+
+    auto ShouldExitResult() -> Result {
+        R_UNLESS(!ShouldExit(), Result_TransferCancelled);
+        R_SUCCEED();
+    }
+
+    void Yield() {
+        svcSleepThread(0);
+    }
+
+    // auto-clear = false
+    auto GetCancelEvent() {
+        return &m_uevent;
+    }
+
+    std::string m_transfer{};
+    std::string m_transfer_info{};
+    std::atomic<s64> m_offset{};
+    std::atomic<s64> m_size{};
+    std::atomic<u64> m_updates{};
+
+private:
+    UEvent m_uevent{};
+    std::atomic_bool m_exit{};
+};
+
+} // namespace sphaira::ui
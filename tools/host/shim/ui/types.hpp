@@ -0,0 +1,48 @@
+#pragma once
+
+// TimeStamp from ui/types.hpp, the rest needs nanovg and hid.
+#include "fs.hpp"
+#include <switch.h>
+#include <string>
+#include <functional>
+
+namespace sphaira {
+
+struct TimeStamp {
+    TimeStamp() {
+        Update();
+    }
+
+    void Update() {
+        start = armGetSystemTick();
+    }
+
+    auto GetNs() const -> u64 {
+        const auto end_ticks = armGetSystemTick();
+        return armTicksToNs(end_ticks) - armTicksToNs(start);
+    }
+
+    auto GetMs() const -> u64 {
+        const auto ns = GetNs();
+        return ns/1000/1000;
+    }
+
+    auto GetSeconds() const -> u64 {
+        const auto ns = GetNs();
+        return ns/1000/1000/1000;
+    }
+
+    auto GetMsD() const -> double {
+        const double ns = GetNs();
+        return ns/1000.0/1000.0;
+    }
+
+    auto GetSecondsD() const -> double {
+        const double ns = GetNs();
+        return ns/1000.0/1000.0/1000.0;
+    }
+
+    u64 start;
+};
+
+} // namespace sphaira
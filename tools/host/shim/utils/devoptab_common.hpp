@@ -0,0 +1,28 @@
+#pragma once
+
+// only BufferedData is used by the host built sources, it reads straight
+// through to the source rather than pulling in the devoptab layer.
+#include "yati/source/base.hpp"
+#include <memory>
+#include <algorithm>
+
+namespace sphaira::devoptab::common {
+
+struct BufferedData : yati::source::Base {
+    BufferedData(const std::shared_ptr<yati::source::Base>& _source, u64 _size, u64 _alloc = 1024 * 512)
+    : source{_source}
+    , capacity{_size} {
+
+    }
+
+    Result Read(void* buf, s64 off, s64 size, u64* bytes_read) override {
+        size = std::min<s64>(size, capacity - off);
+        return source->Read(buf, off, size, bytes_read);
+    }
+
+private:
+    std::shared_ptr<yati::source::Base> source;
+    const u64 capacity;
+};
+
+} // namespace sphaira::devoptab::common
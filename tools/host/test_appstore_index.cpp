@@ -0,0 +1,357 @@
+// builds a RepoIndex from a large synthetic repo.json, reports the build and
+// load time, the memory held by the index and the search latency against the
+// old linear scan, then checks that the trigram search returns exactly what
+// the old linear FindCaseInsensitive scan did for a few thousand queries.
+//
+// test_appstore_index [--count n] [--queries n] [--seed n] [--log]
+
+#include "ui/menus/appstore_index.hpp"
+#include "host.hpp"
+#include "defines.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include <malloc.h>
+
+namespace {
+
+using namespace sphaira;
+using namespace sphaira::ui::menu::appstore;
+
+int g_failed{};
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        std::printf(__VA_ARGS__); \
+        std::printf("\n"); \
+        g_failed++; \
+    } \
+} while (0)
+
+// the search that RepoIndex replaced, from appstore.cpp.
+auto FindCaseInsensitive(std::string_view base, std::string_view term) -> bool {
+    const auto it = std::search(base.cbegin(), base.cend(), term.cbegin(), term.cend(), [](char a, char b){
+        return std::toupper(a) == std::toupper(b);
+    });
+    return it != base.cend();
+}
+
+void LinearSearch(const RepoIndex& index, std::string_view query, u32 fields, std::vector<u32>& out) {
+    out.clear();
+    for (u32 i = 0; i < index.GetCount(); i++) {
+        const auto& r = index.GetRecord(i);
+        if (((fields & SearchField_Title) && FindCaseInsensitive(index.GetString(r.title), query)) ||
+            ((fields & SearchField_Author) && FindCaseInsensitive(index.GetString(r.author), query)) ||
+            ((fields & SearchField_Description) && FindCaseInsensitive(index.GetString(r.description), query))) {
+            out.emplace_back(i);
+        }
+    }
+}
+
+const char* const WORDS[] = {
+    "the", "game", "emulator", "tool", "save", "manager", "theme", "homebrew", "port", "of",
+    "a", "and", "for", "with", "switch", "retro", "arcade", "classic", "puzzle", "platformer",
+    "music", "player", "video", "file", "browser", "ftp", "server", "client", "overlay", "cheat",
+    "editor", "installer", "backup", "restore", "network", "mtp", "usb", "controller", "input", "display",
+    "n64", "snes", "gba", "nes", "psx", "dos", "quake", "doom", "tetris", "chess",
+    "café", "niño", "über", "日本語",
+};
+
+const char* const CATEGORIES[] = {
+    "game", "emu", "tool", "advanced", "theme", "legacy", "misc",
+};
+
+struct Generator {
+    std::mt19937 rng;
+
+    auto Uniform(u32 max) -> u32 {
+        return std::uniform_int_distribution<u32>{0, max - 1}(rng);
+    }
+
+    // made up word, so that the trigrams aren't only from the word list.
+    auto Syllables(u32 count) -> std::string {
+        static const char* const syllables[] = { "ka", "ro", "mi", "zen", "tor", "lux", "qua", "vi", "ne", "sho", "bit", "pix" };
+        std::string out;
+        for (u32 i = 0; i < count; i++) {
+            out += syllables[Uniform(std::size(syllables))];
+        }
+        return out;
+    }
+
+    auto Word() -> std::string {
+        auto word = Uniform(3) ? std::string{WORDS[Uniform(std::size(WORDS))]} : Syllables(1 + Uniform(3));
+        if (!Uniform(4)) {
+            word[0] = std::toupper((unsigned char)word[0]);
+        } else if (!Uniform(20)) {
+            for (auto& c : word) {
+                c = std::toupper((unsigned char)c);
+            }
+        }
+        return word;
+    }
+
+    auto Words(u32 min, u32 max) -> std::string {
+        std::string out;
+        const auto count = min + Uniform(max - min + 1);
+        for (u32 i = 0; i < count; i++) {
+            if (i) {
+                out += ' ';
+            }
+            out += Word();
+        }
+        return out;
+    }
+};
+
+auto WriteRepo(const std::string& path, u32 count, u32 seed, std::vector<std::string>& authors) -> s64 {
+    Generator gen{std::mt19937{seed}};
+
+    // a few authors publish most of the packages.
+    authors.clear();
+    for (u32 i = 0; i < std::max<u32>(count / 8, 1); i++) {
+        authors.emplace_back(gen.Syllables(2 + gen.Uniform(2)) + (gen.Uniform(3) ? "" : std::to_string(gen.Uniform(100))));
+    }
+
+    std::string json = "{\"packages\":[";
+    for (u32 i = 0; i < count; i++) {
+        const auto title = gen.Words(1, 4);
+        const auto author = authors[std::min<u32>(gen.Uniform(authors.size()), gen.Uniform(authors.size()))];
+        const auto description = gen.Words(3, 15);
+
+        char numbers[256];
+        std::snprintf(numbers, sizeof(numbers), "\"updated\":\"%02u/%02u/20%02u\",\"screens\":%u,\"extracted\":%u,\"filesize\":%u,\"app_dls\":%u",
+            1 + gen.Uniform(28), 1 + gen.Uniform(12), 18 + gen.Uniform(8), gen.Uniform(6), 1024 + gen.Uniform(1 << 24), 1024 + gen.Uniform(1 << 22), gen.Uniform(100000));
+
+        json += i ? ",{" : "{";
+        json += "\"name\":\"pkg" + std::to_string(i) + "\",";
+        json += "\"title\":\"" + title + "\",";
+        json += "\"author\":\"" + author + "\",";
+        json += "\"description\":\"" + description + "\",";
+        json += "\"details\":\"" + gen.Words(20, 120) + "\",";
+        json += "\"changelog\":\"" + gen.Words(5, 60) + "\",";
+        json += "\"category\":\"" + std::string{CATEGORIES[gen.Uniform(std::size(CATEGORIES))]} + "\",";
+        json += "\"license\":\"" + std::string{gen.Uniform(2) ? "GPLv3" : "MIT"} + "\",";
+        json += "\"version\":\"" + std::to_string(gen.Uniform(5)) + "." + std::to_string(gen.Uniform(20)) + "\",";
+        json += "\"url\":\"https://example.com/pkg" + std::to_string(i) + "\",";
+        json += "\"binary\":\"/switch/pkg" + std::to_string(i) + ".nro\",";
+        json += "\"md5\":\"0123456789abcdef0123456789abcdef\",";
+        json += numbers;
+        json += "}";
+    }
+    json += "]}";
+
+    auto f = std::fopen(path.c_str(), "wb");
+    if (!f || std::fwrite(json.data(), 1, json.size(), f) != json.size()) {
+        std::printf("failed to write %s\n", path.c_str());
+        std::exit(1);
+    }
+    std::fclose(f);
+    return json.size();
+}
+
+auto HeapUsed() -> u64 {
+    return mallinfo2().uordblks;
+}
+
+// mean time of a search in us, repeated for at least 20ms.
+template <typename F>
+auto TimeUs(F&& func) -> double {
+    u32 count = 0;
+    const auto start = host::GetTimeNs();
+    u64 elapsed;
+    do {
+        func();
+        count++;
+        elapsed = host::GetTimeNs() - start;
+    } while (elapsed < 20'000'000 && count < 100'000);
+    return elapsed / 1e+3 / count;
+}
+
+auto FieldsName(u32 fields) -> std::string {
+    std::string out;
+    if (fields & SearchField_Title) out += 't';
+    if (fields & SearchField_Author) out += 'a';
+    if (fields & SearchField_Description) out += 'd';
+    return out;
+}
+
+// a substring of a field of a record with the case flipped at random, a
+// random string, or nothing.
+auto RandomQuery(Generator& gen, const RepoIndex& index) -> std::string {
+    switch (gen.Uniform(8)) {
+        case 0: {
+            static const char alphabet[] = "abcdeklmnoqrstuxyz 0123\xC3\xA9";
+            std::string out;
+            for (u32 i = 0, len = 1 + gen.Uniform(5); i < len; i++) {
+                out += alphabet[gen.Uniform(sizeof(alphabet) - 1)];
+            }
+            return out;
+        }
+
+        case 1:
+            return {};
+
+        default: {
+            const auto& r = index.GetRecord(gen.Uniform(index.GetCount()));
+            const IndexString* strs[] = { &r.title, &r.author, &r.description };
+            const auto str = index.GetString(*strs[gen.Uniform(std::size(strs))]);
+            if (str.empty()) {
+                return {};
+            }
+
+            const auto off = gen.Uniform(str.size());
+            auto out = std::string{str.substr(off, 1 + gen.Uniform(12))};
+            for (auto& c : out) {
+                if (!gen.Uniform(3)) {
+                    c = std::isupper((unsigned char)c) ? std::tolower((unsigned char)c) : std::toupper((unsigned char)c);
+                }
+            }
+            return out;
+        }
+    }
+}
+
+void TestEquivalence(const RepoIndex& index, u32 queries, u32 seed) {
+    Generator gen{std::mt19937{seed + 1}};
+    std::vector<u32> trigram, linear;
+    u32 bad = 0, matched = 0;
+
+    std::vector<std::string> fixed{ "", " ", "a", "AB", "the", "THE", "tHe GaMe", "zzzzzz", "\xC3\xA9", "caf\xC3\xA9", "\xE6\x97\xA5\xE6\x9C\xAC" };
+    for (u32 i = 0; i < queries; i++) {
+        fixed.emplace_back(RandomQuery(gen, index));
+    }
+
+    for (const auto& query : fixed) {
+        for (u32 fields = 1; fields <= (SearchField_Title | SearchField_Author | SearchField_Description); fields++) {
+            index.Search(query, fields, trigram);
+            LinearSearch(index, query, fields, linear);
+            matched += !linear.empty();
+
+            if (trigram != linear) {
+                if (bad < 5) {
+                    std::printf("mismatch for \"%s\" fields: %s trigram: %zu linear: %zu\n", query.c_str(), FieldsName(fields).c_str(), trigram.size(), linear.size());
+                }
+                bad++;
+            }
+        }
+    }
+
+    std::printf("equivalence: %zu queries x 7 field sets, %u with matches, %u differ\n", fixed.size(), matched, bad);
+    CHECK(!bad, "%u searches differ from the linear scan", bad);
+    // most of the queries are taken from the records, so should match.
+    CHECK(matched > fixed.size(), "only %u searches matched", matched);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    u32 count = 20000;
+    u32 queries = 2000;
+    u32 seed = 1;
+    bool log{};
+
+    for (int i = 1; i < argc; i++) {
+        const auto next = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(argv[i], "--count") && next && std::atoi(next) > 0) {
+            count = std::atoi(next);
+            i++;
+        } else if (!std::strcmp(argv[i], "--queries") && next && std::atoi(next) >= 0) {
+            queries = std::atoi(next);
+            i++;
+        } else if (!std::strcmp(argv[i], "--seed") && next) {
+            seed = std::atoi(next);
+            i++;
+        } else if (!std::strcmp(argv[i], "--log")) {
+            log = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--count n] [--queries n] [--seed n] [--log]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    host::SetLogEnabled(log);
+
+    // yyjson reads the json with stdio, so the sd root is the host root and
+    // the paths are absolute host paths.
+    char dir[] = "/tmp/sphaira_appstore_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::printf("failed to create temp dir\n");
+        return 1;
+    }
+    ON_SCOPE_EXIT(std::filesystem::remove_all(dir));
+    host::SetSdRoot("/");
+
+    const auto json_path = std::string{dir} + "/repo.json";
+    const auto index_path = std::string{dir} + "/cache/repo.idx";
+    std::vector<std::string> authors;
+    const auto json_size = WriteRepo(json_path, count, seed, authors);
+
+    fs::FsNativeSd fs;
+
+    // no index, the json is parsed and the index written.
+    RepoIndex built;
+    auto start = host::GetTimeNs();
+    const auto build_rc = built.Open(&fs, json_path, index_path, "etag");
+    const auto build_ns = host::GetTimeNs() - start;
+    CHECK(R_SUCCEEDED(build_rc), "build failed: 0x%X", build_rc);
+    CHECK(built.GetCount() == count, "built %u records", built.GetCount());
+
+    // same etag and json, the index is loaded.
+    const auto heap_before = HeapUsed();
+    RepoIndex index;
+    start = host::GetTimeNs();
+    const auto load_rc = index.Open(&fs, json_path, index_path, "etag");
+    const auto load_ns = host::GetTimeNs() - start;
+    const auto heap = HeapUsed() - heap_before;
+    CHECK(R_SUCCEEDED(load_rc), "load failed: 0x%X", load_rc);
+    CHECK(index.GetCount() == count, "loaded %u records", index.GetCount());
+
+    if (g_failed) {
+        std::printf("%d checks failed\n", g_failed);
+        return 1;
+    }
+
+    std::printf("packages: %u json: %.1f KiB index: %.1f KiB\n", count, json_size / 1024.0, std::filesystem::file_size(index_path) / 1024.0);
+    std::printf("build: %.1f ms load: %.2f ms heap after load: %.1f KiB\n\n", build_ns / 1e+6, load_ns / 1e+6, heap / 1024.0);
+
+    // searches that the menu does, the author search is the one from the entry menu.
+    const auto author = authors[0];
+    const std::pair<std::string, u32> searches[] = {
+        { "a", SearchField_Title | SearchField_Author | SearchField_Description },
+        { "emu", SearchField_Title | SearchField_Author | SearchField_Description },
+        { "Retro Arcade", SearchField_Title | SearchField_Author | SearchField_Description },
+        { "quake port", SearchField_Title | SearchField_Author | SearchField_Description },
+        { "caf\xC3\xA9", SearchField_Title | SearchField_Author | SearchField_Description },
+        { "xyzzy", SearchField_Title | SearchField_Author | SearchField_Description },
+        { author, SearchField_Author },
+    };
+
+    std::printf("%-16s %6s %8s %11s %11s %8s\n", "query", "fields", "matches", "trigram us", "linear us", "speedup");
+
+    std::vector<u32> out;
+    for (const auto& [query, fields] : searches) {
+        const auto trigram_us = TimeUs([&]() { index.Search(query, fields, out); });
+        const auto matches = out.size();
+        const auto linear_us = TimeUs([&]() { LinearSearch(index, query, fields, out); });
+        std::printf("%-16s %6s %8zu %11.1f %11.1f %7.1fx\n", query.c_str(), FieldsName(fields).c_str(), matches, trigram_us, linear_us, linear_us / trigram_us);
+    }
+
+    std::printf("\n");
+    TestEquivalence(index, queries, seed);
+
+    if (g_failed) {
+        std::printf("%d checks failed\n", g_failed);
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,589 @@
+// plays songs through the decode ahead ring and gapless queue of audio.cpp
+// against the fake audio renderer (shim/audren.cpp).
+// reports underruns and checks that every frame is played once and in order,
+// that queued songs switch without a gap and that queueing a song doesn't
+// wait for it to load.
+//
+// test_audio [--data dir] [--speed x] [--real_clock] [--only name] [--log]
+//
+// the voices play on a clock stepped by the audio thread, so that a late
+// wakeup on a busy host isn't counted as an underrun. --real_clock plays them
+// against real time instead.
+//
+// most songs are decoded by a synthetic decoder that models slow loads and
+// reads. the sample files in --data (1s, 44100Hz, stereo) are decoded by the
+// real decoders, which are timed first to report the decode cost per format.
+// the cost is for the host cpu, so only compare formats against each other.
+
+// the decoders and song table are in an anonymous namespace.
+#include "utils/audio.cpp"
+#include "host.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+namespace sphaira::audio {
+namespace {
+
+double g_speed{4};
+
+struct SongModel {
+    u32 seconds;
+    u32 sample_rate;
+    u32 channels;
+    // time taken by LoadFile(), such as parsing tags over the network.
+    u32 load_ms;
+    // the decoder stalls for stall_ms every stall_every seconds of audio,
+    // such as a slow read from a network mount.
+    u32 stall_ms;
+    u32 stall_every;
+    // sample file in --data, decoded with the real decoder rather than
+    // from the model above.
+    const char* file;
+
+    auto Frames() const -> u64 {
+        return u64(seconds) * sample_rate;
+    }
+};
+
+// frame of a song, so that the sink can check the order and continuity.
+auto SampleValue(u32 song, u64 frame, u32 channel) -> s16 {
+    return s16((song * 7919 + frame * 3 + channel) & 0x7FFF);
+}
+
+void SleepSongMs(u32 ms) {
+    if (ms) {
+        svcSleepThread(s64(ms * 1e+6 / g_speed));
+    }
+}
+
+struct Synthetic final : CustomBase {
+    Synthetic(const SongModel& model, u32 index) : m_model{model}, m_index{index} {
+    }
+
+    ~Synthetic() {
+        Stop();
+    }
+
+    Result LoadFile(fs::Fs* fs, const fs::FsPath& path, u32 flags) override {
+        SleepSongMs(m_model.load_ms);
+
+        m_info.sample_count = m_model.Frames();
+        m_info.sample_rate = m_model.sample_rate;
+        return Create(m_model.channels, m_model.sample_rate, [this](int samples, s16* out) {
+            return Decode(samples, out);
+        });
+    }
+
+    Result SeekDecoder(u64 target) override {
+        m_pos = target;
+        R_SUCCEED();
+    }
+
+    u64 Tell() override {
+        return m_pos;
+    }
+
+private:
+    int Decode(int samples, s16* out) {
+        const auto count = std::min<s64>(samples, m_model.Frames() - m_pos);
+        if (count <= 0) {
+            return 0;
+        }
+
+        if (m_model.stall_every) {
+            const auto every = u64(m_model.stall_every) * m_model.sample_rate;
+            if (m_pos / every != (m_pos + count) / every) {
+                SleepSongMs(m_model.stall_ms);
+            }
+        }
+
+        for (s64 i = 0; i < count; i++) {
+            for (u32 c = 0; c < m_model.channels; c++) {
+                out[i * m_model.channels + c] = SampleValue(m_index, m_pos + i, c);
+            }
+        }
+
+        m_pos += count;
+        return count;
+    }
+
+private:
+    const SongModel m_model;
+    const u32 m_index;
+    u64 m_pos{};
+};
+
+// pcm of a song, decoded up front to check what the sink plays.
+struct Reference {
+    std::vector<s16> pcm;
+    u32 channels;
+    u32 sample_rate;
+
+    auto Frames() const -> u64 {
+        return channels ? pcm.size() / channels : 0;
+    }
+};
+
+auto SyntheticReference(const SongModel& model, u32 index) -> Reference {
+    Reference ref{ {}, model.channels, model.sample_rate };
+    ref.pcm.resize(model.Frames() * model.channels);
+
+    for (u64 i = 0; i < model.Frames(); i++) {
+        for (u32 c = 0; c < model.channels; c++) {
+            ref.pcm[i * model.channels + c] = SampleValue(index, i, c);
+        }
+    }
+
+    return ref;
+}
+
+struct Decoded {
+    bool ok;
+    Info info;
+    Reference ref;
+    u64 load_ns;
+    u64 decode_ns;
+};
+
+auto FilePath(const char* file) -> fs::FsPath {
+    fs::FsPath path{"/"};
+    path += file;
+    return path;
+}
+
+// decodes a sample file with the real decoder, as the decode thread would.
+auto DecodeFile(const char* file) -> Decoded {
+    Decoded out{};
+    fs::FsNativeSd fs{};
+    const auto path = FilePath(file);
+
+    auto source = CreateSource(path);
+    if (!source || !source->IsGapless()) {
+        return out;
+    }
+
+    // every decoder that can be queued is a CustomBase.
+    auto custom = static_cast<CustomBase*>(source.get());
+
+    auto start = host::GetTimeNs();
+    if (R_FAILED(custom->LoadFile(&fs, path, 0))) {
+        return out;
+    }
+    out.load_ns = host::GetTimeNs() - start;
+
+    custom->GetInfo(&out.info);
+    out.ref.channels = out.info.channels;
+    out.ref.sample_rate = out.info.sample_rate;
+    if (!out.ref.channels) {
+        return out;
+    }
+
+    // same chunk size as the ring.
+    std::vector<s16> chunk(2048 * out.ref.channels);
+    for (;;) {
+        start = host::GetTimeNs();
+        const auto count = custom->DecodeFrames(2048, chunk.data());
+        out.decode_ns += host::GetTimeNs() - start;
+
+        if (count <= 0) {
+            break;
+        }
+
+        out.ref.pcm.insert(out.ref.pcm.end(), chunk.begin(), chunk.begin() + count * out.ref.channels);
+    }
+
+    out.ok = true;
+    return out;
+}
+
+// same as OpenSong(), with the synthetic decoder.
+Result OpenSynthetic(const SongModel& model, u32 index, SongID* id) {
+    SCOPED_MUTEX(&g_mutex);
+
+    for (auto& e : g_songs) {
+        SCOPED_MUTEX(&e.mutex);
+
+        if (e.state == State::Free) {
+            auto source = std::make_unique<Synthetic>(model, index);
+            R_TRY(source->LoadFile(nullptr, {}, 0));
+            R_TRY(source->Start());
+
+            e.state = State::Paused;
+            e.source = source.release();
+            e.progress = {};
+            *id = &e;
+            R_SUCCEED();
+        }
+    }
+
+    R_THROW(0x1);
+}
+
+// same as QueueSong(), with the synthetic decoder.
+Result QueueSynthetic(SongID id, const SongModel& model, u32 index) {
+    auto source = std::make_unique<Synthetic>(model, index);
+
+    LockSongAndDo(IsGood,
+        R_TRY(e->source->Queue(std::move(source), nullptr, {}));
+    );
+}
+
+struct Scenario {
+    const char* name;
+    s64 decode_ahead;
+    std::vector<SongModel> songs;
+    // the songs have the same format, so should play as one.
+    bool expect_gapless;
+    bool expect_underruns;
+};
+
+struct Report {
+    u64 frames;
+    u64 bad_frames;
+    u32 switches;
+    u32 reopens;
+    u64 max_queue_ns;
+    host::AudioStats stats;
+    bool finished;
+};
+
+// checks the pcm handed to the sink against the songs, in order.
+struct Checker {
+    const std::vector<Reference>* songs;
+    u32 song;
+    u64 frame;
+    u64 frames;
+    u64 bad;
+
+    void OnPlayed(const s16* data, u32 frames, u32 channels) {
+        for (u32 i = 0; i < frames; i++) {
+            while (song < songs->size() && frame == (*songs)[song].Frames()) {
+                song++;
+                frame = 0;
+            }
+
+            if (song >= songs->size() || (*songs)[song].channels != channels) {
+                bad += frames - i;
+                return;
+            }
+
+            const auto& pcm = (*songs)[song].pcm;
+            for (u32 c = 0; c < channels; c++) {
+                if (data[i * channels + c] != pcm[frame * channels + c]) {
+                    bad++;
+                    break;
+                }
+            }
+
+            frame++;
+            this->frames++;
+        }
+    }
+};
+
+// plays the songs the same way as the music player, it queues the next song
+// each time a song starts and opens it if the queue was dropped.
+auto Run(const Scenario& s, const std::vector<Reference>& refs) -> Report {
+    Report report{};
+    Checker checker{ &refs };
+    fs::FsNativeSd fs{};
+
+    App::GetApp()->m_audio_decode_ahead.Set(s.decode_ahead);
+    host::ResetAudioStats();
+    host::SetAudioPlayedCallback([&checker](const s16* data, u32 frames, u32 channels) {
+        checker.OnPlayed(data, frames, channels);
+    });
+    ON_SCOPE_EXIT(host::SetAudioPlayedCallback({}));
+
+    u32 index = 0;
+    u32 track = 0;
+    SongID song{};
+
+    const auto open = [&]() -> Result {
+        const auto& model = s.songs[index];
+        if (model.file) {
+            return OpenSong(&fs, FilePath(model.file), 0, &song);
+        }
+        return OpenSynthetic(model, index, &song);
+    };
+
+    const auto queue_next = [&]() {
+        if (index + 1 < s.songs.size()) {
+            const auto& model = s.songs[index + 1];
+            const auto start = host::GetTimeNs();
+            if (model.file) {
+                QueueSong(song, &fs, FilePath(model.file));
+            } else {
+                QueueSynthetic(song, model, index + 1);
+            }
+            report.max_queue_ns = std::max(report.max_queue_ns, host::GetTimeNs() - start);
+        }
+    };
+
+    if (R_FAILED(open())) {
+        return report;
+    }
+
+    queue_next();
+    PlaySong(song);
+
+    u64 total_ms{};
+    for (const auto& e : refs) {
+        total_ms += e.Frames() * 1000 / e.sample_rate;
+    }
+
+    const auto deadline = host::GetTimeNs() + u64(total_ms / g_speed * 3 + 5000) * 1'000'000;
+    while (host::GetTimeNs() < deadline) {
+        // roughly a frame.
+        svcSleepThread(16'000'000);
+
+        Progress progress{};
+        State state{};
+        if (R_FAILED(GetProgress(song, &progress, &state))) {
+            break;
+        }
+
+        if (progress.track != track) {
+            report.switches += progress.track - track;
+            index += progress.track - track;
+            track = progress.track;
+            queue_next();
+        }
+
+        if (state == State::Finished) {
+            CloseSong(&song);
+
+            if (++index >= s.songs.size()) {
+                report.finished = true;
+                break;
+            }
+
+            if (R_FAILED(open())) {
+                break;
+            }
+
+            report.reopens++;
+            track = 0;
+            queue_next();
+            PlaySong(song);
+        } else if (state == State::Error) {
+            break;
+        }
+    }
+
+    if (song) {
+        CloseSong(&song);
+    }
+
+    report.frames = checker.frames;
+    report.bad_frames = checker.bad;
+    report.stats = host::GetAudioStats();
+    return report;
+}
+
+int g_failed{};
+
+// stb_vorbis.h has its own.
+#undef CHECK
+#define CHECK(cond, name) do { \
+    if (!(cond)) { \
+        std::printf("FAIL %s: %s\n", name, #cond); \
+        g_failed++; \
+    } \
+} while (0)
+
+} // namespace
+} // namespace sphaira::audio
+
+int main(int argc, char** argv) {
+    using namespace sphaira;
+    using namespace sphaira::audio;
+
+    const char* data{};
+    const char* only{};
+    bool log{};
+    bool real_clock{};
+
+    for (int i = 1; i < argc; i++) {
+        const auto next = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(argv[i], "--data") && next) {
+            data = next;
+            i++;
+        } else if (!std::strcmp(argv[i], "--speed") && next && std::atof(next) > 0) {
+            g_speed = std::atof(next);
+            i++;
+        } else if (!std::strcmp(argv[i], "--only") && next) {
+            only = next;
+            i++;
+        } else if (!std::strcmp(argv[i], "--real_clock")) {
+            real_clock = true;
+        } else if (!std::strcmp(argv[i], "--log")) {
+            log = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--data dir] [--speed x] [--real_clock] [--only name] [--log]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    host::SetLogEnabled(log);
+    host::SetAudioSpeed(g_speed);
+    host::SetAudioClockStepped(!real_clock);
+
+    const std::vector<Scenario> scenarios{
+        // a folder of songs with the same format, loading each takes a while.
+        { "gapless", 2, {
+            { 3, 44100, 2, 300 },
+            { 3, 44100, 2, 300 },
+            { 3, 44100, 2, 300 },
+        }, true, false },
+        // the decoder stalls for 400ms every second, the ring covers it.
+        { "slow_reads", 2, {
+            { 4, 48000, 2, 0, 400, 1 },
+            { 4, 48000, 2, 0, 400, 1 },
+        }, true, false },
+        // same as above without decoding ahead, the voice runs dry.
+        { "slow_reads_no_ahead", 0, {
+            { 4, 48000, 2, 0, 400, 1 },
+        }, false, true },
+        // the sample rate differs, so the queued song is dropped and opened after.
+        { "format_change", 2, {
+            { 2, 44100, 2, 100 },
+            { 2, 48000, 1, 100 },
+        }, false, false },
+        // the sample files queued after each other.
+        { "flac_gapless", 2, {
+            { .file = "song.flac" },
+            { .file = "song.flac" },
+            { .file = "song.flac" },
+        }, true, false },
+        { "mp3_gapless", 2, {
+            { .file = "song.mp3" },
+            { .file = "song.mp3" },
+            { .file = "song.mp3" },
+        }, true, false },
+        { "ogg_gapless", 2, {
+            { .file = "song.ogg" },
+            { .file = "song.ogg" },
+            { .file = "song.ogg" },
+        }, true, false },
+        // the samples have the same format, so the decoder changes without a gap.
+        { "mixed_gapless", 2, {
+            { .file = "song.flac" },
+            { .file = "song.mp3" },
+            { .file = "song.ogg" },
+        }, true, false },
+    };
+
+    // decodes the sample files up front, for the decode cost and to check playback.
+    std::vector<std::pair<const char*, Reference>> samples;
+
+    if (data) {
+        host::SetSdRoot(data);
+
+        std::printf("%-12s %8s %8s %8s %9s %10s %11s\n",
+            "file", "channels", "rate", "frames", "load ms", "decode ms", "x realtime");
+
+        for (const auto file : { "song.flac", "song.mp3", "song.ogg" }) {
+            if (!IsSongSupported(FilePath(file))) {
+                std::printf("%-12s decoder not built\n", file);
+                continue;
+            }
+
+            const auto d = DecodeFile(file);
+            const auto seconds = d.info.sample_rate ? double(d.ref.Frames()) / d.info.sample_rate : 0;
+            const auto realtime = d.decode_ns ? seconds / (d.decode_ns / 1e+9) : 0;
+            std::printf("%-12s %8u %8u %8llu %9.2f %10.2f %11.1f\n",
+                file, d.info.channels, d.info.sample_rate, (unsigned long long)d.ref.Frames(), d.load_ns / 1e+6, d.decode_ns / 1e+6, realtime);
+
+            CHECK(d.ok, file);
+            CHECK(d.ref.Frames() && d.ref.Frames() == d.info.sample_count, file);
+            // the ring only covers slow reads if decoding is faster than playback.
+            CHECK(realtime > 1, file);
+
+            if (d.ok) {
+                samples.emplace_back(file, d.ref);
+            }
+        }
+
+        std::printf("\n");
+    } else {
+        std::printf("no --data, skipping the sample files\n");
+    }
+
+    if (R_FAILED(Init())) {
+        std::printf("failed to init audio\n");
+        return 1;
+    }
+
+    std::printf("%-20s %7s %9s %8s %9s %10s %12s %10s\n",
+        "scenario", "songs", "switches", "reopens", "underruns", "starved ms", "max queue ms", "bad frames");
+
+    for (const auto& s : scenarios) {
+        if (only && std::strcmp(only, s.name)) {
+            continue;
+        }
+
+        std::vector<Reference> refs;
+        for (u32 i = 0; i < s.songs.size(); i++) {
+            const auto& model = s.songs[i];
+            if (!model.file) {
+                refs.emplace_back(SyntheticReference(model, i));
+                continue;
+            }
+
+            const auto it = std::ranges::find_if(samples, [&model](auto& e) {
+                return !std::strcmp(e.first, model.file);
+            });
+
+            if (it != samples.end()) {
+                refs.emplace_back(it->second);
+            }
+        }
+
+        if (refs.size() != s.songs.size()) {
+            std::printf("%-20s skipped, missing sample files\n", s.name);
+            continue;
+        }
+
+        const auto r = Run(s, refs);
+        std::printf("%-20s %7zu %9u %8u %9u %10.1f %12.3f %10llu\n",
+            s.name, s.songs.size(), r.switches, r.reopens, r.stats.underruns, r.stats.starved_ns / 1e+6 * g_speed, r.max_queue_ns / 1e+6, (unsigned long long)r.bad_frames);
+
+        u64 frames{};
+        for (const auto& e : refs) {
+            frames += e.Frames();
+        }
+
+        CHECK(r.finished, s.name);
+        CHECK(r.frames == frames, s.name);
+        CHECK(r.bad_frames == 0, s.name);
+        // queueing only hands the song to the decode thread.
+        CHECK(r.max_queue_ns < 20'000'000, s.name);
+
+        if (s.expect_gapless) {
+            CHECK(r.switches == s.songs.size() - 1 && r.reopens == 0, s.name);
+        } else {
+            CHECK(r.switches + r.reopens == s.songs.size() - 1, s.name);
+        }
+
+        if (s.expect_underruns) {
+            CHECK(r.stats.underruns > 0, s.name);
+        } else {
+            CHECK(r.stats.underruns == 0, s.name);
+        }
+    }
+
+    Exit();
+
+    if (g_failed) {
+        std::printf("%d checks failed\n", g_failed);
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,303 @@
+// drives utils::qos::TokenBucket with a fake clock, checks that the budget is
+// kept, shared fairly, not halved by copies and that foreground io never
+// waits, then checks that the default budgets beat the old fixed 2ms sleep on
+// a simulated sd card.
+//
+// test_io_qos [--read latency_ms:MiB/s] [--write latency_ms:MiB/s]
+
+#include "utils/io_qos.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+using namespace sphaira;
+using namespace sphaira::utils;
+
+constexpr u64 MiB = 1024 * 1024;
+constexpr u64 NS = 1'000'000'000;
+// chunk size used by the transfers with file based emummc, see SMALL_BUFFER_SIZE.
+constexpr s64 CHUNK = 1024 * 512;
+// the sleep that the budget replaced.
+constexpr u64 OLD_SLEEP_NS = 2'000'000;
+
+int g_failed{};
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        std::printf(__VA_ARGS__); \
+        std::printf("\n"); \
+        g_failed++; \
+    } \
+} while (0)
+
+// simulated device, same as host::DeviceModel but returns the time rather than sleeping.
+struct Device {
+    double latency_ms;
+    double bandwidth; // MiB/s
+
+    auto Cost(s64 size) const -> u64 {
+        return u64((latency_ms / 1e+3 + size / (bandwidth * MiB)) * NS);
+    }
+};
+
+auto Rate(u64 bytes, u64 ns) -> double {
+    return bytes / double(MiB) / (ns / double(NS));
+}
+
+// a thread doing io of size bytes in chunks, returns when it finished.
+auto RunBulk(qos::TokenBucket& bucket, u64 now, u64 size, s64 chunk) -> u64 {
+    for (u64 off = 0; off < size; off += chunk) {
+        now += bucket.Reserve(now, chunk, qos::Priority_Bulk);
+    }
+    return now;
+}
+
+void TestUnlimited() {
+    qos::TokenBucket bucket;
+    bucket.SetBudget({}, 0);
+    CHECK(bucket.Reserve(0, 64 * MiB, qos::Priority_Bulk) == 0, "unlimited budget waited");
+    CHECK(bucket.Reserve(0, 64 * MiB, qos::Priority_Bulk) == 0, "unlimited budget waited");
+}
+
+void TestBurst() {
+    qos::TokenBucket bucket;
+    bucket.SetBudget({ .rate = 64 * MiB, .burst = 1 * MiB }, 0);
+
+    // the burst goes through without waiting.
+    CHECK(bucket.Reserve(0, 512 * 1024, qos::Priority_Bulk) == 0, "waited within the burst");
+    CHECK(bucket.Reserve(0, 512 * 1024, qos::Priority_Bulk) == 0, "waited within the burst");
+    // then everything after it waits for its cost.
+    const auto wait = bucket.Reserve(0, 512 * 1024, qos::Priority_Bulk);
+    CHECK(wait == 512 * 1024 * NS / (64 * MiB), "wait: %llu", (unsigned long long)wait);
+}
+
+void TestRate() {
+    for (const s64 rate : { 8, 48, 64, 200 }) {
+        qos::TokenBucket bucket;
+        bucket.SetBudget({ .rate = rate * s64(MiB), .burst = 1 * MiB }, 0);
+
+        const u64 size = 1024 * MiB;
+        const auto end = RunBulk(bucket, 0, size, CHUNK);
+        // only the burst is free.
+        const auto expected = (size - 1 * MiB) * NS / (rate * MiB);
+        CHECK(std::llabs(s64(end - expected)) < s64(NS / 1000), "rate: %lld end: %llu expected: %llu", (long long)rate, (unsigned long long)end, (unsigned long long)expected);
+    }
+}
+
+void TestIdle() {
+    qos::TokenBucket bucket;
+    bucket.SetBudget({ .rate = 64 * MiB, .burst = 1 * MiB }, 0);
+
+    // being idle for a long time does not give more than the burst.
+    const u64 now = 60 * NS;
+    CHECK(bucket.Reserve(now, 1 * MiB, qos::Priority_Bulk) == 0, "waited within the burst");
+    CHECK(bucket.Reserve(now, CHUNK, qos::Priority_Bulk) == CHUNK * NS / (64 * MiB), "idle budget carried over");
+}
+
+void TestFairness() {
+    qos::TokenBucket bucket;
+    bucket.SetBudget({ .rate = 64 * MiB, .burst = 1 * MiB }, 0);
+
+    // two threads reserving in turn, such as two paste workers.
+    u64 now[2]{};
+    u64 bytes[2]{};
+    while (std::max(now[0], now[1]) < 10 * NS) {
+        const auto i = now[0] <= now[1] ? 0 : 1;
+        now[i] += bucket.Reserve(now[i], i ? CHUNK / 4 : CHUNK, qos::Priority_Bulk);
+        bytes[i] += i ? CHUNK / 4 : CHUNK;
+    }
+
+    // both get the same time on the device, so the one doing larger io gets more bytes.
+    const auto total = Rate(bytes[0] + bytes[1], 10 * NS);
+    CHECK(std::fabs(total - 64) < 1, "total: %.2f MiB/s", total);
+    CHECK(bytes[0] > bytes[1], "bytes: %llu %llu", (unsigned long long)bytes[0], (unsigned long long)bytes[1]);
+}
+
+void TestForeground() {
+    qos::TokenBucket bucket;
+    bucket.SetBudget({ .rate = 64 * MiB, .burst = 1 * MiB }, 0);
+
+    // foreground io never waits, even past the burst.
+    u64 waited = 0;
+    for (int i = 0; i < 64; i++) {
+        waited += bucket.Reserve(0, CHUNK, qos::Priority_Foreground);
+    }
+    CHECK(waited == 0, "foreground waited: %llu", (unsigned long long)waited);
+
+    // bulk io after it waits for what the foreground used.
+    const auto wait = bucket.Reserve(0, CHUNK, qos::Priority_Bulk);
+    const auto expected = (65 * CHUNK - 1 * MiB) * NS / (64 * MiB);
+    CHECK(wait == expected, "wait: %llu expected: %llu", (unsigned long long)wait, (unsigned long long)expected);
+}
+
+void TestForegroundDuringBulk() {
+    qos::TokenBucket bucket;
+    bucket.SetBudget({ .rate = 64 * MiB, .burst = 1 * MiB }, 0);
+
+    // a paste running whilst the ui loads a 64KiB icon every frame.
+    constexpr u64 FRAME_NS = NS / 60;
+    constexpr s64 ICON = 64 * 1024;
+    u64 bulk_now{}, ui_now{};
+    u64 bulk_bytes{}, ui_bytes{}, ui_waited{};
+    while (std::min(bulk_now, ui_now) < 10 * NS) {
+        if (ui_now <= bulk_now) {
+            ui_waited += bucket.Reserve(ui_now, ICON, qos::Priority_Foreground);
+            ui_bytes += ICON;
+            ui_now += FRAME_NS;
+        } else {
+            bulk_now += bucket.Reserve(bulk_now, CHUNK, qos::Priority_Bulk);
+            bulk_bytes += CHUNK;
+        }
+    }
+
+    // the ui is never slowed down, the paste gives up what the ui used.
+    const auto ui = Rate(ui_bytes, ui_now);
+    const auto bulk = Rate(bulk_bytes, bulk_now);
+    std::printf("foreground during bulk at 64 MiB/s: ui: %.1f MiB/s bulk: %.1f MiB/s\n", ui, bulk);
+    CHECK(ui_waited == 0, "foreground waited: %llu", (unsigned long long)ui_waited);
+    CHECK(std::fabs(ui + bulk - 64) < 1, "ui: %.2f bulk: %.2f", ui, bulk);
+}
+
+// copies size bytes from and to the same device, reads and writes are pipelined
+// as in thread::Transfer, returns when the last write finished.
+auto SimCopy(qos::TokenBucket* read, qos::TokenBucket* write, const Device& r, const Device& w, u64 size, u64 sleep_ns) -> u64 {
+    u64 read_now{}, write_now{};
+    for (u64 off = 0; off < size; off += CHUNK) {
+        if (read) {
+            read_now += read->Reserve(read_now, CHUNK, qos::Priority_Bulk);
+        }
+        read_now += r.Cost(CHUNK) + sleep_ns;
+
+        // the write can't start before the data was read.
+        write_now = std::max(write_now, read_now);
+        if (write) {
+            write_now += write->Reserve(write_now, CHUNK, qos::Priority_Bulk);
+        }
+        write_now += w.Cost(CHUNK) + sleep_ns;
+    }
+    return write_now;
+}
+
+void TestCopyNotHalved() {
+    // a copy used to charge both the read and the write to the same budget.
+    const Device fast{ 0, 1000 };
+    const u64 size = 512 * MiB;
+    const qos::Budget budget{ .rate = 48 * MiB, .burst = 1 * MiB };
+
+    qos::TokenBucket shared;
+    shared.SetBudget(budget, 0);
+    const auto shared_rate = Rate(size, SimCopy(&shared, &shared, fast, fast, size, 0));
+
+    qos::TokenBucket read, write;
+    read.SetBudget(budget, 0);
+    write.SetBudget(budget, 0);
+    const auto split_rate = Rate(size, SimCopy(&read, &write, fast, fast, size, 0));
+
+    std::printf("copy at 48 MiB/s budget, shared bucket: %.1f MiB/s, read/write buckets: %.1f MiB/s\n", shared_rate, split_rate);
+    CHECK(shared_rate < 25, "shared: %.2f", shared_rate);
+    CHECK(std::fabs(split_rate - 48) < 1, "split: %.2f", split_rate);
+}
+
+// throughput of single threaded io in chunks on a device with a budget.
+auto BudgetRate(const Device& device, const qos::Budget& budget, u64 size) -> double {
+    qos::TokenBucket bucket;
+    bucket.SetBudget(budget, 0);
+
+    u64 now{};
+    for (u64 off = 0; off < size; off += CHUNK) {
+        now += bucket.Reserve(now, CHUNK, qos::Priority_Bulk) + device.Cost(CHUNK);
+    }
+    return Rate(size, now);
+}
+
+// prints the throughput of the old sleep and of the budget at a few rates,
+// then checks that the default budgets beat the old sleep in each direction.
+void CompareOldSleep(const Device& r, const Device& w) {
+    const u64 size = 1024 * MiB;
+
+    const auto old_read = Rate(CHUNK, r.Cost(CHUNK) + OLD_SLEEP_NS);
+    const auto old_write = Rate(CHUNK, w.Cost(CHUNK) + OLD_SLEEP_NS);
+    const auto old_copy = Rate(size, SimCopy(nullptr, nullptr, r, w, size, OLD_SLEEP_NS));
+    const auto none_copy = Rate(size, SimCopy(nullptr, nullptr, r, w, size, 0));
+
+    std::printf("sd read: %.1f MiB/s write: %.1f MiB/s\n", Rate(CHUNK, r.Cost(CHUNK)), Rate(CHUNK, w.Cost(CHUNK)));
+    std::printf("%-24s %8s %8s %8s\n", "policy", "read", "write", "copy");
+    std::printf("%-24s %8.1f %8.1f %8.1f\n", "none", Rate(CHUNK, r.Cost(CHUNK)), Rate(CHUNK, w.Cost(CHUNK)), none_copy);
+    std::printf("%-24s %8.1f %8.1f %8.1f\n", "old 2ms sleep", old_read, old_write, old_copy);
+
+    const auto print = [&](const char* name, s64 read_rate, s64 write_rate, double* out_read, double* out_write, double* out_copy) {
+        const qos::Budget read_budget{ .rate = read_rate * s64(MiB), .burst = qos::DEFAULT_BURST * 1024 };
+        const qos::Budget write_budget{ .rate = write_rate * s64(MiB), .burst = qos::DEFAULT_BURST * 1024 };
+
+        qos::TokenBucket read, write;
+        read.SetBudget(read_budget, 0);
+        write.SetBudget(write_budget, 0);
+
+        *out_read = BudgetRate(r, read_budget, size);
+        *out_write = BudgetRate(w, write_budget, size);
+        *out_copy = Rate(size, SimCopy(&read, &write, r, w, size, 0));
+        std::printf("%-24s %8.1f %8.1f %8.1f\n", name, *out_read, *out_write, *out_copy);
+    };
+
+    double read, write, copy;
+    for (const s64 rate : { 32, 48, 56, 64 }) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "budget %lld MiB/s", (long long)rate);
+        print(name, rate, rate, &read, &write, &copy);
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "default %lld/%lld MiB/s", (long long)qos::DEFAULT_READ_RATE, (long long)qos::DEFAULT_WRITE_RATE);
+    print(name, qos::DEFAULT_READ_RATE, qos::DEFAULT_WRITE_RATE, &read, &write, &copy);
+
+    CHECK(read > old_read, "default read: %.2f old: %.2f", read, old_read);
+    CHECK(write > old_write, "default write: %.2f old: %.2f", write, old_write);
+    CHECK(copy > old_copy, "default copy: %.2f old: %.2f", copy, old_copy);
+}
+
+bool ParseDevice(const char* arg, Device& out) {
+    return 2 == std::sscanf(arg, "%lf:%lf", &out.latency_ms, &out.bandwidth) && out.bandwidth > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // same sd card as bench_transfer.
+    Device read{ 0.1, 90 };
+    Device write{ 0.1, 70 };
+
+    for (int i = 1; i < argc; i++) {
+        const auto next = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(argv[i], "--read") && next && ParseDevice(next, read)) {
+            i++;
+        } else if (!std::strcmp(argv[i], "--write") && next && ParseDevice(next, write)) {
+            i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--read latency_ms:MiB/s] [--write latency_ms:MiB/s]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    TestUnlimited();
+    TestBurst();
+    TestRate();
+    TestIdle();
+    TestFairness();
+    TestForeground();
+    TestForegroundDuringBulk();
+    TestCopyNotHalved();
+    CompareOldSleep(read, write);
+
+    if (g_failed) {
+        std::printf("%d checks failed\n", g_failed);
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
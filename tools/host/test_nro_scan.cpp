@@ -0,0 +1,332 @@
+// scans a synthetic sd card of nro's with nro_scan(), cold (no index) then warm
+// (from the index), reports the time and fs calls of each and checks that the
+// warm scan returns the same entries without opening the nro's.
+// also checks that modified and deleted nro's are picked up, that a failing
+// timestamp falls back to parsing the nro and that scanning a folder keeps the
+// index entries of its siblings.
+//
+// test_nro_scan [--count n] [--read latency_ms:MiB/s] [--keep] [--log]
+
+#include "nro.hpp"
+#include "host.hpp"
+#include "defines.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+using namespace sphaira;
+
+constexpr fs::FsPath ROOT{"/switch"};
+constexpr u64 CODE_SIZE = 0x1000;
+
+int g_failed{};
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        std::printf("FAIL %s:%d: %s: ", __FILE__, __LINE__, #cond); \
+        std::printf(__VA_ARGS__); \
+        std::printf("\n"); \
+        g_failed++; \
+    } \
+} while (0)
+
+// what nro_scan() should return for an nro.
+struct Expected {
+    std::string path;
+    std::string name;
+    std::string author;
+    std::string version;
+    s64 size;
+    u64 icon_size;
+    u64 icon_offset;
+    bool is_nacp_valid;
+};
+
+auto HostPath(const std::string& path) -> std::string {
+    return host::GetSdRoot() + path;
+}
+
+void CreateDirs(const std::string& path) {
+    std::filesystem::create_directories(std::filesystem::path{HostPath(path)}.parent_path());
+}
+
+// writes an nro with an asset header, icon and nacp, or with nothing after
+// the code if valid_nacp is false (such as vgedit).
+// the nacp is mostly zeros so the file is written sparse.
+auto WriteNro(const std::string& path, const std::string& name, const std::string& author, const std::string& version, u64 icon_size, bool valid_nacp) -> Expected {
+    CreateDirs(path);
+    const auto fd = open(HostPath(path).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::printf("failed to create %s\n", path.c_str());
+        std::exit(1);
+    }
+    ON_SCOPE_EXIT(close(fd));
+
+    NroData data{};
+    data.header.magic = NROHEADER_MAGIC;
+    data.header.size = CODE_SIZE;
+    pwrite(fd, &data, sizeof(data), 0);
+
+    Expected e{ path, name, author, version, CODE_SIZE, 0, 0, valid_nacp };
+
+    if (!valid_nacp) {
+        ftruncate(fd, CODE_SIZE);
+        // the name is taken from the file name.
+        e.name = path.substr(path.rfind('/') + 1);
+        e.name.resize(e.name.size() - 4);
+        e.author = e.version = "Unknown";
+        return e;
+    }
+
+    NroAssetHeader asset{};
+    asset.magic = NROASSETHEADER_MAGIC;
+    asset.icon = { sizeof(asset), icon_size };
+    asset.nacp = { sizeof(asset) + icon_size, sizeof(NacpStruct) };
+    pwrite(fd, &asset, sizeof(asset), CODE_SIZE);
+
+    std::vector<u8> icon(icon_size, 0xFF);
+    pwrite(fd, icon.data(), icon.size(), CODE_SIZE + asset.icon.offset);
+
+    NacpLanguageEntry lang{};
+    std::strcpy(lang.name, name.c_str());
+    std::strcpy(lang.author, author.c_str());
+    char display_version[0x10]{};
+    std::strcpy(display_version, version.c_str());
+    pwrite(fd, &lang, sizeof(lang), CODE_SIZE + asset.nacp.offset);
+    pwrite(fd, display_version, sizeof(display_version), CODE_SIZE + asset.nacp.offset + offsetof(NacpStruct, display_version));
+    ftruncate(fd, CODE_SIZE + asset.nacp.offset + asset.nacp.size);
+
+    e.size = CODE_SIZE + sizeof(asset) + asset.icon.size + asset.nacp.size;
+    e.icon_size = icon_size;
+    e.icon_offset = CODE_SIZE + asset.icon.offset;
+    return e;
+}
+
+// moves the modified time forward, the timestamps only have second precision.
+void Touch(const std::string& path, u64 seconds) {
+    const timespec times[2]{ { time_t(seconds), 0 }, { time_t(seconds), 0 } };
+    utimensat(AT_FDCWD, HostPath(path).c_str(), times, 0);
+}
+
+// lays out the nro's the ways that they are found in /switch.
+auto CreateSd(u32 count) -> std::vector<Expected> {
+    std::vector<Expected> expected;
+
+    for (u32 i = 0; i < count; i++) {
+        const auto n = std::to_string(i);
+        const auto name = "App " + n;
+        const auto author = "Author " + std::to_string(i % 37);
+        const auto version = std::to_string(i % 5) + "." + std::to_string(i % 11);
+        const auto icon_size = 256 + i % 64;
+
+        switch (i % 4) {
+            // switch/app.nro
+            case 0: expected.emplace_back(WriteNro("/switch/app" + n + ".nro", name, author, version, icon_size, true)); break;
+            // switch/app/app.nro, found by the fast path.
+            case 1: expected.emplace_back(WriteNro("/switch/app" + n + "/app" + n + ".nro", name, author, version, icon_size, true)); break;
+            // switch/dir/other.nro, found by scanning the folder.
+            case 2: expected.emplace_back(WriteNro("/switch/dir" + n + "/other" + n + ".nro", name, author, version, icon_size, true)); break;
+            // switch/app.nro without a nacp.
+            case 3: expected.emplace_back(WriteNro("/switch/app" + n + ".nro", name, author, version, icon_size, false)); break;
+        }
+    }
+
+    // siblings whose names are prefixes of each other.
+    expected.emplace_back(WriteNro("/switch/foo/foo.nro", "Foo", "Foo", "1.0", 256, true));
+    expected.emplace_back(WriteNro("/switch/foobar/foobar.nro", "Foobar", "Foobar", "1.0", 256, true));
+
+    std::ranges::sort(expected, {}, &Expected::path);
+    return expected;
+}
+
+struct Scan {
+    std::vector<NroEntry> nros;
+    host::Counters counters;
+    u64 ns;
+    Result rc;
+};
+
+auto RunScan(const fs::FsPath& path) -> Scan {
+    Scan scan{};
+    host::ResetCounters();
+
+    const auto start = host::GetTimeNs();
+    scan.rc = nro_scan(path, scan.nros);
+    scan.ns = host::GetTimeNs() - start;
+    scan.counters = host::GetCounters();
+
+    std::ranges::sort(scan.nros, [](auto& a, auto& b) {
+        return std::strcmp(a.path, b.path) < 0;
+    });
+    return scan;
+}
+
+void CheckEntries(const char* name, const Scan& scan, const std::vector<Expected>& expected) {
+    CHECK(R_SUCCEEDED(scan.rc), "%s: scan failed: 0x%X", name, scan.rc);
+    CHECK(scan.nros.size() == expected.size(), "%s: found %zu expected %zu", name, scan.nros.size(), expected.size());
+
+    u32 bad = 0;
+    for (size_t i = 0; i < std::min(scan.nros.size(), expected.size()); i++) {
+        const auto& a = scan.nros[i];
+        const auto& e = expected[i];
+
+        if (e.path != a.path.s || e.name != a.GetName() || e.author != a.GetAuthor() ||
+            e.version != a.GetDisplayVersion() || e.size != a.size || e.icon_size != a.icon_size ||
+            e.icon_offset != a.icon_offset || e.is_nacp_valid != a.is_nacp_valid) {
+            if (!bad) {
+                std::printf("%s: mismatch at %s (%s) name: %s author: %s version: %s size: %lld icon: %llu@%llu\n",
+                    name, e.path.c_str(), a.path.s, a.GetName(), a.GetAuthor(), a.GetDisplayVersion(),
+                    (long long)a.size, (unsigned long long)a.icon_size, (unsigned long long)a.icon_offset);
+            }
+            bad++;
+        }
+    }
+
+    CHECK(!bad, "%s: %u entries differ", name, bad);
+}
+
+void Print(const char* name, const Scan& scan) {
+    std::printf("%-16s %6zu %10.1f %7llu %7llu %10llu %10llu\n",
+        name, scan.nros.size(), scan.ns / 1e+6,
+        (unsigned long long)scan.counters.fs_file_opens, (unsigned long long)scan.counters.fs_file_reads,
+        (unsigned long long)scan.counters.fs_file_read_bytes, (unsigned long long)scan.counters.fs_timestamp_calls);
+}
+
+bool ParseModel(const char* arg, host::DeviceModel& out) {
+    return 2 == std::sscanf(arg, "%lf:%lf", &out.latency_ms, &out.bandwidth);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    u32 count = 3000;
+    host::DeviceModel read_model{};
+    bool keep{};
+    bool log{};
+
+    for (int i = 1; i < argc; i++) {
+        const auto next = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(argv[i], "--count") && next && std::atoi(next) > 0) {
+            count = std::atoi(next);
+            i++;
+        } else if (!std::strcmp(argv[i], "--read") && next && ParseModel(next, read_model)) {
+            host::SetFsReadModel(&read_model);
+            i++;
+        } else if (!std::strcmp(argv[i], "--keep")) {
+            keep = true;
+        } else if (!std::strcmp(argv[i], "--log")) {
+            log = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--count n] [--read latency_ms:MiB/s] [--keep] [--log]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    host::SetLogEnabled(log);
+
+    char dir[] = "/tmp/sphaira_nro_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::printf("failed to create sd root\n");
+        return 1;
+    }
+    ON_SCOPE_EXIT(if (!keep) { std::filesystem::remove_all(dir); });
+    host::SetSdRoot(dir);
+
+    auto expected = CreateSd(count);
+
+    std::printf("%-16s %6s %10s %7s %7s %10s %10s\n", "scan", "nros", "ms", "opens", "reads", "read bytes", "timestamps");
+
+    // no index, every nro is parsed and the index is written.
+    const auto cold = RunScan(ROOT);
+    Print("cold", cold);
+    CheckEntries("cold", cold, expected);
+
+    // every nro is found in the index, only the index is opened.
+    const auto warm = RunScan(ROOT);
+    Print("warm", warm);
+    CheckEntries("warm", warm, expected);
+    CHECK(warm.counters.fs_file_opens == 1, "warm: opens: %llu", (unsigned long long)warm.counters.fs_file_opens);
+
+    // a modified nro is parsed again, the rest come from the index.
+    {
+        auto& e = *std::ranges::find(expected, "/switch/app0.nro", &Expected::path);
+        e = WriteNro(e.path, "App 0 updated", "Someone else", "2.0", 512, true);
+        Touch(e.path, 1'000'000'000);
+
+        const auto scan = RunScan(ROOT);
+        Print("modified", scan);
+        CheckEntries("modified", scan, expected);
+        // index, the nro and writing the index.
+        CHECK(scan.counters.fs_file_opens == 3, "modified: opens: %llu", (unsigned long long)scan.counters.fs_file_opens);
+    }
+
+    // a deleted nro is dropped from the index.
+    {
+        const auto it = std::ranges::find(expected, "/switch/app4.nro", &Expected::path);
+        unlink(HostPath(it->path).c_str());
+        expected.erase(it);
+
+        const auto scan = RunScan(ROOT);
+        Print("deleted", scan);
+        CheckEntries("deleted", scan, expected);
+
+        const auto again = RunScan(ROOT);
+        CheckEntries("deleted warm", again, expected);
+        CHECK(again.counters.fs_file_opens == 1, "deleted warm: opens: %llu", (unsigned long long)again.counters.fs_file_opens);
+    }
+
+    // scanning /switch/foo keeps the index entry of /switch/foobar.
+    {
+        const auto scan = RunScan("/switch/foo");
+        Print("sibling", scan);
+        CHECK(scan.nros.size() == 1, "sibling: found %zu", scan.nros.size());
+
+        const auto again = RunScan(ROOT);
+        CheckEntries("sibling warm", again, expected);
+        CHECK(again.counters.fs_file_opens == 1, "sibling warm: opens: %llu", (unsigned long long)again.counters.fs_file_opens);
+    }
+
+    // when the timestamp can't be read, the nro's are parsed and not cached.
+    {
+        host::SetTimeStampFail(true);
+        const auto scan = RunScan(ROOT);
+        host::SetTimeStampFail(false);
+        Print("no timestamps", scan);
+        CheckEntries("no timestamps", scan, expected);
+        CHECK(scan.counters.fs_file_opens >= expected.size(), "no timestamps: opens: %llu", (unsigned long long)scan.counters.fs_file_opens);
+
+        const auto cached = std::ranges::count_if(scan.nros, [](auto& e) {
+            return e.timestamp.is_valid;
+        });
+        CHECK(cached == 0, "no timestamps: %lld entries with a timestamp", (long long)cached);
+
+        // nothing was cached, so this is a cold scan again.
+        const auto cold_again = RunScan(ROOT);
+        Print("cold again", cold_again);
+        CheckEntries("cold again", cold_again, expected);
+        CHECK(cold_again.counters.fs_file_opens > expected.size(), "cold again: opens: %llu", (unsigned long long)cold_again.counters.fs_file_opens);
+
+        const auto warm_again = RunScan(ROOT);
+        Print("warm again", warm_again);
+        CheckEntries("warm again", warm_again, expected);
+        CHECK(warm_again.counters.fs_file_opens == 1, "warm again: opens: %llu", (unsigned long long)warm_again.counters.fs_file_opens);
+    }
+
+    if (g_failed) {
+        std::printf("%d checks failed\n", g_failed);
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
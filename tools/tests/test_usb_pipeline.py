@@ -0,0 +1,266 @@
+import sys, os
+sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '..')))
+
+import unittest
+import tempfile
+import shutil
+import threading
+import crc32c
+
+from usb_common import *
+
+# same as PIPELINE_BLOCK_SIZE in usb_installer.cpp, smaller to keep the tests fast.
+BLOCK_SIZE = 1024 * 4
+
+# mirrors usb::install::Usb and usb::dump::Usb from the switch side of the loopback.
+class FakeSwitch:
+	def __init__(self, usb, window):
+		self.usb = usb
+		self.want_window = window
+		self.window = PIPELINE_WINDOW_NONE
+		self.pending = []
+		self.block = b""
+		self.block_off = 0
+		self.file_size = 0
+		self.max_pending = 0
+
+	def send_and_verify(self, data):
+		self.usb.write(data)
+		return self.get_result()
+
+	def get_result(self):
+		packet = ResultPacket.unpack(self.usb.read(PACKET_SIZE))
+		packet.verify()
+		return packet
+
+	# install.
+	def connect(self):
+		result = self.send_and_verify(SendPacket.build(RESULT_OK, 0, self.want_window).pack())
+		self.window = min(max(result.arg4, PIPELINE_WINDOW_NONE), PIPELINE_WINDOW_MAX)
+		return self.usb.read(result.arg3).decode("utf-8").splitlines()
+
+	def quit(self):
+		self.send_and_verify(SendPacket.build(CMD_QUIT).pack())
+
+	def open_file(self, index):
+		result = self.send_and_verify(SendPacket.build(CMD_OPEN, index).pack())
+		self.file_size = ((result.arg3 & 0xFFFF) << 32) | result.arg4
+		self.block = b""
+		self.block_off = 0
+		return self.file_size
+
+	def close_file(self):
+		while self.pending:
+			self.receive_block()
+		self.send_and_verify(SendDataPacket.build(0, 0, 0).pack())
+
+	def read(self, off, size):
+		if self.window <= PIPELINE_WINDOW_NONE:
+			result = self.send_and_verify(SendDataPacket.build(off, size, 0).pack())
+			buf = self.usb.read(result.arg3)
+			if crc32c.crc32c(buf) != result.arg4:
+				raise ValueError("CRC32C mismatch")
+			return buf
+
+		out = b""
+		size = min(size, max(self.file_size - off, 0))
+		while size:
+			if off >= self.block_off and off < self.block_off + len(self.block):
+				pos = off - self.block_off
+				buf = self.block[pos:pos + size]
+				out += buf
+				off += len(buf)
+				size -= len(buf)
+				continue
+
+			while self.pending and self.pending[0][0] + self.pending[0][1] <= off:
+				self.receive_block()
+			if self.pending and self.pending[0][0] > off:
+				while self.pending:
+					self.receive_block()
+			if not self.pending:
+				self.request_block(off)
+			while len(self.pending) < self.window:
+				next_off = self.pending[-1][0] + self.pending[-1][1]
+				if next_off >= self.file_size:
+					break
+				self.request_block(next_off)
+
+			self.receive_block()
+		return out
+
+	def request_block(self, off):
+		size = min(BLOCK_SIZE, self.file_size - off)
+		self.usb.write(SendDataPacket.build(off, size, 0).pack())
+		self.pending.append((off, size))
+		self.max_pending = max(self.max_pending, len(self.pending))
+
+	def receive_block(self):
+		[off, _] = self.pending.pop(0)
+		result = self.get_result()
+		buf = self.usb.read(result.arg3)
+		if crc32c.crc32c(buf) != result.arg4:
+			raise ValueError("CRC32C mismatch")
+		self.block = buf
+		self.block_off = off
+
+	# export.
+	def export(self, name, data, chunk_size):
+		name = name.encode("utf-8")
+		result = self.send_and_verify(SendPacket.build(CMD_EXPORT, len(name), self.want_window).pack())
+		self.window = min(max(result.arg4, PIPELINE_WINDOW_NONE), PIPELINE_WINDOW_MAX)
+		self.send_and_verify(name)
+
+		pending = 0
+		for off in range(0, len(data), chunk_size):
+			buf = data[off:off + chunk_size]
+			header = SendDataPacket.build(off, len(buf), crc32c.crc32c(buf)).pack()
+			if self.window <= PIPELINE_WINDOW_NONE:
+				self.send_and_verify(header)
+				self.send_and_verify(buf)
+				continue
+
+			if pending >= self.window:
+				self.get_result()
+				pending -= 1
+			self.usb.write(header)
+			self.usb.write(buf)
+			pending += 1
+			self.max_pending = max(self.max_pending, pending)
+
+		while pending:
+			self.get_result()
+			pending -= 1
+		self.send_and_verify(SendDataPacket.build(0, 0, 0).pack())
+
+class HostThread:
+	def __init__(self, target, *args):
+		self.error = None
+		self.thread = threading.Thread(target=self.run, args=(target, args), daemon=True)
+		self.thread.start()
+
+	def run(self, target, args):
+		try:
+			target(*args)
+		except Exception as e:
+			self.error = e
+
+	def join(self):
+		self.thread.join(10)
+		if self.error:
+			raise self.error
+
+class TestUsbPipelineInstall(unittest.TestCase):
+	def setUp(self):
+		import random
+		self.tempdir = tempfile.mkdtemp()
+		# sizes around the block size to hit partial and empty tail blocks.
+		sizes = [1, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1, BLOCK_SIZE * 9 + 123, random.randint(0, BLOCK_SIZE * 16)]
+		self.files = [(f"test{i+1}.nsp", os.urandom(size)) for i, size in enumerate(sizes)]
+
+		from usb_install import add_file_to_install_list, paths
+		paths.clear()
+		for fname, data in self.files:
+			fpath = os.path.join(self.tempdir, fname)
+			with open(fpath, "wb") as f:
+				f.write(data)
+			add_file_to_install_list(fpath)
+
+	def tearDown(self):
+		shutil.rmtree(self.tempdir)
+
+	def install(self, window, read_size):
+		from usb_install import run_install
+		host_usb, switch_usb = LoopbackUsb.pair()
+		host = HostThread(run_install, host_usb)
+		switch = FakeSwitch(switch_usb, window)
+
+		names = switch.connect()
+		self.assertEqual(names, [fname for fname, _ in self.files])
+
+		for idx, (_, data) in enumerate(self.files):
+			file_size = switch.open_file(idx)
+			self.assertEqual(file_size, len(data))
+
+			got = b""
+			while len(got) < file_size:
+				got += switch.read(len(got), read_size)
+			switch.close_file()
+			self.assertEqual(got, data)
+
+		switch.quit()
+		host.join()
+		return switch
+
+	def test_legacy(self):
+		switch = self.install(0, 1000)
+		self.assertEqual(switch.window, PIPELINE_WINDOW_NONE)
+		self.assertEqual(switch.max_pending, 0)
+
+	def test_pipelined(self):
+		switch = self.install(4, 1000)
+		self.assertEqual(switch.window, 4)
+		self.assertEqual(switch.max_pending, 4)
+
+	def test_pipelined_large_reads(self):
+		switch = self.install(4, BLOCK_SIZE * 3 + 7)
+		self.assertEqual(switch.max_pending, 4)
+
+	def test_window_is_clamped(self):
+		switch = self.install(PIPELINE_WINDOW_MAX * 2, BLOCK_SIZE)
+		self.assertEqual(switch.window, PIPELINE_WINDOW_MAX)
+
+	def test_pipelined_random_access(self):
+		from usb_install import run_install
+		host_usb, switch_usb = LoopbackUsb.pair()
+		host = HostThread(run_install, host_usb)
+		switch = FakeSwitch(switch_usb, 4)
+		switch.connect()
+
+		idx = 4
+		data = self.files[idx][1]
+		switch.open_file(idx)
+
+		# skip forward past the window, then seek backwards.
+		for off, size in [(0, 10), (BLOCK_SIZE * 7 + 5, 100), (BLOCK_SIZE + 3, BLOCK_SIZE), (len(data) - 10, 100)]:
+			self.assertEqual(switch.read(off, size), data[off:off + size])
+
+		switch.close_file()
+		switch.quit()
+		host.join()
+
+class TestUsbPipelineExport(unittest.TestCase):
+	def setUp(self):
+		self.root = tempfile.mkdtemp()
+		self.files = [(f"test{i+1}.bin", os.urandom(i * 1000 + 1)) for i in range(8)]
+
+	def tearDown(self):
+		shutil.rmtree(self.root)
+
+	def export(self, window):
+		from usb_export import run_export
+		host_usb, switch_usb = LoopbackUsb.pair()
+		host = HostThread(run_export, host_usb, self.root)
+		switch = FakeSwitch(switch_usb, window)
+
+		for fname, data in self.files:
+			switch.export(fname, data, 333)
+		switch.quit()
+		host.join()
+
+		for fname, data in self.files:
+			with open(os.path.join(self.root, fname), "rb") as f:
+				self.assertEqual(f.read(), data)
+		return switch
+
+	def test_legacy(self):
+		switch = self.export(0)
+		self.assertEqual(switch.window, PIPELINE_WINDOW_NONE)
+
+	def test_pipelined(self):
+		switch = self.export(4)
+		self.assertEqual(switch.window, 4)
+		self.assertEqual(switch.max_pending, 4)
+
+if __name__ == "__main__":
+	unittest.main()
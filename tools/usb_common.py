@@ -1,4 +1,5 @@
 import struct
+import threading
 import usb.core
 import usb.util
 import time
@@ -21,6 +22,18 @@ RESULT_ERROR = 1
 FLAG_NONE = 0
 FLAG_STREAM = 1 << 0
 
+# pipeline window, the switch asks for one in arg4 of the first send header
+# and we reply with the window we accept in arg4 of the result.
+# a window of 0 or 1 means each request waits for its result.
+PIPELINE_WINDOW_NONE = 1
+PIPELINE_WINDOW_MAX = 16
+
+def negotiate_window(want: int) -> int:
+    # older switch versions ask for 0, reply with 0 so that nothing changes.
+    if want <= PIPELINE_WINDOW_NONE:
+        return 0
+    return min(want, PIPELINE_WINDOW_MAX)
+
 class UsbPacket:
     STRUCT_FORMAT = "<6I"  # 6 unsigned 32-bit ints, little-endian
 
@@ -96,7 +109,28 @@ class SendDataPacket(UsbPacket):
     def get_crc32c(self):
         return self.arg5
 
-class Usb:
+class UsbBase:
+    def read(self, size: int, timeout: int = 0) -> bytes:
+        raise NotImplementedError
+
+    def write(self, buf: bytes, timeout: int = 0) -> int:
+        raise NotImplementedError
+
+    def get_send_header(self) -> tuple[int, int, int]:
+        packet = SendPacket.unpack(self.read(PACKET_SIZE))
+        packet.verify()
+        return packet.get_cmd(), packet.arg3, packet.arg4
+
+    def get_send_data_header(self) -> tuple[int, int, int]:
+        packet = SendDataPacket.unpack(self.read(PACKET_SIZE))
+        packet.verify()
+        return packet.get_offset(), packet.get_size(), packet.get_crc32c()
+
+    def send_result(self, result: int, arg3: int = 0, arg4: int = 0) -> None:
+        send_data = ResultPacket.build(result, arg3, arg4).pack()
+        self.write(send_data)
+
+class Usb(UsbBase):
     def __init__(self):
         self.__out_ep = None
         self.__in_ep = None
@@ -141,16 +175,67 @@ class Usb:
     def write(self, buf: bytes, timeout: int = 0) -> int:
         return self.__out_ep.write(data=buf, timeout=timeout)
 
-    def get_send_header(self) -> tuple[int, int, int]:
-        packet = SendPacket.unpack(self.read(PACKET_SIZE))
-        packet.verify()
-        return packet.get_cmd(), packet.arg3, packet.arg4
+class LoopbackPipe:
+    """one direction of a loopback connection, behaves like a bulk endpoint.
+    writes block until the other side has read all of the data."""
+
+    def __init__(self, timeout: float):
+        self.__cond = threading.Condition()
+        self.__buf = bytearray()
+        self.__closed = False
+        self.__timeout = timeout
+
+    def close(self) -> None:
+        with self.__cond:
+            self.__closed = True
+            self.__cond.notify_all()
+
+    def read(self, size: int) -> bytes:
+        with self.__cond:
+            if not self.__cond.wait_for(lambda: len(self.__buf) >= size or self.__closed, self.__timeout):
+                raise TimeoutError("loopback read timed out")
+            if len(self.__buf) < size:
+                raise EOFError("loopback closed")
+
+            data = bytes(self.__buf[:size])
+            del self.__buf[:size]
+            self.__cond.notify_all()
+            return data
+
+    def write(self, buf: bytes) -> int:
+        with self.__cond:
+            if self.__closed:
+                raise EOFError("loopback closed")
+
+            self.__buf += buf
+            self.__cond.notify_all()
+            if not self.__cond.wait_for(lambda: not self.__buf or self.__closed, self.__timeout):
+                raise TimeoutError("loopback write timed out")
+            return len(buf)
+
+class LoopbackUsb(UsbBase):
+    """in-process transport used to test both sides of the protocol without a switch.
+    create a connected pair with LoopbackUsb.pair()."""
+
+    def __init__(self, in_pipe: LoopbackPipe, out_pipe: LoopbackPipe):
+        self.__in_pipe = in_pipe
+        self.__out_pipe = out_pipe
 
-    def get_send_data_header(self) -> tuple[int, int, int]:
-        packet = SendDataPacket.unpack(self.read(PACKET_SIZE))
-        packet.verify()
-        return packet.get_offset(), packet.get_size(), packet.get_crc32c()
+    @classmethod
+    def pair(cls, timeout: float = 5.0):
+        a = LoopbackPipe(timeout)
+        b = LoopbackPipe(timeout)
+        return cls(a, b), cls(b, a)
 
-    def send_result(self, result: int, arg3: int = 0, arg4: int = 0) -> None:
-        send_data = ResultPacket.build(result, arg3, arg4).pack()
-        self.write(send_data)
+    def wait_for_connect(self) -> None:
+        pass
+
+    def close(self) -> None:
+        self.__in_pipe.close()
+        self.__out_pipe.close()
+
+    def read(self, size: int, timeout: int = 0) -> bytes:
+        return self.__in_pipe.read(size)
+
+    def write(self, buf: bytes, timeout: int = 0) -> int:
+        return self.__out_pipe.write(bytes(buf))
@@ -1,6 +1,8 @@
 import crc32c
 import sys
 import os
+import queue
+import threading
 from pathlib import Path
 from usb_common import *
 
@@ -15,38 +17,98 @@ def create_file_folder(root: Path, file_path: Path) -> Path:
 
     return full_path
 
-def wait_for_input(usb: Usb, path: Path) -> None:
+def write_file_data(file, off: int, buf: bytes, crc32c_want: int) -> int:
+    # validate the crc32c matches.
+    crc32c_got = crc32c.crc32c(buf)
+    if (crc32c_want != crc32c_got):
+        return RESULT_ERROR
+
+    try:
+        file.seek(off)
+        file.write(buf)
+        return RESULT_OK
+    except BlockingIOError as e:
+        print("Error: failed to write: {} at: {} size: {} error: {}".format(e.filename, off, len(buf), str(e)))
+        return RESULT_ERROR
+
+def file_transfer_loop(usb: UsbBase, file) -> None:
+    while True:
+        [off, size, crc32c_want] = usb.get_send_data_header()
+
+        # todo: this isn't needed really.
+        usb.send_result(RESULT_OK)
+
+        # check if we should finish now.
+        if (off == 0 and size == 0):
+            break
+
+        # read the buffer and write it out.
+        buf = usb.read(size)
+        usb.send_result(write_file_data(file, off, buf, crc32c_want))
+
+def file_transfer_loop_pipelined(usb: UsbBase, file) -> None:
+    # sphaira sends the next header and data without waiting for the result, so
+    # results are sent on another thread, otherwise both sides could block on a write.
+    results = queue.Queue()
+
+    def send_results() -> None:
+        while True:
+            result = results.get()
+            if result is None:
+                break
+            usb.send_result(result)
+
+    writer = threading.Thread(target=send_results, daemon=True)
+    writer.start()
+
+    while True:
+        [off, size, crc32c_want] = usb.get_send_data_header()
+
+        # check if we should finish now, this is acked after all of the data.
+        if (off == 0 and size == 0):
+            results.put(RESULT_OK)
+            break
+
+        # header and data are acked once.
+        buf = usb.read(size)
+        results.put(write_file_data(file, off, buf, crc32c_want))
+
+    results.put(None)
+    writer.join()
+
+def wait_for_input(usb: UsbBase, path: Path, window: int = 0) -> None:
     print("now waiting for intput\n")
 
     with open(path, "wb") as file:
         print("opened file {}".format(path))
 
-        while True:
-            [off, size, crc32c_want] = usb.get_send_data_header()
-
-            # todo: this isn't needed really.
-            usb.send_result(RESULT_OK)
-
-            # check if we should finish now.
-            if (off == 0 and size == 0):
-                break
+        if window > PIPELINE_WINDOW_NONE:
+            file_transfer_loop_pipelined(usb, file)
+        else:
+            file_transfer_loop(usb, file)
 
-            # read the buffer and calculate the crc32c.
-            buf = usb.read(size)
-            crc32c_got = crc32c.crc32c(buf)
+def run_export(usb: UsbBase, root_path: str) -> None:
+    # wait for command.
+    while True:
+        [cmd, arg3, arg4] = usb.get_send_header()
 
-            # validate the crc32c matches.
-            if (crc32c_want != crc32c_got):
-                usb.send_result(RESULT_ERROR)
-                continue
+        if (cmd == CMD_QUIT):
+            usb.send_result(RESULT_OK)
+            break
+        elif (cmd == CMD_EXPORT):
+            # reply with the window we accept, older switch versions ask for 0.
+            window = negotiate_window(arg4)
+            usb.send_result(RESULT_OK, 0, window)
+
+            # todo: handle and return errors here.
+            file_name = get_file_name(usb, arg3)
+            full_path = create_file_folder(root_path, file_name)
+            usb.send_result(RESULT_OK)
 
-            try:
-                file.seek(off)
-                file.write(buf)
-                usb.send_result(RESULT_OK)
-            except BlockingIOError as e:
-                print("Error: failed to write: {} at: {} size: {} error: {}".format(e.filename, off, size, str(e)))
-                usb.send_result(RESULT_ERROR)
+            wait_for_input(usb, full_path, window)
+        else:
+            usb.send_result(RESULT_ERROR)
+            break
 
 if __name__ == '__main__':
     print("hello world")
@@ -68,25 +130,6 @@ if __name__ == '__main__':
         # get usb endpoints.
         usb.wait_for_connect()
 
-        # wait for command.
-        while True:
-            [cmd, arg3, arg4] = usb.get_send_header()
-
-            if (cmd == CMD_QUIT):
-                usb.send_result(RESULT_OK)
-                break
-            elif (cmd == CMD_EXPORT):
-                usb.send_result(RESULT_OK)
-
-                # todo: handle and return errors here.
-                file_name = get_file_name(usb, arg3)
-                full_path = create_file_folder(root_path, file_name)
-                usb.send_result(RESULT_OK)
-
-                wait_for_input(usb, full_path)
-            else:
-                usb.send_result(RESULT_ERROR)
-                break
-
+        run_export(usb, root_path)
     except Exception as inst:
         print("An exception occurred " + str(inst))
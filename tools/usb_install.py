@@ -3,6 +3,8 @@ import glob
 from io import BufferedReader
 import sys
 import os
+import queue
+import threading
 from pathlib import Path
 from usb_common import *
 
@@ -20,12 +22,38 @@ ACCEPTED_EXTS = INSTALLABLE_EXTS + tuple(".rar")
 # real path, internal path (same if not .rar)
 paths: list[tuple[str, str]] = []
 
-def send_file_info_result(usb: Usb, result: int, file_size: int, flags: int):
+def send_file_info_result(usb: UsbBase, result: int, file_size: int, flags: int):
     size_lsb = file_size & 0xFFFFFFFF
     size_msb = ((file_size >> 32) & 0xFFFF) | (flags << 16)
     usb.send_result(result, size_msb, size_lsb)
 
-def file_transfer_loop(usb: Usb, file: BufferedReader, flags: int) -> None:
+def send_file_data(usb: UsbBase, file: BufferedReader, flags: int, off: int, size: int) -> None:
+    # if we cannot seek, ensure that sphaira doesn't try to seek backwards.
+    if (flags & FLAG_STREAM) and off < file.tell():
+        print("Error: tried to seek on file without random access.")
+        usb.send_result(RESULT_ERROR)
+        return
+
+    # read file and calculate the hash.
+    try:
+        file.seek(off)
+        buf = file.read(size)
+    except BlockingIOError as e:
+        print("Error: failed to read: {} at: {} size: {} error: {}".format(e.filename, off, size, str(e)))
+        usb.send_result(RESULT_ERROR)
+        return
+
+    # respond back with the length of the data and the crc32c.
+    usb.send_result(RESULT_OK, len(buf), crc32c.crc32c(buf))
+
+    # send the data.
+    usb.write(buf)
+
+def file_transfer_loop(usb: UsbBase, file: BufferedReader, flags: int, window: int = 0) -> None:
+    if window > PIPELINE_WINDOW_NONE:
+        file_transfer_loop_pipelined(usb, file, flags)
+        return
+
     print("inside file transfer loop now")
 
     while True:
@@ -37,28 +65,46 @@ def file_transfer_loop(usb: Usb, file: BufferedReader, flags: int) -> None:
             usb.send_result(RESULT_OK)
             break
 
-        # if we cannot seek, ensure that sphaira doesn't try to seek backwards.
-        if (flags & FLAG_STREAM) and off < file.tell():
-            print("Error: tried to seek on file without random access.")
-            usb.send_result(RESULT_ERROR)
-            continue
+        send_file_data(usb, file, flags, off, size)
 
-        # read file and calculate the hash.
+def file_transfer_loop_pipelined(usb: UsbBase, file: BufferedReader, flags: int) -> None:
+    print("inside pipelined file transfer loop now")
+
+    # sphaira sends the next requests without waiting for the data, so they
+    # are read on another thread, otherwise both sides could block on a write.
+    requests = queue.Queue()
+
+    def read_requests() -> None:
         try:
-            file.seek(off)
-            buf = file.read(size)
-        except BlockingIOError as e:
-            print("Error: failed to read: {} at: {} size: {} error: {}".format(e.filename, off, size, str(e)))
-            usb.send_result(RESULT_ERROR)
-            continue
+            while True:
+                [off, size, _] = usb.get_send_data_header()
+                requests.put((off, size))
+                if (off == 0 and size == 0):
+                    break
+        except Exception as e:
+            requests.put(e)
+
+    reader = threading.Thread(target=read_requests, daemon=True)
+    reader.start()
+
+    # requests are answered in the order that they were sent.
+    while True:
+        request = requests.get()
+        if isinstance(request, Exception):
+            raise request
+
+        [off, size] = request
 
-        # respond back with the length of the data and the crc32c.
-        usb.send_result(RESULT_OK, len(buf), crc32c.crc32c(buf))
+        # check if we should finish now.
+        if (off == 0 and size == 0):
+            usb.send_result(RESULT_OK)
+            break
 
-        # send the data.
-        usb.write(buf)
+        send_file_data(usb, file, flags, off, size)
 
-def wait_for_input(usb: Usb, file_index: int) -> None:
+    reader.join()
+
+def wait_for_input(usb: UsbBase, file_index: int, window: int = 0) -> None:
     print("now waiting for intput\n")
 
     # open file / rar. (todo: learn how to make a class with inheritance)
@@ -76,14 +122,14 @@ def wait_for_input(usb: Usb, file_index: int) -> None:
 
                     print("opened file: {} flags: {}".format(internal_path, flags))
                     send_file_info_result(usb, RESULT_OK, info.file_size, flags)
-                    file_transfer_loop(usb, file, flags)
+                    file_transfer_loop(usb, file, flags, window)
         else:
             with open(path, "rb") as file:
                 print("opened file {}".format(path))
                 file.seek(0, os.SEEK_END)
                 file_size = file.tell()
                 send_file_info_result(usb, RESULT_OK, file_size, flags)
-                file_transfer_loop(usb, file, flags)
+                file_transfer_loop(usb, file, flags, window)
 
     except OSError as e:
         print("Error: failed to open: {} error: {}".format(e.filename, str(e)))
@@ -107,6 +153,34 @@ def add_file_to_install_list(path: str) -> None:
         print("Adding file: {} type: FILE".format(path))
         paths.append([path, path])
 
+def run_install(usb: UsbBase) -> None:
+    # build string table.
+    string_table = bytes()
+    for [_, path] in paths:
+        string_table += bytes(Path(path).name.__str__(), 'utf8') + b'\n'
+
+    # this reads the send header and checks the magic.
+    [_, _, window_want] = usb.get_send_header()
+    window = negotiate_window(window_want)
+    print("pipeline window: {}".format(window))
+
+    # send recv, accepted window and string table.
+    usb.send_result(RESULT_OK, len(string_table), window)
+    usb.write(string_table)
+
+    # wait for command.
+    while True:
+        [cmd, arg3, arg4] = usb.get_send_header()
+
+        if cmd == CMD_QUIT:
+            usb.send_result(RESULT_OK)
+            break
+        elif cmd == CMD_OPEN:
+            wait_for_input(usb, arg3, window)
+        else:
+            usb.send_result(RESULT_ERROR)
+            break
+
 if __name__ == '__main__':
     print("hello world")
 
@@ -133,30 +207,6 @@ if __name__ == '__main__':
         # get usb endpoints.
         usb.wait_for_connect()
 
-        # build string table.
-        string_table = bytes()
-        for [_, path] in paths:
-            string_table += bytes(Path(path).name.__str__(), 'utf8') + b'\n'
-
-        # this reads the send header and checks the magic.
-        usb.get_send_header()
-
-        # send recv and string table.
-        usb.send_result(RESULT_OK, len(string_table))
-        usb.write(string_table)
-
-        # wait for command.
-        while True:
-            [cmd, arg3, arg4] = usb.get_send_header()
-
-            if cmd == CMD_QUIT:
-                usb.send_result(RESULT_OK)
-                break
-            elif cmd == CMD_OPEN:
-                wait_for_input(usb, arg3)
-            else:
-                usb.send_result(RESULT_ERROR)
-                break
-
+        run_install(usb)
     except Exception as inst:
         print("An exception occurred " + str(inst))